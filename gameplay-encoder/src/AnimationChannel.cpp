@@ -1,12 +1,20 @@
 #include "Base.h"
 #include "AnimationChannel.h"
 #include "Transform.h"
+#include "Quaternion.h"
+
+// The storage formats of the key values in the binary file.
+#define ANIMATION_CHANNEL_VALUES_FLOAT 0
+#define ANIMATION_CHANNEL_VALUES_QUANTIZED 1
+
+// The largest quantized key value.
+#define ANIMATION_CHANNEL_QUANTIZED_MAX 65535
 
 namespace gameplay
 {
 
 AnimationChannel::AnimationChannel(void) :
-    _targetAttrib(0)
+    _targetAttrib(0), _quantized(false)
 {
 }
 
@@ -28,12 +36,21 @@ void AnimationChannel::writeBinary(FILE* file)
     Object::writeBinary(file);
     write(_targetId, file);
     write(_targetAttrib, file);
+    bool quantized = _quantized && !_keytimes.empty() && _keyValues.size() % _keytimes.size() == 0;
+    write((unsigned char)(quantized ? ANIMATION_CHANNEL_VALUES_QUANTIZED : ANIMATION_CHANNEL_VALUES_FLOAT), file);
     write(_keytimes.size(), file);
     for (std::vector<float>::const_iterator i = _keytimes.begin(); i != _keytimes.end(); ++i)
     {
         write((unsigned long)*i, file);
     }
-    write(_keyValues, file);
+    if (quantized)
+    {
+        writeQuantizedValues(file);
+    }
+    else
+    {
+        write(_keyValues, file);
+    }
     write(_tangentsIn, file);
     write(_tangentsOut, file);
     write(_interpolations, file);
@@ -167,6 +184,95 @@ void AnimationChannel::removeDuplicates()
     }
 }
 
+unsigned int AnimationChannel::reduceKeys(float positionTolerance, float rotationTolerance, float scaleTolerance)
+{
+    // The runtime interpolates every channel linearly, so only channels keyed that way are
+    // known to be played back as the error below is measured.
+    for (std::vector<unsigned int>::const_iterator i = _interpolations.begin(); i != _interpolations.end(); ++i)
+    {
+        if (*i != LINEAR)
+        {
+            return 0;
+        }
+    }
+
+    KeyGroup groups[3];
+    const unsigned int groupCount = getKeyGroups(positionTolerance, rotationTolerance, scaleTolerance, groups);
+    const size_t keyCount = _keytimes.size();
+    if (groupCount == 0 || keyCount < 3)
+    {
+        return 0;
+    }
+    const unsigned int componentCount = groups[groupCount - 1].offset + groups[groupCount - 1].count;
+    if (_keyValues.size() != keyCount * componentCount)
+    {
+        return 0;
+    }
+
+    // Extend each segment from the last kept key for as long as the keys it skips are
+    // interpolated within the tolerances, then keep the last key that fit.
+    std::vector<size_t> keys;
+    keys.push_back(0);
+    for (size_t end = 2; end < keyCount; ++end)
+    {
+        if (!canInterpolate(keys.back(), end, componentCount, groups, groupCount))
+        {
+            keys.push_back(end - 1);
+        }
+    }
+    keys.push_back(keyCount - 1);
+    if (keys.size() == keyCount)
+    {
+        return 0;
+    }
+
+    // Move the kept keys to the front. Tangents and interpolations are moved with them
+    // when there is one for each key.
+    const bool tangentsIn = _tangentsIn.size() == _keyValues.size();
+    const bool tangentsOut = _tangentsOut.size() == _keyValues.size();
+    const bool interpolations = _interpolations.size() == keyCount;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const size_t src = keys[i] * componentCount;
+        const size_t dst = i * componentCount;
+        _keytimes[i] = _keytimes[keys[i]];
+        std::copy(_keyValues.begin() + src, _keyValues.begin() + src + componentCount, _keyValues.begin() + dst);
+        if (tangentsIn)
+        {
+            std::copy(_tangentsIn.begin() + src, _tangentsIn.begin() + src + componentCount, _tangentsIn.begin() + dst);
+        }
+        if (tangentsOut)
+        {
+            std::copy(_tangentsOut.begin() + src, _tangentsOut.begin() + src + componentCount, _tangentsOut.begin() + dst);
+        }
+        if (interpolations)
+        {
+            _interpolations[i] = _interpolations[keys[i]];
+        }
+    }
+    _keytimes.resize(keys.size());
+    _keyValues.resize(keys.size() * componentCount);
+    if (tangentsIn)
+    {
+        _tangentsIn.resize(_keyValues.size());
+    }
+    if (tangentsOut)
+    {
+        _tangentsOut.resize(_keyValues.size());
+    }
+    if (interpolations)
+    {
+        _interpolations.resize(keys.size());
+    }
+
+    return keyCount - keys.size();
+}
+
+void AnimationChannel::setQuantized(bool quantized)
+{
+    _quantized = quantized;
+}
+
 void AnimationChannel::convertToQuaternion()
 {
     if (_targetAttrib == Transform::ANIMATE_ROTATE_X ||
@@ -270,6 +376,172 @@ unsigned int AnimationChannel::getInterpolationType(const char* str)
     return value;
 }
 
+unsigned int AnimationChannel::getKeyGroups(float positionTolerance, float rotationTolerance, float scaleTolerance, KeyGroup* groups) const
+{
+    unsigned int scaleCount = 0;
+    unsigned int rotationCount = 0;
+    unsigned int translationCount = 0;
+    switch (_targetAttrib)
+    {
+    case Transform::ANIMATE_SCALE:
+        scaleCount = 3;
+        break;
+    case Transform::ANIMATE_SCALE_X:
+    case Transform::ANIMATE_SCALE_Y:
+    case Transform::ANIMATE_SCALE_Z:
+        scaleCount = 1;
+        break;
+    case Transform::ANIMATE_SCALE_XY:
+    case Transform::ANIMATE_SCALE_XZ:
+    case Transform::ANIMATE_SCALE_YZ:
+        scaleCount = 2;
+        break;
+    case Transform::ANIMATE_ROTATE:
+        rotationCount = 4;
+        break;
+    case Transform::ANIMATE_TRANSLATE:
+        translationCount = 3;
+        break;
+    case Transform::ANIMATE_TRANSLATE_X:
+    case Transform::ANIMATE_TRANSLATE_Y:
+    case Transform::ANIMATE_TRANSLATE_Z:
+        translationCount = 1;
+        break;
+    case Transform::ANIMATE_TRANSLATE_XY:
+    case Transform::ANIMATE_TRANSLATE_XZ:
+    case Transform::ANIMATE_TRANSLATE_YZ:
+        translationCount = 2;
+        break;
+    case Transform::ANIMATE_ROTATE_TRANSLATE:
+        rotationCount = 4;
+        translationCount = 3;
+        break;
+    case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+        scaleCount = 3;
+        rotationCount = 4;
+        translationCount = 3;
+        break;
+    default:
+        return 0;
+    }
+
+    // The groups are in the order of the key values: scale, rotation, then translation.
+    unsigned int groupCount = 0;
+    unsigned int offset = 0;
+    if (scaleCount > 0)
+    {
+        KeyGroup& group = groups[groupCount++];
+        group.offset = offset;
+        group.count = scaleCount;
+        group.rotation = false;
+        group.tolerance = scaleTolerance;
+        offset += scaleCount;
+    }
+    if (rotationCount > 0)
+    {
+        KeyGroup& group = groups[groupCount++];
+        group.offset = offset;
+        group.count = rotationCount;
+        group.rotation = true;
+        group.tolerance = rotationTolerance;
+        offset += rotationCount;
+    }
+    if (translationCount > 0)
+    {
+        KeyGroup& group = groups[groupCount++];
+        group.offset = offset;
+        group.count = translationCount;
+        group.rotation = false;
+        group.tolerance = positionTolerance;
+    }
+    return groupCount;
+}
+
+bool AnimationChannel::canInterpolate(size_t begin, size_t end, unsigned int componentCount, const KeyGroup* groups, unsigned int groupCount) const
+{
+    const float* from = &_keyValues[begin * componentCount];
+    const float* to = &_keyValues[end * componentCount];
+    const float duration = _keytimes[end] - _keytimes[begin];
+    for (size_t i = begin + 1; i < end; ++i)
+    {
+        const float* value = &_keyValues[i * componentCount];
+        float t = duration > 0.0f ? (_keytimes[i] - _keytimes[begin]) / duration : 0.0f;
+        t = std::min(std::max(t, 0.0f), 1.0f);
+        for (unsigned int j = 0; j < groupCount; ++j)
+        {
+            const KeyGroup& group = groups[j];
+            const float* a = from + group.offset;
+            const float* b = to + group.offset;
+            const float* v = value + group.offset;
+            float error = 0.0f;
+            if (group.rotation)
+            {
+                // The angle between the original rotation and the one slerped by the runtime.
+                Quaternion q;
+                Quaternion::slerp(Quaternion(a[0], a[1], a[2], a[3]), Quaternion(b[0], b[1], b[2], b[3]), t, &q);
+                float lengths = sqrt((q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w) * (v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]));
+                if (lengths > 0.0f)
+                {
+                    float cosHalfAngle = fabs(q.x * v[0] + q.y * v[1] + q.z * v[2] + q.w * v[3]) / lengths;
+                    error = 2.0f * acos(std::min(cosHalfAngle, 1.0f));
+                }
+            }
+            else
+            {
+                for (unsigned int k = 0; k < group.count; ++k)
+                {
+                    float d = a[k] + (b[k] - a[k]) * t - v[k];
+                    error += d * d;
+                }
+                error = sqrt(error);
+            }
+            if (error > group.tolerance)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void AnimationChannel::writeQuantizedValues(FILE* file)
+{
+    // Each component is stored as a number of steps above its minimum over all keys,
+    // so the precision follows the range of each component rather than its magnitude.
+    const size_t componentCount = _keyValues.size() / _keytimes.size();
+    std::vector<float> ranges(componentCount * 2);
+    for (size_t i = 0; i < componentCount; ++i)
+    {
+        float minimum = _keyValues[i];
+        float maximum = _keyValues[i];
+        for (size_t j = i; j < _keyValues.size(); j += componentCount)
+        {
+            minimum = std::min(minimum, _keyValues[j]);
+            maximum = std::max(maximum, _keyValues[j]);
+        }
+        ranges[i * 2] = minimum;
+        ranges[i * 2 + 1] = (maximum - minimum) / ANIMATION_CHANNEL_QUANTIZED_MAX;
+    }
+
+    std::vector<unsigned short> values(_keyValues.size());
+    for (size_t i = 0; i < _keyValues.size(); ++i)
+    {
+        const float step = ranges[(i % componentCount) * 2 + 1];
+        if (step > 0.0f)
+        {
+            float steps = (_keyValues[i] - ranges[(i % componentCount) * 2]) / step + 0.5f;
+            values[i] = (unsigned short)std::min(std::max(steps, 0.0f), (float)ANIMATION_CHANNEL_QUANTIZED_MAX);
+        }
+        else
+        {
+            values[i] = 0;
+        }
+    }
+
+    write(ranges, file);
+    write(values, file);
+}
+
 void AnimationChannel::deleteRange(size_t begin, size_t end)
 {
     // delete range
@@ -62,6 +62,30 @@ public:
 
     void removeDuplicates();
 
+    /**
+     * Removes the keys that linear interpolation between the remaining keys reproduces
+     * within the given tolerances. The first and last keys are always kept.
+     *
+     * Only scale, rotation and translation channels with linear interpolation are reduced.
+     * Rotations are compared by the angle between the interpolated and original quaternions,
+     * and scales and translations by the distance between the interpolated and original values.
+     *
+     * @param positionTolerance The maximum translation error.
+     * @param rotationTolerance The maximum rotation error, in radians.
+     * @param scaleTolerance The maximum scale error.
+     *
+     * @return The number of keys removed.
+     */
+    unsigned int reduceKeys(float positionTolerance, float rotationTolerance, float scaleTolerance);
+
+    /**
+     * Sets whether the key values are written as 16-bit values quantized over the range
+     * of each component, rather than as floats.
+     *
+     * @param quantized True to quantize the key values.
+     */
+    void setQuantized(bool quantized);
+
     void convertToQuaternion();
     void convertToTransform();
 
@@ -77,7 +101,35 @@ public:
 
 private:
 
+    /**
+     * A group of key value components whose error is measured together when reducing keys.
+     */
+    struct KeyGroup
+    {
+        unsigned int offset;    // The first component of the group.
+        unsigned int count;     // The number of components of the group.
+        bool rotation;          // Whether the components are a quaternion.
+        float tolerance;        // The maximum error of the group.
+    };
+
     void deleteRange(size_t begin, size_t end);
+
+    /**
+     * Gets the groups of components of the key values of the target attribute.
+     *
+     * @return The number of groups, or zero if the target attribute is not reduced.
+     */
+    unsigned int getKeyGroups(float positionTolerance, float rotationTolerance, float scaleTolerance, KeyGroup* groups) const;
+
+    /**
+     * Returns true if the keys between the given keys are interpolated from them within the tolerances.
+     */
+    bool canInterpolate(size_t begin, size_t end, unsigned int componentCount, const KeyGroup* groups, unsigned int groupCount) const;
+
+    /**
+     * Writes the key values quantized to 16 bits over the range of each component.
+     */
+    void writeQuantizedValues(FILE* file);
 private:
 
     std::string _targetId;
@@ -87,6 +139,7 @@ private:
     std::vector<float> _tangentsIn;
     std::vector<float> _tangentsOut;
     std::vector<unsigned int> _interpolations;
+    bool _quantized;
 };
 
 }
@@ -320,6 +320,14 @@ void DAESceneEncoder::write(const std::string& filepath, const EncoderArguments&
     dstFilename.append(getFilenameNoExt(filenameOnly));
 
     _gamePlayFile.adjust();
+    if (arguments.animationReductionEnabled())
+    {
+        _gamePlayFile.reduceAnimations(arguments.getAnimationPositionTolerance(), arguments.getAnimationRotationTolerance(), arguments.getAnimationScaleTolerance());
+    }
+    if (arguments.animationQuantizationEnabled())
+    {
+        _gamePlayFile.quantizeAnimations();
+    }
 
     if (text)
     {
@@ -1531,6 +1539,7 @@ Mesh* DAESceneEncoder::loadMesh(const domMesh* meshElement, const std::string& g
     }
     mesh = new Mesh();
     mesh->setId(geometryId.c_str());
+    mesh->setWeldTolerance(EncoderArguments::getInstance()->getWeldTolerance());
     
     std::vector<DAEPolygonInput*> polygonInputs;
 
@@ -1759,19 +1768,9 @@ Mesh* DAESceneEncoder::loadMesh(const domMesh* meshElement, const std::string& g
             // On the last input source attempt to add the vertex or index an existing one.
             if (k == (inputSourceCount - 1))
             {
-                // Only add unique vertices, use a hashtable and compare the hash functions of the
-                // vertices. If they exist simply lookup the index of the existing ones.
-                // otherwise add and new one and index it.
-                unsigned int index;
-                if (mesh->contains(vertex))
-                {
-                    index = mesh->getVertexIndex(vertex);
-                }
-                else
-                {
-                    index = mesh->addVertex(vertex);
-                }
-                subset->addIndex(index);
+                // Only add unique vertices: the mesh's vertex hash table returns the index
+                // of an existing vertex, or adds the new one and returns its index.
+                subset->addIndex(mesh->weldVertex(vertex));
 
                 poly += (maxOffset+1);
                 k = 0;
@@ -15,10 +15,17 @@ static EncoderArguments* __instance;
 
 EncoderArguments::EncoderArguments(size_t argc, const char** argv) :
     _fontSize(0),
+    _animationPositionTolerance(0.0f),
+    _animationRotationTolerance(0.0f),
+    _animationScaleTolerance(0.0f),
+    _weldTolerance(0.0f),
     _parseError(false),
     _fontPreview(false),
+    _fontDistanceField(false),
     _textOutput(false),
-    _daeOutput(false)
+    _daeOutput(false),
+    _animationReduction(false),
+    _animationQuantization(false)
 {
     __instance = this;
 
@@ -149,6 +156,14 @@ void EncoderArguments::printUsage() const
         "\t\t\tList of nodes to generate heightmaps for.\n" \
         "\t\t\tNode id list should be in quotes with a space between each id.\n" \
         "\t\t\tHeightmaps will be saved in files named <nodeid>.png.\n");
+    fprintf(stderr,"  -weld <tolerance>\tWeld mesh vertices whose attributes differ by less than the tolerance.\n" \
+        "\t\t\tThe tolerance applies to positions, normals and texture coordinates alike;\n" \
+        "\t\t\tjoint indices must match exactly.\n");
+    fprintf(stderr,"  -reduceAnimations <position> <rotation> <scale>\n" \
+        "\t\t\tRemove animation keys that interpolation reproduces within the\n" \
+        "\t\t\tgiven translation, rotation (in degrees) and scale errors.\n");
+    fprintf(stderr,"  -quantizeAnimations\n" \
+        "\t\t\tWrite animation key values as 16-bit quantized values.\n");
     fprintf(stderr,"\n");
     fprintf(stderr,"COLLADA file options:\n");
     fprintf(stderr,"  -dae <filepath>\tOutput optimized DAE.\n");
@@ -156,6 +171,7 @@ void EncoderArguments::printUsage() const
     fprintf(stderr,"TTF file options:\n");
     fprintf(stderr,"  -s <size of font>\tSize of the font.\n");
     fprintf(stderr,"  -p\t\t\tOutput font preview.\n");
+    fprintf(stderr,"  -sdf\t\t\tOutput a signed distance field font, which can be drawn at any size.\n");
     exit(8);
 }
 
@@ -164,6 +180,11 @@ bool EncoderArguments::fontPreviewEnabled() const
     return _fontPreview;
 }
 
+bool EncoderArguments::fontDistanceFieldEnabled() const
+{
+    return _fontDistanceField;
+}
+
 bool EncoderArguments::textOutputEnabled() const
 {
     return _textOutput;
@@ -174,6 +195,36 @@ bool EncoderArguments::DAEOutputEnabled() const
     return _daeOutput;
 }
 
+bool EncoderArguments::animationReductionEnabled() const
+{
+    return _animationReduction;
+}
+
+bool EncoderArguments::animationQuantizationEnabled() const
+{
+    return _animationQuantization;
+}
+
+float EncoderArguments::getAnimationPositionTolerance() const
+{
+    return _animationPositionTolerance;
+}
+
+float EncoderArguments::getAnimationRotationTolerance() const
+{
+    return _animationRotationTolerance;
+}
+
+float EncoderArguments::getAnimationScaleTolerance() const
+{
+    return _animationScaleTolerance;
+}
+
+float EncoderArguments::getWeldTolerance() const
+{
+    return _weldTolerance;
+}
+
 const char* EncoderArguments::getNodeId() const
 {
     if (_nodeId.length() == 0)
@@ -308,7 +359,35 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
     case 'p':
         _fontPreview = true;
         break;
+    case 'q':
+        if (str.compare("-quantizeAnimations") == 0)
+        {
+            _animationQuantization = true;
+        }
+        break;
+    case 'r':
+        if (str.compare("-reduceAnimations") == 0)
+        {
+            // read three tolerances, make sure not to go out of bounds
+            if ((*index + 3) >= options.size())
+            {
+                fprintf(stderr, "Error: -reduceAnimations requires 3 arguments.\n");
+                _parseError = true;
+                return;
+            }
+            _animationPositionTolerance = (float)atof(options[++(*index)].c_str());
+            _animationRotationTolerance = MATH_DEG_TO_RAD((float)atof(options[++(*index)].c_str()));
+            _animationScaleTolerance = (float)atof(options[++(*index)].c_str());
+            _animationReduction = true;
+        }
+        break;
     case 's':
+        if (str.compare("-sdf") == 0)
+        {
+            _fontDistanceField = true;
+            break;
+        }
+
         // Font Size
 
         // old format was -s##
@@ -338,6 +417,22 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
     case 't':
         _textOutput = true;
         break;
+    case 'w':
+        if (str.compare("-weld") == 0)
+        {
+            (*index)++;
+            if (*index < options.size())
+            {
+                _weldTolerance = std::max((float)atof(options[*index].c_str()), 0.0f);
+            }
+            else
+            {
+                fprintf(stderr, "Error: missing argument for -weld.\n");
+                _parseError = true;
+                return;
+            }
+        }
+        break;
     default:
         break;
     }
@@ -86,9 +86,29 @@ public:
     void printUsage() const;
 
     bool fontPreviewEnabled() const;
+    bool fontDistanceFieldEnabled() const;
     bool textOutputEnabled() const;
     bool DAEOutputEnabled() const;
 
+    /**
+     * Returns true if animation keys that interpolation reproduces within the tolerances should be removed.
+     */
+    bool animationReductionEnabled() const;
+
+    /**
+     * Returns true if animation key values should be written as 16-bit quantized values.
+     */
+    bool animationQuantizationEnabled() const;
+
+    float getAnimationPositionTolerance() const;
+    float getAnimationRotationTolerance() const;
+    float getAnimationScaleTolerance() const;
+
+    /**
+     * Returns the tolerance within which mesh vertices are welded, or zero to only weld identical vertices.
+     */
+    float getWeldTolerance() const;
+
     const char* getNodeId() const;
     unsigned int getFontSize() const;
 
@@ -118,10 +138,18 @@ private:
 
     unsigned int _fontSize;
 
+    float _animationPositionTolerance;
+    float _animationRotationTolerance;
+    float _animationScaleTolerance;
+    float _weldTolerance;
+
     bool _parseError;
     bool _fontPreview;
+    bool _fontDistanceField;
     bool _textOutput;
     bool _daeOutput;
+    bool _animationReduction;
+    bool _animationQuantization;
 
     std::vector<std::string> _groupAnimationNodeId;
     std::vector<std::string> _groupAnimationAnimationId;
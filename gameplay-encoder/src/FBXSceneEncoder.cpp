@@ -185,6 +185,14 @@ void FBXSceneEncoder::write(const std::string& filepath, const EncoderArguments&
 
     print("Optimizing GamePlay Binary.");
     _gamePlayFile.adjust();
+    if (arguments.animationReductionEnabled())
+    {
+        _gamePlayFile.reduceAnimations(arguments.getAnimationPositionTolerance(), arguments.getAnimationRotationTolerance(), arguments.getAnimationScaleTolerance());
+    }
+    if (arguments.animationQuantizationEnabled())
+    {
+        _gamePlayFile.quantizeAnimations();
+    }
     
     std::string filenameOnly = getFilenameFromFilePath(filepath);
     std::string dstFilename = filepath.substr(0, filepath.find_last_of('/'));
@@ -735,6 +743,7 @@ Mesh* FBXSceneEncoder::loadMesh(KFbxMesh* fbxMesh)
         return mesh;
     }
     mesh = new Mesh();
+    mesh->setWeldTolerance(EncoderArguments::getInstance()->getWeldTolerance());
     // GamePlay requires that a mesh have a unique ID but KFbxMesh doesn't have a string ID.
     const char* name = fbxMesh->GetNode()->GetName();
     if (name)
@@ -795,16 +804,7 @@ Mesh* FBXSceneEncoder::loadMesh(KFbxMesh* fbxMesh)
             }
 
             // Add the vertex to the mesh if it hasn't already been added and find the vertex index.
-            unsigned int index;
-            if (mesh->contains(vertex))
-            {
-                index = mesh->getVertexIndex(vertex);
-            }
-            else
-            {
-                index = mesh->addVertex(vertex);
-            }
-            meshParts[meshPartIndex]->addIndex(index);
+            meshParts[meshPartIndex]->addIndex(mesh->weldVertex(vertex));
             vertexIndex++;
         }
     }
@@ -1,11 +1,36 @@
 #include "Base.h"
 #include "GPBFile.h"
+#include "ThreadUtil.h"
 
 namespace gameplay
 {
 
 static GPBFile* __instance = NULL;
 
+/**
+ * The animation channels reduced by one thread.
+ */
+struct KeyReductionJob
+{
+    const std::vector<AnimationChannel*>* channels; // The channels to reduce.
+    unsigned int first;                             // The first channel reduced by this job.
+    unsigned int stride;                            // The number of channels between those reduced by this job.
+    float positionTolerance;                        // The maximum translation error.
+    float rotationTolerance;                        // The maximum rotation error, in radians.
+    float scaleTolerance;                           // The maximum scale error.
+    unsigned int removedKeyCount;                   // The number of keys removed by this job.
+};
+
+static void reduceKeys(void* data, unsigned int index)
+{
+    KeyReductionJob* job = (KeyReductionJob*)data + index;
+    const std::vector<AnimationChannel*>& channels = *job->channels;
+    for (unsigned int i = job->first; i < channels.size(); i += job->stride)
+    {
+        job->removedKeyCount += channels[i]->reduceKeys(job->positionTolerance, job->rotationTolerance, job->scaleTolerance);
+    }
+}
+
 GPBFile::GPBFile(void)
     : _file(NULL), _animationsAdded(false)
 {
@@ -245,6 +270,12 @@ void GPBFile::adjust()
         }
     }
 
+    // optimize the triangle and vertex order of each mesh
+    for (std::list<Mesh*>::iterator i = _geometry.begin(); i != _geometry.end(); ++i)
+    {
+        (*i)->optimize();
+    }
+
     // TODO:
     // remove ambient _lights
     // for each node
@@ -259,4 +290,61 @@ void GPBFile::adjust()
     //   This can be merged into one animation. Same for scale animations.
 }
 
+void GPBFile::reduceAnimations(float positionTolerance, float rotationTolerance, float scaleTolerance)
+{
+    std::vector<AnimationChannel*> channels;
+    unsigned int keyCount = 0;
+    for (unsigned int i = 0; i < _animations.getAnimationCount(); ++i)
+    {
+        Animation* animation = _animations.getAnimation(i);
+        for (unsigned int j = 0; j < animation->getAnimationChannelCount(); ++j)
+        {
+            AnimationChannel* channel = animation->getAnimationChannel(j);
+            channels.push_back(channel);
+            keyCount += channel->getKeyTimes().size();
+        }
+    }
+    if (channels.empty())
+    {
+        return;
+    }
+
+    unsigned int threadCount = std::max(std::min(getProcessorCount(), (unsigned int)channels.size()), 1u);
+
+    std::vector<KeyReductionJob> jobs(threadCount);
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        KeyReductionJob& job = jobs[i];
+        job.channels = &channels;
+        job.first = i;
+        job.stride = threadCount;
+        job.positionTolerance = positionTolerance;
+        job.rotationTolerance = rotationTolerance;
+        job.scaleTolerance = scaleTolerance;
+        job.removedKeyCount = 0;
+    }
+
+    // Each channel is only touched by one job, so the threads need no synchronization.
+    runParallel(threadCount, reduceKeys, &jobs[0]);
+
+    unsigned int removedKeyCount = 0;
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        removedKeyCount += jobs[i].removedKeyCount;
+    }
+    fprintf(stderr, "Reduced animation keys from %u to %u.\n", keyCount, keyCount - removedKeyCount);
+}
+
+void GPBFile::quantizeAnimations()
+{
+    for (unsigned int i = 0; i < _animations.getAnimationCount(); ++i)
+    {
+        Animation* animation = _animations.getAnimation(i);
+        for (unsigned int j = 0; j < animation->getAnimationChannelCount(); ++j)
+        {
+            animation->getAnimationChannel(j)->setQuantized(true);
+        }
+    }
+}
+
 }
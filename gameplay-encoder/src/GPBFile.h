@@ -21,7 +21,7 @@ namespace gameplay
  * Increment the version number when making a change that break binary compatibility.
  * [0] is major, [1] is minor.
  */
-const unsigned char GPB_VERSION[2] = {1, 1};
+const unsigned char GPB_VERSION[2] = {1, 2};
 
 /**
  * The GamePlay Binary file class handles writing the GamePlay Binary file.
@@ -98,6 +98,21 @@ public:
      */
     void adjust();
 
+    /**
+     * Removes the animation keys that linear interpolation reproduces within the given
+     * tolerances. The channels are reduced on one thread per processor.
+     *
+     * @param positionTolerance The maximum translation error.
+     * @param rotationTolerance The maximum rotation error, in radians.
+     * @param scaleTolerance The maximum scale error.
+     */
+    void reduceAnimations(float positionTolerance, float rotationTolerance, float scaleTolerance);
+
+    /**
+     * Sets the key values of all animation channels to be written as 16-bit quantized values.
+     */
+    void quantizeAnimations();
+
 private:
 
     FILE* _file;
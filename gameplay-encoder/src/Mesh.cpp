@@ -2,10 +2,49 @@
 #include "Mesh.h"
 #include "Model.h"
 
+// The number of floats in the hash table key of a vertex.
+#define MESH_VERTEX_KEY_SIZE 22
+
+// The offset of the blend indices in the hash table key of a vertex. The
+// attributes before it are snapped to the weld tolerance; the indices are not.
+#define MESH_VERTEX_KEY_BLEND_INDICES 18
+
+// The value of unused vertex hash table entries.
+#define MESH_VERTEX_EMPTY 0xFFFFFFFF
+
+// The initial capacity of the vertex hash table.
+#define MESH_VERTEX_TABLE_CAPACITY 1024
+
 namespace gameplay
 {
 
-Mesh::Mesh(void) : model(NULL)
+/**
+ * Returns the MurmurHash3 hash of the bits of a vertex key.
+ */
+static unsigned int hashVertexKey(const float* key)
+{
+    unsigned int hash = 0;
+    for (unsigned int i = 0; i < MESH_VERTEX_KEY_SIZE; ++i)
+    {
+        unsigned int k;
+        memcpy(&k, key + i, sizeof(k));
+        k *= 0xcc9e2d51;
+        k = (k << 15) | (k >> 17);
+        k *= 0x1b873593;
+        hash ^= k;
+        hash = (hash << 13) | (hash >> 19);
+        hash = hash * 5 + 0xe6546b64;
+    }
+    hash ^= MESH_VERTEX_KEY_SIZE * sizeof(float);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+Mesh::Mesh(void) : model(NULL), _weldTolerance(0.0f)
 {
 }
 
@@ -362,22 +401,191 @@ const VertexElement& Mesh::getVertexElement(unsigned int index) const
 
 bool Mesh::contains(const Vertex& vertex) const
 {
-    return vertexLookupTable.count(vertex) > 0;
+    if (_vertexTable.empty())
+    {
+        return false;
+    }
+    float key[MESH_VERTEX_KEY_SIZE];
+    getVertexKey(vertex, key);
+    return _vertexTable[findVertexEntry(key, hashVertexKey(key))].index != MESH_VERTEX_EMPTY;
 }
 
 unsigned int Mesh::addVertex(const Vertex& vertex)
 {
+    // Keep the hash table at most half full.
+    if ((vertices.size() + 1) * 2 > _vertexTable.size())
+    {
+        rehashVertices(_vertexTable.empty() ? MESH_VERTEX_TABLE_CAPACITY : _vertexTable.size() * 2);
+    }
+
     unsigned int index = getVertexCount();
+    float key[MESH_VERTEX_KEY_SIZE];
+    getVertexKey(vertex, key);
+    unsigned int hash = hashVertexKey(key);
+    VertexEntry& entry = _vertexTable[findVertexEntry(key, hash)];
+    if (entry.index == MESH_VERTEX_EMPTY)
+    {
+        entry.index = index;
+        entry.hash = hash;
+    }
     vertices.push_back(vertex);
-    vertexLookupTable[vertex] = index;
     return index;
 }
 
 unsigned int Mesh::getVertexIndex(const Vertex& vertex)
 {
-    std::map<Vertex,unsigned int>::iterator it;
-    it = vertexLookupTable.find(vertex);
-    return it->second;
+    assert(contains(vertex));
+    float key[MESH_VERTEX_KEY_SIZE];
+    getVertexKey(vertex, key);
+    return _vertexTable[findVertexEntry(key, hashVertexKey(key))].index;
+}
+
+unsigned int Mesh::weldVertex(const Vertex& vertex)
+{
+    if ((vertices.size() + 1) * 2 > _vertexTable.size())
+    {
+        rehashVertices(_vertexTable.empty() ? MESH_VERTEX_TABLE_CAPACITY : _vertexTable.size() * 2);
+    }
+
+    float key[MESH_VERTEX_KEY_SIZE];
+    getVertexKey(vertex, key);
+    unsigned int hash = hashVertexKey(key);
+    VertexEntry& entry = _vertexTable[findVertexEntry(key, hash)];
+    if (entry.index == MESH_VERTEX_EMPTY)
+    {
+        entry.index = getVertexCount();
+        entry.hash = hash;
+        vertices.push_back(vertex);
+    }
+    return entry.index;
+}
+
+void Mesh::setWeldTolerance(float tolerance)
+{
+    _weldTolerance = tolerance;
+    if (!_vertexTable.empty())
+    {
+        rehashVertices(_vertexTable.size());
+    }
+}
+
+void Mesh::optimize()
+{
+    const unsigned int vertexCount = getVertexCount();
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        (*i)->optimizeVertexCache(vertexCount);
+    }
+
+    // Number the vertices in the order the parts first use them. Vertices no part uses
+    // keep their order at the end.
+    std::vector<unsigned int> remap(vertexCount, MESH_VERTEX_EMPTY);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertexCount);
+    for (std::vector<MeshPart*>::const_iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        const MeshPart* part = *i;
+        for (unsigned int j = 0, indexCount = part->getIndicesCount(); j < indexCount; ++j)
+        {
+            unsigned int index = part->getIndex(j);
+            if (remap[index] == MESH_VERTEX_EMPTY)
+            {
+                remap[index] = ordered.size();
+                ordered.push_back(vertices[index]);
+            }
+        }
+    }
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        if (remap[i] == MESH_VERTEX_EMPTY)
+        {
+            remap[i] = ordered.size();
+            ordered.push_back(vertices[i]);
+        }
+    }
+
+    vertices.swap(ordered);
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        (*i)->remapIndices(remap);
+    }
+    if (!_vertexTable.empty())
+    {
+        rehashVertices(_vertexTable.size());
+    }
+}
+
+void Mesh::getVertexKey(const Vertex& vertex, float* key) const
+{
+    // The same attributes as Vertex::operator==.
+    memcpy(key, &vertex.position.x, 3 * sizeof(float));
+    memcpy(key + 3, &vertex.normal.x, 3 * sizeof(float));
+    memcpy(key + 6, &vertex.tangent.x, 3 * sizeof(float));
+    memcpy(key + 9, &vertex.binormal.x, 3 * sizeof(float));
+    memcpy(key + 12, &vertex.texCoord.x, 2 * sizeof(float));
+    memcpy(key + 14, &vertex.blendWeights.x, 4 * sizeof(float));
+    memcpy(key + MESH_VERTEX_KEY_BLEND_INDICES, &vertex.blendIndices.x, 4 * sizeof(float));
+    for (unsigned int i = 0; i < MESH_VERTEX_KEY_SIZE; ++i)
+    {
+        // Joint indices are only welded when they are identical; snapping them
+        // would bind a vertex to a different joint.
+        if (_weldTolerance > 0.0f && i < MESH_VERTEX_KEY_BLEND_INDICES)
+        {
+            key[i] = floor(key[i] / _weldTolerance + 0.5f);
+        }
+        // Equal values must have the same bits, so -0 is hashed as 0.
+        if (key[i] == 0.0f)
+        {
+            key[i] = 0.0f;
+        }
+    }
+}
+
+unsigned int Mesh::findVertexEntry(const float* key, unsigned int hash) const
+{
+    const unsigned int mask = _vertexTable.size() - 1;
+    float entryKey[MESH_VERTEX_KEY_SIZE];
+    for (unsigned int i = hash & mask; ; i = (i + 1) & mask)
+    {
+        const VertexEntry& entry = _vertexTable[i];
+        if (entry.index == MESH_VERTEX_EMPTY)
+        {
+            return i;
+        }
+        // Only vertices with the same hash are compared.
+        if (entry.hash == hash)
+        {
+            getVertexKey(vertices[entry.index], entryKey);
+            if (memcmp(entryKey, key, sizeof(entryKey)) == 0)
+            {
+                return i;
+            }
+        }
+    }
+}
+
+void Mesh::rehashVertices(unsigned int capacity)
+{
+    while (capacity < vertices.size() * 2)
+    {
+        capacity *= 2;
+    }
+    VertexEntry empty = { MESH_VERTEX_EMPTY, 0 };
+    _vertexTable.assign(capacity, empty);
+
+    // The first of several vertices with the same key is the one found.
+    float key[MESH_VERTEX_KEY_SIZE];
+    for (unsigned int i = 0, count = getVertexCount(); i < count; ++i)
+    {
+        getVertexKey(vertices[i], key);
+        unsigned int hash = hashVertexKey(key);
+        VertexEntry& entry = _vertexTable[findVertexEntry(key, hash)];
+        if (entry.index == MESH_VERTEX_EMPTY)
+        {
+            entry.index = i;
+            entry.hash = hash;
+        }
+    }
 }
 
 void Mesh::computeBounds()
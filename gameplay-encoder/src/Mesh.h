@@ -60,6 +60,32 @@ public:
 
     unsigned int getVertexIndex(const Vertex& vertex);
 
+    /**
+     * Returns the index of the vertex equal to the given one, within the weld tolerance,
+     * adding the given vertex if there is none.
+     */
+    unsigned int weldVertex(const Vertex& vertex);
+
+    /**
+     * Sets the tolerance within which vertices are welded by weldVertex. Vertex attributes
+     * are snapped to a grid of this size when compared, so vertices closer than the
+     * tolerance may still be kept apart when they fall in different grid cells.
+     *
+     * The same tolerance applies to positions, normals, tangents, binormals, texture
+     * coordinates and blend weights, so it should be small compared to the texture
+     * coordinate range. Blend indices must always match exactly.
+     *
+     * @param tolerance The size of the grid, or zero to only weld identical vertices.
+     */
+    void setWeldTolerance(float tolerance);
+
+    /**
+     * Optimizes the triangle order of each part for the post-transform vertex cache, then
+     * reorders the vertices in the order the parts first use them, so that vertices are
+     * fetched from memory mostly sequentially.
+     */
+    void optimize();
+
     /**
      * Generates a heightmap with the given filename for this mesh.
      */
@@ -69,14 +95,40 @@ public:
     std::vector<Vertex> vertices;
     std::vector<MeshPart*> parts;
     BoundingVolume bounds;
-    std::map<Vertex, unsigned int> vertexLookupTable;
 
 private:
 
+    /**
+     * An entry of the vertex hash table.
+     */
+    struct VertexEntry
+    {
+        unsigned int index;     // The index of the vertex, or 0xFFFFFFFF for an unused entry.
+        unsigned int hash;      // The hash of the key of the vertex.
+    };
+
     void computeBounds();
 
+    /**
+     * Gets the hash table key of the given vertex: its attributes, snapped to the weld tolerance
+     * (except for the blend indices, which are copied as they are).
+     */
+    void getVertexKey(const Vertex& vertex, float* key) const;
+
+    /**
+     * Finds the hash table entry of the vertex with the given key and hash, or the unused entry where it would be inserted.
+     */
+    unsigned int findVertexEntry(const float* key, unsigned int hash) const;
+
+    /**
+     * Rebuilds the vertex hash table with the given capacity, which must be a power of two.
+     */
+    void rehashVertices(unsigned int capacity);
+
 private:
     std::vector<VertexElement> _vertexFormat;
+    std::vector<VertexEntry> _vertexTable;
+    float _weldTolerance;
 
 };
 
@@ -1,9 +1,58 @@
 #include "Base.h"
 #include "MeshPart.h"
 
+// The size of the simulated post-transform vertex cache.
+#define VERTEX_CACHE_SIZE 32
+
+// The score of the vertices of the last triangle added.
+#define VERTEX_CACHE_LAST_TRIANGLE_SCORE 0.75f
+
+// The power by which the score of a vertex decays with its position in the cache.
+#define VERTEX_CACHE_DECAY_POWER 1.5f
+
+// The scale and power of the bonus of vertices with few triangles left to add.
+#define VERTEX_CACHE_VALENCE_BOOST_SCALE 2.0f
+#define VERTEX_CACHE_VALENCE_BOOST_POWER 0.5f
+
+// The index of no triangle.
+#define VERTEX_CACHE_NO_TRIANGLE 0xFFFFFFFF
+
 namespace gameplay
 {
 
+/**
+ * Returns the score of a vertex with the given position in the cache (-1 if not cached)
+ * and number of triangles left to add. Triangles with the highest sum of vertex scores
+ * are added first.
+ */
+static float vertexCacheScore(int cachePosition, unsigned int remainingTriangles)
+{
+    if (remainingTriangles == 0)
+    {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            // The vertices of the last triangle are scored the same, whatever their order,
+            // so they are not favored for being used right away.
+            score = VERTEX_CACHE_LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            float scale = 1.0f / (VERTEX_CACHE_SIZE - 3);
+            score = pow(1.0f - (cachePosition - 3) * scale, VERTEX_CACHE_DECAY_POWER);
+        }
+    }
+
+    // Vertices with few triangles left are favored, so they leave the cache for good sooner.
+    score += VERTEX_CACHE_VALENCE_BOOST_SCALE * pow((float)remainingTriangles, -VERTEX_CACHE_VALENCE_BOOST_POWER);
+    return score;
+}
+
 MeshPart::MeshPart(void) :
     _primitiveType(TRIANGLES),
     _indexFormat(INDEX16)
@@ -86,6 +135,158 @@ unsigned int MeshPart::getIndex(unsigned int i) const
     return _indices[i];
 }
 
+void MeshPart::optimizeVertexCache(unsigned int vertexCount)
+{
+    if (_primitiveType != TRIANGLES || _indices.size() < 6 || _indices.size() % 3 != 0)
+    {
+        return;
+    }
+    const unsigned int triangleCount = _indices.size() / 3;
+
+    // List the triangles using each vertex. The first remaining[v] triangles of the list
+    // of vertex v are those not added yet.
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (std::vector<unsigned int>::const_iterator i = _indices.begin(); i != _indices.end(); ++i)
+    {
+        assert(*i < vertexCount);
+        ++offsets[*i + 1];
+    }
+    std::vector<unsigned int> remaining(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        remaining[i] = offsets[i + 1];
+        offsets[i + 1] += offsets[i];
+    }
+    std::vector<unsigned int> triangles(_indices.size());
+    std::vector<unsigned int> filled(offsets.begin(), offsets.end() - 1);
+    for (unsigned int i = 0; i < _indices.size(); ++i)
+    {
+        triangles[filled[_indices[i]]++] = i / 3;
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        scores[i] = vertexCacheScore(-1, remaining[i]);
+    }
+
+    // Start with the best triangle overall.
+    unsigned int best = 0;
+    float bestScore = -1.0f;
+    for (unsigned int i = 0; i < triangleCount; ++i)
+    {
+        const unsigned int* triangle = &_indices[i * 3];
+        float score = scores[triangle[0]] + scores[triangle[1]] + scores[triangle[2]];
+        if (score > bestScore)
+        {
+            best = i;
+            bestScore = score;
+        }
+    }
+
+    std::vector<bool> added(triangleCount, false);
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> newCache;
+    std::vector<unsigned int> optimized;
+    optimized.reserve(_indices.size());
+    unsigned int next = 0;
+    for (unsigned int n = 0; n < triangleCount; ++n)
+    {
+        if (best == VERTEX_CACHE_NO_TRIANGLE)
+        {
+            // No cached vertex has triangles left, so continue with the next triangle in
+            // the original order rather than searching all of them.
+            while (added[next])
+            {
+                ++next;
+            }
+            best = next;
+        }
+
+        added[best] = true;
+        const unsigned int* triangle = &_indices[best * 3];
+        optimized.insert(optimized.end(), triangle, triangle + 3);
+
+        // Remove the triangle from the lists of its vertices, and move them to the front of the cache.
+        newCache.clear();
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            unsigned int vertex = triangle[i];
+            unsigned int* list = &triangles[offsets[vertex]];
+            unsigned int count = remaining[vertex];
+            for (unsigned int j = 0; j < count; ++j)
+            {
+                if (list[j] == best)
+                {
+                    list[j] = list[count - 1];
+                    list[count - 1] = best;
+                    --remaining[vertex];
+                    break;
+                }
+            }
+            if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+            {
+                newCache.push_back(vertex);
+            }
+        }
+        for (std::vector<unsigned int>::const_iterator i = cache.begin(); i != cache.end(); ++i)
+        {
+            if (*i != triangle[0] && *i != triangle[1] && *i != triangle[2])
+            {
+                newCache.push_back(*i);
+            }
+        }
+
+        // Update the scores of the vertices pushed out of the cache and of those in it.
+        for (unsigned int i = VERTEX_CACHE_SIZE; i < newCache.size(); ++i)
+        {
+            cachePositions[newCache[i]] = -1;
+            scores[newCache[i]] = vertexCacheScore(-1, remaining[newCache[i]]);
+        }
+        if (newCache.size() > VERTEX_CACHE_SIZE)
+        {
+            newCache.resize(VERTEX_CACHE_SIZE);
+        }
+        for (unsigned int i = 0; i < newCache.size(); ++i)
+        {
+            cachePositions[newCache[i]] = i;
+            scores[newCache[i]] = vertexCacheScore(i, remaining[newCache[i]]);
+        }
+        cache.swap(newCache);
+
+        // Only the triangles of cached vertices changed score, so the next triangle is the best of them.
+        best = VERTEX_CACHE_NO_TRIANGLE;
+        bestScore = -1.0f;
+        for (std::vector<unsigned int>::const_iterator i = cache.begin(); i != cache.end(); ++i)
+        {
+            const unsigned int* list = &triangles[offsets[*i]];
+            for (unsigned int j = 0, count = remaining[*i]; j < count; ++j)
+            {
+                const unsigned int* candidate = &_indices[list[j] * 3];
+                float score = scores[candidate[0]] + scores[candidate[1]] + scores[candidate[2]];
+                if (score > bestScore)
+                {
+                    best = list[j];
+                    bestScore = score;
+                }
+            }
+        }
+    }
+
+    _indices.swap(optimized);
+}
+
+void MeshPart::remapIndices(const std::vector<unsigned int>& remap)
+{
+    _indexFormat = INDEX16;
+    for (std::vector<unsigned int>::iterator i = _indices.begin(); i != _indices.end(); ++i)
+    {
+        *i = remap[*i];
+        updateIndexFormat(*i);
+    }
+}
+
 void MeshPart::writeBinaryIndex(unsigned int index, FILE* file)
 {
     switch (_indexFormat)
@@ -62,6 +62,20 @@ public:
      */
     unsigned int getIndex(unsigned int i) const;
 
+    /**
+     * Reorders the triangles of this part so that their vertices are likely to still be in
+     * the post-transform vertex cache, using Tom Forsyth's linear-speed vertex cache optimization.
+     * Parts that are not triangle lists are left unchanged.
+     *
+     * @param vertexCount The number of vertices of the mesh.
+     */
+    void optimizeVertexCache(unsigned int vertexCount);
+
+    /**
+     * Replaces each index with the element of the given table at that index.
+     */
+    void remapIndices(const std::vector<unsigned int>& remap);
+
 private:
 
     /**
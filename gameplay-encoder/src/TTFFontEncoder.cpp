@@ -1,10 +1,43 @@
 #include "Base.h"
 #include "TTFFontEncoder.h"
 #include "GPBFile.h"
+#include "ThreadUtil.h"
+
+// The squared distance of pixels with no feature in a distance transform.
+#define DISTANCE_FIELD_INFINITY 1e20f
 
 namespace gameplay
 {
 
+/**
+ * A glyph whose distance field is written to the font image.
+ */
+struct DistanceFieldGlyph
+{
+    unsigned int code;      // The character code.
+    float originX;          // The image x position of the glyph origin.
+    float baselineY;        // The image y position of the glyph baseline.
+    int left;               // The left of the image area covered by the glyph.
+    int top;                // The top of the image area covered by the glyph.
+    int right;              // The right (exclusive) of the image area covered by the glyph.
+    int bottom;             // The bottom (exclusive) of the image area covered by the glyph.
+};
+
+/**
+ * The glyphs of a font image generated by one thread.
+ */
+struct DistanceFieldJob
+{
+    const char* filename;                           // The path of the font.
+    unsigned int fontSize;                          // The size of the font.
+    const std::vector<DistanceFieldGlyph>* glyphs;  // The glyphs of the font image.
+    unsigned int first;                             // The first glyph generated by this job.
+    unsigned int stride;                            // The number of glyphs between those generated by this job.
+    unsigned char* image;                           // The font image.
+    unsigned int imageWidth;                        // The width of the font image.
+    bool failed;                                    // Set if the font could not be loaded.
+};
+
 void drawBitmap(unsigned char* dstBitmap, int x, int y, int dstWidth, unsigned char* srcBitmap, int srcWidth, int srcHeight)
 {
     // offset dst bitmap by x,y.
@@ -38,7 +71,200 @@ void writeString(FILE* fp, const char* str)
     }
 }
 
-int writeFont(const char* filename, unsigned int fontSize, const char* id, bool fontpreview = false)
+/**
+ * Computes the squared distance of each of the n samples of f to the nearest feature, where f
+ * holds 0 at features and DISTANCE_FIELD_INFINITY elsewhere (Felzenszwalb and Huttenlocher).
+ * v and z are scratch arrays of at least n and n + 1 elements.
+ */
+static void distanceTransform(const float* f, float* d, int* v, float* z, int n)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -DISTANCE_FIELD_INFINITY;
+    z[1] = DISTANCE_FIELD_INFINITY;
+    for (int q = 1; q < n; ++q)
+    {
+        float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        while (s <= z[k])
+        {
+            --k;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = DISTANCE_FIELD_INFINITY;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; ++q)
+    {
+        while (z[k + 1] < q)
+        {
+            ++k;
+        }
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+/**
+ * Computes the squared distance of each pixel of a width x height grid to the nearest pixel
+ * whose coverage is (inside) or is not (!inside) at least half.
+ */
+static void distanceTransform(const unsigned char* coverage, int width, int height, bool inside, float* distances)
+{
+    int n = std::max(width, height);
+    std::vector<float> f(n);
+    std::vector<float> d(n);
+    std::vector<int> v(n);
+    std::vector<float> z(n + 1);
+
+    for (int i = 0, count = width * height; i < count; ++i)
+    {
+        distances[i] = ((coverage[i] >= 128) == inside) ? 0.0f : DISTANCE_FIELD_INFINITY;
+    }
+
+    // Columns, then rows of the column distances.
+    for (int x = 0; x < width; ++x)
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            f[y] = distances[y * width + x];
+        }
+        distanceTransform(&f[0], &d[0], &v[0], &z[0], height);
+        for (int y = 0; y < height; ++y)
+        {
+            distances[y * width + x] = d[y];
+        }
+    }
+    for (int y = 0; y < height; ++y)
+    {
+        float* row = &distances[y * width];
+        memcpy(&f[0], row, width * sizeof(float));
+        distanceTransform(&f[0], row, &v[0], &z[0], width);
+    }
+}
+
+/**
+ * Writes the distance field of a glyph rasterized DISTANCE_FIELD_UPSCALE times larger
+ * into the font image.
+ */
+static void drawDistanceField(const DistanceFieldGlyph& glyph, FT_GlyphSlot slot, unsigned char* image, unsigned int imageWidth)
+{
+    const int upscale = DISTANCE_FIELD_UPSCALE;
+    const float spread = (float)(DISTANCE_FIELD_SPREAD * upscale);
+
+    // Pad the glyph bitmap so that the distances around it are measured within the grid.
+    int padding = (DISTANCE_FIELD_SPREAD + 1) * upscale;
+    int width = slot->bitmap.width + padding * 2;
+    int height = slot->bitmap.rows + padding * 2;
+    std::vector<unsigned char> coverage(width * height, 0);
+    for (int y = 0; y < (int)slot->bitmap.rows; ++y)
+    {
+        memcpy(&coverage[(y + padding) * width + padding], slot->bitmap.buffer + y * slot->bitmap.pitch, slot->bitmap.width);
+    }
+
+    std::vector<float> outside(width * height);
+    std::vector<float> inside(width * height);
+    distanceTransform(&coverage[0], width, height, true, &outside[0]);
+    distanceTransform(&coverage[0], width, height, false, &inside[0]);
+
+    // Sample the signed distance at the center of each texel, mapped to [0, 255] with
+    // the edge of the glyph at 128.
+    float gridLeft = (float)(slot->bitmap_left - padding);
+    float gridTop = (float)(slot->bitmap_top + padding);
+    for (int y = glyph.top; y < glyph.bottom; ++y)
+    {
+        int gy = (int)floor(gridTop + (y + 0.5f - glyph.baselineY) * upscale);
+        gy = std::min(std::max(gy, 0), height - 1);
+        for (int x = glyph.left; x < glyph.right; ++x)
+        {
+            int gx = (int)floor((x + 0.5f - glyph.originX) * upscale - gridLeft);
+            gx = std::min(std::max(gx, 0), width - 1);
+
+            int i = gy * width + gx;
+            float distance = (coverage[i] >= 128) ? sqrt(inside[i]) - 0.5f : 0.5f - sqrt(outside[i]);
+            float value = 0.5f + distance / (spread * 2.0f);
+            value = std::min(std::max(value, 0.0f), 1.0f);
+            image[y * imageWidth + x] = (unsigned char)(value * 255.0f + 0.5f);
+        }
+    }
+}
+
+/**
+ * Generates the distance fields of the glyphs of a job. FreeType faces cannot be shared
+ * between threads, so each job loads the font itself.
+ */
+static void generateDistanceFields(void* data, unsigned int index)
+{
+    DistanceFieldJob* job = (DistanceFieldJob*)data + index;
+    FT_Library library;
+    FT_Face face;
+    if (FT_Init_FreeType(&library))
+    {
+        job->failed = true;
+        return;
+    }
+    if (FT_New_Face(library, job->filename, 0, &face) ||
+        FT_Set_Char_Size(face, 0, job->fontSize * DISTANCE_FIELD_UPSCALE * 64, 0, 0))
+    {
+        FT_Done_FreeType(library);
+        job->failed = true;
+        return;
+    }
+
+    const std::vector<DistanceFieldGlyph>& glyphs = *job->glyphs;
+    for (unsigned int i = job->first, count = glyphs.size(); i < count; i += job->stride)
+    {
+        if (FT_Load_Char(face, glyphs[i].code, FT_LOAD_RENDER | FT_LOAD_NO_HINTING))
+        {
+            fprintf(stderr, "FT_Load_Char error : %d \n", glyphs[i].code);
+            continue;
+        }
+        drawDistanceField(glyphs[i], face->glyph, job->image, job->imageWidth);
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+}
+
+/**
+ * Writes the distance fields of the given glyphs into the font image, spreading the
+ * glyphs across one thread per processor.
+ */
+static bool drawDistanceFields(const char* filename, unsigned int fontSize, const std::vector<DistanceFieldGlyph>& glyphs,
+                               unsigned char* image, unsigned int imageWidth)
+{
+    unsigned int threadCount = std::max(std::min(getProcessorCount(), (unsigned int)glyphs.size()), 1u);
+
+    std::vector<DistanceFieldJob> jobs(threadCount);
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        DistanceFieldJob& job = jobs[i];
+        job.filename = filename;
+        job.fontSize = fontSize;
+        job.glyphs = &glyphs;
+        job.first = i;
+        job.stride = threadCount;
+        job.image = image;
+        job.imageWidth = imageWidth;
+        job.failed = false;
+    }
+
+    // Glyphs cover disjoint areas of the image, so the threads need no synchronization.
+    runParallel(threadCount, generateDistanceFields, &jobs[0]);
+
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        if (jobs[i].failed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int writeFont(const char* filename, unsigned int fontSize, const char* id, bool fontpreview = false, bool distanceField = false)
 {
  
     Glyph glyphArray[END_INDEX - START_INDEX];
@@ -112,6 +338,10 @@ int writeFont(const char* filename, unsigned int fontSize, const char* id, bool
 
     // Include padding in the rowSize.
     rowSize += GLYPH_PADDING;
+
+    // Distance field glyphs fade out around their cells, so leave room for the fade between cells.
+    int margin = distanceField ? DISTANCE_FIELD_SPREAD : 0;
+    int rowHeight = rowSize + margin * 2;
     
     // Initialize with padding.
     int penX = 0;
@@ -149,15 +379,15 @@ int writeFont(const char* filename, unsigned int fontSize, const char* id, bool
             int glyphWidth = slot->bitmap.pitch;
             int glyphHeight = slot->bitmap.rows;
 
-            advance = glyphWidth + GLYPH_PADDING; //((int)slot->advance.x >> 6) + GLYPH_PADDING;
+            advance = glyphWidth + GLYPH_PADDING + margin * 2; //((int)slot->advance.x >> 6) + GLYPH_PADDING;
 
             // If we reach the end of the image wrap aroud to the next row.
             if ((penX + advance) > (int)imageWidth)
             {
                 penX = 0;
                 row += 1;
-                penY = row * rowSize;
-                if (penY + rowSize > (int)imageHeight)
+                penY = row * rowHeight;
+                if (penY + rowHeight > (int)imageHeight)
                 {
                     powerOf2++;
                     break;
@@ -170,7 +400,7 @@ int writeFont(const char* filename, unsigned int fontSize, const char* id, bool
             // Set the pen position for the next glyph
             penX += advance; // Move X to next glyph position
             // Move Y back to the top of the row.
-            penY = row * rowSize;
+            penY = row * rowHeight;
 
             if (ascii == (END_INDEX-1))
             {
@@ -185,7 +415,7 @@ int writeFont(const char* filename, unsigned int fontSize, const char* id, bool
     powerOf2 = 1;
     for (;;)
     {
-        if ((penY + rowSize) >= pow(2.0, powerOf2))
+        if ((penY + rowHeight) >= pow(2.0, powerOf2))
         {
             powerOf2++;
         }
@@ -203,6 +433,7 @@ int writeFont(const char* filename, unsigned int fontSize, const char* id, bool
     penY = 0;
     row = 0;
     i = 0;
+    std::vector<DistanceFieldGlyph> distanceFieldGlyphs;
     for (unsigned char ascii = START_INDEX; ascii < END_INDEX; ++ascii)
     {
         // Load glyph image into the slot (erase the previous one).
@@ -217,15 +448,15 @@ int writeFont(const char* filename, unsigned int fontSize, const char* id, bool
         int glyphWidth = slot->bitmap.pitch;
         int glyphHeight = slot->bitmap.rows;
 
-        advance = glyphWidth + GLYPH_PADDING;//((int)slot->advance.x >> 6) + GLYPH_PADDING;
+        advance = glyphWidth + GLYPH_PADDING + margin * 2;//((int)slot->advance.x >> 6) + GLYPH_PADDING;
 
         // If we reach the end of the image wrap aroud to the next row.
         if ((penX + advance) > (int)imageWidth)
         {
             penX = 0;
             row += 1;
-            penY = row * rowSize;
-            if (penY + rowSize > (int)imageHeight)
+            penY = row * rowHeight;
+            if (penY + rowHeight > (int)imageHeight)
             {
                 fprintf(stderr, "Image size exceeded!");
                return -1;
@@ -233,28 +464,55 @@ int writeFont(const char* filename, unsigned int fontSize, const char* id, bool
 
         }
         
+        // The cell of the glyph, inside its margin.
+        int cellX = penX + margin;
+        int cellY = penY + margin;
+
         // penY should include the glyph offsets.
-        penY += (actualfontHeight - glyphHeight) + (glyphHeight - slot->bitmap_top);
+        penY = cellY + (actualfontHeight - glyphHeight) + (glyphHeight - slot->bitmap_top);
 
-        // Draw the glyph to the bitmap with a one pixel padding.
-        drawBitmap(imageBuffer, penX, penY, imageWidth, glyphBuffer, glyphWidth, glyphHeight);
+        if (distanceField)
+        {
+            // Generated once all glyphs are placed, over the cell and its margin.
+            DistanceFieldGlyph glyph;
+            glyph.code = ascii;
+            glyph.originX = (float)(cellX - slot->bitmap_left);
+            glyph.baselineY = (float)(penY + slot->bitmap_top);
+            glyph.left = penX;
+            glyph.top = cellY - margin;
+            glyph.right = std::min(cellX + glyphWidth + margin, (int)imageWidth);
+            glyph.bottom = std::min(cellY + rowSize + margin, (int)imageHeight);
+            distanceFieldGlyphs.push_back(glyph);
+        }
+        else
+        {
+            // Draw the glyph to the bitmap with a one pixel padding.
+            drawBitmap(imageBuffer, cellX, penY, imageWidth, glyphBuffer, glyphWidth, glyphHeight);
+        }
         
         // Move Y back to the top of the row.
-        penY = row * rowSize;
+        penY = row * rowHeight;
 
         glyphArray[i].index = ascii;
-        glyphArray[i].width = advance - GLYPH_PADDING;
+        glyphArray[i].width = glyphWidth;
         
         // Generate UV coords.
-        glyphArray[i].uvCoords[0] = (float)penX / (float)imageWidth;
-        glyphArray[i].uvCoords[1] = (float)penY / (float)imageHeight;
-        glyphArray[i].uvCoords[2] = (float)(penX + advance - GLYPH_PADDING) / (float)imageWidth;
-        glyphArray[i].uvCoords[3] = (float)(penY + rowSize) / (float)imageHeight;
+        glyphArray[i].uvCoords[0] = (float)cellX / (float)imageWidth;
+        glyphArray[i].uvCoords[1] = (float)cellY / (float)imageHeight;
+        glyphArray[i].uvCoords[2] = (float)(cellX + glyphWidth) / (float)imageWidth;
+        glyphArray[i].uvCoords[3] = (float)(cellY + rowSize) / (float)imageHeight;
 
         // Set the pen position for the next glyph
         penX += advance; // Move X to next glyph position
         i++;
     }
+
+    if (distanceField && !drawDistanceFields(filename, fontSize, distanceFieldGlyphs, imageBuffer, imageWidth))
+    {
+        fprintf(stderr, "Failed to generate the distance fields of the font.\n");
+        free(imageBuffer);
+        return -1;
+    }
     
     unsigned int idlen = strlen(id);
 
@@ -285,7 +543,8 @@ int writeFont(const char* filename, unsigned int fontSize, const char* id, bool
     // TODO: Switch based on TTF style name and write appropriate font style unsigned int
     // For now just hardcoding to 0.
     //char* style = face->style_name;
-    writeUint(gpbFp, 0); // 0 == PLAIN
+    // The spread of distance field fonts is stored above the style.
+    writeUint(gpbFp, distanceField ? (DISTANCE_FIELD_SPREAD << DISTANCE_FIELD_STYLE_SHIFT) : 0); // 0 == PLAIN
 
     // Font size.
     writeUint(gpbFp, rowSize);
@@ -6,6 +6,15 @@
 
 #define GLYPH_PADDING   4
 
+// The distance, in texels, over which distance field glyphs fade out from their edges.
+#define DISTANCE_FIELD_SPREAD   4
+
+// The scale of the glyphs rasterized to compute distance fields from.
+#define DISTANCE_FIELD_UPSCALE  8
+
+// The bit of the font style where the distance field spread is stored.
+#define DISTANCE_FIELD_STYLE_SHIFT  16
+
 namespace gameplay
 {
 
@@ -26,6 +35,6 @@ void writeFloat(FILE* fp, float f);
 
 void writeString(FILE* fp, const char* str);
 
-int writeFont(const char* filename, unsigned int fontSize, const char* id, bool fontpreview);
+int writeFont(const char* filename, unsigned int fontSize, const char* id, bool fontpreview, bool distanceField);
 
 }
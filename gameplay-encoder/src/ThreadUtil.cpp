@@ -0,0 +1,114 @@
+#include "Base.h"
+#include "ThreadUtil.h"
+
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace gameplay
+{
+
+/**
+ * A call made by runParallel on a thread.
+ */
+struct ParallelCall
+{
+    void (*fn)(void* data, unsigned int index);     // The function to call.
+    void* data;                                     // The data passed to the function.
+    unsigned int index;                             // The index passed to the function.
+};
+
+static void runParallelCall(ParallelCall* call)
+{
+    call->fn(call->data, call->index);
+}
+
+#ifdef WIN32
+static DWORD WINAPI runParallelThread(LPVOID data)
+{
+    runParallelCall((ParallelCall*)data);
+    return 0;
+}
+#else
+static void* runParallelThread(void* data)
+{
+    runParallelCall((ParallelCall*)data);
+    return NULL;
+}
+#endif
+
+unsigned int getProcessorCount()
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned int)info.dwNumberOfProcessors : 1;
+#else
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? (unsigned int)processors : 1;
+#endif
+}
+
+void runParallel(unsigned int count, void (*fn)(void* data, unsigned int index), void* data)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::vector<ParallelCall> calls(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        calls[i].fn = fn;
+        calls[i].data = data;
+        calls[i].index = i;
+    }
+
+#ifdef WIN32
+    std::vector<HANDLE> threads(count, (HANDLE)NULL);
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        threads[i] = CreateThread(NULL, 0, runParallelThread, &calls[i], 0, NULL);
+        if (threads[i] == NULL)
+        {
+            runParallelCall(&calls[i]);
+        }
+    }
+    runParallelCall(&calls[0]);
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        if (threads[i])
+        {
+            WaitForSingleObject(threads[i], INFINITE);
+            CloseHandle(threads[i]);
+        }
+    }
+#else
+    std::vector<pthread_t> threads(count);
+    std::vector<bool> started(count, false);
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        started[i] = pthread_create(&threads[i], NULL, runParallelThread, &calls[i]) == 0;
+        if (!started[i])
+        {
+            runParallelCall(&calls[i]);
+        }
+    }
+    runParallelCall(&calls[0]);
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+#endif
+}
+
+}
@@ -0,0 +1,23 @@
+#ifndef THREADUTIL_H_
+#define THREADUTIL_H_
+
+namespace gameplay
+{
+
+/**
+ * Returns the number of processors available to the encoder (at least 1).
+ */
+unsigned int getProcessorCount();
+
+/**
+ * Calls fn(data, i) for each i from 0 to count - 1, each call on its own thread.
+ * The calling thread makes the first call, and makes the calls of threads that
+ * cannot be started itself. Returns once every call has returned.
+ *
+ * The calls must not touch the same data unless they synchronize themselves.
+ */
+void runParallel(unsigned int count, void (*fn)(void* data, unsigned int index), void* data);
+
+}
+
+#endif
@@ -76,7 +76,7 @@ int main(int argc, const char** argv)
         {
             std::string realpath(arguments.getFilePath());
             std::string id = getFileName(realpath);
-            writeFont(realpath.c_str(), arguments.getFontSize(), id.c_str(), arguments.fontPreviewEnabled());
+            writeFont(realpath.c_str(), arguments.getFontSize(), id.c_str(), arguments.fontPreviewEnabled(), arguments.fontDistanceFieldEnabled());
             break;
         }
     case EncoderArguments::FILEFORMAT_GPB:
@@ -4,7 +4,7 @@
 MeshGame game;
 
 MeshGame::MeshGame()
-    : _font(NULL), _scene(NULL),_modelNode(NULL), _touched(false), _touchX(0)
+    : _font(NULL), _scene(NULL), _renderQueue(NULL), _modelNode(NULL), _touched(false), _touchX(0)
 {
 }
 
@@ -22,6 +22,9 @@ void MeshGame::initialize()
     _scene = pkg->loadScene();
     SAFE_RELEASE(pkg);
 
+    // Create the queue used to sort the scene's draw items by render state.
+    _renderQueue = RenderQueue::create();
+
     // Get the duck node
     _modelNode = _scene->findNode("duck");
 
@@ -38,6 +41,7 @@ void MeshGame::initialize()
 void MeshGame::finalize()
 {
     SAFE_RELEASE(_font);
+    SAFE_RELEASE(_renderQueue);
     SAFE_RELEASE(_scene);
 }
 
@@ -53,8 +57,11 @@ void MeshGame::render(long elapsedTime)
     // Clear the color and depth buffers.
     clear(CLEAR_COLOR_DEPTH, Vector4::zero(), 1.0f, 0);
 
-    // Visit all the nodes in the scene, drawing the models/mesh.
-    _scene->visit(this, &MeshGame::drawScene);
+    // Visit the nodes in view of the camera, queuing the models/mesh, then draw them sorted by render state.
+    _renderQueue->clear();
+    _scene->visitVisible(_scene->getActiveCamera()->getFrustum(), this, &MeshGame::queueScene);
+    _renderQueue->sort();
+    _renderQueue->draw();
 
     // Draw the fps
     drawFrameRate(_font, Vector4(0, 0.5f, 1, 1), 5, 5, getFrameRate());
@@ -88,11 +95,9 @@ void MeshGame::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int cont
     };
 }
 
-bool MeshGame::drawScene(Node* node, void* cookie)
+bool MeshGame::queueScene(Node* node, void* cookie)
 {
-    Model* model = node->getModel(); 
-    if (model)
-        model->draw();
+    _renderQueue->add(node);
     return true;
 }
 
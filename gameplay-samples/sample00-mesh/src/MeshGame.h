@@ -51,12 +51,13 @@ protected:
 
 private:
 
-    bool drawScene(Node* node, void* cookie);
+    bool queueScene(Node* node, void* cookie);
 
     void drawFrameRate(Font* font, const Vector4& color, unsigned int x, unsigned int y, unsigned int fps);
 
     Font* _font;
     Scene* _scene;
+    RenderQueue* _renderQueue;
     Node* _modelNode;
     bool _touched;
     int _touchX;
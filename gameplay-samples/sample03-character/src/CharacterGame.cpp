@@ -4,7 +4,7 @@
 CharacterGame game; 
 
 CharacterGame::CharacterGame()
-    : _font(NULL), _scene(NULL), _modelNode(NULL), _animation(NULL), _animationState(0), _rotateX(0)
+    : _font(NULL), _scene(NULL), _renderQueue(NULL), _modelNode(NULL), _animation(NULL), _animationState(0), _rotateX(0)
 {
 }
 
@@ -22,6 +22,9 @@ void CharacterGame::initialize()
     _scene = pkg->loadScene();
     SAFE_RELEASE(pkg);
 
+    // Create the queue used to sort the scene's draw items by render state.
+    _renderQueue = RenderQueue::create();
+
     _modelNode = _scene->findNode("boyShape");
 
     // Get directional light node.
@@ -44,6 +47,7 @@ void CharacterGame::initialize()
 
 void CharacterGame::finalize()
 {
+    SAFE_RELEASE(_renderQueue);
     SAFE_RELEASE(_scene);
     SAFE_RELEASE(_font);
 }
@@ -57,17 +61,16 @@ void CharacterGame::render(long elapsedTime)
     // Clear the color and depth buffers.
     clear(CLEAR_COLOR_DEPTH, Vector4::zero(), 1.0f, 0);
 
-    // Draw our scene
-    _scene->visit(this, &CharacterGame::drawScene);
+    // Draw the visible part of our scene, sorted by render state
+    _renderQueue->clear();
+    _scene->visitVisible(_scene->getActiveCamera()->getFrustum(), this, &CharacterGame::queueScene);
+    _renderQueue->sort();
+    _renderQueue->draw();
 }
 
-bool CharacterGame::drawScene(Node* node, void* cookie)
+bool CharacterGame::queueScene(Node* node, void* cookie)
 {
-    Model* model = node->getModel();
-    if (model)
-    {
-        model->draw();
-    }
+    _renderQueue->add(node);
     return true;
 }
 
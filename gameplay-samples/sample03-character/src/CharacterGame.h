@@ -51,12 +51,13 @@ protected:
 
 private:
 
-    bool drawScene(Node* node, void* cookie);
+    bool queueScene(Node* node, void* cookie);
 
     void loadAnimationClips();
 
     Font* _font;
     Scene* _scene;
+    RenderQueue* _renderQueue;
     Node* _modelNode;
     Animation* _animation;
     unsigned int _animationState;
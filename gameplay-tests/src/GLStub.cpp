@@ -0,0 +1,364 @@
+// Defines the GL entry points used by the engine without a GL context, so that the
+// tests can create effects, meshes and materials and run the code that uses them
+// without a window or GPU.
+//
+// Shaders always compile and link, programs have a single active attribute,
+// a_position, and a single active uniform, the sampler u_texture, and each glGen*
+// call returns new object names.
+// Buffer contents are kept and buffer uploads and draw calls are recorded (see
+// GLStub.h). Other state calls do nothing.
+#include "Base.h"
+#include "GLStub.h"
+
+// The number of vertex attributes reported by GL_MAX_VERTEX_ATTRIBS.
+#define STUB_MAX_VERTEX_ATTRIBS 16
+
+// The number of color attachments reported by GL_MAX_COLOR_ATTACHMENTS.
+#define STUB_MAX_COLOR_ATTACHMENTS 4
+
+// The attribute every program has.
+#define STUB_ATTRIBUTE_NAME "a_position"
+
+// The uniform every program has, a sampler so that sprite batches can be created.
+#define STUB_UNIFORM_NAME "u_texture"
+
+static GLuint __nextName = 1;
+static GLint __textureBinding = 0;
+static GLint __framebufferBinding = 0;
+static GLint __renderbufferBinding = 0;
+static GLuint __arrayBufferBinding = 0;
+static GLuint __elementArrayBufferBinding = 0;
+static std::map<GLuint, std::vector<unsigned char> > __buffers;
+static std::vector<gameplay::GLStub::BufferCall> __bufferCalls;
+static std::vector<gameplay::GLStub::DrawCall> __drawCalls;
+static unsigned int __invalidCallCount = 0;
+
+static void generateNames(GLsizei n, GLuint* names)
+{
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        names[i] = __nextName++;
+    }
+}
+
+static void GLAPIENTRY stubActiveTexture(GLenum texture) { }
+static void GLAPIENTRY stubAttachShader(GLuint program, GLuint shader) { }
+
+static GLuint* getBufferBinding(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:
+        return &__arrayBufferBinding;
+    case GL_ELEMENT_ARRAY_BUFFER:
+        return &__elementArrayBufferBinding;
+    default:
+        ++__invalidCallCount;
+        return NULL;
+    }
+}
+
+static void recordBufferCall(gameplay::GLStub::BufferCallType type, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    gameplay::GLStub::BufferCall call;
+    call.type = type;
+    call.buffer = buffer;
+    call.offset = (unsigned int)offset;
+    call.size = (unsigned int)size;
+    __bufferCalls.push_back(call);
+}
+
+static void recordDrawCall(GLenum mode, GLint first, GLsizei count, GLenum type, const GLvoid* indices)
+{
+    gameplay::GLStub::DrawCall call;
+    call.mode = mode;
+    call.first = first;
+    call.count = count;
+    call.type = type;
+    call.offset = (unsigned int)(size_t)indices;
+    call.arrayBuffer = __arrayBufferBinding;
+    call.elementArrayBuffer = __elementArrayBufferBinding;
+    __drawCalls.push_back(call);
+}
+
+static void GLAPIENTRY stubBindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint* binding = getBufferBinding(target);
+    if (binding)
+    {
+        *binding = buffer;
+    }
+}
+
+static void GLAPIENTRY stubBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+    GLuint* binding = getBufferBinding(target);
+    if (!binding || *binding == 0 || size < 0)
+    {
+        ++__invalidCallCount;
+        return;
+    }
+
+    // New storage: the previous contents are not kept, even when no data is given.
+    std::vector<unsigned char>& buffer = __buffers[*binding];
+    if (data)
+    {
+        buffer.assign((const unsigned char*)data, (const unsigned char*)data + size);
+    }
+    else
+    {
+        // Copied, as assign() takes a reference and the constant has no definition.
+        unsigned char undefinedByte = gameplay::GLStub::UNDEFINED_BYTE;
+        buffer.assign(size, undefinedByte);
+    }
+    recordBufferCall(gameplay::GLStub::BUFFER_DATA, *binding, 0, size);
+}
+
+static void GLAPIENTRY stubBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+    GLuint* binding = getBufferBinding(target);
+    if (!binding || *binding == 0 || offset < 0 || size < 0 || !data)
+    {
+        ++__invalidCallCount;
+        return;
+    }
+
+    std::vector<unsigned char>& buffer = __buffers[*binding];
+    if ((size_t)(offset + size) > buffer.size())
+    {
+        ++__invalidCallCount;
+        return;
+    }
+    memcpy(&buffer[offset], data, size);
+    recordBufferCall(gameplay::GLStub::BUFFER_SUB_DATA, *binding, offset, size);
+}
+
+static void GLAPIENTRY stubDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        __buffers.erase(buffers[i]);
+        if (__arrayBufferBinding == buffers[i])
+            __arrayBufferBinding = 0;
+        if (__elementArrayBufferBinding == buffers[i])
+            __elementArrayBufferBinding = 0;
+    }
+}
+static void GLAPIENTRY stubBindFramebuffer(GLenum target, GLuint framebuffer) { __framebufferBinding = framebuffer; }
+static void GLAPIENTRY stubBindRenderbuffer(GLenum target, GLuint renderbuffer) { __renderbufferBinding = renderbuffer; }
+static void GLAPIENTRY stubBindVertexArray(GLuint array) { }
+static void GLAPIENTRY stubCompileShader(GLuint shader) { }
+static GLuint GLAPIENTRY stubCreateProgram() { return __nextName++; }
+static GLuint GLAPIENTRY stubCreateShader(GLenum type) { return __nextName++; }
+static void GLAPIENTRY stubDeleteNames(GLsizei n, const GLuint* names) { }
+static void GLAPIENTRY stubDeleteName(GLuint name) { }
+static void GLAPIENTRY stubVertexAttribArray(GLuint index) { }
+static void GLAPIENTRY stubFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer) { }
+static void GLAPIENTRY stubFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) { }
+static void GLAPIENTRY stubGenNames(GLsizei n, GLuint* names) { generateNames(n, names); }
+static void GLAPIENTRY stubGenerateMipmap(GLenum target) { }
+static void GLAPIENTRY stubGetInfoLog(GLuint object, GLsizei bufSize, GLsizei* length, GLchar* infoLog) { }
+static void GLAPIENTRY stubLinkProgram(GLuint program) { }
+static void GLAPIENTRY stubRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) { }
+static void GLAPIENTRY stubShaderSource(GLuint shader, GLsizei count, const GLchar** strings, const GLint* lengths) { }
+static void GLAPIENTRY stubUniform1f(GLint location, GLfloat v0) { }
+static void GLAPIENTRY stubUniform1i(GLint location, GLint v0) { }
+static void GLAPIENTRY stubUniform2f(GLint location, GLfloat v0, GLfloat v1) { }
+static void GLAPIENTRY stubUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) { }
+static void GLAPIENTRY stubUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) { }
+static void GLAPIENTRY stubUniformfv(GLint location, GLsizei count, const GLfloat* value) { }
+static void GLAPIENTRY stubUniformiv(GLint location, GLsizei count, const GLint* value) { }
+static void GLAPIENTRY stubUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) { }
+static void GLAPIENTRY stubUseProgram(GLuint program) { }
+static void GLAPIENTRY stubVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer) { }
+
+static void GLAPIENTRY stubGetActiveAttrib(GLuint program, GLuint index, GLsizei maxLength, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    strncpy(name, STUB_ATTRIBUTE_NAME, maxLength);
+    *size = 1;
+    *type = GL_FLOAT_VEC4;
+}
+
+static GLint GLAPIENTRY stubGetAttribLocation(GLuint program, const GLchar* name)
+{
+    return strcmp(name, STUB_ATTRIBUTE_NAME) == 0 ? 0 : -1;
+}
+
+static void GLAPIENTRY stubGetActiveUniform(GLuint program, GLuint index, GLsizei maxLength, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    strncpy(name, STUB_UNIFORM_NAME, maxLength);
+    *size = 1;
+    *type = GL_SAMPLER_2D;
+}
+
+static GLint GLAPIENTRY stubGetUniformLocation(GLuint program, const GLchar* name)
+{
+    return strcmp(name, STUB_UNIFORM_NAME) == 0 ? 0 : -1;
+}
+
+static void GLAPIENTRY stubGetiv(GLuint object, GLenum pname, GLint* params)
+{
+    switch (pname)
+    {
+    case GL_COMPILE_STATUS:
+    case GL_LINK_STATUS:
+        *params = GL_TRUE;
+        break;
+    case GL_ACTIVE_ATTRIBUTES:
+        *params = 1;
+        break;
+    case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH:
+        *params = sizeof(STUB_ATTRIBUTE_NAME);
+        break;
+    case GL_ACTIVE_UNIFORMS:
+        *params = 1;
+        break;
+    case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+        *params = sizeof(STUB_UNIFORM_NAME);
+        break;
+    default:
+        *params = 0;
+        break;
+    }
+}
+
+// The GL 2.0 and later entry points, which the engine calls through GLEW.
+PFNGLACTIVETEXTUREPROC __glewActiveTexture = stubActiveTexture;
+PFNGLATTACHSHADERPROC __glewAttachShader = stubAttachShader;
+PFNGLBINDBUFFERPROC __glewBindBuffer = stubBindBuffer;
+PFNGLBINDFRAMEBUFFERPROC __glewBindFramebuffer = stubBindFramebuffer;
+PFNGLBINDRENDERBUFFERPROC __glewBindRenderbuffer = stubBindRenderbuffer;
+PFNGLBINDVERTEXARRAYPROC __glewBindVertexArray = stubBindVertexArray;
+PFNGLBUFFERDATAPROC __glewBufferData = stubBufferData;
+PFNGLBUFFERSUBDATAPROC __glewBufferSubData = stubBufferSubData;
+PFNGLCOMPILESHADERPROC __glewCompileShader = stubCompileShader;
+PFNGLCREATEPROGRAMPROC __glewCreateProgram = stubCreateProgram;
+PFNGLCREATESHADERPROC __glewCreateShader = stubCreateShader;
+PFNGLDELETEBUFFERSPROC __glewDeleteBuffers = stubDeleteBuffers;
+PFNGLDELETEFRAMEBUFFERSPROC __glewDeleteFramebuffers = stubDeleteNames;
+PFNGLDELETEPROGRAMPROC __glewDeleteProgram = stubDeleteName;
+PFNGLDELETESHADERPROC __glewDeleteShader = stubDeleteName;
+PFNGLDELETEVERTEXARRAYSPROC __glewDeleteVertexArrays = stubDeleteNames;
+PFNGLDISABLEVERTEXATTRIBARRAYPROC __glewDisableVertexAttribArray = stubVertexAttribArray;
+PFNGLENABLEVERTEXATTRIBARRAYPROC __glewEnableVertexAttribArray = stubVertexAttribArray;
+PFNGLFRAMEBUFFERRENDERBUFFERPROC __glewFramebufferRenderbuffer = stubFramebufferRenderbuffer;
+PFNGLFRAMEBUFFERTEXTURE2DPROC __glewFramebufferTexture2D = stubFramebufferTexture2D;
+PFNGLGENBUFFERSPROC __glewGenBuffers = stubGenNames;
+PFNGLGENFRAMEBUFFERSPROC __glewGenFramebuffers = stubGenNames;
+PFNGLGENRENDERBUFFERSPROC __glewGenRenderbuffers = stubGenNames;
+PFNGLGENERATEMIPMAPPROC __glewGenerateMipmap = stubGenerateMipmap;
+PFNGLGETACTIVEATTRIBPROC __glewGetActiveAttrib = stubGetActiveAttrib;
+PFNGLGETACTIVEUNIFORMPROC __glewGetActiveUniform = stubGetActiveUniform;
+PFNGLGETATTRIBLOCATIONPROC __glewGetAttribLocation = stubGetAttribLocation;
+PFNGLGETPROGRAMINFOLOGPROC __glewGetProgramInfoLog = stubGetInfoLog;
+PFNGLGETPROGRAMIVPROC __glewGetProgramiv = stubGetiv;
+PFNGLGETSHADERINFOLOGPROC __glewGetShaderInfoLog = stubGetInfoLog;
+PFNGLGETSHADERIVPROC __glewGetShaderiv = stubGetiv;
+PFNGLGETUNIFORMLOCATIONPROC __glewGetUniformLocation = stubGetUniformLocation;
+PFNGLLINKPROGRAMPROC __glewLinkProgram = stubLinkProgram;
+PFNGLRENDERBUFFERSTORAGEPROC __glewRenderbufferStorage = stubRenderbufferStorage;
+PFNGLSHADERSOURCEPROC __glewShaderSource = stubShaderSource;
+PFNGLUNIFORM1FPROC __glewUniform1f = stubUniform1f;
+PFNGLUNIFORM1FVPROC __glewUniform1fv = stubUniformfv;
+PFNGLUNIFORM1IPROC __glewUniform1i = stubUniform1i;
+PFNGLUNIFORM1IVPROC __glewUniform1iv = stubUniformiv;
+PFNGLUNIFORM2FPROC __glewUniform2f = stubUniform2f;
+PFNGLUNIFORM2FVPROC __glewUniform2fv = stubUniformfv;
+PFNGLUNIFORM3FPROC __glewUniform3f = stubUniform3f;
+PFNGLUNIFORM3FVPROC __glewUniform3fv = stubUniformfv;
+PFNGLUNIFORM4FPROC __glewUniform4f = stubUniform4f;
+PFNGLUNIFORM4FVPROC __glewUniform4fv = stubUniformfv;
+PFNGLUNIFORMMATRIX4FVPROC __glewUniformMatrix4fv = stubUniformMatrix4fv;
+PFNGLUSEPROGRAMPROC __glewUseProgram = stubUseProgram;
+PFNGLVERTEXATTRIBPOINTERPROC __glewVertexAttribPointer = stubVertexAttribPointer;
+
+// The GL 1.1 entry points, which the engine calls directly.
+extern "C"
+{
+
+void GLAPIENTRY glBindTexture(GLenum target, GLuint texture) { __textureBinding = texture; }
+void GLAPIENTRY glBlendFunc(GLenum sfactor, GLenum dfactor) { }
+void GLAPIENTRY glClear(GLbitfield mask) { }
+void GLAPIENTRY glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) { }
+void GLAPIENTRY glClearDepth(GLclampd depth) { }
+void GLAPIENTRY glClearStencil(GLint s) { }
+void GLAPIENTRY glDeleteTextures(GLsizei n, const GLuint* textures) { }
+void GLAPIENTRY glDepthMask(GLboolean flag) { }
+void GLAPIENTRY glDisable(GLenum cap) { }
+void GLAPIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count) { recordDrawCall(mode, first, count, 0, NULL); }
+void GLAPIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) { recordDrawCall(mode, 0, count, type, indices); }
+void GLAPIENTRY glEnable(GLenum cap) { }
+void GLAPIENTRY glGenTextures(GLsizei n, GLuint* textures) { generateNames(n, textures); }
+GLenum GLAPIENTRY glGetError() { return GL_NO_ERROR; }
+void GLAPIENTRY glPixelStorei(GLenum pname, GLint param) { }
+void GLAPIENTRY glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels) { }
+void GLAPIENTRY glTexParameteri(GLenum target, GLenum pname, GLint param) { }
+void GLAPIENTRY glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) { }
+void GLAPIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height) { }
+
+void GLAPIENTRY glGetIntegerv(GLenum pname, GLint* params)
+{
+    switch (pname)
+    {
+    case GL_MAX_VERTEX_ATTRIBS:
+        *params = STUB_MAX_VERTEX_ATTRIBS;
+        break;
+    case GL_MAX_COLOR_ATTACHMENTS:
+        *params = STUB_MAX_COLOR_ATTACHMENTS;
+        break;
+    case GL_TEXTURE_BINDING_2D:
+        *params = __textureBinding;
+        break;
+    case GL_FRAMEBUFFER_BINDING:
+        *params = __framebufferBinding;
+        break;
+    case GL_RENDERBUFFER_BINDING:
+        *params = __renderbufferBinding;
+        break;
+    case GL_ARRAY_BUFFER_BINDING:
+        *params = __arrayBufferBinding;
+        break;
+    case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+        *params = __elementArrayBufferBinding;
+        break;
+    default:
+        *params = 0;
+        break;
+    }
+}
+
+}
+
+namespace gameplay
+{
+
+const std::vector<unsigned char>& GLStub::getBufferData(GLuint buffer)
+{
+    static const std::vector<unsigned char> empty;
+    std::map<GLuint, std::vector<unsigned char> >::const_iterator itr = __buffers.find(buffer);
+    return itr != __buffers.end() ? itr->second : empty;
+}
+
+const std::vector<GLStub::BufferCall>& GLStub::getBufferCalls()
+{
+    return __bufferCalls;
+}
+
+const std::vector<GLStub::DrawCall>& GLStub::getDrawCalls()
+{
+    return __drawCalls;
+}
+
+unsigned int GLStub::getInvalidCallCount()
+{
+    return __invalidCallCount;
+}
+
+void GLStub::clear()
+{
+    __bufferCalls.clear();
+    __drawCalls.clear();
+    __invalidCallCount = 0;
+}
+
+}
@@ -0,0 +1,98 @@
+#ifndef GLSTUB_H_
+#define GLSTUB_H_
+
+namespace gameplay
+{
+
+/**
+ * Defines the recording of the GL stub that the tests run the engine with.
+ *
+ * The stub keeps a copy of the contents of each buffer object, and records the
+ * buffer uploads and draw calls, so tests can check what would reach the GPU.
+ * Calls that GL would reject (such as an upload beyond the end of a buffer) are
+ * counted instead of reported by glGetError, so they fail the test that checks
+ * them instead of an assertion of the engine.
+ */
+class GLStub
+{
+public:
+
+    /**
+     * The byte a buffer is filled with when glBufferData is given no data, so that
+     * contents orphaned by an upload cannot be mistaken for valid data.
+     */
+    static const unsigned char UNDEFINED_BYTE = 0xCD;
+
+    /**
+     * The types of recorded buffer uploads.
+     */
+    enum BufferCallType
+    {
+        BUFFER_DATA,
+        BUFFER_SUB_DATA
+    };
+
+    /**
+     * A recorded buffer upload.
+     */
+    struct BufferCall
+    {
+        BufferCallType type;    // The GL function.
+        GLuint buffer;          // The buffer bound to the target.
+        unsigned int offset;    // The offset of glBufferSubData, otherwise 0.
+        unsigned int size;      // The size of the upload, in bytes.
+    };
+
+    /**
+     * A recorded draw call.
+     */
+    struct DrawCall
+    {
+        GLenum mode;                // The primitive type.
+        unsigned int first;         // The first vertex of glDrawArrays, otherwise 0.
+        unsigned int count;         // The number of vertices or indices.
+        GLenum type;                // The index type of glDrawElements, otherwise 0.
+        unsigned int offset;        // The offset of the indices of glDrawElements in the element array buffer, in bytes.
+        GLuint arrayBuffer;         // The buffer bound to GL_ARRAY_BUFFER.
+        GLuint elementArrayBuffer;  // The buffer bound to GL_ELEMENT_ARRAY_BUFFER.
+    };
+
+    /**
+     * Gets the contents of a buffer object.
+     *
+     * @param buffer The buffer.
+     *
+     * @return The contents of the buffer, empty if it has no storage.
+     */
+    static const std::vector<unsigned char>& getBufferData(GLuint buffer);
+
+    /**
+     * Gets the buffer uploads recorded since the last call to clear().
+     *
+     * @return The recorded buffer uploads.
+     */
+    static const std::vector<BufferCall>& getBufferCalls();
+
+    /**
+     * Gets the draw calls recorded since the last call to clear().
+     *
+     * @return The recorded draw calls.
+     */
+    static const std::vector<DrawCall>& getDrawCalls();
+
+    /**
+     * Gets the number of calls that GL would have rejected since the last call to clear().
+     *
+     * @return The number of invalid calls.
+     */
+    static unsigned int getInvalidCallCount();
+
+    /**
+     * Clears the recorded calls. The contents of buffers are kept.
+     */
+    static void clear();
+};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+// Declares the wrappers the tests use to call the private kernels of MathUtil.
+//
+// This header has no include guard: MathUtilTest.cpp includes it once as is, and
+// once with MathUtilTest renamed to MathUtilScalarTest, to declare the wrappers of
+// both the vector implementation of the build and the scalar implementation.
+
+namespace gameplay
+{
+
+class MathUtilTest
+{
+public:
+
+    static void multiplyMatrix(const float* m1, const float* m2, float* dst);
+
+    static void multiplyMatrixRows(const float* m1, const float* m2, float* dst);
+
+    static bool invertMatrix(const float* m, float* dst);
+
+    static void transformVector4(const float* m, float x, float y, float z, float w, float* dst);
+
+    static void blendQuaternion(const float* q1, float alpha, const float* q2, float beta, float* dst);
+
+    static void accumulateVector4(const float* v, float weight, float* sum);
+
+    static void accumulateQuaternion(const float* q, float weight, float* sum);
+
+    static void skinVertex(const float* palette, const unsigned int* rows, const float* weights, const float* position,
+                           const float* directions, unsigned int directionCount, float* dstPosition, float* const* dstDirections);
+
+    static void addScaledArray(const float* src, float scale, float* dst, unsigned int count);
+
+    static void lerpArray(const float* start, const float* delta, const float* t, float* dst, unsigned int count);
+
+    static void spendEnergyArray(float* energy, const float* energyInverse, float elapsed, float* percent, unsigned int count);
+
+    static void advanceFrameArray(const float* percent, float percentPerFrame, unsigned int lastFrame,
+                                  unsigned int* frames, unsigned int count);
+
+    static void advanceLoopedFrameArray(float* time, float elapsed, float duration, unsigned int frameCount,
+                                        unsigned int* frames, unsigned int count);
+
+    static void randomArray(unsigned int* state, float* dst, unsigned int count);
+};
+
+}
@@ -0,0 +1,79 @@
+// Defines the wrappers declared by MathUtilKernels.h for the MathUtil included before.
+
+namespace gameplay
+{
+
+void MathUtilTest::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+    MathUtil::multiplyMatrix(m1, m2, dst);
+}
+
+void MathUtilTest::multiplyMatrixRows(const float* m1, const float* m2, float* dst)
+{
+    MathUtil::multiplyMatrixRows(m1, m2, dst);
+}
+
+bool MathUtilTest::invertMatrix(const float* m, float* dst)
+{
+    return MathUtil::invertMatrix(m, dst);
+}
+
+void MathUtilTest::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    MathUtil::transformVector4(m, x, y, z, w, dst);
+}
+
+void MathUtilTest::blendQuaternion(const float* q1, float alpha, const float* q2, float beta, float* dst)
+{
+    MathUtil::blendQuaternion(q1, alpha, q2, beta, dst);
+}
+
+void MathUtilTest::accumulateVector4(const float* v, float weight, float* sum)
+{
+    MathUtil::accumulateVector4(v, weight, sum);
+}
+
+void MathUtilTest::accumulateQuaternion(const float* q, float weight, float* sum)
+{
+    MathUtil::accumulateQuaternion(q, weight, sum);
+}
+
+void MathUtilTest::skinVertex(const float* palette, const unsigned int* rows, const float* weights, const float* position,
+                              const float* directions, unsigned int directionCount, float* dstPosition, float* const* dstDirections)
+{
+    MathUtil::skinVertex(palette, rows, weights, position, directions, directionCount, dstPosition, dstDirections);
+}
+
+void MathUtilTest::addScaledArray(const float* src, float scale, float* dst, unsigned int count)
+{
+    MathUtil::addScaledArray(src, scale, dst, count);
+}
+
+void MathUtilTest::lerpArray(const float* start, const float* delta, const float* t, float* dst, unsigned int count)
+{
+    MathUtil::lerpArray(start, delta, t, dst, count);
+}
+
+void MathUtilTest::spendEnergyArray(float* energy, const float* energyInverse, float elapsed, float* percent, unsigned int count)
+{
+    MathUtil::spendEnergyArray(energy, energyInverse, elapsed, percent, count);
+}
+
+void MathUtilTest::advanceFrameArray(const float* percent, float percentPerFrame, unsigned int lastFrame,
+                                     unsigned int* frames, unsigned int count)
+{
+    MathUtil::advanceFrameArray(percent, percentPerFrame, lastFrame, frames, count);
+}
+
+void MathUtilTest::advanceLoopedFrameArray(float* time, float elapsed, float duration, unsigned int frameCount,
+                                           unsigned int* frames, unsigned int count)
+{
+    MathUtil::advanceLoopedFrameArray(time, elapsed, duration, frameCount, frames, count);
+}
+
+void MathUtilTest::randomArray(unsigned int* state, float* dst, unsigned int count)
+{
+    MathUtil::randomArray(state, dst, count);
+}
+
+}
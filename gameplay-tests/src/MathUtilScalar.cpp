@@ -0,0 +1,10 @@
+// Compiles the kernel wrappers with the scalar MathUtil implementation, renamed so
+// that it does not clash with the implementation selected by the build.
+#define GAMEPLAY_MATH_NO_SIMD
+#define MathUtil MathUtilScalar
+#define MathUtilTest MathUtilScalarTest
+
+#include "Base.h"
+#include "MathUtil.h"
+#include "MathUtilKernels.h"
+#include "MathUtilKernels.inl"
@@ -0,0 +1,562 @@
+#include "Base.h"
+#include "Test.h"
+#include "MathUtilKernels.h"
+#define MathUtilTest MathUtilScalarTest
+#include "MathUtilKernels.h"
+#undef MathUtilTest
+#include <cstring>
+#include <algorithm>
+
+// Compares each kernel of the MathUtil implementation selected by the build (SSE2 or
+// NEON) with the scalar implementation, on random and edge inputs. The vector
+// implementations evaluate the same expressions in a different order, so results are
+// compared with a tolerance relative to the magnitude of the results, chosen per kernel.
+
+// The number of random inputs each kernel is run on.
+#define RANDOM_INPUT_COUNT 1000
+
+// Products of sums in a different order.
+#define MULTIPLY_TOLERANCE 1e-5f
+
+// The SSE2 inverse computes its cofactors by 2x2 blocks, which loses about 7e-4 on
+// matrices with entries of mixed magnitudes.
+#define INVERT_TOLERANCE 2e-3f
+
+// The length correction of blended quaternions amplifies rounding a little.
+#define BLEND_TOLERANCE 1e-5f
+
+// Single multiply-adds.
+#define ACCUMULATE_TOLERANCE 1e-6f
+
+// Blended joint matrices applied to a vector.
+#define SKIN_TOLERANCE 1e-5f
+
+// The number of elements of the arrays given to the particle kernels, a multiple of 4.
+#define PARTICLE_ARRAY_COUNT 64
+
+namespace gameplay
+{
+
+static unsigned int __randomState = 1;
+
+/**
+ * Returns a random float in [min, max), from a sequence that is the same on every run.
+ */
+static float random(float min, float max)
+{
+    __randomState = __randomState * 1664525u + 1013904223u;
+    return min + (max - min) * ((__randomState >> 8) * (1.0f / 16777216.0f));
+}
+
+/**
+ * Fills an array with random floats in [min, max).
+ */
+static void randomArray(float* dst, unsigned int count, float min, float max)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] = random(min, max);
+    }
+}
+
+/**
+ * Fills m with a random matrix that is far from singular: random entries added to a
+ * diagonal of the given scale.
+ */
+static void randomMatrix(float* m, float scale)
+{
+    randomArray(m, 16, -scale, scale);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        m[i * 5] += random(2.0f, 4.0f) * scale * (random(0.0f, 1.0f) < 0.5f ? -1.0f : 1.0f);
+    }
+}
+
+/**
+ * Fills q with a random unit quaternion.
+ */
+static void randomQuaternion(float* q)
+{
+    float length;
+    do
+    {
+        randomArray(q, 4, -1.0f, 1.0f);
+        length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    } while (length < 0.01f);
+
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        q[i] /= length;
+    }
+}
+
+/**
+ * Checks that two arrays are equal within a tolerance relative to the largest magnitude
+ * of the expected array.
+ */
+static bool checkArray(const char* kernel, const float* actual, const float* expected, unsigned int count, float tolerance)
+{
+    float scale = 1.0f;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        scale = std::max(scale, (float)fabs(expected[i]));
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!(fabs(actual[i] - expected[i]) <= tolerance * scale))
+        {
+            Test::fail(__FILE__, __LINE__, "%s: element %u is %.9g instead of %.9g", kernel, i, actual[i], expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks that two arrays of frame indices are equal.
+ */
+static bool checkFrames(const char* kernel, const unsigned int* actual, const unsigned int* expected, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (actual[i] != expected[i])
+        {
+            Test::fail(__FILE__, __LINE__, "%s: frame %u is %u instead of %u", kernel, i, actual[i], expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static const float __identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+static const float __zero[16] = { 0 };
+
+// A matrix with two equal rows.
+static const float __singular[16] = { 1, 2, 1, 4, 5, 6, 5, 8, 9, 10, 9, 12, 13, 14, 13, 16 };
+
+// A rotation, scale and translation, as built by Node.
+static const float __transform[16] = { 0, 2, 0, 0, -2, 0, 0, 0, 0, 0, 2, 0, 10, -20, 30, 1 };
+
+TEST(multiplyMatrix)
+{
+    float m1[16], m2[16], actual[16], expected[16];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        float scale = i % 3 == 0 ? 1000.0f : (i % 3 == 1 ? 0.001f : 1.0f);
+        randomArray(m1, 16, -scale, scale);
+        randomArray(m2, 16, -1.0f, 1.0f);
+        MathUtilTest::multiplyMatrix(m1, m2, actual);
+        MathUtilScalarTest::multiplyMatrix(m1, m2, expected);
+        if (!checkArray("multiplyMatrix", actual, expected, 16, MULTIPLY_TOLERANCE))
+            break;
+    }
+
+    // Identity and zero.
+    MathUtilTest::multiplyMatrix(__transform, __identity, actual);
+    checkArray("multiplyMatrix", actual, __transform, 16, 0.0f);
+    MathUtilTest::multiplyMatrix(__identity, __transform, actual);
+    checkArray("multiplyMatrix", actual, __transform, 16, 0.0f);
+    MathUtilTest::multiplyMatrix(__transform, __zero, actual);
+    checkArray("multiplyMatrix", actual, __zero, 16, 0.0f);
+
+    // The result may be written over either operand.
+    randomArray(m1, 16, -1.0f, 1.0f);
+    randomArray(m2, 16, -1.0f, 1.0f);
+    MathUtilScalarTest::multiplyMatrix(m1, m2, expected);
+    memcpy(actual, m1, sizeof(actual));
+    MathUtilTest::multiplyMatrix(actual, m2, actual);
+    checkArray("multiplyMatrix", actual, expected, 16, MULTIPLY_TOLERANCE);
+    memcpy(actual, m2, sizeof(actual));
+    MathUtilTest::multiplyMatrix(m1, actual, actual);
+    checkArray("multiplyMatrix", actual, expected, 16, MULTIPLY_TOLERANCE);
+}
+
+TEST(multiplyMatrixRows)
+{
+    float m1[16], m2[16], actual[12], expected[12];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        randomArray(m1, 16, -10.0f, 10.0f);
+        randomArray(m2, 16, -10.0f, 10.0f);
+        MathUtilTest::multiplyMatrixRows(m1, m2, actual);
+        MathUtilScalarTest::multiplyMatrixRows(m1, m2, expected);
+        if (!checkArray("multiplyMatrixRows", actual, expected, 12, MULTIPLY_TOLERANCE))
+            break;
+    }
+
+    // The rows of the full product.
+    float product[16], rows[12];
+    MathUtilScalarTest::multiplyMatrix(__transform, m2, product);
+    for (unsigned int row = 0; row < 3; ++row)
+    {
+        for (unsigned int column = 0; column < 4; ++column)
+        {
+            rows[row * 4 + column] = product[column * 4 + row];
+        }
+    }
+    MathUtilTest::multiplyMatrixRows(__transform, m2, actual);
+    checkArray("multiplyMatrixRows", actual, rows, 12, MULTIPLY_TOLERANCE);
+}
+
+TEST(invertMatrix)
+{
+    float m[16], actual[16], expected[16];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        randomMatrix(m, i % 2 == 0 ? 1.0f : 100.0f);
+        bool actualResult = MathUtilTest::invertMatrix(m, actual);
+        bool expectedResult = MathUtilScalarTest::invertMatrix(m, expected);
+        TEST_ASSERT(actualResult == expectedResult);
+        if (!checkArray("invertMatrix", actual, expected, 16, INVERT_TOLERANCE))
+            break;
+    }
+
+    // Exact inverses.
+    TEST_ASSERT(MathUtilTest::invertMatrix(__identity, actual));
+    checkArray("invertMatrix", actual, __identity, 16, 0.0f);
+    TEST_ASSERT(MathUtilTest::invertMatrix(__transform, actual));
+    float product[16];
+    MathUtilScalarTest::multiplyMatrix(__transform, actual, product);
+    checkArray("invertMatrix", product, __identity, 16, INVERT_TOLERANCE);
+
+    // Singular matrices are not inverted, and leave dst unchanged.
+    memcpy(actual, __transform, sizeof(actual));
+    TEST_ASSERT(!MathUtilTest::invertMatrix(__singular, actual));
+    TEST_ASSERT(!MathUtilTest::invertMatrix(__zero, actual));
+    checkArray("invertMatrix", actual, __transform, 16, 0.0f);
+
+    // The result may be written over the matrix.
+    randomMatrix(m, 1.0f);
+    MathUtilScalarTest::invertMatrix(m, expected);
+    TEST_ASSERT(MathUtilTest::invertMatrix(m, m));
+    checkArray("invertMatrix", m, expected, 16, INVERT_TOLERANCE);
+}
+
+TEST(transformVector4)
+{
+    float m[16], v[4], actual[4], expected[4];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        randomArray(m, 16, -10.0f, 10.0f);
+        randomArray(v, 4, -100.0f, 100.0f);
+        MathUtilTest::transformVector4(m, v[0], v[1], v[2], v[3], actual);
+        MathUtilScalarTest::transformVector4(m, v[0], v[1], v[2], v[3], expected);
+        if (!checkArray("transformVector4", actual, expected, 4, MULTIPLY_TOLERANCE))
+            break;
+    }
+
+    // Points are translated, directions are not.
+    const float point[4] = { 8, -18, 32, 1 };
+    MathUtilTest::transformVector4(__transform, 1, 1, 1, 1, actual);
+    checkArray("transformVector4", actual, point, 4, 0.0f);
+    const float direction[4] = { -2, 2, 0, 0 };
+    MathUtilTest::transformVector4(__transform, 1, 1, 0, 0, actual);
+    checkArray("transformVector4", actual, direction, 4, 0.0f);
+}
+
+TEST(blendQuaternion)
+{
+    float q1[4], q2[4], actual[4], expected[4];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        randomQuaternion(q1);
+        randomQuaternion(q2);
+        float t = random(0.0f, 1.0f);
+        MathUtilTest::blendQuaternion(q1, 1.0f - t, q2, t, actual);
+        MathUtilScalarTest::blendQuaternion(q1, 1.0f - t, q2, t, expected);
+        if (!checkArray("blendQuaternion", actual, expected, 4, BLEND_TOLERANCE))
+            break;
+    }
+
+    // The ends of the blend, written over either operand.
+    randomQuaternion(q1);
+    randomQuaternion(q2);
+    memcpy(actual, q1, sizeof(actual));
+    MathUtilTest::blendQuaternion(actual, 1.0f, q2, 0.0f, actual);
+    checkArray("blendQuaternion", actual, q1, 4, BLEND_TOLERANCE);
+    memcpy(actual, q2, sizeof(actual));
+    MathUtilTest::blendQuaternion(q1, 0.0f, actual, 1.0f, actual);
+    checkArray("blendQuaternion", actual, q2, 4, BLEND_TOLERANCE);
+}
+
+TEST(accumulateVector4)
+{
+    float v[4], actual[4], expected[4];
+    randomArray(actual, 4, -1.0f, 1.0f);
+    memcpy(expected, actual, sizeof(expected));
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        randomArray(v, 4, -10.0f, 10.0f);
+        float weight = i % 10 == 0 ? 0.0f : random(-1.0f, 1.0f);
+        MathUtilTest::accumulateVector4(v, weight, actual);
+        MathUtilScalarTest::accumulateVector4(v, weight, expected);
+        if (!checkArray("accumulateVector4", actual, expected, 4, ACCUMULATE_TOLERANCE))
+            break;
+    }
+}
+
+TEST(accumulateQuaternion)
+{
+    float q[4], actual[4], expected[4];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        // Sum a few weighted quaternions, as blended animation channels do.
+        memset(actual, 0, sizeof(actual));
+        memset(expected, 0, sizeof(expected));
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            randomQuaternion(q);
+            float weight = random(0.0f, 1.0f);
+            MathUtilTest::accumulateQuaternion(q, weight, actual);
+            MathUtilScalarTest::accumulateQuaternion(q, weight, expected);
+        }
+        if (!checkArray("accumulateQuaternion", actual, expected, 4, ACCUMULATE_TOLERANCE))
+            break;
+    }
+
+    // A quaternion in the opposite hemisphere is negated before it is added.
+    const float sum[4] = { 0, 0, 0, 1 };
+    const float opposite[4] = { 0, 0, 0.6f, -0.8f };
+    const float expectedSum[4] = { 0, 0, -0.3f, 1.4f };
+    memcpy(actual, sum, sizeof(actual));
+    MathUtilTest::accumulateQuaternion(opposite, 0.5f, actual);
+    checkArray("accumulateQuaternion", actual, expectedSum, 4, ACCUMULATE_TOLERANCE);
+}
+
+TEST(skinVertex)
+{
+    // A palette of 8 joints.
+    float palette[8 * 12];
+    randomArray(palette, 8 * 12, -2.0f, 2.0f);
+
+    float position[4], directions[12], weights[4];
+    unsigned int rows[4];
+    float actual[12], expected[12];
+    float* actualDirections[3] = { &actual[3], &actual[6], &actual[9] };
+    float* expectedDirections[3] = { &expected[3], &expected[6], &expected[9] };
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        randomArray(position, 3, -100.0f, 100.0f);
+        position[3] = 1.0f;
+        randomArray(directions, 12, -1.0f, 1.0f);
+        randomArray(weights, 4, 0.0f, 1.0f);
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            rows[j] = (unsigned int)random(0.0f, 8.0f) * 3;
+        }
+        if (i % 4 == 0)
+        {
+            // Unused influences.
+            weights[2] = weights[3] = 0.0f;
+        }
+
+        // Every number of directions, which the vector kernels skin in different ways.
+        unsigned int directionCount = i % 4;
+        memset(actual, 0, sizeof(actual));
+        memset(expected, 0, sizeof(expected));
+        MathUtilTest::skinVertex(palette, rows, weights, position, directions, directionCount, actual, actualDirections);
+        MathUtilScalarTest::skinVertex(palette, rows, weights, position, directions, directionCount, expected, expectedDirections);
+        if (!checkArray("skinVertex", actual, expected, 12, SKIN_TOLERANCE))
+            break;
+    }
+
+    // Identity joints leave the vertex unchanged.
+    float identity[12] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0 };
+    const unsigned int identityRows[4] = { 0, 0, 0, 0 };
+    const float identityWeights[4] = { 0.5f, 0.25f, 0.25f, 0.0f };
+    MathUtilTest::skinVertex(identity, identityRows, identityWeights, position, directions, 3, actual, actualDirections);
+    checkArray("skinVertex", actual, position, 3, SKIN_TOLERANCE);
+    checkArray("skinVertex", &actual[3], &directions[0], 3, SKIN_TOLERANCE);
+    checkArray("skinVertex", &actual[6], &directions[4], 3, SKIN_TOLERANCE);
+    checkArray("skinVertex", &actual[9], &directions[8], 3, SKIN_TOLERANCE);
+}
+
+TEST(addScaledArray)
+{
+    float src[PARTICLE_ARRAY_COUNT], actual[PARTICLE_ARRAY_COUNT], expected[PARTICLE_ARRAY_COUNT];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        randomArray(src, PARTICLE_ARRAY_COUNT, -100.0f, 100.0f);
+        randomArray(actual, PARTICLE_ARRAY_COUNT, -100.0f, 100.0f);
+        memcpy(expected, actual, sizeof(expected));
+        float scale = random(0.0f, 0.1f);
+        MathUtilTest::addScaledArray(src, scale, actual, PARTICLE_ARRAY_COUNT);
+        MathUtilScalarTest::addScaledArray(src, scale, expected, PARTICLE_ARRAY_COUNT);
+        if (!checkArray("addScaledArray", actual, expected, PARTICLE_ARRAY_COUNT, ACCUMULATE_TOLERANCE))
+            break;
+    }
+}
+
+TEST(lerpArray)
+{
+    float start[PARTICLE_ARRAY_COUNT], delta[PARTICLE_ARRAY_COUNT], t[PARTICLE_ARRAY_COUNT];
+    float actual[PARTICLE_ARRAY_COUNT], expected[PARTICLE_ARRAY_COUNT];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        randomArray(start, PARTICLE_ARRAY_COUNT, -1.0f, 1.0f);
+        randomArray(delta, PARTICLE_ARRAY_COUNT, -2.0f, 2.0f);
+        randomArray(t, PARTICLE_ARRAY_COUNT, 0.0f, 1.0f);
+        MathUtilTest::lerpArray(start, delta, t, actual, PARTICLE_ARRAY_COUNT);
+        MathUtilScalarTest::lerpArray(start, delta, t, expected, PARTICLE_ARRAY_COUNT);
+        if (!checkArray("lerpArray", actual, expected, PARTICLE_ARRAY_COUNT, ACCUMULATE_TOLERANCE))
+            break;
+    }
+
+    // The ends of the interpolation.
+    for (unsigned int i = 0; i < PARTICLE_ARRAY_COUNT; ++i)
+    {
+        t[i] = 0.0f;
+    }
+    MathUtilTest::lerpArray(start, delta, t, actual, PARTICLE_ARRAY_COUNT);
+    checkArray("lerpArray", actual, start, PARTICLE_ARRAY_COUNT, 0.0f);
+    for (unsigned int i = 0; i < PARTICLE_ARRAY_COUNT; ++i)
+    {
+        t[i] = 1.0f;
+        expected[i] = start[i] + delta[i];
+    }
+    MathUtilTest::lerpArray(start, delta, t, actual, PARTICLE_ARRAY_COUNT);
+    checkArray("lerpArray", actual, expected, PARTICLE_ARRAY_COUNT, 0.0f);
+}
+
+TEST(spendEnergyArray)
+{
+    float energyInverse[PARTICLE_ARRAY_COUNT];
+    float actualEnergy[PARTICLE_ARRAY_COUNT], expectedEnergy[PARTICLE_ARRAY_COUNT];
+    float actualPercent[PARTICLE_ARRAY_COUNT], expectedPercent[PARTICLE_ARRAY_COUNT];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        // Particles part way through their life, some of which run out of energy.
+        for (unsigned int j = 0; j < PARTICLE_ARRAY_COUNT; ++j)
+        {
+            float energy = random(0.1f, 10.0f);
+            energyInverse[j] = 1.0f / energy;
+            actualEnergy[j] = energy * random(0.0f, 1.0f);
+        }
+        memcpy(expectedEnergy, actualEnergy, sizeof(expectedEnergy));
+        float elapsed = random(0.0f, 0.1f);
+        MathUtilTest::spendEnergyArray(actualEnergy, energyInverse, elapsed, actualPercent, PARTICLE_ARRAY_COUNT);
+        MathUtilScalarTest::spendEnergyArray(expectedEnergy, energyInverse, elapsed, expectedPercent, PARTICLE_ARRAY_COUNT);
+        if (!checkArray("spendEnergyArray", actualEnergy, expectedEnergy, PARTICLE_ARRAY_COUNT, ACCUMULATE_TOLERANCE) ||
+            !checkArray("spendEnergyArray", actualPercent, expectedPercent, PARTICLE_ARRAY_COUNT, ACCUMULATE_TOLERANCE))
+            break;
+    }
+
+    // A full particle has spent nothing, an empty one everything.
+    for (unsigned int i = 0; i < PARTICLE_ARRAY_COUNT; ++i)
+    {
+        actualEnergy[i] = i % 2 == 0 ? 4.0f : 0.0f;
+        energyInverse[i] = 0.25f;
+        expectedPercent[i] = i % 2 == 0 ? 0.0f : 1.0f;
+    }
+    MathUtilTest::spendEnergyArray(actualEnergy, energyInverse, 0.0f, actualPercent, PARTICLE_ARRAY_COUNT);
+    checkArray("spendEnergyArray", actualPercent, expectedPercent, PARTICLE_ARRAY_COUNT, 0.0f);
+}
+
+TEST(advanceFrameArray)
+{
+    float percent[PARTICLE_ARRAY_COUNT];
+    unsigned int actual[PARTICLE_ARRAY_COUNT], expected[PARTICLE_ARRAY_COUNT];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        unsigned int frameCount = 1 + i % 16;
+        float percentPerFrame = 1.0f / frameCount;
+        for (unsigned int j = 0; j < PARTICLE_ARRAY_COUNT; ++j)
+        {
+            actual[j] = (unsigned int)random(0.0f, (float)frameCount);
+        }
+        memcpy(expected, actual, sizeof(expected));
+        randomArray(percent, PARTICLE_ARRAY_COUNT, 0.0f, 1.0f);
+        MathUtilTest::advanceFrameArray(percent, percentPerFrame, frameCount - 1, actual, PARTICLE_ARRAY_COUNT);
+        MathUtilScalarTest::advanceFrameArray(percent, percentPerFrame, frameCount - 1, expected, PARTICLE_ARRAY_COUNT);
+        if (!checkFrames("advanceFrameArray", actual, expected, PARTICLE_ARRAY_COUNT))
+            break;
+    }
+
+    // Frames of a quarter advance at the end of the frame, but not past the last frame.
+    const float edgePercent[8] = { 0.2f, 0.25f, 0.5f, 0.74f, 1.0f, 1.0f, 0.0f, 0.3f };
+    unsigned int edgeFrames[8] = { 0, 0, 1, 2, 3, 2, 0, 1 };
+    const unsigned int edgeExpected[8] = { 0, 1, 2, 2, 3, 3, 0, 1 };
+    MathUtilTest::advanceFrameArray(edgePercent, 0.25f, 3, edgeFrames, 8);
+    checkFrames("advanceFrameArray", edgeFrames, edgeExpected, 8);
+}
+
+TEST(advanceLoopedFrameArray)
+{
+    float actualTime[PARTICLE_ARRAY_COUNT], expectedTime[PARTICLE_ARRAY_COUNT];
+    unsigned int actualFrames[PARTICLE_ARRAY_COUNT], expectedFrames[PARTICLE_ARRAY_COUNT];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        unsigned int frameCount = 1 + i % 16;
+        float duration = random(0.01f, 1.0f);
+        for (unsigned int j = 0; j < PARTICLE_ARRAY_COUNT; ++j)
+        {
+            actualFrames[j] = (unsigned int)random(0.0f, (float)frameCount);
+        }
+        randomArray(actualTime, PARTICLE_ARRAY_COUNT, 0.0f, duration);
+        memcpy(expectedFrames, actualFrames, sizeof(expectedFrames));
+        memcpy(expectedTime, actualTime, sizeof(expectedTime));
+        float elapsed = random(0.0f, duration);
+        MathUtilTest::advanceLoopedFrameArray(actualTime, elapsed, duration, frameCount, actualFrames, PARTICLE_ARRAY_COUNT);
+        MathUtilScalarTest::advanceLoopedFrameArray(expectedTime, elapsed, duration, frameCount, expectedFrames, PARTICLE_ARRAY_COUNT);
+        if (!checkArray("advanceLoopedFrameArray", actualTime, expectedTime, PARTICLE_ARRAY_COUNT, ACCUMULATE_TOLERANCE) ||
+            !checkFrames("advanceLoopedFrameArray", actualFrames, expectedFrames, PARTICLE_ARRAY_COUNT))
+            break;
+    }
+
+    // Frames advance when their time reaches the duration, and the last frame wraps to the first.
+    float edgeTime[4] = { 0.25f, 0.5f, 0.75f, 0.75f };
+    unsigned int edgeFrames[4] = { 0, 1, 2, 3 };
+    const float edgeExpectedTime[4] = { 0.5f, 0.75f, 0.0f, 0.0f };
+    const unsigned int edgeExpectedFrames[4] = { 0, 1, 3, 0 };
+    MathUtilTest::advanceLoopedFrameArray(edgeTime, 0.25f, 1.0f, 4, edgeFrames, 4);
+    checkArray("advanceLoopedFrameArray", edgeTime, edgeExpectedTime, 4, 0.0f);
+    checkFrames("advanceLoopedFrameArray", edgeFrames, edgeExpectedFrames, 4);
+}
+
+TEST(randomArraySequence)
+{
+    // The random sequence must be the same with every implementation, bit for bit, so
+    // that seeded particle emitters emit the same particles whatever the build.
+    unsigned int actualState[4], expectedState[4];
+    float actual[PARTICLE_ARRAY_COUNT], expected[PARTICLE_ARRAY_COUNT];
+    for (unsigned int i = 0; i < RANDOM_INPUT_COUNT; ++i)
+    {
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            random(0.0f, 1.0f);
+            actualState[j] = expectedState[j] = __randomState | 1;
+        }
+        unsigned int count = 4 * (1 + i % (PARTICLE_ARRAY_COUNT / 4));
+        MathUtilTest::randomArray(actualState, actual, count);
+        MathUtilScalarTest::randomArray(expectedState, expected, count);
+        if (memcmp(actual, expected, count * sizeof(float)) != 0 || memcmp(actualState, expectedState, sizeof(actualState)) != 0)
+        {
+            Test::fail(__FILE__, __LINE__, "randomArray: the sequence of %u floats differs from the scalar implementation", count);
+            break;
+        }
+        for (unsigned int j = 0; j < count; ++j)
+        {
+            if (!(actual[j] >= 0.0f && actual[j] < 1.0f))
+            {
+                Test::fail(__FILE__, __LINE__, "randomArray: element %u is %.9g, outside [0, 1)", j, actual[j]);
+                break;
+            }
+        }
+    }
+
+    // The first values of the xorshift generators, whose high 23 bits are the random floats.
+    unsigned int state[4] = { 1, 2, 3, 4 };
+    const unsigned int highBits[8] = { 528, 1056, 1584, 2112, 132099, 262214, 394309, 524428 };
+    const unsigned int finalState[4] = { 67634689, 134253570, 201886211, 268507140 };
+    MathUtilTest::randomArray(state, actual, 8);
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        expected[i] = (float)highBits[i] / 8388608.0f;
+    }
+    checkArray("randomArray", actual, expected, 8, 0.0f);
+    TEST_ASSERT(memcmp(state, finalState, sizeof(state)) == 0);
+}
+
+}
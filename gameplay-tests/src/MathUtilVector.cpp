@@ -0,0 +1,6 @@
+// Compiles the kernel wrappers with the MathUtil implementation selected by the build
+// (SSE2, NEON or scalar).
+#include "Base.h"
+#include "MathUtil.h"
+#include "MathUtilKernels.h"
+#include "MathUtilKernels.inl"
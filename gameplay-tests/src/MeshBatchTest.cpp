@@ -0,0 +1,132 @@
+#include "Base.h"
+#include "MeshBatch.h"
+#include "GLStub.h"
+#include "Test.h"
+
+// Draws frames of numbered quads with a streaming mesh batch, and checks that every
+// index drawn refers to the right vertex in the vertex ring, as the rings wrap around
+// and grow in the middle of a batch.
+
+namespace gameplay
+{
+
+/**
+ * Gives the tests access to the default render state that passes are bound against.
+ */
+class MeshBatchTest : public RenderState
+{
+public:
+
+    /**
+     * Creates the default render state, as the game does on startup.
+     */
+    static void initialize()
+    {
+        RenderState::initialize();
+    }
+
+    /**
+     * Releases the default render state.
+     */
+    static void finalize()
+    {
+        RenderState::finalize();
+    }
+};
+
+/**
+ * A vertex of the tests, numbered by its w coordinate to be found again in the vertex ring.
+ */
+struct BatchVertex
+{
+    float x, y, z;
+    float id;
+};
+
+static const unsigned short __quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+/**
+ * Checks that the last draw call drew the given quads.
+ */
+static void checkQuads(unsigned int quadCount, unsigned int firstId)
+{
+    const std::vector<GLStub::DrawCall>& draws = GLStub::getDrawCalls();
+    TEST_ASSERT(draws.size() == 1);
+    if (draws.size() != 1)
+        return;
+
+    const GLStub::DrawCall& draw = draws[0];
+    TEST_ASSERT(draw.mode == GL_TRIANGLES && draw.type == GL_UNSIGNED_SHORT);
+    TEST_ASSERT(draw.count == quadCount * 6);
+
+    const std::vector<unsigned char>& indexData = GLStub::getBufferData(draw.elementArrayBuffer);
+    const std::vector<unsigned char>& vertexData = GLStub::getBufferData(draw.arrayBuffer);
+    TEST_ASSERT(draw.offset + draw.count * sizeof(unsigned short) <= indexData.size());
+    if (draw.offset + draw.count * sizeof(unsigned short) > indexData.size())
+        return;
+
+    const unsigned short* indices = (const unsigned short*)&indexData[draw.offset];
+    const BatchVertex* vertices = (const BatchVertex*)&vertexData[0];
+    unsigned int vertexCount = vertexData.size() / sizeof(BatchVertex);
+    for (unsigned int i = 0; i < draw.count; ++i)
+    {
+        unsigned int expectedId = firstId + (i / 6) * 4 + __quadIndices[i % 6];
+        if (indices[i] >= vertexCount || vertices[indices[i]].id != (float)expectedId)
+        {
+            if (indices[i] >= vertexCount)
+                Test::fail(__FILE__, __LINE__, "index %u is %u, past the %u vertices of the ring", i, indices[i], vertexCount);
+            else
+                Test::fail(__FILE__, __LINE__, "index %u refers to vertex %g instead of vertex %u", i, vertices[indices[i]].id, expectedId);
+            return;
+        }
+    }
+}
+
+TEST(meshBatchOffsetsIndicesInRing)
+{
+    MeshBatchTest::initialize();
+    Effect* effect = Effect::createFromSource("attribute vec4 a_position; void main() { gl_Position = a_position; }",
+                                              "void main() { gl_FragColor = vec4(1.0); }");
+    Material* material = Material::create(effect);
+    VertexFormat::Element elements[] = { VertexFormat::Element(VertexFormat::POSITION, 4) };
+
+    // 8 triangles make rings of 96 vertices and 96 indices, which frames of 5 quads
+    // (20 vertices and 30 indices) wrap around in the middle of a batch. The frame of
+    // 30 quads grows the rings.
+    MeshBatch* batch = MeshBatch::create(VertexFormat(elements, 1), Mesh::TRIANGLES, material, true, 8, 8, true);
+    TEST_ASSERT(batch);
+    const unsigned int quadCounts[] = { 5, 5, 5, 5, 5, 5, 2, 7, 30, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5 };
+
+    unsigned int id = 0;
+    for (unsigned int frame = 0; frame < sizeof(quadCounts) / sizeof(quadCounts[0]); ++frame)
+    {
+        unsigned int firstId = id;
+        batch->begin();
+        for (unsigned int q = 0; q < quadCounts[frame]; ++q)
+        {
+            BatchVertex quad[4];
+            for (unsigned int i = 0; i < 4; ++i)
+            {
+                quad[i].x = (float)(i & 1);
+                quad[i].y = (float)(i >> 1);
+                quad[i].z = 0.0f;
+                quad[i].id = (float)id++;
+            }
+            batch->add(quad, 4, (unsigned short*)__quadIndices, 6);
+        }
+        batch->end();
+
+        GLStub::clear();
+        batch->draw();
+        checkQuads(quadCounts[frame], firstId);
+        TEST_ASSERT(GLStub::getInvalidCallCount() == 0);
+    }
+    TEST_ASSERT(batch->getCapacity() > 8);
+
+    SAFE_DELETE(batch);
+    SAFE_RELEASE(material);
+    SAFE_RELEASE(effect);
+    MeshBatchTest::finalize();
+}
+
+}
@@ -0,0 +1,243 @@
+#include "Base.h"
+#include "ParticleEmitter.h"
+#include "Node.h"
+#include "Test.h"
+
+// Checks that the compaction of the particles of an emitter keeps every living particle,
+// with all of its properties, and only the living particles, and that emitters seeded
+// with the same value emit the same particles.
+
+// The largest number of particles of the emitters.
+#define PARTICLE_COUNT_MAX 40
+
+// The number of living and dead particle patterns compacted.
+#define PATTERN_COUNT 1000
+
+// The number of updates of the replayed emitters, and their duration in milliseconds.
+#define REPLAY_UPDATE_COUNT 100
+#define REPLAY_UPDATE_TIME 16
+
+namespace gameplay
+{
+
+/**
+ * Fills and checks the particles of the emitters of the tests, which are private.
+ *
+ * The value of property k of the particle numbered n is n * 64 + k + 1, so a particle is
+ * found again from any of its properties, and a property copied from another particle
+ * or another property is detected.
+ */
+class ParticleEmitterTest
+{
+public:
+
+    /**
+     * Creates an emitter drawing with a sprite batch of a 1x1 texture.
+     */
+    static ParticleEmitter* createEmitter(unsigned int particleCountMax)
+    {
+        unsigned char white[4] = { 255, 255, 255, 255 };
+        Texture* texture = Texture::create(Texture::RGBA, 1, 1, white);
+        SpriteBatch* batch = SpriteBatch::create(texture, NULL, particleCountMax);
+        texture->release(); // batch owns the texture
+        return new ParticleEmitter(batch, particleCountMax);
+    }
+
+    /**
+     * Fills the emitter with count numbered particles, giving the dead ones no energy.
+     */
+    static void fillParticles(ParticleEmitter* emitter, const bool* living, unsigned int count)
+    {
+        unsigned int arrayCount = getFloatArrayCount(emitter);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            for (unsigned int k = 0; k < arrayCount; ++k)
+            {
+                emitter->_particleData[k * emitter->_particleCapacity + i] = getValue(i, k);
+            }
+            emitter->_particles._frame[i] = i;
+            if (!living[i])
+            {
+                // Particles die when their energy reaches zero or passes it.
+                emitter->_particles._energy[i] = i % 2 == 0 ? 0.0f : -1.0f;
+            }
+        }
+        emitter->_particleCount = count;
+    }
+
+    static void removeDeadParticles(ParticleEmitter* emitter)
+    {
+        emitter->removeDeadParticles();
+    }
+
+    /**
+     * Checks that the emitter holds each of the living particles of fillParticles() once.
+     */
+    static void checkParticles(ParticleEmitter* emitter, const bool* living, unsigned int count)
+    {
+        unsigned int livingCount = 0;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (living[i])
+                ++livingCount;
+        }
+        TEST_ASSERT(emitter->_particleCount == livingCount);
+
+        bool found[PARTICLE_COUNT_MAX] = { false };
+        unsigned int arrayCount = getFloatArrayCount(emitter);
+        for (unsigned int i = 0; i < emitter->_particleCount && i < count; ++i)
+        {
+            unsigned int n = emitter->_particles._frame[i];
+            if (n >= count || !living[n] || found[n])
+            {
+                Test::fail(__FILE__, __LINE__, "slot %u holds particle %u, which is %s", i, n,
+                    n >= count ? "unknown" : (!living[n] ? "dead" : "already in another slot"));
+                return;
+            }
+            found[n] = true;
+
+            for (unsigned int k = 0; k < arrayCount; ++k)
+            {
+                float value = emitter->_particleData[k * emitter->_particleCapacity + i];
+                if (value != getValue(n, k))
+                {
+                    Test::fail(__FILE__, __LINE__, "property %u of particle %u in slot %u is %g instead of %g", k, n, i, value, getValue(n, k));
+                    return;
+                }
+            }
+        }
+    }
+
+    /**
+     * Checks whether two emitters hold the same particles, bit for bit.
+     */
+    static bool hasSameParticles(ParticleEmitter* a, ParticleEmitter* b)
+    {
+        if (a->_particleCount != b->_particleCount)
+            return false;
+
+        unsigned int count = a->_particleCount;
+        for (unsigned int k = 0, arrayCount = getFloatArrayCount(a); k < arrayCount; ++k)
+        {
+            if (memcmp(&a->_particleData[k * a->_particleCapacity], &b->_particleData[k * b->_particleCapacity], count * sizeof(float)) != 0)
+                return false;
+        }
+        return memcmp(a->_particles._frame, b->_particles._frame, count * sizeof(unsigned int)) == 0;
+    }
+
+    static void clearParticles(ParticleEmitter* emitter)
+    {
+        emitter->_particleCount = 0;
+    }
+
+private:
+
+    /**
+     * Gets the number of float arrays of the particles, which are allocated one after
+     * the other, with _timeOnCurrentFrame last.
+     */
+    static unsigned int getFloatArrayCount(ParticleEmitter* emitter)
+    {
+        return (emitter->_particles._timeOnCurrentFrame - emitter->_particleData) / emitter->_particleCapacity + 1;
+    }
+
+    static float getValue(unsigned int particle, unsigned int property)
+    {
+        return (float)(particle * 64 + property + 1);
+    }
+};
+
+static unsigned int __randomState = 1;
+
+/**
+ * Returns a random float in [min, max), from a sequence that is the same on every run.
+ */
+static float random(float min, float max)
+{
+    __randomState = __randomState * 1664525u + 1013904223u;
+    return min + (max - min) * ((__randomState >> 8) * (1.0f / 16777216.0f));
+}
+
+TEST(particleEmitterKeepsLivingParticles)
+{
+    ParticleEmitter* emitter = ParticleEmitterTest::createEmitter(PARTICLE_COUNT_MAX);
+    bool living[PARTICLE_COUNT_MAX];
+    for (unsigned int i = 0; i < PATTERN_COUNT; ++i)
+    {
+        // Every particle count, with none, some or all of the particles living.
+        unsigned int count = i % (PARTICLE_COUNT_MAX + 1);
+        float livingRatio = (float)(i / (PARTICLE_COUNT_MAX + 1) % 5) * 0.25f;
+        for (unsigned int j = 0; j < count; ++j)
+        {
+            living[j] = random(0.0f, 1.0f) < livingRatio;
+        }
+
+        ParticleEmitterTest::fillParticles(emitter, living, count);
+        ParticleEmitterTest::removeDeadParticles(emitter);
+        ParticleEmitterTest::checkParticles(emitter, living, count);
+    }
+
+    // Runs of dead particles at both ends and in the middle.
+    for (unsigned int i = 0; i < PARTICLE_COUNT_MAX; ++i)
+    {
+        living[i] = (i >= 5 && i < 15) || (i >= 25 && i < 35);
+    }
+    ParticleEmitterTest::fillParticles(emitter, living, PARTICLE_COUNT_MAX);
+    ParticleEmitterTest::removeDeadParticles(emitter);
+    ParticleEmitterTest::checkParticles(emitter, living, PARTICLE_COUNT_MAX);
+
+    SAFE_RELEASE(emitter);
+}
+
+TEST(particleEmitterReplaysSeed)
+{
+    // Emitters 0 and 1 share a seed, emitter 2 has another. Particles of random energy
+    // and ellipsoidal positions die and are compacted while new ones are emitted.
+    ParticleEmitter* emitters[3];
+    Node* nodes[3];
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        emitters[i] = ParticleEmitterTest::createEmitter(PARTICLE_COUNT_MAX);
+        emitters[i]->setEmissionRate(100);
+        emitters[i]->setEnergy(100, 400);
+        emitters[i]->setEllipsoid(true);
+        emitters[i]->setRotationPerParticle(-1.0f, 1.0f);
+        emitters[i]->setRandomSeed(i < 2 ? 7 : 8);
+        nodes[i] = Node::create();
+        nodes[i]->setParticleEmitter(emitters[i]);
+        emitters[i]->start();
+    }
+
+    for (unsigned int i = 0; i < REPLAY_UPDATE_COUNT; ++i)
+    {
+        for (unsigned int j = 0; j < 3; ++j)
+        {
+            emitters[j]->update(REPLAY_UPDATE_TIME);
+        }
+        if (!ParticleEmitterTest::hasSameParticles(emitters[0], emitters[1]))
+        {
+            Test::fail(__FILE__, __LINE__, "emitters of the same seed differ after %u updates", i + 1);
+            break;
+        }
+    }
+    TEST_ASSERT(emitters[0]->getParticlesCount() > 0);
+    TEST_ASSERT(!ParticleEmitterTest::hasSameParticles(emitters[0], emitters[2]));
+
+    // Seeding again restarts the sequence, whatever was emitted before.
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        ParticleEmitterTest::clearParticles(emitters[i]);
+        emitters[i]->setRandomSeed(7);
+        emitters[i]->emit(PARTICLE_COUNT_MAX);
+    }
+    TEST_ASSERT(ParticleEmitterTest::hasSameParticles(emitters[0], emitters[1]));
+    TEST_ASSERT(ParticleEmitterTest::hasSameParticles(emitters[0], emitters[2]));
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        SAFE_RELEASE(emitters[i]);
+        SAFE_RELEASE(nodes[i]);
+    }
+}
+
+}
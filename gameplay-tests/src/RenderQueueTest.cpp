@@ -0,0 +1,289 @@
+#include "Base.h"
+#include "RenderQueue.h"
+#include "Technique.h"
+#include "MeshPart.h"
+#include "Test.h"
+
+// Sorts and draws a render queue of models in front of a camera, and checks the
+// commands it submits to a recording backend.
+
+namespace gameplay
+{
+
+typedef RenderQueue::RecordingBackend RecordingBackend;
+
+static const char* __vertexShader = "attribute vec4 a_position; void main() { gl_Position = a_position; }";
+static const char* __fragmentShader = "void main() { gl_FragColor = vec4(1.0); }";
+
+/**
+ * The scene drawn by the tests.
+ *
+ * Every model is on the axis of the camera, at the given distance, so the depth of its
+ * items is the square of that distance:
+ *
+ *  node   mesh      material  effect  blend  layer  distance
+ *  a1     indexed   a         1       no     0      3
+ *  a2     indexed   a         1       no     0      1
+ *  b1     indexed   b         1       no     0      2
+ *  c1     arrays    c         2       no     0      5
+ *  t1     arrays    t         2       yes    0      4
+ *  t2     arrays    t         2       yes    0      6
+ *  u1     indexed   u         1       no     1      0.5
+ */
+class RenderQueueScene
+{
+public:
+
+    enum NodeIndex { A1, A2, B1, C1, T1, T2, U1, NODE_COUNT };
+
+    RenderQueueScene()
+    {
+        effect1 = Effect::createFromSource(__vertexShader, __fragmentShader);
+        effect2 = Effect::createFromSource(__vertexShader, __fragmentShader, "#define SECOND");
+
+        VertexFormat::Element elements[] = { VertexFormat::Element(VertexFormat::POSITION, 3) };
+        indexedMesh = Mesh::createMesh(VertexFormat(elements, 1), 4);
+        indexedPart = indexedMesh->addPart(Mesh::TRIANGLES, Mesh::INDEX16, 6);
+        arraysMesh = Mesh::createMesh(VertexFormat(elements, 1), 4);
+        arraysMesh->setPrimitiveType(Mesh::TRIANGLE_STRIP);
+
+        a = Material::create(effect1);
+        b = Material::create(effect1);
+        c = Material::create(effect2);
+        t = Material::create(effect2);
+        t->getStateBlock()->setBlend(true);
+        u = Material::create(effect1);
+
+        nodes[A1] = createNode("a1", indexedMesh, a, 3.0f);
+        nodes[A2] = createNode("a2", indexedMesh, a, 1.0f);
+        nodes[B1] = createNode("b1", indexedMesh, b, 2.0f);
+        nodes[C1] = createNode("c1", arraysMesh, c, 5.0f);
+        nodes[T1] = createNode("t1", arraysMesh, t, 4.0f);
+        nodes[T2] = createNode("t2", arraysMesh, t, 6.0f);
+        nodes[U1] = createNode("u1", indexedMesh, u, 0.5f);
+
+        camera = Camera::createPerspective(45.0f, 1.0f, 0.1f, 100.0f);
+        cameraNode = Node::create("camera");
+        cameraNode->setCamera(camera);
+
+        // The bindings are shared by the passes of the same mesh and effect.
+        indexedBinding = VertexAttributeBinding::create(indexedMesh, effect1);
+        arraysBinding = VertexAttributeBinding::create(arraysMesh, effect2);
+
+        queue = RenderQueue::create();
+        queue->setCamera(camera);
+    }
+
+    ~RenderQueueScene()
+    {
+        SAFE_RELEASE(queue);
+        SAFE_RELEASE(indexedBinding);
+        SAFE_RELEASE(arraysBinding);
+        SAFE_RELEASE(cameraNode);
+        SAFE_RELEASE(camera);
+        for (unsigned int i = 0; i < NODE_COUNT; ++i)
+        {
+            SAFE_RELEASE(nodes[i]);
+        }
+        SAFE_RELEASE(a);
+        SAFE_RELEASE(b);
+        SAFE_RELEASE(c);
+        SAFE_RELEASE(t);
+        SAFE_RELEASE(u);
+        SAFE_RELEASE(indexedMesh);
+        SAFE_RELEASE(arraysMesh);
+        SAFE_RELEASE(effect1);
+        SAFE_RELEASE(effect2);
+    }
+
+    /**
+     * Adds the nodes to the queue in the given order, with u1 in layer 1.
+     */
+    void add(const unsigned int* order)
+    {
+        for (unsigned int i = 0; i < NODE_COUNT; ++i)
+        {
+            queue->add(nodes[order[i]], order[i] == U1 ? 1 : 0);
+        }
+    }
+
+    static Pass* getPass(Material* material)
+    {
+        return material->getTechnique()->getPass(0u);
+    }
+
+    Effect* effect1;
+    Effect* effect2;
+    Mesh* indexedMesh;
+    MeshPart* indexedPart;
+    Mesh* arraysMesh;
+    Material* a;
+    Material* b;
+    Material* c;
+    Material* t;
+    Material* u;
+    Node* nodes[NODE_COUNT];
+    Camera* camera;
+    Node* cameraNode;
+    VertexAttributeBinding* indexedBinding;
+    VertexAttributeBinding* arraysBinding;
+    RenderQueue* queue;
+
+private:
+
+    static Node* createNode(const char* id, Mesh* mesh, Material* material, float distance)
+    {
+        Model* model = Model::create(mesh);
+        model->setMaterial(material);
+        Node* node = Node::create(id);
+        node->setModel(model);
+        node->setTranslation(0.0f, 0.0f, -distance);
+        SAFE_RELEASE(model);
+        return node;
+    }
+};
+
+/**
+ * Checks that the recorded commands match the expected commands.
+ */
+static void checkCommands(const RecordingBackend& backend, const RecordingBackend::Command* expected, unsigned int expectedCount)
+{
+    const std::vector<RecordingBackend::Command>& commands = backend.getCommands();
+    TEST_ASSERT(commands.size() == expectedCount);
+
+    for (unsigned int i = 0, count = std::min((unsigned int)commands.size(), expectedCount); i < count; ++i)
+    {
+        const RecordingBackend::Command& command = commands[i];
+        if (command.type != expected[i].type || command.object != expected[i].object || command.value != expected[i].value)
+        {
+            Test::fail(__FILE__, __LINE__, "command %u is (%d, %p, %u) instead of (%d, %p, %u)", i,
+                command.type, command.object, command.value, expected[i].type, expected[i].object, expected[i].value);
+            return;
+        }
+    }
+}
+
+TEST(renderQueueSortsByState)
+{
+    RenderQueueScene scene;
+
+    // Effect and pass sort ids are assigned as items are added, so this order sorts
+    // the passes of effect 2 (first added with t1) before those of effect 1.
+    const unsigned int order[] = { RenderQueueScene::T1, RenderQueueScene::B1, RenderQueueScene::U1, RenderQueueScene::C1,
+                                   RenderQueueScene::A1, RenderQueueScene::T2, RenderQueueScene::A2 };
+    scene.add(order);
+    TEST_ASSERT(scene.queue->getItemCount() == RenderQueueScene::NODE_COUNT);
+    scene.queue->sort();
+
+    RecordingBackend backend;
+    scene.queue->draw(&backend);
+
+    unsigned int indexBuffer = scene.indexedPart->getIndexBuffer();
+    const RecordingBackend::Command expected[] =
+    {
+        // Opaque items of layer 0, by effect and pass, then front-to-back.
+        { RecordingBackend::BIND_EFFECT, scene.effect2, 0 },
+        { RecordingBackend::BIND_RENDER_STATE, RenderQueueScene::getPass(scene.c), 0 },
+        { RecordingBackend::BIND_VERTEX_ATTRIBUTES, scene.arraysBinding, 0 },
+        { RecordingBackend::BIND_INDEX_BUFFER, NULL, 0 },
+        { RecordingBackend::DRAW_ARRAYS, NULL, 4 },                                         // c1
+        { RecordingBackend::BIND_EFFECT, scene.effect1, 0 },
+        { RecordingBackend::BIND_RENDER_STATE, RenderQueueScene::getPass(scene.b), 0 },
+        { RecordingBackend::UNBIND_VERTEX_ATTRIBUTES, scene.arraysBinding, 0 },
+        { RecordingBackend::BIND_VERTEX_ATTRIBUTES, scene.indexedBinding, 0 },
+        { RecordingBackend::BIND_INDEX_BUFFER, NULL, indexBuffer },
+        { RecordingBackend::DRAW_ELEMENTS, NULL, 6 },                                       // b1
+        { RecordingBackend::BIND_RENDER_STATE, RenderQueueScene::getPass(scene.a), 0 },
+        { RecordingBackend::DRAW_ELEMENTS, NULL, 6 },                                       // a2
+        { RecordingBackend::DRAW_ELEMENTS, NULL, 6 },                                       // a1
+
+        // Transparent items of layer 0, back-to-front.
+        { RecordingBackend::BIND_EFFECT, scene.effect2, 0 },
+        { RecordingBackend::BIND_RENDER_STATE, RenderQueueScene::getPass(scene.t), 0 },
+        { RecordingBackend::UNBIND_VERTEX_ATTRIBUTES, scene.indexedBinding, 0 },
+        { RecordingBackend::BIND_VERTEX_ATTRIBUTES, scene.arraysBinding, 0 },
+        { RecordingBackend::BIND_INDEX_BUFFER, NULL, 0 },
+        { RecordingBackend::DRAW_ARRAYS, NULL, 4 },                                         // t2
+        { RecordingBackend::DRAW_ARRAYS, NULL, 4 },                                         // t1
+
+        // Layer 1.
+        { RecordingBackend::BIND_EFFECT, scene.effect1, 0 },
+        { RecordingBackend::BIND_RENDER_STATE, RenderQueueScene::getPass(scene.u), 0 },
+        { RecordingBackend::UNBIND_VERTEX_ATTRIBUTES, scene.arraysBinding, 0 },
+        { RecordingBackend::BIND_VERTEX_ATTRIBUTES, scene.indexedBinding, 0 },
+        { RecordingBackend::BIND_INDEX_BUFFER, NULL, indexBuffer },
+        { RecordingBackend::DRAW_ELEMENTS, NULL, 6 },                                       // u1
+        { RecordingBackend::UNBIND_VERTEX_ATTRIBUTES, scene.indexedBinding, 0 }
+    };
+    checkCommands(backend, expected, sizeof(expected) / sizeof(expected[0]));
+
+    // A queue that does not change draws the same commands again.
+    std::vector<RecordingBackend::Command> commands = backend.getCommands();
+    backend.clear();
+    scene.queue->draw(&backend);
+    checkCommands(backend, &commands[0], commands.size());
+
+    // A cleared queue draws nothing.
+    scene.queue->clear();
+    TEST_ASSERT(scene.queue->getItemCount() == 0);
+    backend.clear();
+    scene.queue->draw(&backend);
+    TEST_ASSERT(backend.getCommands().empty());
+}
+
+TEST(renderQueueBindsEachPassOnce)
+{
+    RenderQueueScene scene;
+    RecordingBackend backend;
+
+    // Whatever the order the nodes are added in, the items of each pass are drawn
+    // together, and u1 in layer 1 is drawn last.
+    unsigned int order[RenderQueueScene::NODE_COUNT];
+    for (unsigned int i = 0; i < RenderQueueScene::NODE_COUNT; ++i)
+    {
+        order[i] = i;
+    }
+    unsigned int random = 1;
+    for (unsigned int shuffle = 0; shuffle < 100; ++shuffle)
+    {
+        for (unsigned int i = RenderQueueScene::NODE_COUNT - 1; i > 0; --i)
+        {
+            random = random * 1664525u + 1013904223u;
+            std::swap(order[i], order[(random >> 16) % (i + 1)]);
+        }
+
+        scene.queue->clear();
+        scene.add(order);
+        scene.queue->sort();
+        backend.clear();
+        scene.queue->draw(&backend);
+
+        TEST_ASSERT(backend.getCommandCount(RecordingBackend::BIND_RENDER_STATE) == 5);
+        TEST_ASSERT(backend.getCommandCount(RecordingBackend::DRAW_ARRAYS) == 3);
+        TEST_ASSERT(backend.getCommandCount(RecordingBackend::DRAW_ELEMENTS) == 4);
+        TEST_ASSERT(backend.getCommandCount(RecordingBackend::BIND_VERTEX_ATTRIBUTES) == backend.getCommandCount(RecordingBackend::UNBIND_VERTEX_ATTRIBUTES));
+
+        const std::vector<RecordingBackend::Command>& commands = backend.getCommands();
+        unsigned int last = 0;
+        for (unsigned int i = 0; i < commands.size(); ++i)
+        {
+            if (commands[i].type == RecordingBackend::BIND_RENDER_STATE)
+            {
+                last = i;
+            }
+        }
+        TEST_ASSERT(commands[last].object == RenderQueueScene::getPass(scene.u));
+    }
+}
+
+TEST(renderQueueIgnoresNodesWithoutModel)
+{
+    RenderQueue* queue = RenderQueue::create();
+    Node* node = Node::create("empty");
+    queue->add(node);
+    TEST_ASSERT(queue->getItemCount() == 0);
+    SAFE_RELEASE(node);
+    SAFE_RELEASE(queue);
+}
+
+}
@@ -0,0 +1,294 @@
+#include "Base.h"
+#include "SkinnedMesh.h"
+#include "Model.h"
+#include "Platform.h"
+#include "Test.h"
+
+// Compares the vertices skinned by SkinnedMesh with the skinning of the MATRIX_PALETTE
+// path of the vertex shaders (res/shaders/bumped.vsh), transcribed below, and times
+// skinned mesh updates.
+
+// The tolerance of skinned vertices, relative to their magnitude. SkinnedMesh blends
+// the joint matrices before transforming, while the shaders blend transformed vectors.
+#define SKINNING_TOLERANCE 1e-5f
+
+// The number of joints of the skins.
+#define SKINNING_JOINT_COUNT 32
+
+// The number of vertices and updates of the benchmark.
+#define BENCHMARK_VERTEX_COUNT 10000
+#define BENCHMARK_UPDATE_COUNT 100
+
+namespace gameplay
+{
+
+/**
+ * Creates and destroys the skins of the tests, whose constructor is private.
+ */
+class SkinnedMeshTest
+{
+public:
+
+    static MeshSkin* createSkin(unsigned int jointCount)
+    {
+        MeshSkin* skin = new MeshSkin();
+        skin->setJointCount(jointCount);
+        return skin;
+    }
+
+    static void setModel(MeshSkin* skin, Model* model)
+    {
+        skin->_model = model;
+    }
+
+    static void destroySkin(MeshSkin* skin)
+    {
+        delete skin;
+    }
+};
+
+static unsigned int __randomState = 1;
+
+/**
+ * Returns a random float in [min, max), from a sequence that is the same on every run.
+ */
+static float random(float min, float max)
+{
+    __randomState = __randomState * 1664525u + 1013904223u;
+    return min + (max - min) * ((__randomState >> 8) * (1.0f / 16777216.0f));
+}
+
+/**
+ * The vertex format of the tests: the attributes of bumped.vsh, plus texture coordinates
+ * that are copied unchanged.
+ */
+static const VertexFormat::Element __elements[] =
+{
+    VertexFormat::Element(VertexFormat::POSITION, 3),
+    VertexFormat::Element(VertexFormat::NORMAL, 3),
+    VertexFormat::Element(VertexFormat::TANGENT, 3),
+    VertexFormat::Element(VertexFormat::BINORMAL, 3),
+    VertexFormat::Element(VertexFormat::TEXCOORD0, 2),
+    VertexFormat::Element(VertexFormat::BLENDWEIGHTS, 4),
+    VertexFormat::Element(VertexFormat::BLENDINDICES, 4)
+};
+
+// The offsets of the elements in a source vertex, and its size, in floats.
+#define SOURCE_POSITION     0
+#define SOURCE_NORMAL       3
+#define SOURCE_TANGENT      6
+#define SOURCE_BINORMAL     9
+#define SOURCE_TEXCOORD     12
+#define SOURCE_WEIGHTS      14
+#define SOURCE_INDICES      18
+#define SOURCE_STRIDE       22
+
+// The offsets of the elements in a skinned vertex, and its size, in floats.
+#define SKINNED_TEXCOORD    12
+#define SKINNED_STRIDE      14
+
+/**
+ * Fills source vertices with random positions and directions, influenced by one to
+ * four joints each.
+ */
+static void randomVertices(float* vertices, unsigned int vertexCount)
+{
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        float* vertex = &vertices[v * SOURCE_STRIDE];
+        for (unsigned int i = 0; i < SOURCE_WEIGHTS; ++i)
+        {
+            vertex[i] = random(-10.0f, 10.0f);
+        }
+
+        unsigned int influenceCount = 1 + v % 4;
+        float sum = 0.0f;
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            vertex[SOURCE_WEIGHTS + i] = i < influenceCount ? random(0.1f, 1.0f) : 0.0f;
+            vertex[SOURCE_INDICES + i] = (float)(int)random(0.0f, (float)SKINNING_JOINT_COUNT);
+            sum += vertex[SOURCE_WEIGHTS + i];
+        }
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            vertex[SOURCE_WEIGHTS + i] /= sum;
+        }
+    }
+}
+
+/**
+ * Fills a matrix palette with random joint matrices: rotations and scales in the 3x3
+ * part, and translations in the fourth column.
+ */
+static void randomPalette(Vector4* palette, unsigned int jointCount)
+{
+    for (unsigned int i = 0; i < jointCount * 3; ++i)
+    {
+        palette[i].set(random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-20.0f, 20.0f));
+    }
+}
+
+/**
+ * Skins a position like skinPosition of bumped.vsh.
+ */
+static void shaderSkinPosition(const float* vertex, const Vector4* palette, float* dst)
+{
+    Vector4 position(vertex[SOURCE_POSITION], vertex[SOURCE_POSITION + 1], vertex[SOURCE_POSITION + 2], 1.0f);
+    Vector4 skinned(0.0f, 0.0f, 0.0f, 0.0f);
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+        float blendWeight = vertex[SOURCE_WEIGHTS + j];
+        int matrixIndex = (int)vertex[SOURCE_INDICES + j] * 3;
+        Vector4 tmp(position.dot(palette[matrixIndex]), position.dot(palette[matrixIndex + 1]), position.dot(palette[matrixIndex + 2]), position.w);
+        skinned += tmp * blendWeight;
+    }
+    dst[0] = skinned.x;
+    dst[1] = skinned.y;
+    dst[2] = skinned.z;
+}
+
+/**
+ * Skins a normal, tangent or binormal like skinTangentSpaceVector of bumped.vsh.
+ */
+static void shaderSkinTangentSpaceVector(const float* vertex, unsigned int offset, const Vector4* palette, float* dst)
+{
+    Vector3 vector(vertex[offset], vertex[offset + 1], vertex[offset + 2]);
+    Vector3 skinned(0.0f, 0.0f, 0.0f);
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+        float blendWeight = vertex[SOURCE_WEIGHTS + j];
+        int matrixIndex = (int)vertex[SOURCE_INDICES + j] * 3;
+        Vector3 tmp(vector.dot(Vector3(palette[matrixIndex].x, palette[matrixIndex].y, palette[matrixIndex].z)),
+                    vector.dot(Vector3(palette[matrixIndex + 1].x, palette[matrixIndex + 1].y, palette[matrixIndex + 1].z)),
+                    vector.dot(Vector3(palette[matrixIndex + 2].x, palette[matrixIndex + 2].y, palette[matrixIndex + 2].z)));
+        skinned += tmp * blendWeight;
+    }
+    dst[0] = skinned.x;
+    dst[1] = skinned.y;
+    dst[2] = skinned.z;
+}
+
+TEST(skinnedMeshMatchesShader)
+{
+    // More vertices than one range of an update.
+    const unsigned int vertexCount = 1500;
+    float* vertices = new float[vertexCount * SOURCE_STRIDE];
+    randomVertices(vertices, vertexCount);
+    Vector4 palette[SKINNING_JOINT_COUNT * 3];
+    randomPalette(palette, SKINNING_JOINT_COUNT);
+
+    MeshSkin* skin = SkinnedMeshTest::createSkin(SKINNING_JOINT_COUNT);
+    SkinnedMesh* skinnedMesh = SkinnedMesh::create(skin, VertexFormat(__elements, 7), vertices, vertexCount);
+    TEST_ASSERT(skinnedMesh);
+    TEST_ASSERT(skinnedMesh->getVertexFormat().getVertexSize() == SKINNED_STRIDE * sizeof(float));
+    skinnedMesh->update(palette, SKINNING_JOINT_COUNT * 3);
+
+    const unsigned int offsets[] = { SOURCE_POSITION, SOURCE_NORMAL, SOURCE_TANGENT, SOURCE_BINORMAL };
+    Vector3 min(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector3 max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        const float* vertex = &vertices[v * SOURCE_STRIDE];
+        const float* skinned = &skinnedMesh->getVertexData()[v * SKINNED_STRIDE];
+        for (unsigned int e = 0; e < 4; ++e)
+        {
+            float expected[3];
+            if (e == 0)
+            {
+                shaderSkinPosition(vertex, palette, expected);
+                min.set(std::min(min.x, expected[0]), std::min(min.y, expected[1]), std::min(min.z, expected[2]));
+                max.set(std::max(max.x, expected[0]), std::max(max.y, expected[1]), std::max(max.z, expected[2]));
+            }
+            else
+            {
+                shaderSkinTangentSpaceVector(vertex, offsets[e], palette, expected);
+            }
+            for (unsigned int i = 0; i < 3; ++i)
+            {
+                TEST_ASSERT_NEAR(skinned[e * 3 + i], expected[i], SKINNING_TOLERANCE);
+            }
+        }
+
+        // Texture coordinates are copied.
+        TEST_ASSERT(skinned[SKINNED_TEXCOORD] == vertex[SOURCE_TEXCOORD]);
+        TEST_ASSERT(skinned[SKINNED_TEXCOORD + 1] == vertex[SOURCE_TEXCOORD + 1]);
+    }
+
+    // The bounding box encloses the skinned positions of all ranges.
+    const BoundingBox& box = skinnedMesh->getBoundingBox();
+    TEST_ASSERT_NEAR(box.min.x, min.x, SKINNING_TOLERANCE);
+    TEST_ASSERT_NEAR(box.min.y, min.y, SKINNING_TOLERANCE);
+    TEST_ASSERT_NEAR(box.min.z, min.z, SKINNING_TOLERANCE);
+    TEST_ASSERT_NEAR(box.max.x, max.x, SKINNING_TOLERANCE);
+    TEST_ASSERT_NEAR(box.max.y, max.y, SKINNING_TOLERANCE);
+    TEST_ASSERT_NEAR(box.max.z, max.z, SKINNING_TOLERANCE);
+
+    SAFE_RELEASE(skinnedMesh);
+    SkinnedMeshTest::destroySkin(skin);
+    SAFE_DELETE_ARRAY(vertices);
+}
+
+TEST(skinnedMeshKeepsModelOfSkin)
+{
+    float vertices[SOURCE_STRIDE];
+    randomVertices(vertices, 1);
+
+    VertexFormat::Element elements[] = { VertexFormat::Element(VertexFormat::POSITION, 3) };
+    Mesh* mesh = Mesh::createMesh(VertexFormat(elements, 1), 1);
+    Model* model = Model::create(mesh);
+    MeshSkin* skin = SkinnedMeshTest::createSkin(SKINNING_JOINT_COUNT);
+    SkinnedMeshTest::setModel(skin, model);
+
+    SkinnedMesh* skinnedMesh = SkinnedMesh::create(skin, VertexFormat(__elements, 7), vertices, 1);
+    TEST_ASSERT(model->getRefCount() == 2);
+    SAFE_RELEASE(skinnedMesh);
+    TEST_ASSERT(model->getRefCount() == 1);
+
+    SAFE_RELEASE(model);
+    SAFE_RELEASE(mesh);
+    SkinnedMeshTest::destroySkin(skin);
+}
+
+TEST(skinnedMeshBenchmark)
+{
+    float* vertices = new float[BENCHMARK_VERTEX_COUNT * SOURCE_STRIDE];
+    randomVertices(vertices, BENCHMARK_VERTEX_COUNT);
+    Vector4 palette[SKINNING_JOINT_COUNT * 3];
+    randomPalette(palette, SKINNING_JOINT_COUNT);
+
+    MeshSkin* skin = SkinnedMeshTest::createSkin(SKINNING_JOINT_COUNT);
+    SkinnedMesh* skinnedMesh = SkinnedMesh::create(skin, VertexFormat(__elements, 7), vertices, BENCHMARK_VERTEX_COUNT);
+
+    long start = Platform::getAbsoluteTime();
+    for (unsigned int i = 0; i < BENCHMARK_UPDATE_COUNT; ++i)
+    {
+        skinnedMesh->update(palette, SKINNING_JOINT_COUNT * 3);
+    }
+    long skinnedMeshTime = Platform::getAbsoluteTime() - start;
+
+    // The same work done the way the shaders do it, for comparison.
+    float* skinned = new float[BENCHMARK_VERTEX_COUNT * 12];
+    start = Platform::getAbsoluteTime();
+    for (unsigned int i = 0; i < BENCHMARK_UPDATE_COUNT; ++i)
+    {
+        for (unsigned int v = 0; v < BENCHMARK_VERTEX_COUNT; ++v)
+        {
+            const float* vertex = &vertices[v * SOURCE_STRIDE];
+            shaderSkinPosition(vertex, palette, &skinned[v * 12]);
+            shaderSkinTangentSpaceVector(vertex, SOURCE_NORMAL, palette, &skinned[v * 12 + 3]);
+            shaderSkinTangentSpaceVector(vertex, SOURCE_TANGENT, palette, &skinned[v * 12 + 6]);
+            shaderSkinTangentSpaceVector(vertex, SOURCE_BINORMAL, palette, &skinned[v * 12 + 9]);
+        }
+    }
+    long shaderTime = Platform::getAbsoluteTime() - start;
+
+    printf("    %u updates of %u vertices: SkinnedMesh %ld ms, shader transcription %ld ms\n",
+        BENCHMARK_UPDATE_COUNT, BENCHMARK_VERTEX_COUNT, skinnedMeshTime, shaderTime);
+
+    SAFE_DELETE_ARRAY(skinned);
+    SAFE_RELEASE(skinnedMesh);
+    SkinnedMeshTest::destroySkin(skin);
+    SAFE_DELETE_ARRAY(vertices);
+}
+
+}
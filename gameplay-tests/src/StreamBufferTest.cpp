@@ -0,0 +1,185 @@
+#include "Base.h"
+#include "StreamBuffer.h"
+#include "GLStub.h"
+#include "Test.h"
+
+// Streams regions of numbered elements through a stream buffer, and checks the
+// uploads recorded by the GL stub and the contents of the GL buffer.
+
+// The number of elements of the rings of the tests.
+#define RING_CAPACITY 16
+
+namespace gameplay
+{
+
+/**
+ * Appends elements numbered from the given number to the current region.
+ */
+static bool appendElements(StreamBuffer* buffer, unsigned int count, unsigned int first)
+{
+    unsigned int* data = (unsigned int*)buffer->append(count);
+    if (!data)
+        return false;
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        data[i] = first + i;
+    }
+    return true;
+}
+
+/**
+ * Checks that the GL buffer holds elements numbered from the given number at the given position.
+ */
+static void checkElements(StreamBuffer* buffer, unsigned int start, unsigned int count, unsigned int first)
+{
+    const std::vector<unsigned char>& data = GLStub::getBufferData(buffer->getHandle());
+    TEST_ASSERT(data.size() == buffer->getCapacity() * sizeof(unsigned int));
+    if (data.size() < (start + count) * sizeof(unsigned int))
+        return;
+
+    const unsigned int* elements = (const unsigned int*)&data[0];
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (elements[start + i] != first + i)
+        {
+            Test::fail(__FILE__, __LINE__, "element %u is %u instead of %u", start + i, elements[start + i], first + i);
+            return;
+        }
+    }
+}
+
+/**
+ * Checks that the given upload was recorded.
+ */
+static void checkBufferCall(unsigned int index, GLStub::BufferCallType type, unsigned int offset, unsigned int size)
+{
+    const std::vector<GLStub::BufferCall>& calls = GLStub::getBufferCalls();
+    TEST_ASSERT(index < calls.size());
+    if (index < calls.size())
+    {
+        TEST_ASSERT(calls[index].type == type);
+        TEST_ASSERT(calls[index].offset == offset);
+        TEST_ASSERT(calls[index].size == size);
+    }
+}
+
+TEST(streamBufferUploadsAppendedElements)
+{
+    GLStub::clear();
+    StreamBuffer* buffer = StreamBuffer::create(GL_ARRAY_BUFFER, sizeof(unsigned int), RING_CAPACITY);
+    TEST_ASSERT(buffer);
+    checkBufferCall(0, GLStub::BUFFER_DATA, 0, RING_CAPACITY * sizeof(unsigned int));
+
+    // Only the elements appended since the last upload are uploaded.
+    buffer->begin();
+    TEST_ASSERT(appendElements(buffer, 4, 100));
+    buffer->upload();
+    TEST_ASSERT(appendElements(buffer, 2, 104));
+    buffer->upload();
+    buffer->upload();
+    TEST_ASSERT(buffer->getStart() == 0 && buffer->getCount() == 6);
+    checkBufferCall(1, GLStub::BUFFER_SUB_DATA, 0, 4 * sizeof(unsigned int));
+    checkBufferCall(2, GLStub::BUFFER_SUB_DATA, 4 * sizeof(unsigned int), 2 * sizeof(unsigned int));
+    TEST_ASSERT(GLStub::getBufferCalls().size() == 3);
+    checkElements(buffer, 0, 6, 100);
+
+    // The next region follows the previous one.
+    buffer->begin();
+    TEST_ASSERT(appendElements(buffer, 3, 200));
+    buffer->upload();
+    TEST_ASSERT(buffer->getStart() == 6 && buffer->getCount() == 3);
+    checkBufferCall(3, GLStub::BUFFER_SUB_DATA, 6 * sizeof(unsigned int), 3 * sizeof(unsigned int));
+    checkElements(buffer, 0, 6, 100);
+    checkElements(buffer, 6, 3, 200);
+
+    // An invalidated region is uploaded whole again.
+    buffer->invalidate();
+    buffer->upload();
+    checkBufferCall(4, GLStub::BUFFER_SUB_DATA, 6 * sizeof(unsigned int), 3 * sizeof(unsigned int));
+
+    TEST_ASSERT(GLStub::getInvalidCallCount() == 0);
+    SAFE_DELETE(buffer);
+}
+
+TEST(streamBufferWrapsAndOrphans)
+{
+    StreamBuffer* buffer = StreamBuffer::create(GL_ARRAY_BUFFER, sizeof(unsigned int), RING_CAPACITY);
+    GLStub::clear();
+
+    // Two regions of 6 elements fill the ring up to element 12.
+    for (unsigned int region = 0; region < 2; ++region)
+    {
+        buffer->begin();
+        TEST_ASSERT(appendElements(buffer, 6, region * 100));
+        buffer->upload();
+    }
+    TEST_ASSERT(buffer->getStart() == 6);
+
+    // A region that grows past the end of the ring moves to its start with the
+    // elements already appended, and orphans the GL buffer before it is uploaded.
+    buffer->begin();
+    TEST_ASSERT(appendElements(buffer, 3, 200));
+    buffer->upload();
+    TEST_ASSERT(buffer->getStart() == 12);
+    TEST_ASSERT(appendElements(buffer, 3, 203));
+    TEST_ASSERT(buffer->getStart() == 0 && buffer->getCount() == 6);
+    GLStub::clear();
+    buffer->upload();
+    checkBufferCall(0, GLStub::BUFFER_DATA, 0, RING_CAPACITY * sizeof(unsigned int));
+    checkBufferCall(1, GLStub::BUFFER_SUB_DATA, 0, 6 * sizeof(unsigned int));
+    TEST_ASSERT(GLStub::getBufferCalls().size() == 2);
+    checkElements(buffer, 0, 6, 200);
+
+    // The orphaned contents are gone, so nothing may read them.
+    const std::vector<unsigned char>& data = GLStub::getBufferData(buffer->getHandle());
+    TEST_ASSERT(data[6 * sizeof(unsigned int)] == GLStub::UNDEFINED_BYTE);
+
+    // The next region follows without orphaning again.
+    GLStub::clear();
+    buffer->begin();
+    TEST_ASSERT(appendElements(buffer, 4, 300));
+    buffer->upload();
+    TEST_ASSERT(GLStub::getBufferCalls().size() == 1);
+    checkElements(buffer, 6, 4, 300);
+
+    // A region larger than the ring does not fit.
+    buffer->begin();
+    TEST_ASSERT(buffer->append(RING_CAPACITY + 1) == NULL);
+
+    TEST_ASSERT(GLStub::getInvalidCallCount() == 0);
+    SAFE_DELETE(buffer);
+}
+
+TEST(streamBufferSetCapacity)
+{
+    StreamBuffer* buffer = StreamBuffer::create(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int), RING_CAPACITY);
+    buffer->begin();
+    TEST_ASSERT(appendElements(buffer, 10, 0));
+    buffer->upload();
+    buffer->begin();
+    TEST_ASSERT(appendElements(buffer, 5, 100));
+    buffer->upload();
+
+    // The current region does not fit in a smaller ring.
+    TEST_ASSERT(!buffer->setCapacity(4));
+    TEST_ASSERT(buffer->getCapacity() == RING_CAPACITY);
+
+    // The current region moves to the start of a larger ring, which is allocated and
+    // uploaded by the next upload.
+    GLStub::clear();
+    TEST_ASSERT(buffer->setCapacity(2 * RING_CAPACITY));
+    TEST_ASSERT(buffer->getCapacity() == 2 * RING_CAPACITY);
+    TEST_ASSERT(buffer->getStart() == 0 && buffer->getCount() == 5);
+    TEST_ASSERT(GLStub::getBufferCalls().empty());
+    TEST_ASSERT(appendElements(buffer, 20, 105));
+    buffer->upload();
+    checkBufferCall(0, GLStub::BUFFER_DATA, 0, 2 * RING_CAPACITY * sizeof(unsigned int));
+    checkBufferCall(1, GLStub::BUFFER_SUB_DATA, 0, 25 * sizeof(unsigned int));
+    checkElements(buffer, 0, 25, 100);
+
+    TEST_ASSERT(GLStub::getInvalidCallCount() == 0);
+    SAFE_DELETE(buffer);
+}
+
+}
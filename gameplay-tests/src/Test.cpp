@@ -0,0 +1,81 @@
+#include "Test.h"
+#include <cstdarg>
+#include <cstring>
+#include <algorithm>
+
+namespace gameplay
+{
+
+static Test* __firstTest = NULL;
+static Test* __lastTest = NULL;
+static unsigned int __failureCount = 0;
+
+Test::Test(const char* name, Function function)
+    : _name(name), _function(function), _next(NULL)
+{
+    // Keep the test cases in the order they were declared in.
+    if (__lastTest)
+    {
+        __lastTest->_next = this;
+    }
+    else
+    {
+        __firstTest = this;
+    }
+    __lastTest = this;
+}
+
+unsigned int Test::runAll(const char* filter)
+{
+    unsigned int runCount = 0;
+    unsigned int failedCount = 0;
+    for (Test* test = __firstTest; test; test = test->_next)
+    {
+        if (filter && strstr(test->_name, filter) == NULL)
+        {
+            continue;
+        }
+
+        printf("[ RUN  ] %s\n", test->_name);
+        __failureCount = 0;
+        test->_function();
+        ++runCount;
+        if (__failureCount > 0)
+        {
+            ++failedCount;
+            printf("[ FAIL ] %s\n", test->_name);
+        }
+        else
+        {
+            printf("[  OK  ] %s\n", test->_name);
+        }
+    }
+
+    printf("%u of %u tests passed.\n", runCount - failedCount, runCount);
+    return failedCount;
+}
+
+void Test::fail(const char* file, int line, const char* format, ...)
+{
+    // Only print the first failures, since tests often check in loops.
+    ++__failureCount;
+    if (__failureCount > 10)
+    {
+        return;
+    }
+
+    printf("%s(%d): ", file, line);
+    va_list arguments;
+    va_start(arguments, format);
+    vprintf(format, arguments);
+    va_end(arguments);
+    printf("\n");
+}
+
+bool Test::isNear(float a, float b, float tolerance)
+{
+    float scale = std::max(1.0f, (float)std::max(fabs(a), fabs(b)));
+    return fabs(a - b) <= tolerance * scale;
+}
+
+}
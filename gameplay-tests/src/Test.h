@@ -0,0 +1,93 @@
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <cstdio>
+#include <cmath>
+
+namespace gameplay
+{
+
+/**
+ * Defines a test case of the test runner.
+ *
+ * Test cases are declared with the TEST macro and register themselves with the
+ * runner when the program starts. Checks made with the TEST_ASSERT macros report
+ * their failures and let the test case continue, so that one run lists every
+ * failing check.
+ */
+class Test
+{
+public:
+
+    /**
+     * The function running a test case.
+     */
+    typedef void (*Function)();
+
+    /**
+     * Constructor. Registers the test case with the runner.
+     *
+     * @param name The name of the test case.
+     * @param function The function running the test case.
+     */
+    Test(const char* name, Function function);
+
+    /**
+     * Runs the registered test cases.
+     *
+     * @param filter Only the test cases whose name contains this string are run, or all if NULL.
+     *
+     * @return The number of test cases that failed.
+     */
+    static unsigned int runAll(const char* filter);
+
+    /**
+     * Reports a failed check of the running test case.
+     *
+     * @param file The source file of the check.
+     * @param line The line of the check.
+     * @param format The printf format of the failure message.
+     */
+    static void fail(const char* file, int line, const char* format, ...);
+
+    /**
+     * Checks that two floats are equal within a tolerance relative to their magnitude.
+     *
+     * The tolerance is absolute for values smaller than one.
+     *
+     * @return True if the values are equal within the tolerance.
+     */
+    static bool isNear(float a, float b, float tolerance);
+
+private:
+
+    const char* _name;      // The name of the test case.
+    Function _function;     // The function running the test case.
+    Test* _next;            // The next registered test case.
+};
+
+}
+
+/**
+ * Declares a test case.
+ */
+#define TEST(name) \
+    static void name(); \
+    static gameplay::Test __test_##name(#name, &name); \
+    static void name()
+
+/**
+ * Checks that a condition is true.
+ */
+#define TEST_ASSERT(condition) \
+    if (!(condition)) \
+        gameplay::Test::fail(__FILE__, __LINE__, "%s", #condition)
+
+/**
+ * Checks that two floats are equal within a relative tolerance.
+ */
+#define TEST_ASSERT_NEAR(a, b, tolerance) \
+    if (!gameplay::Test::isNear((a), (b), (tolerance))) \
+        gameplay::Test::fail(__FILE__, __LINE__, "%s (%.9g) != %s (%.9g)", #a, (double)(a), #b, (double)(b))
+
+#endif
@@ -0,0 +1,36 @@
+// Defines the Platform functions used by the engine code under test, in place of
+// the platform implementations, which create a window and GL context.
+#include "Base.h"
+#include "Platform.h"
+#include <ctime>
+
+namespace gameplay
+{
+
+static bool __vsync = WINDOW_VSYNC;
+
+extern void printError(const char* format, ...)
+{
+    va_list argptr;
+    va_start(argptr, format);
+    fprintf(stderr, "\n");
+    vfprintf(stderr, format, argptr);
+    va_end(argptr);
+}
+
+long Platform::getAbsoluteTime()
+{
+    return (long)(clock() * 1000.0 / CLOCKS_PER_SEC);
+}
+
+bool Platform::isVsync()
+{
+    return __vsync;
+}
+
+void Platform::setVsync(bool enable)
+{
+    __vsync = enable;
+}
+
+}
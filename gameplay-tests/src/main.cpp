@@ -0,0 +1,11 @@
+#include "Test.h"
+
+/**
+ * Runs the tests, or only those whose name contains the first argument.
+ *
+ * @return The number of failed tests, so that a non-zero exit code reports failures.
+ */
+int main(int argc, char** argv)
+{
+    return (int)gameplay::Test::runAll(argc > 1 ? argv[1] : NULL);
+}
@@ -27,6 +27,12 @@ Animation::Animation(const char* id, AnimationTarget* target, int propertyId, un
     createChannel(target, propertyId, keyCount, keyTimes, keyValues, keyInValue, keyOutValue, type);
 }
 
+Animation::Animation(const char* id, AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration)
+    : _controller(Game::getInstance()->getAnimationController()), _id(id), _duration(0), _defaultClip(NULL), _clips(NULL)
+{
+    createChannel(target, propertyId, curve, duration);
+}
+
 Animation::~Animation()
 {
     if (_defaultClip)
@@ -239,8 +245,6 @@ Animation::Channel* Animation::createChannel(AnimationTarget* target, int proper
     assert(propertyComponentCount > 0);
 
     Curve* curve = new Curve(keyCount, propertyComponentCount);
-    if (target->_targetType == AnimationTarget::TRANSFORM)
-        setTransformRotationOffset(curve, propertyId);
 
     unsigned long lowest = keyTimes[0];
     unsigned long duration = keyTimes[keyCount-1] - lowest;
@@ -264,9 +268,7 @@ Animation::Channel* Animation::createChannel(AnimationTarget* target, int proper
 
     SAFE_DELETE(normalizedKeyTimes);
 
-    Channel* channel = new Channel(this, target, propertyId, curve, duration);
-    addChannel(channel);
-    return channel;
+    return createChannel(target, propertyId, curve, duration);
 }
 
 Animation::Channel* Animation::createChannel(AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned long* keyTimes, float* keyValues, float* keyInValue, float* keyOutValue, unsigned int type)
@@ -275,8 +277,6 @@ Animation::Channel* Animation::createChannel(AnimationTarget* target, int proper
     assert(propertyComponentCount > 0);
 
     Curve* curve = new Curve(keyCount, propertyComponentCount);
-    if (target->_targetType == AnimationTarget::TRANSFORM)
-        setTransformRotationOffset(curve, propertyId);
     
     unsigned long lowest = keyTimes[0];
     unsigned long duration = keyTimes[keyCount-1] - lowest;
@@ -300,6 +300,16 @@ Animation::Channel* Animation::createChannel(AnimationTarget* target, int proper
 
     SAFE_DELETE(normalizedKeyTimes);
 
+    return createChannel(target, propertyId, curve, duration);
+}
+
+Animation::Channel* Animation::createChannel(AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration)
+{
+    assert(curve && curve->getComponentCount() == target->getAnimationPropertyComponentCount(propertyId));
+
+    if (target->_targetType == AnimationTarget::TRANSFORM)
+        setTransformRotationOffset(curve, propertyId);
+
     Channel* channel = new Channel(this, target, propertyId, curve, duration);
     addChannel(channel);
     return channel;
@@ -2,6 +2,7 @@
 #include "AnimationClip.h"
 #include "Animation.h"
 #include "AnimationTarget.h"
+#include "AnimationPose.h"
 #include "Game.h"
 #include "Quaternion.h"
 
@@ -11,7 +12,7 @@ namespace gameplay
 AnimationClip::AnimationClip(const char* id, Animation* animation, unsigned long startTime, unsigned long endTime)
     : _id(id), _animation(animation), _startTime(startTime), _endTime(endTime), _duration(_endTime - _startTime), _repeatCount(1.0f), 
       _activeDuration(_duration * _repeatCount), _speed(1.0f), _isPlaying(false), _timeStarted(0), _elapsedTime(0), _runningTime(0), 
-      _crossFadeToClip(NULL), _crossFadeStart(0), _crossFadeOutElapsed(0), _crossFadeOutDuration(0), _blendWeight(1.0f), 
+      _crossFadeToClip(NULL), _crossFadeStart(0), _crossFadeOutElapsed(0), _crossFadeOutDuration(0), _blendWeight(1.0f), _percentComplete(0.0f), 
       _isFadingOutStarted(false), _isFadingOut(false), _isFadingIn(false), _beginListeners(NULL), _endListeners(NULL)
 {
     assert(0 <= startTime && startTime <= animation->_duration && 0 <= endTime && endTime <= animation->_duration);
@@ -198,7 +199,7 @@ void AnimationClip::addEndListener(AnimationClip::Listener* listener)
     _endListeners->push_back(listener);
 }
 
-bool AnimationClip::update(unsigned long elapsedTime, std::list<AnimationTarget*>* activeTargets)
+void AnimationClip::advance(unsigned long elapsedTime)
 {
     float speed = _speed;
     if (!_isPlaying)
@@ -238,7 +239,7 @@ bool AnimationClip::update(unsigned long elapsedTime, std::list<AnimationTarget*
     }
 
     // Add back in start time, and divide by the total animation's duration to get the actual percentage complete
-    percentComplete = (float)(_startTime + percentComplete) / (float) _animation->_duration;
+    _percentComplete = (float)(_startTime + percentComplete) / (float) _animation->_duration;
     
     if (_isFadingOut)
     {
@@ -283,30 +284,104 @@ bool AnimationClip::update(unsigned long elapsedTime, std::list<AnimationTarget*
             _isPlaying = false;
         }
     }
-    
-    // Evaluate this clip.
-    Animation::Channel* channel = NULL;
-    AnimationValue* value = NULL;
-    AnimationTarget* target = NULL;
+}
+
+void AnimationClip::evaluate()
+{
+    // Evaluate the point on each channel's Curve, resuming from the segment evaluated last update.
+    // Only this clip's values are written, so clips can be evaluated concurrently.
+    unsigned int channelCount = _animation->_channels.size();
+    for (unsigned int i = 0; i < channelCount; i++)
+    {
+        Animation::Channel* channel = _animation->_channels[i];
+        AnimationValue* value = _values[i];
+        const AnimationTarget* target = channel->_target;
+
+        if (target->_animationLod == NULL || target->_animationLod->interval == 1)
+        {
+            channel->_curve->evaluate(_percentComplete, value->_value, &value->_curveIndex);
+            value->_lodValid = false;
+        }
+        else if (!target->isAnimationLodSkipped())
+        {
+            evaluateLod(channel->_curve, target, value);
+        }
+        else
+        {
+            // The values sampled before the target was skipped are stale by the time it is animated again.
+            value->_lodValid = false;
+        }
+    }
+}
+
+void AnimationClip::evaluateLod(Curve* curve, const AnimationTarget* target, AnimationValue* value)
+{
+    const AnimationTarget::Lod* lod = target->_animationLod;
+
+    // Evaluate the curve once per interval, and interpolate from the previous evaluation to
+    // the latest one over the frames of the interval. This delays the animation by up to one
+    // interval, which is not noticeable at the distances reduced rates are used at.
+    unsigned int count = value->_componentCount;
+    if (value->_lodValues == NULL)
+    {
+        value->_lodValues = new float[count * 2];
+    }
+    float* previous = value->_lodValues;
+    float* next = value->_lodValues + count;
+
+    // A change of interval restarts the interpolation from the current point of the curve.
+    if (!value->_lodValid || value->_lodInterval != lod->interval)
+    {
+        curve->evaluate(_percentComplete, next, &value->_curveIndex);
+        memcpy(previous, next, value->_componentSize);
+        value->_lodValid = true;
+        value->_lodInterval = lod->interval;
+    }
+    else if (lod->frame == 0)
+    {
+        memcpy(previous, next, value->_componentSize);
+        curve->evaluate(_percentComplete, next, &value->_curveIndex);
+    }
+
+    float t = (float)(lod->frame + 1) / (float)lod->interval;
+    float* dst = value->_value;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        dst[i] = previous[i] + (next[i] - previous[i]) * t;
+    }
+
+    if (curve->_quaternionOffset)
+    {
+        // Interpolate rotations along the shortest path. The result is not normalized,
+        // since the pose normalizes rotations after blending them.
+        const float* q1 = previous + *curve->_quaternionOffset;
+        const float* q2 = next + *curve->_quaternionOffset;
+        if (q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3] < 0.0f)
+        {
+            float* q = dst + *curve->_quaternionOffset;
+            for (unsigned int i = 0; i < 4; i++)
+            {
+                q[i] = q1[i] - (q2[i] + q1[i]) * t;
+            }
+        }
+    }
+}
+
+void AnimationClip::apply(AnimationPose* pose)
+{
     unsigned int channelCount = _animation->_channels.size();
     for (unsigned int i = 0; i < channelCount; i++)
     {
-        channel = _animation->_channels[i];
-        target = channel->_target;
-        value = _values[i];
-
-        // If the target's _animationPropertyBitFlag is clear, we can assume that this is the first
-        // animation channel to act on the target and we can add the target to the list of
-        // active targets stored by the AnimationController.
-        if (target->_animationPropertyBitFlag == 0x00)
-            activeTargets->push_front(target);
-
-        // Evaluate the point on Curve
-        channel->_curve->evaluate(percentComplete, value->_value);
-        // Set the animation value on the target property.
-        target->setAnimationPropertyValue(channel->_propertyId, value, _blendWeight);
+        Animation::Channel* channel = _animation->_channels[i];
+        if (!channel->_target->isAnimationLodSkipped())
+        {
+            pose->blend(channel->_target, channel->_propertyId, _values[i], _blendWeight);
+        }
     }
+}
 
+bool AnimationClip::finish()
+{
     // When ended. Probably should move to it's own method so we can call it when the clip is ended early.
     if (!_isPlaying)
     {
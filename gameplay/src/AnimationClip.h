@@ -10,6 +10,8 @@ namespace gameplay
 {
 
 class Animation;
+class AnimationPose;
+class AnimationTarget;
 class AnimationValue;
 
 /**
@@ -213,9 +215,33 @@ private:
     ~AnimationClip();
 
     /**
-     * Updates the animation with the elapsed time.
+     * Advances the clip's time and blend weight by the elapsed time.
      */
-    bool update(unsigned long elapsedTime, std::list<AnimationTarget*>* activeTargets);
+    void advance(unsigned long elapsedTime);
+
+    /**
+     * Evaluates the clip's channels at the current time into the clip's values.
+     *
+     * This only writes to the clip itself, so different clips may be evaluated concurrently.
+     */
+    void evaluate();
+
+    /**
+     * Evaluates a channel whose target is animated at a reduced rate.
+     */
+    void evaluateLod(Curve* curve, const AnimationTarget* target, AnimationValue* value);
+
+    /**
+     * Blends the clip's evaluated values into the given pose.
+     */
+    void apply(AnimationPose* pose);
+
+    /**
+     * Notifies the end listeners if the clip has ended.
+     *
+     * @return true if the clip has ended, false otherwise.
+     */
+    bool finish();
 
     /**
      * Handles when the AnimationClip begins.
@@ -244,6 +270,7 @@ private:
     unsigned long _crossFadeOutElapsed;       // The amount of time that has elapsed for the crossfade.
     unsigned long _crossFadeOutDuration;      // The duration of the cross fade.
     float _blendWeight;                       // The clip's blendweight
+    float _percentComplete;                   // The position of the clip within the animation, computed by advance().
     bool _isFadingOutStarted;                 // Flag to indicate if the cross fade started
     bool _isFadingOut;                        // Flag to indicate if the clip is fading out
     bool _isFadingIn;                         // Flag to indicate if the clip is fading in.
@@ -1,19 +1,25 @@
 #include "Base.h"
 #include "AnimationController.h"
+#include "AnimationPose.h"
+#include "MeshSkin.h"
 #include "Game.h"
 #include "Curve.h"
 
+// Updates animating fewer channels than this evaluate their clips on the calling thread only.
+#define ANIMATION_CONTROLLER_PARALLEL_THRESHOLD 256
+
 namespace gameplay
 {
 
 AnimationController::AnimationController()
-    : _state(STOPPED), _animations(NULL)
+    : _state(STOPPED), _pose(new AnimationPose()), _animations(NULL)
 {
 }
 
 AnimationController::~AnimationController()
 {
     destroyAllAnimations();
+    SAFE_DELETE(_pose);
 }
 
 Animation* AnimationController::createAnimation(const char* id, AnimationTarget* target, int propertyId, unsigned int keyCount, unsigned long* keyTimes, float* keyValues, Curve::InterpolationType type)
@@ -38,6 +44,17 @@ Animation* AnimationController::createAnimation(const char* id, AnimationTarget*
     return animation;
 }
 
+Animation* AnimationController::createAnimation(const char* id, AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration)
+{
+    assert(target && curve && curve->getPointCount() >= 2);
+
+    Animation* animation = new Animation(id, target, propertyId, curve, duration);
+
+    addAnimation(animation);
+
+    return animation;
+}
+
 Animation* AnimationController::createAnimation(const char* id, AnimationTarget* target, const char* animationFile)
 {
     assert(target && animationFile);
@@ -333,12 +350,62 @@ void AnimationController::update(long elapsedTime)
     if (_state != RUNNING)
         return;
 
-    // Loop through running clips and call update() on them.
+    // Compute the level of detail at which skins are animated this frame.
+    for (unsigned int i = 0, count = _lodSkins.size(); i < count; i++)
+    {
+        _lodSkins[i]->updateAnimationLod();
+    }
+
+    // Advance the running clips. Cross fades update the blend weights of other clips
+    // here, so all weights are final before any clip is applied.
+    unsigned int channelCount = 0;
+    _evaluatingClips.clear();
+    for (std::list<AnimationClip*>::iterator clipIter = _runningClips.begin(); clipIter != _runningClips.end(); clipIter++)
+    {
+        AnimationClip* clip = (*clipIter);
+        clip->advance(elapsedTime);
+        channelCount += clip->_animation->_channels.size();
+        _evaluatingClips.push_back(clip);
+    }
+
+    // Evaluate the curves of each clip. This is the bulk of the work, and since each
+    // clip only writes its own values, the clips are spread across the job system.
+    Game* game = Game::getInstance();
+    JobSystem* jobSystem = game ? game->getJobSystem() : NULL;
+    unsigned int clipCount = _evaluatingClips.size();
+    if (jobSystem && channelCount >= ANIMATION_CONTROLLER_PARALLEL_THRESHOLD)
+    {
+        jobSystem->parallelFor(clipCount, &AnimationController::evaluateClip, this);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < clipCount; i++)
+        {
+            _evaluatingClips[i]->evaluate();
+        }
+    }
+
+    // Blend the evaluated values into the pose on this thread, in the order the clips
+    // are running, so that the result does not depend on how the clips were evaluated.
+    for (unsigned int i = 0; i < clipCount; i++)
+    {
+        _evaluatingClips[i]->apply(_pose);
+    }
+
+    // Write the blended pose to the targets, once per target. Transform change notifications
+    // are deferred meanwhile, so that the subtree of each animated node is dirtied and its
+    // listeners notified only once.
+    Transform::suspendTransformChanged();
+    _pose->apply();
+    Transform::resumeTransformChanged();
+    _evaluatingClips.clear();
+
+    // Remove the clips that ended, notifying their end listeners.
     std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
     while (clipIter != _runningClips.end())
     {
         AnimationClip* clip = (*clipIter);
-        if (clip->update(elapsedTime, &_activeTargets))
+        if (clip->finish())
         {
             SAFE_RELEASE(clip);
             clipIter = _runningClips.erase(clipIter);
@@ -348,21 +415,33 @@ void AnimationController::update(long elapsedTime)
             clipIter++;
         }
     }
-
-    // Loop through active AnimationTarget's and reset their _animationPropertyBitFlag for the next frame.
-    std::list<AnimationTarget*>::iterator targetItr = _activeTargets.begin();
-    while (targetItr != _activeTargets.end())
-    {
-        AnimationTarget* target = (*targetItr);
-        target->_animationPropertyBitFlag = 0x00;
-        targetItr++;
-    }
-    _activeTargets.clear();
     
     if (_runningClips.empty())
         _state = IDLE;
 }
 
+void AnimationController::addLodSkin(MeshSkin* skin)
+{
+    // Start each skin at a different frame of its interval, so that a crowd
+    // animated at the same reduced rate is not evaluated all on the same frame.
+    skin->_animationLod.frame = _lodSkins.size();
+    _lodSkins.push_back(skin);
+}
+
+void AnimationController::removeLodSkin(MeshSkin* skin)
+{
+    std::vector<MeshSkin*>::iterator itr = std::find(_lodSkins.begin(), _lodSkins.end(), skin);
+    if (itr != _lodSkins.end())
+    {
+        _lodSkins.erase(itr);
+    }
+}
+
+void AnimationController::evaluateClip(void* controller, unsigned int index)
+{
+    ((AnimationController*)controller)->_evaluatingClips[index]->evaluate();
+}
+
 void AnimationController::addAnimation(Animation* animation)
 {
     _animations.push_back(animation);
@@ -9,6 +9,9 @@
 namespace gameplay
 {
 
+class AnimationPose;
+class MeshSkin;
+
 /**
  * Defines a class for controlling game animation.
  */
@@ -18,6 +21,8 @@ class AnimationController
     friend class Animation;
     friend class AnimationClip;
     friend class SceneLoader;
+    friend class MeshSkin;
+    friend class Package;
 
 public:
 
@@ -147,6 +152,20 @@ private:
      */
     Animation* createAnimation(const char* id, AnimationTarget* target, Properties* animationProperties);
 
+    /**
+     * Creates an animation on this target from a curve that holds the animation's key data.
+     * The animation takes ownership of the curve.
+     *
+     * @param id The ID of the animation.
+     * @param target The animation target.
+     * @param propertyId The property on this target to animate.
+     * @param curve The curve holding the key data (with normalized key times).
+     * @param duration The duration of the animation (in milliseconds).
+     *
+     * @return The newly created animation.
+     */
+    Animation* createAnimation(const char* id, AnimationTarget* target, int propertyId, Curve* curve, unsigned long duration);
+
     /**
      * Gets the controller's state.
      *
@@ -189,6 +208,21 @@ private:
      */
     void update(long elapsedTime);
 
+    /**
+     * Adds a skin whose animation level of detail must be updated every frame.
+     */
+    void addLodSkin(MeshSkin* skin);
+
+    /**
+     * Removes a skin added by addLodSkin.
+     */
+    void removeLodSkin(MeshSkin* skin);
+
+    /**
+     * Job function evaluating the clip at the given index of _evaluatingClips.
+     */
+    static void evaluateClip(void* controller, unsigned int index);
+
     /**
      * Adds an animation on this AnimationTarget.
      */ 
@@ -206,7 +240,9 @@ private:
     
     State _state;                               // The current state of the AnimationController.
     std::list<AnimationClip*> _runningClips;    // A list of running AnimationClips.
-    std::list<AnimationTarget*> _activeTargets;   // A list of animating AnimationTargets.
+    AnimationPose* _pose;                       // The pose the running clips are blended into.
+    std::vector<MeshSkin*> _lodSkins;           // The skins with animation level of detail enabled.
+    std::vector<AnimationClip*> _evaluatingClips; // The running clips being evaluated by the current update.
     std::vector<Animation*> _animations;        // A list of animations registered with the AnimationController
 };
 
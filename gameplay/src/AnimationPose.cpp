@@ -0,0 +1,252 @@
+#include "Base.h"
+#include "AnimationPose.h"
+#include "Transform.h"
+#include "MathUtil.h"
+
+namespace gameplay
+{
+
+// The components of a scale or translation selected by each property.
+static const float POSE_MASK_XYZ[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+static const float POSE_MASK_X[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+static const float POSE_MASK_Y[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
+static const float POSE_MASK_Z[4] = { 0.0f, 0.0f, 1.0f, 0.0f };
+
+AnimationPose::AnimationPose()
+{
+}
+
+AnimationPose::AnimationPose(const AnimationPose& copy)
+{
+    // hidden
+}
+
+AnimationPose::~AnimationPose()
+{
+    for (unsigned int i = 0, count = _values.size(); i < count; i++)
+    {
+        SAFE_DELETE(_values[i]);
+    }
+}
+
+unsigned int AnimationPose::getSlot(AnimationTarget* target, int propertyId)
+{
+    if (target->_poseSlot >= 0)
+        return target->_poseSlot;
+
+    unsigned int slot = _targets.size();
+    target->_poseSlot = slot;
+    _targets.push_back(target);
+    _propertyIds.push_back(propertyId);
+
+    if (target->_targetType == AnimationTarget::TRANSFORM)
+    {
+        // The slots are reused from frame to frame, so the arrays only grow.
+        if (_scales.size() < (slot + 1) * 4)
+        {
+            _scales.resize((slot + 1) * 4);
+            _rotations.resize((slot + 1) * 4);
+            _translations.resize((slot + 1) * 4);
+            _scaleWeights.resize((slot + 1) * 4);
+            _translationWeights.resize((slot + 1) * 4);
+            _rotationWeights.resize(slot + 1);
+        }
+        memset(&_scales[slot * 4], 0, 4 * sizeof(float));
+        memset(&_rotations[slot * 4], 0, 4 * sizeof(float));
+        memset(&_translations[slot * 4], 0, 4 * sizeof(float));
+        memset(&_scaleWeights[slot * 4], 0, 4 * sizeof(float));
+        memset(&_translationWeights[slot * 4], 0, 4 * sizeof(float));
+        _rotationWeights[slot] = 0.0f;
+    }
+    else
+    {
+        if (_values.size() < slot + 1)
+        {
+            _values.resize(slot + 1, NULL);
+        }
+        unsigned int componentCount = target->getAnimationPropertyComponentCount(propertyId);
+        if (_values[slot] == NULL || _values[slot]->_componentCount != componentCount)
+        {
+            SAFE_DELETE(_values[slot]);
+            _values[slot] = new AnimationValue(componentCount);
+        }
+        memset(_values[slot]->_value, 0, _values[slot]->_componentSize);
+    }
+
+    return slot;
+}
+
+void AnimationPose::blendVector(float* sum, float* weights, float x, float y, float z, const float* mask, float weight)
+{
+    float v[4] = { x, y, z, 0.0f };
+    MathUtil::accumulateVector4(v, weight, sum);
+    MathUtil::accumulateVector4(mask, weight, weights);
+}
+
+void AnimationPose::blend(AnimationTarget* target, int propertyId, AnimationValue* value, float weight)
+{
+    assert(target);
+    assert(value);
+    assert(weight >= 0.0f && weight <= 1.0f);
+
+    if (weight == 0.0f)
+        return;
+
+    unsigned int slot = getSlot(target, propertyId);
+
+    if (target->_targetType != AnimationTarget::TRANSFORM)
+    {
+        if (_propertyIds[slot] != propertyId)
+        {
+            // Only one property per non-transform target is blended in the pose,
+            // any other property is left to the target to accumulate.
+            target->setAnimationPropertyValue(propertyId, value, weight);
+            return;
+        }
+
+        float* sum = _values[slot]->_value;
+        for (unsigned int i = 0, count = _values[slot]->_componentCount; i < count; i++)
+        {
+            sum[i] += value->_value[i] * weight;
+        }
+        return;
+    }
+
+    const float* v = value->_value;
+    float* scale = &_scales[slot * 4];
+    float* rotation = &_rotations[slot * 4];
+    float* translation = &_translations[slot * 4];
+    float* scaleWeights = &_scaleWeights[slot * 4];
+    float* translationWeights = &_translationWeights[slot * 4];
+
+    switch (propertyId)
+    {
+        case Transform::ANIMATE_SCALE_UNIT:
+            blendVector(scale, scaleWeights, v[0], v[0], v[0], POSE_MASK_XYZ, weight);
+            break;
+        case Transform::ANIMATE_SCALE:
+            blendVector(scale, scaleWeights, v[0], v[1], v[2], POSE_MASK_XYZ, weight);
+            break;
+        case Transform::ANIMATE_SCALE_X:
+            blendVector(scale, scaleWeights, v[0], 0.0f, 0.0f, POSE_MASK_X, weight);
+            break;
+        case Transform::ANIMATE_SCALE_Y:
+            blendVector(scale, scaleWeights, 0.0f, v[0], 0.0f, POSE_MASK_Y, weight);
+            break;
+        case Transform::ANIMATE_SCALE_Z:
+            blendVector(scale, scaleWeights, 0.0f, 0.0f, v[0], POSE_MASK_Z, weight);
+            break;
+        case Transform::ANIMATE_ROTATE:
+            MathUtil::accumulateQuaternion(v, weight, rotation);
+            _rotationWeights[slot] += weight;
+            break;
+        case Transform::ANIMATE_TRANSLATE:
+            blendVector(translation, translationWeights, v[0], v[1], v[2], POSE_MASK_XYZ, weight);
+            break;
+        case Transform::ANIMATE_TRANSLATE_X:
+            blendVector(translation, translationWeights, v[0], 0.0f, 0.0f, POSE_MASK_X, weight);
+            break;
+        case Transform::ANIMATE_TRANSLATE_Y:
+            blendVector(translation, translationWeights, 0.0f, v[0], 0.0f, POSE_MASK_Y, weight);
+            break;
+        case Transform::ANIMATE_TRANSLATE_Z:
+            blendVector(translation, translationWeights, 0.0f, 0.0f, v[0], POSE_MASK_Z, weight);
+            break;
+        case Transform::ANIMATE_ROTATE_TRANSLATE:
+            MathUtil::accumulateQuaternion(v, weight, rotation);
+            _rotationWeights[slot] += weight;
+            blendVector(translation, translationWeights, v[4], v[5], v[6], POSE_MASK_XYZ, weight);
+            break;
+        case Transform::ANIMATE_SCALE_ROTATE_TRANSLATE:
+            blendVector(scale, scaleWeights, v[0], v[1], v[2], POSE_MASK_XYZ, weight);
+            MathUtil::accumulateQuaternion(v + 3, weight, rotation);
+            _rotationWeights[slot] += weight;
+            blendVector(translation, translationWeights, v[7], v[8], v[9], POSE_MASK_XYZ, weight);
+            break;
+        default:
+            break;
+    }
+}
+
+void AnimationPose::apply()
+{
+    for (unsigned int i = 0, count = _targets.size(); i < count; i++)
+    {
+        if (_targets[i]->_targetType == AnimationTarget::TRANSFORM)
+        {
+            applyTransform(i);
+        }
+        else
+        {
+            applyValue(i);
+        }
+    }
+
+    for (unsigned int i = 0, count = _targets.size(); i < count; i++)
+    {
+        _targets[i]->_poseSlot = -1;
+        _targets[i]->_animationPropertyBitFlag = 0x00;
+    }
+    _targets.clear();
+    _propertyIds.clear();
+}
+
+void AnimationPose::applyTransform(unsigned int slot)
+{
+    Transform* transform = static_cast<Transform*>(_targets[slot]);
+    const float* scale = &_scales[slot * 4];
+    const float* rotation = &_rotations[slot * 4];
+    const float* translation = &_translations[slot * 4];
+    const float* scaleWeights = &_scaleWeights[slot * 4];
+    const float* translationWeights = &_translationWeights[slot * 4];
+    float rotationWeight = _rotationWeights[slot];
+    bool changed = false;
+
+    // Components no channel wrote to keep their current value.
+    float* dst = &transform->_scale.x;
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        float weight = scaleWeights[i];
+        if (weight > 0.0f)
+        {
+            dst[i] = weight > 1.0f ? scale[i] / weight : scale[i] + (1.0f - weight);
+            changed = true;
+        }
+    }
+
+    dst = &transform->_translation.x;
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        float weight = translationWeights[i];
+        if (weight > 0.0f)
+        {
+            dst[i] = weight > 1.0f ? translation[i] / weight : translation[i];
+            changed = true;
+        }
+    }
+
+    if (rotationWeight > 0.0f)
+    {
+        Quaternion q(rotation[0], rotation[1], rotation[2], rotation[3]);
+        if (rotationWeight < 1.0f)
+        {
+            // Blend the remaining weight with the identity rotation.
+            q.w += q.w < 0.0f ? rotationWeight - 1.0f : 1.0f - rotationWeight;
+        }
+        q.normalize();
+        transform->_rotation.set(q);
+        changed = true;
+    }
+
+    if (changed)
+    {
+        transform->dirty();
+    }
+}
+
+void AnimationPose::applyValue(unsigned int slot)
+{
+    _targets[slot]->setAnimationPropertyValue(_propertyIds[slot], _values[slot], 1.0f);
+}
+
+}
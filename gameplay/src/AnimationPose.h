@@ -0,0 +1,103 @@
+#ifndef ANIMATIONPOSE_H_
+#define ANIMATIONPOSE_H_
+
+#include "AnimationTarget.h"
+#include "AnimationValue.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines the buffer in which the running clips of an AnimationController blend
+ * their values before they are written to their targets.
+ *
+ * Each animated transform gets a slot in contiguous scale, rotation and translation
+ * arrays, into which every channel acting on it accumulates its weighted value.
+ * Rotations are blended by normalized weighted sum (nlerp) rather than by chaining
+ * rotations. Once all clips have been blended, each target is written exactly
+ * once:
+ *
+ * - When the weights of a component add up to more than one, the result is
+ *   their weighted average.
+ * - When they add up to less than one, the remaining weight goes to the
+ *   identity transform (unit scale, no rotation, no translation).
+ *
+ * Other targets (such as material parameters) accumulate the weighted sum of
+ * their property components, and are written once with the result.
+ */
+class AnimationPose
+{
+    friend class AnimationController;
+    friend class AnimationClip;
+
+private:
+
+    /**
+     * Constructor.
+     */
+    AnimationPose();
+
+    /**
+     * Hidden copy constructor.
+     */
+    AnimationPose(const AnimationPose& copy);
+
+    /**
+     * Hidden copy assignment operator (not implemented).
+     */
+    AnimationPose& operator=(const AnimationPose& copy);
+
+    /**
+     * Destructor.
+     */
+    ~AnimationPose();
+
+    /**
+     * Blends a value of the given target property into the pose.
+     *
+     * @param target The animation target.
+     * @param propertyId The target property.
+     * @param value The value of the property.
+     * @param weight The blend weight of the value, from 0 to 1.
+     */
+    void blend(AnimationTarget* target, int propertyId, AnimationValue* value, float weight);
+
+    /**
+     * Writes the blended values to their targets and empties the pose.
+     */
+    void apply();
+
+    /**
+     * Gets the slot of the given target, adding one if the target is not in the pose yet.
+     */
+    unsigned int getSlot(AnimationTarget* target, int propertyId);
+
+    /**
+     * Accumulates a scale or translation value of a transform slot.
+     */
+    static void blendVector(float* sum, float* weights, float x, float y, float z, const float* mask, float weight);
+
+    /**
+     * Writes the blended transform of the given slot to its target.
+     */
+    void applyTransform(unsigned int slot);
+
+    /**
+     * Writes the blended property value of the given slot to its target.
+     */
+    void applyValue(unsigned int slot);
+
+    std::vector<AnimationTarget*> _targets;     // The target of each slot.
+    std::vector<int> _propertyIds;              // The property blended in each slot of a non-transform target.
+    std::vector<float> _scales;                 // The weighted sum of the scales of each slot (4 floats per slot).
+    std::vector<float> _rotations;              // The weighted sum of the rotations of each slot (4 floats per slot).
+    std::vector<float> _translations;           // The weighted sum of the translations of each slot (4 floats per slot).
+    std::vector<float> _scaleWeights;           // The total weight of each scale component of each slot (4 floats per slot).
+    std::vector<float> _translationWeights;     // The total weight of each translation component of each slot (4 floats per slot).
+    std::vector<float> _rotationWeights;        // The total weight of the rotation of each slot.
+    std::vector<AnimationValue*> _values;       // The weighted sum of the property of each slot of a non-transform target.
+};
+
+}
+
+#endif
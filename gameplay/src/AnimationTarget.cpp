@@ -8,7 +8,7 @@ namespace gameplay
 {
 
 AnimationTarget::AnimationTarget()
-    : _targetType(SCALAR), _animationPropertyBitFlag(0x00), _animationChannels(NULL)
+    : _targetType(SCALAR), _animationPropertyBitFlag(0x00), _poseSlot(-1), _animationLod(NULL), _animationLodMinor(false), _animationChannels(NULL)
 {
 }
 
@@ -28,6 +28,11 @@ AnimationTarget::~AnimationTarget()
     }
 }
 
+bool AnimationTarget::isAnimationLodSkipped() const
+{
+    return _animationLod && (_animationLod->interval == 0 || (_animationLodMinor && _animationLod->interval > 1));
+}
+
 void AnimationTarget::addChannel(Animation::Channel* channel)
 {
     if (_animationChannels == NULL)
@@ -19,6 +19,8 @@ class AnimationTarget
     friend class Animation;
     friend class AnimationClip;
     friend class AnimationController;
+    friend class AnimationPose;
+    friend class MeshSkin;
 
 public:
 
@@ -71,6 +73,25 @@ protected:
 
     char _animationPropertyBitFlag;     // Bit flag used to indicate which properties on the AnimationTarget are currently animating.
 
+    int _poseSlot;                      // The slot of the target in the AnimationPose being blended, or -1.
+
+    /**
+     * The level of detail at which a group of targets (such as the joints of a skin) is animated.
+     */
+    struct Lod
+    {
+        unsigned int interval;          // The number of frames between evaluations, or 0 to stop animating the targets.
+        unsigned int frame;             // The current frame within the interval. Channels are evaluated on frame 0.
+    };
+
+    /**
+     * Determines whether the channels acting on this target are skipped at the current level of detail.
+     */
+    bool isAnimationLodSkipped() const;
+
+    const Lod* _animationLod;           // The level of detail of the group of this target, or NULL to animate it every frame.
+    bool _animationLodMinor;            // Whether this target is skipped when its group is animated at a reduced rate.
+
 private:
 
     /**
@@ -5,7 +5,7 @@ namespace gameplay
 {
 
 AnimationValue::AnimationValue(unsigned int componentCount)
-  : _componentCount(componentCount), _componentSize(componentCount * sizeof(float))
+  : _componentCount(componentCount), _componentSize(componentCount * sizeof(float)), _curveIndex(0), _lodValues(NULL), _lodValid(false), _lodInterval(0)
 {
     _value = new float[_componentCount];
 }
@@ -13,6 +13,7 @@ AnimationValue::AnimationValue(unsigned int componentCount)
 AnimationValue::~AnimationValue()
 {
     SAFE_DELETE_ARRAY(_value);
+    SAFE_DELETE_ARRAY(_lodValues);
 }
 
 float AnimationValue::getFloat(unsigned int index) const
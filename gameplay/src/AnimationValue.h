@@ -12,6 +12,7 @@ namespace gameplay
 class AnimationValue
 {
     friend class AnimationClip;
+    friend class AnimationPose;
 
 public:
 
@@ -75,6 +76,10 @@ private:
     unsigned int _componentCount;   // The number of float values for the property.
     unsigned int _componentSize;    // The number of bytes of memory the property is.
     float* _value;                  // The current value of the property.
+    unsigned int _curveIndex;       // The index of the curve segment last evaluated into this value.
+    float* _lodValues;              // The last two values evaluated at a reduced rate, interpolated into _value.
+    bool _lodValid;                 // Whether _lodValues holds values evaluated at the current reduced rate.
+    unsigned int _lodInterval;      // The reduced rate _lodValues were evaluated at.
 
 };
 
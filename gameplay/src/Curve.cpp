@@ -50,43 +50,57 @@ using std::strcmp;
     }
 #endif
 
+// The alignment (in bytes) of the arrays holding the point data of a curve.
+#define CURVE_DATA_ALIGNMENT 16
+
+// The number of segments scanned forward from a cursor before falling back to a binary search.
+#define CURVE_CURSOR_SCAN_COUNT 4
 
 namespace gameplay
 {
 
+// Rounds the given size up to a multiple of the curve data alignment.
+static size_t alignDataSize(size_t size)
+{
+    return (size + CURVE_DATA_ALIGNMENT - 1) & ~(size_t)(CURVE_DATA_ALIGNMENT - 1);
+}
+
 Curve::Curve(unsigned int pointCount, unsigned int componentCount)
-    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL)
+    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL),
+      _data(NULL), _times(NULL), _values(NULL), _inValues(NULL), _outValues(NULL), _types(NULL)
 {
-    _points = new Point[_pointCount];
+    // Keep all of the point data in a single allocation, with the times, values, tangents
+    // and interpolation types each stored contiguously and aligned for SIMD access.
+    size_t timesSize = alignDataSize(sizeof(float) * _pointCount);
+    size_t valuesSize = alignDataSize(_componentSize * _pointCount);
+    size_t typesSize = alignDataSize(sizeof(InterpolationType) * _pointCount);
+    _data = new unsigned char[timesSize + valuesSize * 3 + typesSize + CURVE_DATA_ALIGNMENT - 1];
+
+    unsigned char* data = (unsigned char*)(((size_t)_data + CURVE_DATA_ALIGNMENT - 1) & ~(size_t)(CURVE_DATA_ALIGNMENT - 1));
+    _times = (float*)data;
+    data += timesSize;
+    _values = (float*)data;
+    data += valuesSize;
+    _inValues = (float*)data;
+    data += valuesSize;
+    _outValues = (float*)data;
+    data += valuesSize;
+    _types = (InterpolationType*)data;
+
     for (unsigned int i = 0; i < _pointCount; i++)
     {
-        _points[i].time = 0.0f;
-        _points[i].value = new float[_componentCount];
-        _points[i].inValue = new float[_componentCount];
-        _points[i].outValue = new float[_componentCount];
-        _points[i].type = LINEAR;
+        _times[i] = 0.0f;
+        _types[i] = LINEAR;
     }
-    _points[_pointCount - 1].time = 1.0f;
+    _times[_pointCount - 1] = 1.0f;
 }
 
 Curve::~Curve()
 {
-    SAFE_DELETE_ARRAY(_points);
+    SAFE_DELETE_ARRAY(_data);
     SAFE_DELETE_ARRAY(_quaternionOffset);
 }
 
-Curve::Point::Point()
-    : time(0.0f), value(NULL), inValue(NULL), outValue(NULL)
-{
-}
-
-Curve::Point::~Point()
-{
-    SAFE_DELETE_ARRAY(value);
-    SAFE_DELETE_ARRAY(inValue);
-    SAFE_DELETE_ARRAY(outValue);
-}
-
 unsigned int Curve::getPointCount() const
 {
     return _pointCount;
@@ -99,12 +113,12 @@ unsigned int Curve::getComponentCount() const
 
 float Curve::getStartTime() const
 {
-    return _points[0].time;
+    return _times[0];
 }
 
 float Curve::getEndTime() const
 {
-    return _points[_pointCount-1].time;
+    return _times[_pointCount-1];
 }
 
 void Curve::setPoint(unsigned int index, float time, float* value, InterpolationType type)
@@ -116,30 +130,30 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 {
     assert(index < _pointCount && time >= 0.0f && time <= 1.0f && !(index == 0 && time != 0.0f) && !(index == _pointCount - 1 && time != 1.0f));
 
-    _points[index].time = time;
-    _points[index].type = type;
+    _times[index] = time;
+    _types[index] = type;
 
     if (value)
-        memcpy(_points[index].value, value, _componentSize);
+        memcpy(_values + index * _componentCount, value, _componentSize);
 
     if (inValue)
-        memcpy(_points[index].inValue, inValue, _componentSize);
+        memcpy(_inValues + index * _componentCount, inValue, _componentSize);
 
     if (outValue)
-        memcpy(_points[index].outValue, outValue, _componentSize);
+        memcpy(_outValues + index * _componentCount, outValue, _componentSize);
 }
 
 void Curve::setTangent(unsigned int index, InterpolationType type, float* inValue, float* outValue)
 {
     assert(index < _pointCount);
 
-    _points[index].type = type;
+    _types[index] = type;
 
     if (inValue)
-        memcpy(_points[index].inValue, inValue, _componentSize);
+        memcpy(_inValues + index * _componentCount, inValue, _componentSize);
 
     if (outValue)
-        memcpy(_points[index].outValue, outValue, _componentSize);
+        memcpy(_outValues + index * _componentCount, outValue, _componentSize);
 }
 
 void Curve::evaluate(float time, float* dst) const
@@ -147,67 +161,111 @@ void Curve::evaluate(float time, float* dst) const
     assert(dst && time >= 0 && time <= 1.0f);
 
     // Check if we are at or beyond the bounds of the curve.
-    if (time <= _points[0].time)
+    if (time <= _times[0])
     {
-        memcpy(dst, _points[0].value, _componentSize);
+        memcpy(dst, _values, _componentSize);
         return;
     }
-    else if (time >= _points[_pointCount - 1].time)
+    else if (time >= _times[_pointCount - 1])
     {
-        memcpy(dst, _points[_pointCount - 1].value, _componentSize);
+        memcpy(dst, _values + (_pointCount - 1) * _componentCount, _componentSize);
         return;
     }
 
     // Locate the points we are interpolating between using a binary search.
     unsigned int index = determineIndex(time);
     
-    Point* from = _points + index;
-    Point* to = _points + (index + 1);
+    interpolate(time, index, dst);
+}
+
+void Curve::evaluate(float time, float* dst, unsigned int* index) const
+{
+    assert(dst && index && time >= 0 && time <= 1.0f);
 
+    // Check if we are at or beyond the bounds of the curve.
+    if (time <= _times[0])
+    {
+        memcpy(dst, _values, _componentSize);
+        *index = 0;
+        return;
+    }
+    else if (time >= _times[_pointCount - 1])
+    {
+        memcpy(dst, _values + (_pointCount - 1) * _componentCount, _componentSize);
+        *index = _pointCount - 2;
+        return;
+    }
+
+    // Resume the search from the segment that was evaluated last.
+    *index = determineIndex(time, *index);
+
+    interpolate(time, *index, dst);
+}
+
+void Curve::evaluateMany(float time, unsigned int count, Curve* const* curves, float* const* dst, unsigned int* indices)
+{
+    assert(curves && dst && time >= 0 && time <= 1.0f);
+
+    // Curves that are evaluated together are usually keyed at the same times (i.e. the channels
+    // of a skeletal animation), so when no cursors are given the segment found for one curve is
+    // used as the starting point of the search for the next one.
+    unsigned int index = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const Curve* curve = curves[i];
+        if (indices)
+            index = indices[i];
+
+        if (time <= curve->_times[0])
+        {
+            memcpy(dst[i], curve->_values, curve->_componentSize);
+            index = 0;
+        }
+        else if (time >= curve->_times[curve->_pointCount - 1])
+        {
+            memcpy(dst[i], curve->_values + (curve->_pointCount - 1) * curve->_componentCount, curve->_componentSize);
+            index = curve->_pointCount - 2;
+        }
+        else
+        {
+            index = curve->determineIndex(time, index);
+            curve->interpolate(time, index, dst[i]);
+        }
+
+        if (indices)
+            indices[i] = index;
+    }
+}
+
+void Curve::interpolate(float time, unsigned int index, float* dst) const
+{
     // Calculate the fractional time between the two points.
-    float scale = (to->time - from->time);
-    float t = (time - from->time) / scale;
+    float scale = (_times[index + 1] - _times[index]);
+    float t = (time - _times[index]) / scale;
 
     // Calculate the value of the curve discretely if appropriate.
-    switch (from->type)
+    switch (_types[index])
     {
         case BEZIER:
         {
-            interpolateBezier(t, from, to, dst);
+            interpolateBezier(t, index, dst);
             return;
         }
         case BSPLINE:
         {
-            Point* c0;
-            Point* c1;
-            if (index == 0)
-            {
-                c0 = from;
-            }
-            else
-            {
-                c0 = (_points + index - 1);
-            }
-            
-            if (index == _pointCount - 2)
-            {
-                c1 = to;
-            }
-            else
-            {
-                c1 = (_points + index + 2);
-            }
-            interpolateBSpline(t, c0, from, to, c1, dst);
+            unsigned int c0 = (index == 0) ? index : index - 1;
+            unsigned int c3 = (index == _pointCount - 2) ? index + 1 : index + 2;
+            interpolateBSpline(t, c0, index, index + 1, c3, dst);
             return;
         }
         case FLAT:
         {
-            interpolateHermiteFlat(t, from, to, dst);
+            interpolateHermiteFlat(t, index, dst);
             return;
         }
         case HERMITE:
         {
-            interpolateHermite(t, from, to, dst);
+            interpolateHermite(t, index, dst);
             return;
         }
         case LINEAR:
@@ -217,12 +275,12 @@ void Curve::evaluate(float time, float* dst) const
         }
         case SMOOTH:
         {
-            interpolateHermiteSmooth(t, index, from, to, dst);
+            interpolateHermiteSmooth(t, index, dst);
             return;
         }
         case STEP:
         {
-            memcpy(dst, from->value, _componentSize);
+            memcpy(dst, _values + index * _componentCount, _componentSize);
             return;
         }
         case QUADRATIC_IN:
@@ -700,7 +758,7 @@ void Curve::evaluate(float time, float* dst) const
         }
     }
 
-    interpolateLinear(t, from, to, dst);
+    interpolateLinear(t, index, dst);
 }
 
 void Curve::setQuaternionOffset(unsigned int offset)
@@ -713,7 +771,7 @@ void Curve::setQuaternionOffset(unsigned int offset)
     *_quaternionOffset = offset;
 }
 
-void Curve::interpolateBezier(float s, Point* from, Point* to, float* dst) const
+void Curve::interpolateBezier(float s, unsigned int index, float* dst) const
 {
     float s_2 = s * s;
     float eq0 = 1 - s;
@@ -723,10 +781,10 @@ void Curve::interpolateBezier(float s, Point* from, Point* to, float* dst) const
     float eq3 = 3 * s_2 * eq0;
     float eq4 = s_2 * s;
 
-    float* fromValue = from->value;
-    float* toValue = to->value;
-    float* outValue = from->outValue;
-    float* inValue = to->inValue;
+    float* fromValue = _values + index * _componentCount;
+    float* toValue = fromValue + _componentCount;
+    float* outValue = _outValues + index * _componentCount;
+    float* inValue = _inValues + (index + 1) * _componentCount;
 
 
     if (!_quaternionOffset)
@@ -753,7 +811,7 @@ void Curve::interpolateBezier(float s, Point* from, Point* to, float* dst) const
         }
 
         // Handle quaternion component.
-        float interpTime = bezier(eq1, eq2, eq3, eq4, from->time, outValue[i], to->time, inValue[i]);
+        float interpTime = bezier(eq1, eq2, eq3, eq4, _times[index], outValue[i], _times[index + 1], inValue[i]);
         interpolateQuaternion(interpTime, (fromValue + i), (toValue + i), (dst + i));
         
         // Handle remaining components (if any) as scalars
@@ -767,7 +825,7 @@ void Curve::interpolateBezier(float s, Point* from, Point* to, float* dst) const
     }
 }
 
-void Curve::interpolateBSpline(float s, Point* c0, Point* c1, Point* c2, Point* c3, float* dst) const
+void Curve::interpolateBSpline(float s, unsigned int c0, unsigned int c1, unsigned int c2, unsigned int c3, float* dst) const
 {   
     float s_2 = s * s;
     float s_3 = s_2 * s;
@@ -776,10 +834,10 @@ void Curve::interpolateBSpline(float s, Point* c0, Point* c1, Point* c2, Point*
     float eq2 = (-3 * s_3 + 3 * s_2 + 3 * s + 1) / 6.0f;
     float eq3 = s_3 / 6.0f;
 
-    float* c0Value = c0->value;
-    float* c1Value = c1->value;
-    float* c2Value = c2->value;
-    float* c3Value = c3->value;
+    float* c0Value = _values + c0 * _componentCount;
+    float* c1Value = _values + c1 * _componentCount;
+    float* c2Value = _values + c2 * _componentCount;
+    float* c3Value = _values + c3 * _componentCount;
 
     if (!_quaternionOffset)
     {
@@ -806,12 +864,12 @@ void Curve::interpolateBSpline(float s, Point* c0, Point* c1, Point* c2, Point*
 
         // Handle quaternion component.
         float interpTime;
-        if (c0->time == c1->time)
-            interpTime = bspline(eq0, eq1, eq2, eq3, -c0->time, c1->time, c2->time, c3->time);
-        else if (c2->time == c3->time)
-            interpTime = bspline(eq0, eq1, eq2, eq3, c0->time, c1->time, c2->time, -c3->time); 
+        if (_times[c0] == _times[c1])
+            interpTime = bspline(eq0, eq1, eq2, eq3, -_times[c0], _times[c1], _times[c2], _times[c3]);
+        else if (_times[c2] == _times[c3])
+            interpTime = bspline(eq0, eq1, eq2, eq3, _times[c0], _times[c1], _times[c2], -_times[c3]); 
         else
-            interpTime = bspline(eq0, eq1, eq2, eq3, c0->time, c1->time, c2->time, c3->time);
+            interpTime = bspline(eq0, eq1, eq2, eq3, _times[c0], _times[c1], _times[c2], _times[c3]);
         interpolateQuaternion(s, (c1Value + i) , (c2Value + i), (dst + i));
             
         // Handle remaining components (if any) as scalars
@@ -825,7 +883,7 @@ void Curve::interpolateBSpline(float s, Point* c0, Point* c1, Point* c2, Point*
     }
 }
 
-void Curve::interpolateHermite(float s, Point* from, Point* to, float* dst) const
+void Curve::interpolateHermite(float s, unsigned int index, float* dst) const
 {
     // Calculate the hermite basis functions.
     float s_2 = s * s;                   // t^2
@@ -835,10 +893,10 @@ void Curve::interpolateHermite(float s, Point* from, Point* to, float* dst) cons
     float h10 = s_3 - 2 * s_2 + s;       // basis function 2
     float h11 = s_3 - s_2;               // basis function 3
 
-    float* fromValue = from->value;
-    float* toValue = to->value;
-    float* outValue = from->outValue;
-    float* inValue = to->inValue;
+    float* fromValue = _values + index * _componentCount;
+    float* toValue = fromValue + _componentCount;
+    float* outValue = _outValues + index * _componentCount;
+    float* inValue = _inValues + (index + 1) * _componentCount;
 
     if (!_quaternionOffset)
     {
@@ -864,7 +922,7 @@ void Curve::interpolateHermite(float s, Point* from, Point* to, float* dst) cons
         }
 
         // Handle quaternion component.
-        float interpTime = hermite(h00, h01, h10, h11, from->time, outValue[i], to->time, inValue[i]);
+        float interpTime = hermite(h00, h01, h10, h11, _times[index], outValue[i], _times[index + 1], inValue[i]);
         interpolateQuaternion(interpTime, (fromValue + i), (toValue + i), (dst + i));
         
         // Handle remaining components (if any) as scalars
@@ -878,7 +936,7 @@ void Curve::interpolateHermite(float s, Point* from, Point* to, float* dst) cons
     }
 }
 
-void Curve::interpolateHermiteFlat(float s, Point* from, Point* to, float* dst) const
+void Curve::interpolateHermiteFlat(float s, unsigned int index, float* dst) const
 {
     // Calculate the hermite basis functions.
     float s_2 = s * s;                   // t^2
@@ -886,8 +944,8 @@ void Curve::interpolateHermiteFlat(float s, Point* from, Point* to, float* dst)
     float h00 = 2 * s_3 - 3 * s_2 + 1;   // basis function 0
     float h01 = -2 * s_3 + 3 * s_2;      // basis function 1
 
-    float* fromValue = from->value;
-    float* toValue = to->value;
+    float* fromValue = _values + index * _componentCount;
+    float* toValue = fromValue + _componentCount;
 
     if (!_quaternionOffset)
     {
@@ -913,7 +971,7 @@ void Curve::interpolateHermiteFlat(float s, Point* from, Point* to, float* dst)
         }
 
         // Handle quaternion component.
-        float interpTime = hermiteFlat(h00, h01, from->time, to->time);
+        float interpTime = hermiteFlat(h00, h01, _times[index], _times[index + 1]);
         interpolateQuaternion(interpTime, (fromValue + i), (toValue + i), (dst + i));
         
         // Handle remaining components (if any) as scalars
@@ -927,7 +985,7 @@ void Curve::interpolateHermiteFlat(float s, Point* from, Point* to, float* dst)
     }
 }
 
-void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, Point* to, float* dst) const
+void Curve::interpolateHermiteSmooth(float s, unsigned int index, float* dst) const
 {
     // Calculate the hermite basis functions.
     float s_2 = s * s;                   // t^2
@@ -940,8 +998,10 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
     float inValue;
     float outValue;
 
-    float* fromValue = from->value;
-    float* toValue = to->value;
+    float* fromValue = _values + index * _componentCount;
+    float* toValue = fromValue + _componentCount;
+    float* prevValue = (index > 0) ? fromValue - _componentCount : NULL;
+    float* nextValue = (index < _pointCount - 2) ? toValue + _componentCount : NULL;
 
     if (!_quaternionOffset)
     {
@@ -959,7 +1019,7 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
                 }
                 else
                 {
-                    outValue = (toValue[i] - (from - 1)->value[i]) * ((from->time - (from - 1)->time) / (to->time - (from - 1)->time));
+                    outValue = (toValue[i] - prevValue[i]) * ((_times[index] - _times[index - 1]) / (_times[index + 1] - _times[index - 1]));
                 }
 
                 if (index == _pointCount - 2)
@@ -968,7 +1028,7 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
                 }
                 else
                 {
-                    inValue = ((to + 1)->value[i] - fromValue[i]) * ((to->time - from->time) / ((to + 1)->time - from->time));
+                    inValue = (nextValue[i] - fromValue[i]) * ((_times[index + 1] - _times[index]) / (_times[index + 2] - _times[index]));
                 }
 
                 dst[i] = hermiteSmooth(h00, h01, h10, h11, fromValue[i], outValue, toValue[i], inValue);
@@ -994,7 +1054,7 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
                 }
                 else
                 {
-                    outValue = (toValue[i] - (from - 1)->value[i]) * ((from->time - (from - 1)->time) / (to->time - (from - 1)->time));
+                    outValue = (toValue[i] - prevValue[i]) * ((_times[index] - _times[index - 1]) / (_times[index + 1] - _times[index - 1]));
                 }
 
                 if (index == _pointCount - 2)
@@ -1003,7 +1063,7 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
                 }
                 else
                 {
-                    inValue = ((to + 1)->value[i] - fromValue[i]) * ((to->time - from->time) / ((to + 1)->time - from->time));
+                    inValue = (nextValue[i] - fromValue[i]) * ((_times[index + 1] - _times[index]) / (_times[index + 2] - _times[index]));
                 }
 
                 dst[i] = hermiteSmooth(h00, h01, h10, h11, fromValue[i], outValue, toValue[i], inValue);
@@ -1013,23 +1073,23 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
         // Handle quaternion component.
         if (index == 0)
         {
-            outValue = to->time - from->time;
+            outValue = _times[index + 1] - _times[index];
         }
         else
         {
-            outValue = (to->time - (from - 1)->time) * ((from->time - (from - 1)->time) / (to->time - (from - 1)->time));
+            outValue = (_times[index + 1] - _times[index - 1]) * ((_times[index] - _times[index - 1]) / (_times[index + 1] - _times[index - 1]));
         }
 
         if (index == _pointCount - 2)
         {
-            inValue = to->time - from->time;
+            inValue = _times[index + 1] - _times[index];
         }
         else
         {
-            inValue = ((to + 1)->time - from->time) * ((to->time - from->time) / ((to + 1)->time - from->time));
+            inValue = (_times[index + 2] - _times[index]) * ((_times[index + 1] - _times[index]) / (_times[index + 2] - _times[index]));
         }
 
-        float interpTime = hermiteSmooth(h00, h01, h10, h11, from->time, outValue, to->time, inValue);
+        float interpTime = hermiteSmooth(h00, h01, h10, h11, _times[index], outValue, _times[index + 1], inValue);
         interpolateQuaternion(interpTime, (fromValue + i), (toValue + i), (dst + i));
         
         // Handle remaining components (if any) as scalars
@@ -1048,7 +1108,7 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
                 }
                 else
                 {
-                    outValue = (toValue[i] - (from - 1)->value[i]) * ((from->time - (from - 1)->time) / (to->time - (from - 1)->time));
+                    outValue = (toValue[i] - prevValue[i]) * ((_times[index] - _times[index - 1]) / (_times[index + 1] - _times[index - 1]));
                 }
 
                 if (index == _pointCount - 2)
@@ -1057,7 +1117,7 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
                 }
                 else
                 {
-                    inValue = ((to + 1)->value[i] - fromValue[i]) * ((to->time - from->time) / ((to + 1)->time - from->time));
+                    inValue = (nextValue[i] - fromValue[i]) * ((_times[index + 1] - _times[index]) / (_times[index + 2] - _times[index]));
                 }
 
                 dst[i] = hermiteSmooth(h00, h01, h10, h11, fromValue[i], outValue, toValue[i], inValue);
@@ -1066,10 +1126,10 @@ void Curve::interpolateHermiteSmooth(float s, unsigned int index, Point* from, P
     }
 }
 
-void Curve::interpolateLinear(float s, Point* from, Point* to, float* dst) const
+void Curve::interpolateLinear(float s, unsigned int index, float* dst) const
 {
-    float* fromValue = from->value;
-    float* toValue = to->value;
+    float* fromValue = _values + index * _componentCount;
+    float* toValue = fromValue + _componentCount;
 
     if (!_quaternionOffset)
     {
@@ -1128,9 +1188,9 @@ int Curve::determineIndex(float time) const
     {
         mid = (min + max) >> 1;
 
-        if (time >= _points[mid].time && time <= _points[mid + 1].time)
+        if (time >= _times[mid] && time <= _times[mid + 1])
             return mid;
-        else if (time < _points[mid].time)
+        else if (time < _times[mid])
             max = mid - 1;
         else
             min = mid + 1;
@@ -1140,6 +1200,34 @@ int Curve::determineIndex(float time) const
     return -1;
 }
 
+int Curve::determineIndex(float time, unsigned int index) const
+{
+    // Time usually moves by a small amount between evaluations, so check the
+    // segments following the given one (or the one preceding it, for reverse
+    // playback) before falling back to a binary search.
+    if (index < _pointCount - 1)
+    {
+        if (time >= _times[index])
+        {
+            unsigned int end = index + CURVE_CURSOR_SCAN_COUNT;
+            if (end > _pointCount - 1)
+                end = _pointCount - 1;
+
+            for (unsigned int i = index; i < end; i++)
+            {
+                if (time <= _times[i + 1])
+                    return i;
+            }
+        }
+        else if (index > 0 && time >= _times[index - 1])
+        {
+            return index - 1;
+        }
+    }
+
+    return determineIndex(time);
+}
+
 int Curve::getInterpolationType(const char* curveId)
 {
     if (strcmp(curveId, "BEZIER") == 0)
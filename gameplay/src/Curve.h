@@ -13,6 +13,7 @@ class Curve
     friend class AnimationClip;
     friend class AnimationController;
     friend class MeshSkin;
+    friend class Package;
 
 public:
 
@@ -354,36 +355,34 @@ public:
      */
     void evaluate(float time, float* dst) const;
 
-private:
-
     /**
-     * Defines a single point within a curve.
+     * Evaluates the curve at the given position value (between 0.0 and 1.0 inclusive),
+     * starting the keyframe search from the segment that was last evaluated.
+     *
+     * This is faster than evaluate(float, float*) when the curve is evaluated repeatedly
+     * at times that progress in small steps (i.e. when it is played back frame by frame).
+     *
+     * @param time The position to evaluate the curve at.
+     * @param dst The evaluated value of the curve at the given time.
+     * @param index The index of the segment to start the search from (0 the first time);
+     *      this is updated with the index of the segment that was evaluated.
      */
-    class Point
-    {
-    public:
-
-        /** The time of the point within the curve. */
-        float time;
-        /** The value of the point. */
-        float* value;
-        /** The value of the tangent when approaching this point (from the previous point in the curve). */
-        float* inValue;
-        /** The value of the tangent when leaving this point (towards the next point in the curve). */
-        float* outValue;
-        /** The type of interpolation to use between this point and the next point. */
-        InterpolationType type;
+    void evaluate(float time, float* dst, unsigned int* index) const;
 
-        /**
-         * Constructor.
-         */
-        Point();
+    /**
+     * Evaluates several curves at the same position value (between 0.0 and 1.0 inclusive).
+     *
+     * @param time The position to evaluate the curves at.
+     * @param count The number of curves to evaluate.
+     * @param curves The curves to evaluate.
+     * @param dst The destination arrays for the evaluated values of each curve.
+     * @param indices The segment index to start the search from for each curve, updated with the
+     *      index of the segment that was evaluated (optional). If NULL, the search for each curve
+     *      starts from the segment that was found for the previous curve.
+     */
+    static void evaluateMany(float time, unsigned int count, Curve* const* curves, float* const* dst, unsigned int* indices = NULL);
 
-        /**
-         * Destructor.
-         */
-        ~Point();
-    };
+private:
 
     /**
      * Constructor.
@@ -398,43 +397,54 @@ private:
     /**
      * Bezier interpolation function.
      */
-    void interpolateBezier(float s, Point* from, Point* to, float* dst) const;
+    void interpolateBezier(float s, unsigned int index, float* dst) const;
 
     /**
      * Bspline interpolation function.
      */
-    void interpolateBSpline(float s, Point* c0, Point* c1, Point* c2, Point* c3, float* dst) const;
+    void interpolateBSpline(float s, unsigned int c0, unsigned int c1, unsigned int c2, unsigned int c3, float* dst) const;
 
     /**
      * Hermite interpolation function.
      */
-    void interpolateHermite(float s, Point* from, Point* to, float* dst) const;
+    void interpolateHermite(float s, unsigned int index, float* dst) const;
 
     /**
      * Hermite interpolation function.
      */
-    void interpolateHermiteFlat(float s, Point* from, Point* to, float* dst) const;
+    void interpolateHermiteFlat(float s, unsigned int index, float* dst) const;
 
     /**
      * Hermite interpolation function.
      */
-    void interpolateHermiteSmooth(float s, unsigned int index, Point* from, Point* to, float* dst) const;
+    void interpolateHermiteSmooth(float s, unsigned int index, float* dst) const;
 
     /** 
      * Linear interpolation function.
      */ 
-    void interpolateLinear(float s, Point* from, Point* to, float* dst) const;
+    void interpolateLinear(float s, unsigned int index, float* dst) const;
 
     /**
      * Quaternion interpolation function.
      */
     void interpolateQuaternion(float s, float* from, float* to, float* dst) const;
     
+    /**
+     * Interpolates the curve between the point at the given index and the next point.
+     */
+    void interpolate(float time, unsigned int index, float* dst) const;
+
     /**
      * Determines the current keyframe to interpolate from based on the specified time.
      */ 
     int determineIndex(float time) const;
 
+    /**
+     * Determines the current keyframe to interpolate from based on the specified time,
+     * searching from the given keyframe index first.
+     */
+    int determineIndex(float time, unsigned int index) const;
+
     /**
      * Sets the offset for the beginning of a Quaternion piece of data within the curve's value span at the specified
      * index. The next four components of data starting at the given index will be interpolated as a Quaternion.
@@ -457,7 +467,12 @@ private:
     unsigned int _componentCount;       // Number of components on the curve.
     unsigned int _componentSize;        // The component size (in bytes).
     unsigned int* _quaternionOffset;    // Offset for the rotation component.
-    Point* _points;                     // The points on the curve.
+    unsigned char* _data;               // The single allocation holding all of the point data.
+    float* _times;                      // The time of each point within the curve.
+    float* _values;                     // The values of the points (componentCount floats per point).
+    float* _inValues;                   // The tangents approaching each point (from the previous point).
+    float* _outValues;                  // The tangents leaving each point (towards the next point).
+    InterpolationType* _types;          // The interpolation type to use between each point and the next.
 };
 
 inline float bezier(float eq0, float eq1, float eq2, float eq3, float from, float out, float to, float in);
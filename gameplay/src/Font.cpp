@@ -3,6 +3,8 @@
 #include "Game.h"
 #include "FileSystem.h"
 #include "Package.h"
+#include "TextLayout.h"
+#include "GlyphAtlas.h"
 
 // Default font vertex shader
 #define FONT_VSH \
@@ -33,6 +35,24 @@
         "gl_FragColor.a = texture2D(u_texture, v_texCoord).a;\n" \
     "}"
 
+// Distance field font fragment shader. The edge is smoothed over about one pixel
+// whatever the size text is drawn at, using the screen space rate of change of the distance.
+#define FONT_DISTANCE_FIELD_FSH \
+    "#ifdef OPENGL_ES\n" \
+    "#extension GL_OES_standard_derivatives : enable\n" \
+    "precision highp float;\n" \
+    "#endif\n" \
+    "varying vec2 v_texCoord;\n" \
+    "varying vec4 v_color;\n" \
+    "uniform sampler2D u_texture;\n" \
+    "void main()\n" \
+    "{\n" \
+        "float distance = texture2D(u_texture, v_texCoord).a;\n" \
+        "float smoothing = 0.7 * fwidth(distance);\n" \
+        "gl_FragColor = v_color;\n" \
+        "gl_FragColor.a = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);\n" \
+    "}"
+
 namespace gameplay
 {
 
@@ -40,8 +60,11 @@ static std::vector<Font*> __fontCache;
 
 static Effect* __fontEffect = NULL;
 
+static Effect* __fontDistanceFieldEffect = NULL;
+
 Font::Font() :
-    _style(PLAIN), _size(0), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL)
+    _style(PLAIN), _size(0), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL), _atlas(NULL),
+    _distanceFieldSpread(0)
 {
 }
 
@@ -59,6 +82,7 @@ Font::~Font()
         __fontCache.erase(itr);
     }
 
+    SAFE_DELETE(_atlas);
     SAFE_DELETE(_batch);
     SAFE_DELETE_ARRAY(_glyphs);
     SAFE_RELEASE(_texture);
@@ -116,33 +140,13 @@ Font* Font::create(const char* path, const char* id)
     return font;
 }
 
-Font* Font::create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture)
+Font* Font::create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture,
+                   unsigned int distanceFieldSpread)
 {
-    // Create the effect for the font's sprite batch.
-    if (__fontEffect == NULL)
-    {
-        __fontEffect = Effect::createFromSource(FONT_VSH, FONT_FSH);
-        if (__fontEffect == NULL)
-        {
-            LOG_ERROR("Failed to create effect for font.");
-            SAFE_RELEASE(texture);
-            return NULL;
-        }
-    }
-    else
-    {
-        __fontEffect->addRef();
-    }
-
     // Create batch for the font.
-    SpriteBatch* batch = SpriteBatch::create(texture, __fontEffect, 128);
-
-    // Release __fontEffect since the SpriteBatch keeps a reference to it
-    SAFE_RELEASE(__fontEffect);
-
+    SpriteBatch* batch = createBatch(texture, distanceFieldSpread > 0);
     if (batch == NULL)
     {
-        LOG_ERROR("Failed to create batch for font.");
         return NULL;
     }
 
@@ -155,26 +159,116 @@ Font* Font::create(const char* family, Style style, unsigned int size, Glyph* gl
     font->_size = size;
     font->_texture = texture;
     font->_batch = batch;
+    font->_distanceFieldSpread = distanceFieldSpread;
 
     // Copy the glyphs array.
     font->_glyphs = new Glyph[glyphCount];
     memcpy(font->_glyphs, glyphs, sizeof(Glyph) * glyphCount);
     font->_glyphCount = glyphCount;
 
+    // Index the glyphs by character code, in a hash table kept at most half full.
+    unsigned int capacity = 16;
+    while (capacity < (unsigned int)glyphCount * 2)
+    {
+        capacity *= 2;
+    }
+    font->_glyphTable.resize(capacity, -1);
+    for (int i = 0; i < glyphCount; ++i)
+    {
+        unsigned int mask = capacity - 1;
+        unsigned int slot = (glyphs[i].code * 2654435761u) & mask;
+        while (font->_glyphTable[slot] >= 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        font->_glyphTable[slot] = i;
+    }
+
     return font;
 }
 
+Font* Font::createFromTrueType(const char* path, unsigned int size, unsigned int pageSize, unsigned int maxPageCount)
+{
+    GlyphAtlas* atlas = GlyphAtlas::create(path, size, pageSize, maxPageCount);
+    if (atlas == NULL)
+    {
+        return NULL;
+    }
+
+    Font* font = new Font();
+    font->_path = path;
+    font->_size = size;
+    font->_atlas = atlas;
+
+    return font;
+}
+
+SpriteBatch* Font::createBatch(Texture* texture, bool distanceField)
+{
+    // Create the effect for the font's sprite batch.
+    Effect*& effect = distanceField ? __fontDistanceFieldEffect : __fontEffect;
+    if (effect == NULL)
+    {
+        effect = Effect::createFromSource(FONT_VSH, distanceField ? FONT_DISTANCE_FIELD_FSH : FONT_FSH);
+        if (effect == NULL)
+        {
+            LOG_ERROR("Failed to create effect for font.");
+            return NULL;
+        }
+    }
+    else
+    {
+        effect->addRef();
+    }
+
+    // Create batch for the font.
+    SpriteBatch* batch = SpriteBatch::create(texture, effect, 128);
+
+    // Release the effect since the SpriteBatch keeps a reference to it
+    SAFE_RELEASE(effect);
+
+    if (batch == NULL)
+    {
+        LOG_ERROR("Failed to create batch for font.");
+        return NULL;
+    }
+
+    return batch;
+}
+
 unsigned int Font::getSize()
 {
     return _size;
 }
 
+bool Font::isDistanceField() const
+{
+    return _distanceFieldSpread > 0;
+}
+
 void Font::begin()
 {
-    _batch->begin();
+    if (_atlas)
+    {
+        _atlas->begin();
+    }
+    else
+    {
+        _batch->begin();
+    }
 }
 
 void Font::drawText(const char* text, int x, int y, const Vector4& color, unsigned int size, bool rightToLeft)
+{
+    layoutText(text, x, y, color, size, rightToLeft, NULL);
+}
+
+void Font::drawText(const char* text, const Rectangle& area, const Vector4& color, unsigned int size, Justify justify, bool wrap, bool rightToLeft)
+{
+    layoutText(text, area, color, size, justify, wrap, rightToLeft, NULL);
+}
+
+void Font::layoutText(const char* text, int x, int y, const Vector4& color, unsigned int size, bool rightToLeft, TextLayout* layout)
 {
     float scale = (float)size / _size;
     char* cursor = NULL;
@@ -239,15 +333,16 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
 
         for (int i = startIndex; i < length && i >= 0; i += iteration)
         {
-            char c = 0;
+            const char* character = NULL;
             if (rightToLeft)
             {
-                c = cursor[i];
+                character = &cursor[i];
             }
             else
             {
-                c = text[i];
+                character = &text[i];
             }
+            char c = character[0];
 
             // Draw this character.
             switch (c)
@@ -264,14 +359,14 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
                 xPos += (size>>1)*4;
                 break;
             default:
-                int index = c - 32; // HACK for ASCII
-                if (index >= 0 && index < (int)_glyphCount)
+                unsigned int page;
+                const Glyph* g = getGlyph(character, &page);
+                if (g)
                 {
-                    Glyph& g = _glyphs[index];
-                    _batch->draw(xPos, yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color);
-                    xPos += g.width * scale + (size>>3);
-                    break;
+                    drawGlyph(xPos, yPos, g->width * scale, size, *g, page, color, layout);
+                    xPos += g->width * scale + (size>>3);
                 }
+                break;
             }
         }
 
@@ -286,7 +381,8 @@ void Font::drawText(const char* text, int x, int y, const Vector4& color, unsign
     }
 }
 
-void Font::drawText(const char* text, const Rectangle& area, const Vector4& color, unsigned int size, Justify justify, bool wrap, bool rightToLeft)
+void Font::layoutText(const char* text, const Rectangle& area, const Vector4& color, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
+                      TextLayout* layout)
 {
     float scale = (float)size / _size;
     char* token = const_cast<char*>(text);
@@ -553,12 +649,11 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
 
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
-            char c = token[i];
-            int glyphIndex = c - 32; // HACK for ASCII
-        
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            unsigned int page;
+            const Glyph* glyph = getGlyph(&token[i], &page);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                const Glyph& g = *glyph;
 
                 if (xPos + (int)(g.width*scale) > area.x + area.width)
                 {
@@ -571,7 +666,7 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
                     // Draw this character.
                     if (draw)
                     {
-                        _batch->draw(xPos, yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color);
+                        drawGlyph(xPos, yPos, g.width * scale, size, g, page, color, layout);
                     }
                 }
                 xPos += g.width*scale + (size>>3);
@@ -644,7 +739,14 @@ void Font::drawText(const char* text, const Rectangle& area, const Vector4& colo
 
 void Font::end()
 {
-    _batch->end();
+    if (_atlas)
+    {
+        _atlas->end();
+    }
+    else
+    {
+        _batch->end();
+    }
 }
 
 void Font::measureText(const char* text, unsigned int size, unsigned int* width, unsigned int* height)
@@ -996,6 +1098,123 @@ void Font::measureText(const char* text, const Rectangle& viewport, unsigned int
     }
 }
 
+void Font::drawGlyph(float x, float y, float width, float height, const Glyph& glyph, unsigned int page, const Vector4& color, TextLayout* layout)
+{
+    if (page == GLYPH_ATLAS_NO_PAGE)
+    {
+        // Blank glyph.
+        return;
+    }
+
+    const float* uvs = glyph.uvs;
+    float spreadUvs[4];
+    if (_distanceFieldSpread > 0)
+    {
+        // Extend the quad over the margin where the distance field fades out around the glyph,
+        // so that edges at the border of the glyph are smoothed on both sides.
+        float spread = (float)_distanceFieldSpread;
+        float spreadU = spread / _texture->getWidth();
+        float spreadV = spread / _texture->getHeight();
+        spreadUvs[0] = uvs[0] - spreadU;
+        spreadUvs[1] = uvs[1] - spreadV;
+        spreadUvs[2] = uvs[2] + spreadU;
+        spreadUvs[3] = uvs[3] + spreadV;
+        uvs = spreadUvs;
+
+        spread *= height / _size;
+        x -= spread;
+        y -= spread;
+        width += spread * 2.0f;
+        height += spread * 2.0f;
+    }
+
+    if (layout)
+    {
+        layout->addGlyph(x, y, width, height, uvs, page, color);
+    }
+    else
+    {
+        getBatch(page)->draw(x, y, width, height, uvs[0], uvs[1], uvs[2], uvs[3], color);
+    }
+}
+
+const Font::Glyph* Font::getGlyph(const char* character, unsigned int* page)
+{
+    // Decode the UTF-8 sequence starting at the given byte. Continuation bytes are
+    // skipped, so that text can be walked a byte at a time in either direction.
+    const unsigned char* bytes = (const unsigned char*)character;
+    unsigned int code = bytes[0];
+    if (code >= 0x80)
+    {
+        unsigned int length;
+        if ((code & 0xE0) == 0xC0)
+        {
+            code &= 0x1F;
+            length = 1;
+        }
+        else if ((code & 0xF0) == 0xE0)
+        {
+            code &= 0x0F;
+            length = 2;
+        }
+        else if ((code & 0xF8) == 0xF0)
+        {
+            code &= 0x07;
+            length = 3;
+        }
+        else
+        {
+            // Continuation or invalid byte.
+            return NULL;
+        }
+
+        for (unsigned int i = 1; i <= length; ++i)
+        {
+            if ((bytes[i] & 0xC0) != 0x80)
+            {
+                // Truncated sequence.
+                return NULL;
+            }
+            code = (code << 6) | (bytes[i] & 0x3F);
+        }
+    }
+
+    if (_atlas)
+    {
+        return _atlas->getGlyph(code, page);
+    }
+
+    *page = 0;
+    if (_glyphTable.empty())
+    {
+        return NULL;
+    }
+
+    unsigned int mask = _glyphTable.size() - 1;
+    for (unsigned int i = (code * 2654435761u) & mask; ; i = (i + 1) & mask)
+    {
+        int index = _glyphTable[i];
+        if (index < 0)
+        {
+            return NULL;
+        }
+        if (_glyphs[index].code == code)
+        {
+            return &_glyphs[index];
+        }
+    }
+}
+
+SpriteBatch* Font::getBatch(unsigned int page)
+{
+    return _atlas ? _atlas->getBatch(page) : _batch;
+}
+
+unsigned int Font::getGlyphVersion() const
+{
+    return _atlas ? _atlas->_version : 0;
+}
+
 unsigned int Font::getTokenWidth(const char* token, unsigned int length, unsigned int size, float scale)
 {
     // Calculate width of word or line.
@@ -1012,11 +1231,11 @@ unsigned int Font::getTokenWidth(const char* token, unsigned int length, unsigne
             tokenWidth += (size>>1)*4;
             break;
         default:
-            int glyphIndex = c - 32;
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            unsigned int page;
+            const Glyph* g = getGlyph(&token[i], &page);
+            if (g)
             {
-                Glyph& g = _glyphs[glyphIndex];
-                tokenWidth += g.width * scale + (size>>3);
+                tokenWidth += g->width * scale + (size>>3);
             }
             break;
         }
@@ -6,12 +6,26 @@
 namespace gameplay
 {
 
+class TextLayout;
+class GlyphAtlas;
+
 /**
  * Defines a font for text rendering.
+ *
+ * Text that is drawn every frame but rarely changes should be drawn through a
+ * TextLayout, which caches the laid out glyphs instead of laying them out on
+ * every call to drawText.
+ *
+ * Fonts encoded as signed distance fields store, for each texel, the distance to the
+ * nearest glyph edge rather than its coverage. Their glyphs stay sharp when drawn at
+ * sizes well above the size they were encoded at, so a single small texture serves
+ * text of all sizes.
  */
 class Font : public Ref
 {
     friend class Package;
+    friend class TextLayout;
+    friend class GlyphAtlas;
 
 public:
 
@@ -104,16 +118,44 @@ public:
      * @param glyphs An array of font glyphs, defining each character in the font within the texture map.
      * @param glyphCount The number of items in the glyph array.
      * @param texture A texture map containing rendered glyphs.
+     * @param distanceFieldSpread The distance, in texels, over which glyphs fade out from their
+     *        edges if the texture holds signed distance fields, or 0 if it holds glyph coverage.
      * 
      * @return The new Font.
      */
-    static Font* create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture);
+    static Font* create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture,
+                        unsigned int distanceFieldSpread = 0);
+
+    /**
+     * Creates a font that rasterizes its glyphs from a TrueType font file as they are drawn.
+     *
+     * Glyphs are packed into a dynamic atlas made of up to maxPageCount textures. Once the
+     * atlas is full, the glyphs of the least recently drawn texture are evicted to make room
+     * for new ones. Unlike fonts baked by the encoder, any character of the font file can be
+     * drawn, while memory remains proportional to the characters actually displayed.
+     *
+     * This requires gameplay to be built with GAMEPLAY_FREETYPE defined and linked with FreeType.
+     *
+     * @param path The path of the TrueType font file.
+     * @param size The font size, in pixels.
+     * @param pageSize The width and height of the atlas textures, in pixels.
+     * @param maxPageCount The maximum number of atlas textures.
+     *
+     * @return The new Font, or NULL if the font file could not be loaded.
+     */
+    static Font* createFromTrueType(const char* path, unsigned int size, unsigned int pageSize = 512, unsigned int maxPageCount = 4);
 
     /**
      * Returns the font size (max height of glyphs) in pixels.
      */
     unsigned int getSize();
 
+    /**
+     * Returns whether the glyphs of this font are signed distance fields, which can be
+     * drawn at any size without blurring.
+     */
+    bool isDistanceField() const;
+
     /**
      * Begins text drawing for this font.
      */
@@ -193,6 +235,44 @@ private:
      */
     ~Font();
 
+    /**
+     * Lays out the glyphs of text drawn at a position, either drawing them or adding them to a layout.
+     */
+    void layoutText(const char* text, int x, int y, const Vector4& color, unsigned int size, bool rightToLeft, TextLayout* layout);
+
+    /**
+     * Lays out the glyphs of text drawn within an area, either drawing them or adding them to a layout.
+     */
+    void layoutText(const char* text, const Rectangle& area, const Vector4& color, unsigned int size, Justify justify, bool wrap, bool rightToLeft,
+                    TextLayout* layout);
+
+    /**
+     * Draws a glyph, or adds it to the given layout if it is not NULL.
+     */
+    void drawGlyph(float x, float y, float width, float height, const Glyph& glyph, unsigned int page, const Vector4& color, TextLayout* layout);
+
+    /**
+     * Gets the glyph of the UTF-8 character starting at the given byte, and the page of the glyph.
+     * Returns NULL for continuation bytes and characters the font has no glyph for.
+     */
+    const Glyph* getGlyph(const char* character, unsigned int* page);
+
+    /**
+     * Gets the batch drawing the glyphs of the given page.
+     */
+    SpriteBatch* getBatch(unsigned int page);
+
+    /**
+     * Gets a version number that changes whenever glyphs previously returned by getGlyph are evicted.
+     */
+    unsigned int getGlyphVersion() const;
+
+    /**
+     * Creates a batch drawing glyphs from the given texture with the font effect, or the
+     * distance field font effect.
+     */
+    static SpriteBatch* createBatch(Texture* texture, bool distanceField = false);
+
     // Utilities
     unsigned int getTokenWidth(const char* token, unsigned int length, unsigned int size, float scale);
     unsigned int getReversedTokenLength(const char* token, const char* bufStart);
@@ -212,6 +292,9 @@ private:
     unsigned int _glyphCount;
     Texture* _texture;
     SpriteBatch* _batch;
+    std::vector<int> _glyphTable;
+    GlyphAtlas* _atlas;
+    unsigned int _distanceFieldSpread;
 };
 
 }
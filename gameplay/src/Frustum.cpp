@@ -79,6 +79,38 @@ bool Frustum::intersects(const BoundingSphere& sphere) const
     return sphere.intersects(*this);
 }
 
+bool Frustum::intersects(const BoundingSphere& sphere, unsigned int* planeMask, unsigned int* lastPlane) const
+{
+    assert(planeMask);
+    assert(lastPlane);
+
+    const Plane* planes[6] = { &_near, &_far, &_left, &_right, &_bottom, &_top };
+
+    unsigned int first = *lastPlane < 6 ? *lastPlane : 0;
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        unsigned int index = (first + i) % 6;
+        unsigned int bit = 1 << index;
+        if ((*planeMask & bit) == 0)
+            continue;
+
+        float distance = planes[index]->distance(sphere.center);
+        if (distance < -sphere.radius)
+        {
+            // Entirely behind the plane.
+            *lastPlane = index;
+            return false;
+        }
+        else if (distance > sphere.radius)
+        {
+            // Entirely in front of the plane, and so is everything the sphere bounds.
+            *planeMask &= ~bit;
+        }
+    }
+
+    return true;
+}
+
 bool Frustum::intersects(const BoundingBox& box) const
 {
     return box.intersects(*this);
@@ -105,23 +137,17 @@ void Frustum::set(const Frustum& frustum)
     _matrix.set(frustum._matrix);
 }
 
-void updatePlane(const Matrix& matrix, Plane* dst)
+void Frustum::updatePlanes()
 {
-    assert(dst);
-
-    dst->setNormal(Vector3(matrix.m[3] + matrix.m[2], matrix.m[7] + matrix.m[6], matrix.m[11] + matrix.m[10]));
-    dst->setDistance(matrix.m[15] + matrix.m[14]);
-
-    Vector3 normal = dst->getNormal();
-    if (!normal.isZero())
-    {
-        float normalizeFactor = 1.0f / sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
-        if (normalizeFactor != 1.0f)
-        {
-            dst->setNormal(Vector3(normal.x * normalizeFactor, normal.y * normalizeFactor, normal.z * normalizeFactor));
-            dst->setDistance(dst->getDistance() * normalizeFactor);
-        }
-    }
+    // Each plane is the sum or difference of the fourth row of the matrix and one of
+    // its first three rows (the matrix is stored in column-major order).
+    const float* m = _matrix.m;
+    _near.set(Vector3(m[3] + m[2], m[7] + m[6], m[11] + m[10]), m[15] + m[14]);
+    _far.set(Vector3(m[3] - m[2], m[7] - m[6], m[11] - m[10]), m[15] - m[14]);
+    _bottom.set(Vector3(m[3] + m[1], m[7] + m[5], m[11] + m[9]), m[15] + m[13]);
+    _top.set(Vector3(m[3] - m[1], m[7] - m[5], m[11] - m[9]), m[15] - m[13]);
+    _left.set(Vector3(m[3] + m[0], m[7] + m[4], m[11] + m[8]), m[15] + m[12]);
+    _right.set(Vector3(m[3] - m[0], m[7] - m[4], m[11] - m[8]), m[15] - m[12]);
 }
 
 void Frustum::set(const Matrix& matrix)
@@ -129,12 +155,7 @@ void Frustum::set(const Matrix& matrix)
     _matrix.set(matrix);
 
     // Update the planes.
-    updatePlane(matrix, &_near);
-    updatePlane(matrix, &_far);
-    updatePlane(matrix, &_bottom);
-    updatePlane(matrix, &_top);
-    updatePlane(matrix, &_left);
-    updatePlane(matrix, &_right);
+    updatePlanes();
 }
 
 }
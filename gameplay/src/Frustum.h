@@ -122,6 +122,27 @@ public:
      */
     bool intersects(const BoundingSphere& sphere) const;
 
+    /**
+     * Tests whether this frustum intersects the specified bounding sphere, as part
+     * of a hierarchical culling pass.
+     *
+     * Only the planes whose bits are set in planeMask are tested, where bit i
+     * selects the plane at index i in the order near, far, left, right, bottom, top.
+     * The bits of the planes the sphere lies entirely in front of are cleared, so
+     * the mask can be passed on to test bounding spheres contained in this one.
+     *
+     * The plane at index lastPlane is tested first. When the sphere lies behind a
+     * plane, lastPlane is set to that plane's index, so an object that was rejected
+     * in the previous frame is usually rejected again by a single plane test.
+     *
+     * @param sphere The bounding sphere to test intersection with.
+     * @param planeMask The planes to test (0x3F for all planes), updated on return.
+     * @param lastPlane The index of the plane to test first, updated when the sphere is rejected.
+     *
+     * @return true if the specified bounding sphere intersects this frustum; false otherwise.
+     */
+    bool intersects(const BoundingSphere& sphere, unsigned int* planeMask, unsigned int* lastPlane) const;
+
     /**
      * Tests whether this frustum intersects the specified bounding box.
      *
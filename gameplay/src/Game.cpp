@@ -17,7 +17,7 @@ Game::Game()
     : _initialized(false), _state(UNINITIALIZED), 
       _frameLastFPS(0), _frameCount(0), _frameRate(0), 
       _clearDepth(1.0f), _clearStencil(0),
-      _animationController(NULL), _audioController(NULL)
+      _animationController(NULL), _audioController(NULL), _physicsController(NULL), _jobSystem(NULL)
 {
     assert(__gameInstance == NULL);
     __gameInstance = this;
@@ -87,6 +87,9 @@ bool Game::startup()
 
     RenderState::initialize();
 
+    _jobSystem = new JobSystem();
+    _jobSystem->initialize();
+
     _animationController = new AnimationController();
     _animationController->initialize();
 
@@ -117,6 +120,9 @@ void Game::shutdown()
         _physicsController->finalize();
         SAFE_DELETE(_physicsController);
 
+        _jobSystem->finalize();
+        SAFE_DELETE(_jobSystem);
+
         RenderState::finalize();
     }
 
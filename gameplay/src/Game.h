@@ -7,6 +7,7 @@
 #include "AudioController.h"
 #include "AnimationController.h"
 #include "PhysicsController.h"
+#include "JobSystem.h"
 #include "Vector4.h"
 
 namespace gameplay
@@ -181,6 +182,14 @@ public:
      */
     inline PhysicsController* getPhysicsController() const;
 
+    /**
+     * Gets the job system used to spread engine work across
+     * the worker threads of the game.
+     * 
+     * @return The job system for this game.
+     */
+    inline JobSystem* getJobSystem() const;
+
     /**
      * Menu callback on menu events.
      */
@@ -333,6 +342,7 @@ private:
     AnimationController* _animationController;  // Controls the scheduling and running of animations.
     AudioController* _audioController;          // Controls audio sources that are playing in the game.
     PhysicsController* _physicsController;      // Controls the simulation of a physics scene and entities.
+    JobSystem* _jobSystem;                      // Runs engine work on the worker threads.
 };
 
 }
@@ -39,6 +39,11 @@ inline PhysicsController* Game::getPhysicsController() const
     return _physicsController;
 }
 
+inline JobSystem* Game::getJobSystem() const
+{
+    return _jobSystem;
+}
+
 template <class T>
 void  Game::renderOnce(T* instance, void (T::*method)(void*), void* cookie)
 {
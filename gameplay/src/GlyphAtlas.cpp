@@ -0,0 +1,467 @@
+#include "Base.h"
+#include "GlyphAtlas.h"
+#include "FileSystem.h"
+
+#ifdef GAMEPLAY_FREETYPE
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#endif
+
+// The number of empty pixels kept between glyphs, so that filtering does not bleed neighbours.
+#define GLYPH_ATLAS_PADDING         2
+
+// The initial capacity of the hash table (a power of two).
+#define GLYPH_ATLAS_INITIAL_ENTRIES 256
+
+namespace gameplay
+{
+
+/**
+ * The font face glyphs are rasterized from.
+ */
+struct GlyphAtlas::Rasterizer
+{
+#ifdef GAMEPLAY_FREETYPE
+    FT_Library library;
+    FT_Face face;
+    char* data;
+#endif
+};
+
+GlyphAtlas::GlyphAtlas()
+    : _rasterizer(NULL), _ascender(0), _cellHeight(0), _pageSize(0), _maxPageCount(0), _entryCount(0), _frame(0), _version(0), _drawing(false), _full(false)
+{
+}
+
+GlyphAtlas::GlyphAtlas(const GlyphAtlas& copy)
+{
+    // hidden
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    for (unsigned int i = 0, count = _pages.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_pages[i].batch);
+        SAFE_RELEASE(_pages[i].texture);
+    }
+
+#ifdef GAMEPLAY_FREETYPE
+    if (_rasterizer)
+    {
+        FT_Done_Face(_rasterizer->face);
+        FT_Done_FreeType(_rasterizer->library);
+        SAFE_DELETE_ARRAY(_rasterizer->data);
+    }
+#endif
+    SAFE_DELETE(_rasterizer);
+}
+
+GlyphAtlas* GlyphAtlas::create(const char* path, unsigned int size, unsigned int pageSize, unsigned int maxPageCount)
+{
+    assert(path);
+    assert(size > 0 && pageSize > 0 && maxPageCount > 0);
+
+#ifdef GAMEPLAY_FREETYPE
+    int dataSize = 0;
+    char* data = FileSystem::readAll(path, &dataSize);
+    if (data == NULL)
+    {
+        LOG_ERROR_VARG("Failed to read font file: %s", path);
+        return NULL;
+    }
+
+    FT_Library library;
+    if (FT_Init_FreeType(&library))
+    {
+        LOG_ERROR("Failed to initialize FreeType.");
+        SAFE_DELETE_ARRAY(data);
+        return NULL;
+    }
+
+    // Size the face like the encoder does for baked fonts (72 dpi, so points are pixels).
+    FT_Face face;
+    if (FT_New_Memory_Face(library, (const FT_Byte*)data, dataSize, 0, &face) ||
+        FT_Set_Char_Size(face, 0, size * 64, 0, 0))
+    {
+        LOG_ERROR_VARG("Failed to load font face: %s", path);
+        FT_Done_FreeType(library);
+        SAFE_DELETE_ARRAY(data);
+        return NULL;
+    }
+
+    GlyphAtlas* atlas = new GlyphAtlas();
+    atlas->_rasterizer = new Rasterizer();
+    atlas->_rasterizer->library = library;
+    atlas->_rasterizer->face = face;
+    atlas->_rasterizer->data = data;
+
+    // Metrics are in 26.6 fixed point.
+    atlas->_ascender = (face->size->metrics.ascender + 63) >> 6;
+    atlas->_cellHeight = atlas->_ascender + ((63 - face->size->metrics.descender) >> 6);
+    atlas->_pageSize = pageSize;
+    atlas->_maxPageCount = maxPageCount;
+    atlas->rehash(GLYPH_ATLAS_INITIAL_ENTRIES, GLYPH_ATLAS_EMPTY);
+
+    if (atlas->_cellHeight + GLYPH_ATLAS_PADDING * 2 > pageSize)
+    {
+        LOG_ERROR_VARG("Font size %u does not fit in pages of %u pixels: %s", size, pageSize, path);
+        SAFE_DELETE(atlas);
+    }
+
+    return atlas;
+#else
+    LOG_ERROR_VARG("Failed to load font file: %s (FreeType support is disabled; define GAMEPLAY_FREETYPE).", path);
+    return NULL;
+#endif
+}
+
+const Font::Glyph* GlyphAtlas::getGlyph(unsigned int code, unsigned int* page)
+{
+    Entry* entry = findEntry(code);
+    if (entry->code != code)
+    {
+        // Rasterization may evict a page and rebuild the table, so the glyph is inserted afterwards.
+        Entry newEntry;
+        rasterize(code, &newEntry);
+        if (newEntry.code == GLYPH_ATLAS_EMPTY)
+        {
+            *page = GLYPH_ATLAS_MISSING;
+            return NULL;
+        }
+        insertEntry(newEntry);
+        entry = findEntry(code);
+    }
+
+    *page = entry->page;
+    if (entry->page == GLYPH_ATLAS_MISSING)
+    {
+        return NULL;
+    }
+    if (entry->page != GLYPH_ATLAS_NO_PAGE)
+    {
+        _pages[entry->page].lastUsed = _frame;
+    }
+
+    return &entry->glyph;
+}
+
+SpriteBatch* GlyphAtlas::getBatch(unsigned int page)
+{
+    assert(page < _pages.size());
+
+    _pages[page].lastUsed = _frame;
+
+    return _pages[page].batch;
+}
+
+void GlyphAtlas::begin()
+{
+    ++_frame;
+    _drawing = true;
+
+    for (unsigned int i = 0, count = _pages.size(); i < count; ++i)
+    {
+        _pages[i].batch->begin();
+    }
+}
+
+void GlyphAtlas::end()
+{
+    for (unsigned int i = 0, count = _pages.size(); i < count; ++i)
+    {
+        _pages[i].batch->end();
+    }
+
+    _drawing = false;
+}
+
+GlyphAtlas::Entry* GlyphAtlas::findEntry(unsigned int code)
+{
+    // Fibonacci hashing spreads consecutive codes (the common case) across the table.
+    unsigned int mask = _entries.size() - 1;
+    for (unsigned int i = (code * 2654435761u) & mask; ; i = (i + 1) & mask)
+    {
+        Entry& entry = _entries[i];
+        if (entry.code == code || entry.code == GLYPH_ATLAS_EMPTY)
+        {
+            return &entry;
+        }
+    }
+}
+
+void GlyphAtlas::insertEntry(const Entry& entry)
+{
+    // Keep the table at most half full so probe sequences stay short.
+    if ((_entryCount + 1) * 2 > _entries.size())
+    {
+        rehash(_entries.size() * 2, GLYPH_ATLAS_EMPTY);
+    }
+
+    Entry* slot = findEntry(entry.code);
+    if (slot->code == GLYPH_ATLAS_EMPTY)
+    {
+        ++_entryCount;
+    }
+    *slot = entry;
+}
+
+void GlyphAtlas::rehash(unsigned int capacity, unsigned int droppedPage)
+{
+    std::vector<Entry> entries(capacity);
+    for (unsigned int i = 0; i < capacity; ++i)
+    {
+        entries[i].code = GLYPH_ATLAS_EMPTY;
+    }
+    entries.swap(_entries);
+
+    _entryCount = 0;
+    for (unsigned int i = 0, count = entries.size(); i < count; ++i)
+    {
+        const Entry& entry = entries[i];
+        if (entry.code != GLYPH_ATLAS_EMPTY && entry.page != droppedPage)
+        {
+            *findEntry(entry.code) = entry;
+            ++_entryCount;
+        }
+    }
+}
+
+void GlyphAtlas::rasterize(unsigned int code, Entry* entry)
+{
+    entry->code = code;
+    entry->page = GLYPH_ATLAS_MISSING;
+    entry->glyph.code = code;
+    entry->glyph.width = 0;
+    memset(entry->glyph.uvs, 0, sizeof(entry->glyph.uvs));
+
+#ifdef GAMEPLAY_FREETYPE
+    FT_Face face = _rasterizer->face;
+    FT_UInt index = FT_Get_Char_Index(face, code);
+    if (index == 0 || FT_Load_Glyph(face, index, FT_LOAD_RENDER))
+    {
+        return;
+    }
+
+    const FT_Bitmap& bitmap = face->glyph->bitmap;
+    unsigned int width = bitmap.width;
+    unsigned int rows = bitmap.rows;
+    if (width == 0 || rows == 0)
+    {
+        // Nothing to draw, but the glyph still advances the pen.
+        entry->page = GLYPH_ATLAS_NO_PAGE;
+        entry->glyph.width = face->glyph->advance.x >> 6;
+        return;
+    }
+
+    // Glyphs occupy full cells with their baseline at the ascender, like baked fonts,
+    // so that they line up when drawn at the font size.
+    unsigned int cellWidth = std::min(width, _pageSize - GLYPH_ATLAS_PADDING * 2);
+    unsigned int x, y, page;
+    if (!allocate(cellWidth + GLYPH_ATLAS_PADDING, _cellHeight + GLYPH_ATLAS_PADDING, &page, &x, &y))
+    {
+        // Every page is in use in the current frame; try again in a later frame.
+        // Warn only once until glyphs can be added again, since this repeats every frame.
+        if (!_full)
+        {
+            WARN_VARG("Glyph atlas is full; character %u and others are not drawn until a page can be evicted.", code);
+            _full = true;
+        }
+        entry->code = GLYPH_ATLAS_EMPTY;
+        return;
+    }
+    _full = false;
+
+    std::vector<unsigned char> cell((cellWidth + GLYPH_ATLAS_PADDING) * (_cellHeight + GLYPH_ATLAS_PADDING), 0);
+    int top = (int)_ascender - face->glyph->bitmap_top;
+    for (unsigned int row = 0; row < rows; ++row)
+    {
+        int cellRow = top + (int)row;
+        if (cellRow >= 0 && cellRow < (int)_cellHeight)
+        {
+            memcpy(&cell[cellRow * (cellWidth + GLYPH_ATLAS_PADDING)], &bitmap.buffer[row * bitmap.pitch], cellWidth);
+        }
+    }
+    _pages[page].texture->setData(x, y, cellWidth + GLYPH_ATLAS_PADDING, _cellHeight + GLYPH_ATLAS_PADDING, &cell[0]);
+
+    entry->page = page;
+    entry->glyph.width = cellWidth;
+    entry->glyph.uvs[0] = (float)x / _pageSize;
+    entry->glyph.uvs[1] = (float)y / _pageSize;
+    entry->glyph.uvs[2] = (float)(x + cellWidth) / _pageSize;
+    entry->glyph.uvs[3] = (float)(y + _cellHeight) / _pageSize;
+#endif
+}
+
+bool GlyphAtlas::allocate(unsigned int width, unsigned int height, unsigned int* page, unsigned int* x, unsigned int* y)
+{
+    for (unsigned int i = 0, count = _pages.size(); i < count; ++i)
+    {
+        if (allocate(_pages[i], width, height, x, y))
+        {
+            *page = i;
+            return true;
+        }
+    }
+
+    if (_pages.size() < _maxPageCount)
+    {
+        if (!addPage())
+        {
+            return false;
+        }
+        *page = _pages.size() - 1;
+        return allocate(_pages[*page], width, height, x, y);
+    }
+
+    // Evict the least recently drawn page, unless it was used in this frame: its glyphs
+    // may already be batched, or be part of the text being laid out.
+    unsigned int oldest = 0;
+    for (unsigned int i = 1, count = _pages.size(); i < count; ++i)
+    {
+        if (_pages[i].lastUsed < _pages[oldest].lastUsed)
+        {
+            oldest = i;
+        }
+    }
+    if (_pages[oldest].lastUsed == _frame)
+    {
+        return false;
+    }
+
+    clearPage(oldest);
+    *page = oldest;
+    return allocate(_pages[oldest], width, height, x, y);
+}
+
+bool GlyphAtlas::allocate(Page& page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y)
+{
+    // Find the position with the lowest top (then the leftmost one) where the rectangle
+    // rests on the skyline.
+    std::vector<Segment>& skyline = page.skyline;
+    unsigned int right = _pageSize - GLYPH_ATLAS_PADDING;
+    unsigned int bestIndex = skyline.size();
+    unsigned int bestY = _pageSize;
+    for (unsigned int i = 0, count = skyline.size(); i < count; ++i)
+    {
+        if (skyline[i].x + width > right)
+        {
+            break;
+        }
+
+        unsigned int top = 0;
+        for (unsigned int j = i, covered = 0; covered < width; covered += skyline[j].width, ++j)
+        {
+            top = std::max(top, skyline[j].y);
+        }
+        if (top + height <= _pageSize - GLYPH_ATLAS_PADDING && top < bestY)
+        {
+            bestIndex = i;
+            bestY = top;
+        }
+    }
+    if (bestIndex == skyline.size())
+    {
+        return false;
+    }
+
+    // Raise the skyline over the rectangle: shrink or remove the segments it covers.
+    Segment segment;
+    segment.x = skyline[bestIndex].x;
+    segment.y = bestY + height;
+    segment.width = width;
+    *x = segment.x;
+    *y = bestY;
+
+    unsigned int end = segment.x + width;
+    unsigned int i = bestIndex;
+    while (i < skyline.size() && skyline[i].x < end)
+    {
+        unsigned int segmentEnd = skyline[i].x + skyline[i].width;
+        if (segmentEnd <= end)
+        {
+            skyline.erase(skyline.begin() + i);
+        }
+        else
+        {
+            skyline[i].width = segmentEnd - end;
+            skyline[i].x = end;
+            break;
+        }
+    }
+    skyline.insert(skyline.begin() + bestIndex, segment);
+
+    // Merge neighbouring segments of the same height.
+    for (unsigned int j = 0; j + 1 < skyline.size(); )
+    {
+        if (skyline[j].y == skyline[j + 1].y)
+        {
+            skyline[j].width += skyline[j + 1].width;
+            skyline.erase(skyline.begin() + j + 1);
+        }
+        else
+        {
+            ++j;
+        }
+    }
+
+    return true;
+}
+
+bool GlyphAtlas::addPage()
+{
+    std::vector<unsigned char> data(_pageSize * _pageSize, 0);
+    Texture* texture = Texture::create(Texture::ALPHA, _pageSize, _pageSize, &data[0]);
+    if (texture == NULL)
+    {
+        return false;
+    }
+
+    SpriteBatch* batch = Font::createBatch(texture);
+    if (batch == NULL)
+    {
+        SAFE_RELEASE(texture);
+        return false;
+    }
+
+    Page page;
+    page.texture = texture;
+    page.batch = batch;
+    page.lastUsed = _frame;
+    resetSkyline(&page);
+    _pages.push_back(page);
+
+    // Pages added while drawing join the frame in progress.
+    if (_drawing)
+    {
+        batch->begin();
+    }
+
+    return true;
+}
+
+void GlyphAtlas::clearPage(unsigned int page)
+{
+    Page& p = _pages[page];
+    resetSkyline(&p);
+
+    // Zero the whole page so filtering never picks up stale glyphs.
+    std::vector<unsigned char> data(_pageSize * _pageSize, 0);
+    p.texture->setData(0, 0, _pageSize, _pageSize, &data[0]);
+
+    rehash(_entries.size(), page);
+    ++_version;
+}
+
+void GlyphAtlas::resetSkyline(Page* page)
+{
+    // Start the skyline below the padding, so that blank texels surround every glyph.
+    Segment segment;
+    segment.x = GLYPH_ATLAS_PADDING;
+    segment.y = GLYPH_ATLAS_PADDING;
+    segment.width = _pageSize - GLYPH_ATLAS_PADDING * 2;
+    page->skyline.clear();
+    page->skyline.push_back(segment);
+}
+
+}
@@ -0,0 +1,190 @@
+#ifndef GLYPHATLAS_H_
+#define GLYPHATLAS_H_
+
+#include "Font.h"
+
+// The code of unused hash table entries.
+#define GLYPH_ATLAS_EMPTY       0xFFFFFFFF
+
+// The page of glyphs with nothing to draw, such as spaces.
+#define GLYPH_ATLAS_NO_PAGE     0xFFFFFFFD
+
+// The page of characters the font has no glyph for.
+#define GLYPH_ATLAS_MISSING     0xFFFFFFFE
+
+namespace gameplay
+{
+
+/**
+ * Defines the glyph atlas of a font that rasterizes its glyphs at runtime.
+ *
+ * Glyphs are rasterized from a TrueType font the first time they are requested,
+ * and packed into the textures (pages) of the atlas with a skyline packer. Once all
+ * pages are full, the least recently drawn page that was not used in the current
+ * frame is cleared and reused, so the memory used by a font remains
+ * proportional to the glyphs that are actually displayed, rather than to the size
+ * of its character set.
+ *
+ * Glyphs are looked up by character code in an open addressing hash table, which
+ * also records the characters missing from the font so they are only looked up in
+ * the font file once.
+ *
+ * Rasterization uses FreeType, and requires gameplay to be built with
+ * GAMEPLAY_FREETYPE defined.
+ */
+class GlyphAtlas
+{
+    friend class Font;
+
+private:
+
+    struct Rasterizer;
+
+    /**
+     * A glyph of the hash table.
+     */
+    struct Entry
+    {
+        unsigned int code;      // The character code, or GLYPH_ATLAS_EMPTY for an unused entry.
+        unsigned int page;      // The page of the glyph, GLYPH_ATLAS_NO_PAGE for blank glyphs or GLYPH_ATLAS_MISSING.
+        Font::Glyph glyph;      // The glyph.
+    };
+
+    /**
+     * A horizontal segment of the skyline of a page.
+     */
+    struct Segment
+    {
+        unsigned int x;         // The left of the segment.
+        unsigned int y;         // The top of the free space above the segment.
+        unsigned int width;     // The width of the segment.
+    };
+
+    /**
+     * A page of the atlas.
+     */
+    struct Page
+    {
+        Texture* texture;               // The texture holding the glyphs of the page.
+        SpriteBatch* batch;             // The batch drawing the glyphs of the page.
+        std::vector<Segment> skyline;   // The skyline of the space used in the page, from left to right.
+        unsigned int lastUsed;          // The last frame glyphs of the page were drawn.
+    };
+
+    /**
+     * Constructor.
+     */
+    GlyphAtlas();
+
+    /**
+     * Hidden copy constructor.
+     */
+    GlyphAtlas(const GlyphAtlas& copy);
+
+    /**
+     * Destructor.
+     */
+    ~GlyphAtlas();
+
+    /**
+     * Creates an atlas for the TrueType font at the given path.
+     *
+     * @param path The path of the font file.
+     * @param size The size of the glyphs, in pixels.
+     * @param pageSize The width and height of the pages, in pixels.
+     * @param maxPageCount The maximum number of pages.
+     *
+     * @return The new atlas, or NULL if the font could not be loaded.
+     */
+    static GlyphAtlas* create(const char* path, unsigned int size, unsigned int pageSize, unsigned int maxPageCount);
+
+    /**
+     * Gets the glyph of the given character, rasterizing it if needed.
+     *
+     * @param code The character code.
+     * @param page Receives the page of the glyph, or GLYPH_ATLAS_NO_PAGE for glyphs with nothing to draw.
+     *
+     * @return The glyph, or NULL if the font has no glyph for the character or it could not be packed.
+     */
+    const Font::Glyph* getGlyph(unsigned int code, unsigned int* page);
+
+    /**
+     * Gets the batch drawing the glyphs of the given page, and marks the page as drawn in the current frame.
+     */
+    SpriteBatch* getBatch(unsigned int page);
+
+    /**
+     * Begins a frame of drawing.
+     */
+    void begin();
+
+    /**
+     * Ends a frame of drawing, drawing the batches of all pages.
+     */
+    void end();
+
+    /**
+     * Finds the entry of the given character, or the unused entry where it would be inserted.
+     */
+    Entry* findEntry(unsigned int code);
+
+    /**
+     * Inserts an entry in the hash table, growing it as needed.
+     */
+    void insertEntry(const Entry& entry);
+
+    /**
+     * Rebuilds the hash table with the given capacity, dropping the glyphs of the given page
+     * (GLYPH_ATLAS_EMPTY to keep all glyphs).
+     */
+    void rehash(unsigned int capacity, unsigned int droppedPage);
+
+    /**
+     * Rasterizes the glyph of the given character into the given entry, which must not be
+     * in the hash table. The code of the entry is set to GLYPH_ATLAS_EMPTY if the glyph
+     * could not be packed.
+     */
+    void rasterize(unsigned int code, Entry* entry);
+
+    /**
+     * Allocates a rectangle in the atlas, evicting a page if needed.
+     */
+    bool allocate(unsigned int width, unsigned int height, unsigned int* page, unsigned int* x, unsigned int* y);
+
+    /**
+     * Allocates a rectangle in the given page with the skyline bottom-left heuristic.
+     */
+    bool allocate(Page& page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y);
+
+    /**
+     * Adds a new, empty page to the atlas.
+     */
+    bool addPage();
+
+    /**
+     * Clears the given page, dropping its glyphs.
+     */
+    void clearPage(unsigned int page);
+
+    /**
+     * Resets the skyline of the given page to an empty page.
+     */
+    void resetSkyline(Page* page);
+
+    Rasterizer* _rasterizer;        // The FreeType face of the font.
+    unsigned int _ascender;         // The distance from the top of a glyph cell to the baseline, in pixels.
+    unsigned int _cellHeight;       // The height of a glyph cell, in pixels.
+    unsigned int _pageSize;         // The width and height of the pages, in pixels.
+    unsigned int _maxPageCount;     // The maximum number of pages.
+    std::vector<Page> _pages;       // The pages.
+    std::vector<Entry> _entries;    // The hash table of glyphs, with a power of two capacity.
+    unsigned int _entryCount;       // The number of used entries.
+    unsigned int _frame;            // The current frame, incremented by begin().
+    unsigned int _version;          // Incremented whenever glyphs are evicted.
+    bool _drawing;                  // Whether a frame is being drawn.
+    bool _full;                     // Whether the last glyph could not be added because every page was in use.
+};
+
+}
+
+#endif
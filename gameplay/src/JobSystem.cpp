@@ -0,0 +1,396 @@
+#include "Base.h"
+#include "JobSystem.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// The maximum number of worker threads started by the job system.
+#define JOB_SYSTEM_MAX_WORKERS 15
+
+// The size of a cache line, used to keep the item ranges of different threads apart.
+#define JOB_SYSTEM_CACHE_LINE_SIZE 64
+
+namespace gameplay
+{
+
+#ifdef WIN32
+
+typedef HANDLE JobThread;
+typedef CRITICAL_SECTION JobMutex;
+typedef CONDITION_VARIABLE JobCondition;
+
+static long atomicIncrement(volatile long* value) { return InterlockedIncrement(value); }
+static long atomicDecrement(volatile long* value) { return InterlockedDecrement(value); }
+static long atomicCompareExchange(volatile long* value, long exchange, long comparand) { return InterlockedCompareExchange(value, exchange, comparand); }
+static long long atomicCompareExchange64(volatile long long* value, long long exchange, long long comparand) { return InterlockedCompareExchange64(value, exchange, comparand); }
+static void mutexInitialize(JobMutex* mutex) { InitializeCriticalSection(mutex); }
+static void mutexFinalize(JobMutex* mutex) { DeleteCriticalSection(mutex); }
+static void mutexLock(JobMutex* mutex) { EnterCriticalSection(mutex); }
+static void mutexUnlock(JobMutex* mutex) { LeaveCriticalSection(mutex); }
+static void conditionInitialize(JobCondition* condition) { InitializeConditionVariable(condition); }
+static void conditionFinalize(JobCondition* condition) { }
+static void conditionWait(JobCondition* condition, JobMutex* mutex) { SleepConditionVariableCS(condition, mutex, INFINITE); }
+static void conditionBroadcast(JobCondition* condition) { WakeAllConditionVariable(condition); }
+
+static unsigned int getProcessorCount()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (unsigned int)info.dwNumberOfProcessors;
+}
+
+#else
+
+typedef pthread_t JobThread;
+typedef pthread_mutex_t JobMutex;
+typedef pthread_cond_t JobCondition;
+
+static long atomicIncrement(volatile long* value) { return __sync_add_and_fetch(value, 1); }
+static long atomicDecrement(volatile long* value) { return __sync_sub_and_fetch(value, 1); }
+static long atomicCompareExchange(volatile long* value, long exchange, long comparand) { return __sync_val_compare_and_swap(value, comparand, exchange); }
+static long long atomicCompareExchange64(volatile long long* value, long long exchange, long long comparand) { return __sync_val_compare_and_swap(value, comparand, exchange); }
+static void mutexInitialize(JobMutex* mutex) { pthread_mutex_init(mutex, NULL); }
+static void mutexFinalize(JobMutex* mutex) { pthread_mutex_destroy(mutex); }
+static void mutexLock(JobMutex* mutex) { pthread_mutex_lock(mutex); }
+static void mutexUnlock(JobMutex* mutex) { pthread_mutex_unlock(mutex); }
+static void conditionInitialize(JobCondition* condition) { pthread_cond_init(condition, NULL); }
+static void conditionFinalize(JobCondition* condition) { pthread_cond_destroy(condition); }
+static void conditionWait(JobCondition* condition, JobMutex* mutex) { pthread_cond_wait(condition, mutex); }
+static void conditionBroadcast(JobCondition* condition) { pthread_cond_broadcast(condition); }
+
+static unsigned int getProcessorCount()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned int)count : 1;
+}
+
+#endif
+
+struct JobSystem::Shared
+{
+    /**
+     * The items of a job not yet claimed by a thread, packed as (begin << 32) | end
+     * so that both bounds can be updated by a single compare-and-swap.
+     */
+    struct Range
+    {
+        volatile long long bounds;                                          // The packed [begin, end) range.
+        char padding[JOB_SYSTEM_CACHE_LINE_SIZE - sizeof(long long)];       // Keeps ranges on separate cache lines.
+    };
+
+    /**
+     * A job being executed by parallelFor.
+     *
+     * The items are split into one range per thread. Each thread claims items from
+     * the front of its own range, and once it runs out, steals the back half of the
+     * range of another thread. Threads therefore mostly touch their own cache line,
+     * and the load still balances when items take uneven amounts of time.
+     */
+    struct Job
+    {
+        Range ranges[JOB_SYSTEM_MAX_WORKERS + 1];   // The unclaimed items of each participating thread.
+        unsigned int rangeCount;                    // The number of ranges (the number of threads).
+        JobFunction function;                       // The function executed for each item.
+        void* data;                                 // The user data passed to the function.
+        volatile long remaining;                    // The number of items not yet completed.
+        volatile long joined;                       // The number of ranges assigned to a thread.
+        unsigned int workers;                       // The number of worker threads currently executing items of this job.
+    };
+
+    JobMutex mutex;                                 // Guards the members below.
+    JobCondition wake;                              // Signalled when a job is submitted or the workers must exit.
+    JobCondition done;                              // Signalled when the last item or worker of a job completes.
+    JobThread threads[JOB_SYSTEM_MAX_WORKERS];      // The worker threads.
+    Job* job;                                       // The job accepting workers, or NULL.
+    unsigned int generation;                        // Incremented each time a job is submitted.
+    bool exit;                                      // Set when the workers must exit.
+
+    static long long pack(unsigned int begin, unsigned int end)
+    {
+        return (long long)(((unsigned long long)begin << 32) | end);
+    }
+
+    static unsigned int getBegin(long long bounds)
+    {
+        return (unsigned int)((unsigned long long)bounds >> 32);
+    }
+
+    static unsigned int getEnd(long long bounds)
+    {
+        return (unsigned int)((unsigned long long)bounds & 0xFFFFFFFF);
+    }
+
+    /**
+     * Claims the first item of the given range.
+     */
+    static bool claim(Range* range, unsigned int* index)
+    {
+        while (true)
+        {
+            long long bounds = range->bounds;
+            unsigned int begin = getBegin(bounds);
+            unsigned int end = getEnd(bounds);
+            if (begin >= end)
+                return false;
+
+            if (atomicCompareExchange64(&range->bounds, pack(begin + 1, end), bounds) == bounds)
+            {
+                *index = begin;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Moves the back half of the range of another thread into the (empty) range of the given thread.
+     */
+    static bool steal(Job* job, unsigned int thief)
+    {
+        for (unsigned int i = 1; i < job->rangeCount; ++i)
+        {
+            Range* victim = &job->ranges[(thief + i) % job->rangeCount];
+            while (true)
+            {
+                long long bounds = victim->bounds;
+                unsigned int begin = getBegin(bounds);
+                unsigned int end = getEnd(bounds);
+                if (begin >= end)
+                    break;
+
+                unsigned int middle = end - (end - begin + 1) / 2;
+                if (atomicCompareExchange64(&victim->bounds, pack(begin, middle), bounds) == bounds)
+                {
+                    // Our range is empty, so other threads leave it alone while we refill it.
+                    Range* range = &job->ranges[thief];
+                    long long empty = range->bounds;
+                    atomicCompareExchange64(&range->bounds, pack(middle, end), empty);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Executes items of the given job, starting with the given range, until none remain to be claimed.
+     */
+    void execute(Job* job, unsigned int rangeIndex)
+    {
+        Range* range = &job->ranges[rangeIndex];
+        unsigned int index;
+        while (true)
+        {
+            if (!claim(range, &index))
+            {
+                if (!steal(job, rangeIndex))
+                    break;
+                continue;
+            }
+
+            job->function(job->data, index);
+
+            if (atomicDecrement(&job->remaining) == 0)
+            {
+                mutexLock(&mutex);
+                conditionBroadcast(&done);
+                mutexUnlock(&mutex);
+            }
+        }
+    }
+
+    /**
+     * Worker thread loop.
+     */
+    void run()
+    {
+        unsigned int generation = 0;
+
+        mutexLock(&mutex);
+        while (true)
+        {
+            while (!exit && this->generation == generation)
+            {
+                conditionWait(&wake, &mutex);
+            }
+            if (exit)
+                break;
+
+            // A worker waking up after the job has completed simply goes back to sleep.
+            generation = this->generation;
+            Job* current = job;
+            if (current)
+            {
+                ++current->workers;
+                mutexUnlock(&mutex);
+
+                // Each worker joins a job at most once, so there is always a range left for it.
+                unsigned int rangeIndex = (unsigned int)atomicIncrement(&current->joined) - 1;
+                assert(rangeIndex < current->rangeCount);
+                execute(current, rangeIndex);
+
+                mutexLock(&mutex);
+                if (--current->workers == 0)
+                {
+                    conditionBroadcast(&done);
+                }
+            }
+        }
+        mutexUnlock(&mutex);
+    }
+
+#ifdef WIN32
+    static DWORD WINAPI threadMain(LPVOID shared)
+    {
+        ((Shared*)shared)->run();
+        return 0;
+    }
+#else
+    static void* threadMain(void* shared)
+    {
+        ((Shared*)shared)->run();
+        return NULL;
+    }
+#endif
+};
+
+JobSystem::JobSystem()
+    : _shared(NULL), _workerCount(0), _busy(0)
+{
+}
+
+JobSystem::JobSystem(const JobSystem& copy)
+{
+    // hidden
+}
+
+JobSystem::~JobSystem()
+{
+    finalize();
+}
+
+void JobSystem::initialize()
+{
+    if (_shared)
+        return;
+
+    _shared = new Shared();
+    mutexInitialize(&_shared->mutex);
+    conditionInitialize(&_shared->wake);
+    conditionInitialize(&_shared->done);
+    _shared->job = NULL;
+    _shared->generation = 0;
+    _shared->exit = false;
+
+    // The thread calling parallelFor executes items too, so leave one processor for it.
+    unsigned int workerCount = getProcessorCount() - 1;
+    if (workerCount > JOB_SYSTEM_MAX_WORKERS)
+        workerCount = JOB_SYSTEM_MAX_WORKERS;
+
+    for (_workerCount = 0; _workerCount < workerCount; ++_workerCount)
+    {
+#ifdef WIN32
+        HANDLE thread = CreateThread(NULL, 0, Shared::threadMain, _shared, 0, NULL);
+        if (thread == NULL)
+        {
+            WARN_VARG("Failed to create job system worker thread %u.", _workerCount);
+            break;
+        }
+        _shared->threads[_workerCount] = thread;
+#else
+        if (pthread_create(&_shared->threads[_workerCount], NULL, Shared::threadMain, _shared) != 0)
+        {
+            WARN_VARG("Failed to create job system worker thread %u.", _workerCount);
+            break;
+        }
+#endif
+    }
+}
+
+void JobSystem::finalize()
+{
+    if (!_shared)
+        return;
+
+    mutexLock(&_shared->mutex);
+    _shared->exit = true;
+    conditionBroadcast(&_shared->wake);
+    mutexUnlock(&_shared->mutex);
+
+    for (unsigned int i = 0; i < _workerCount; ++i)
+    {
+#ifdef WIN32
+        WaitForSingleObject(_shared->threads[i], INFINITE);
+        CloseHandle(_shared->threads[i]);
+#else
+        pthread_join(_shared->threads[i], NULL);
+#endif
+    }
+    _workerCount = 0;
+
+    conditionFinalize(&_shared->done);
+    conditionFinalize(&_shared->wake);
+    mutexFinalize(&_shared->mutex);
+    SAFE_DELETE(_shared);
+}
+
+unsigned int JobSystem::getWorkerCount() const
+{
+    return _workerCount;
+}
+
+void JobSystem::parallelFor(unsigned int count, JobFunction function, void* data)
+{
+    assert(function);
+
+    // Execute serially when there is nothing to share out, or when another job
+    // (possibly the one calling us) already owns the workers.
+    if (count < 2 || _workerCount == 0 || atomicCompareExchange(&_busy, 1, 0) != 0)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            function(data, i);
+        }
+        return;
+    }
+
+    // Split the items evenly between the calling thread (range 0) and the workers.
+    Shared::Job job;
+    job.rangeCount = _workerCount + 1;
+    for (unsigned int i = 0; i < job.rangeCount; ++i)
+    {
+        unsigned int begin = (unsigned int)((unsigned long long)count * i / job.rangeCount);
+        unsigned int end = (unsigned int)((unsigned long long)count * (i + 1) / job.rangeCount);
+        job.ranges[i].bounds = Shared::pack(begin, end);
+    }
+    job.function = function;
+    job.data = data;
+    job.remaining = (long)count;
+    job.joined = 1;
+    job.workers = 0;
+
+    mutexLock(&_shared->mutex);
+    _shared->job = &job;
+    ++_shared->generation;
+    conditionBroadcast(&_shared->wake);
+    mutexUnlock(&_shared->mutex);
+
+    _shared->execute(&job, 0);
+
+    // Wait for the items claimed by workers to complete, and for the workers
+    // to let go of the job before it goes out of scope.
+    mutexLock(&_shared->mutex);
+    _shared->job = NULL;
+    while (job.remaining > 0 || job.workers > 0)
+    {
+        conditionWait(&_shared->done, &_shared->mutex);
+    }
+    mutexUnlock(&_shared->mutex);
+
+    atomicDecrement(&_busy);
+}
+
+}
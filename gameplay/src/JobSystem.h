@@ -0,0 +1,94 @@
+#ifndef JOBSYSTEM_H_
+#define JOBSYSTEM_H_
+
+namespace gameplay
+{
+
+/**
+ * Defines a pool of worker threads used to spread independent pieces of
+ * engine work across the available processor cores.
+ *
+ * Work is submitted as a job function together with a number of items. The
+ * calling thread takes part in executing the items and does not return until
+ * all of them have completed, so callers never observe partially finished work.
+ *
+ * The items of a job are split evenly between the participating threads, and
+ * a thread that finishes its share steals half of the remaining items of
+ * another thread, so uneven items still keep every core busy.
+ */
+class JobSystem
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Defines the function executed for each item of a job.
+     *
+     * @param data The user data passed to parallelFor.
+     * @param index The index of the item to execute, in the range [0, count).
+     */
+    typedef void (*JobFunction)(void* data, unsigned int index);
+
+    /**
+     * Gets the number of worker threads owned by the job system.
+     *
+     * The thread calling parallelFor executes items as well, so up to
+     * getWorkerCount() + 1 items may execute concurrently.
+     *
+     * @return The number of worker threads.
+     */
+    unsigned int getWorkerCount() const;
+
+    /**
+     * Executes the given function once for every index in [0, count), spreading
+     * the items across the worker threads and the calling thread.
+     *
+     * The items are executed in no particular order and must be independent of
+     * each other. This method blocks until all items have been executed. Calls
+     * made while another job is running (including from within a job function)
+     * execute their items serially on the calling thread.
+     *
+     * @param count The number of items to execute.
+     * @param function The function to execute for each item.
+     * @param data User data passed to each invocation of function.
+     */
+    void parallelFor(unsigned int count, JobFunction function, void* data);
+
+private:
+
+    struct Shared;
+
+    /**
+     * Constructor.
+     */
+    JobSystem();
+
+    /**
+     * Constructor.
+     */
+    JobSystem(const JobSystem& copy);
+
+    /**
+     * Destructor.
+     */
+    ~JobSystem();
+
+    /**
+     * Starts the worker threads.
+     */
+    void initialize();
+
+    /**
+     * Stops and joins the worker threads.
+     */
+    void finalize();
+
+    Shared* _shared;                // Threads and synchronization state shared with the workers.
+    unsigned int _workerCount;      // The number of worker threads.
+    volatile long _busy;            // Non-zero while a job is being executed.
+};
+
+}
+
+#endif
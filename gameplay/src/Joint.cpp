@@ -6,7 +6,7 @@ namespace gameplay
 {
 
 Joint::Joint(const char* id)
-    : Node(id), _jointMatrixDirty(true), _skinCount(0)
+    : Node(id), _jointMatrixVersion(1), _bindPoseVersion(1), _skinCount(0), _animationImportance(1.0f)
 {
 }
 
@@ -24,30 +24,23 @@ Node::Type Joint::getType() const
     return Node::JOINT;
 }
 
-void Joint::transformChanged()
+void Joint::setAnimationImportance(float importance)
 {
-    Node::transformChanged();
-    _jointMatrixDirty = true;
+    _animationImportance = importance;
 }
 
-void Joint::updateJointMatrix(const Matrix& bindShape, Vector4* matrixPalette)
+float Joint::getAnimationImportance() const
 {
-    // Note: If more than one MeshSkin influences this Joint, we need to skip
-    // the _jointMatrixDirty optimization since updateJointMatrix() may be
-    // called multiple times a frame with different bindShape matrices (and
-    // different matrixPallete pointers).
-    if (_skinCount > 1 || _jointMatrixDirty)
-    {
-        _jointMatrixDirty = false;
+    return _animationImportance;
+}
 
-        static Matrix t;
-        Matrix::multiply(Node::getWorldMatrix(), getInverseBindPose(), &t);
-        Matrix::multiply(t, bindShape, &t);
+void Joint::transformChanged()
+{
+    Node::transformChanged();
 
-        matrixPalette[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
-        matrixPalette[1].set(t.m[1], t.m[5], t.m[9], t.m[13]);
-        matrixPalette[2].set(t.m[2], t.m[6], t.m[10], t.m[14]);
-    }
+    // Each skin compares this version with the one its palette was computed from,
+    // so that joints shared by several skins are still only recomputed when they move.
+    ++_jointMatrixVersion;
 }
 
 const Matrix& Joint::getInverseBindPose() const
@@ -58,7 +51,7 @@ const Matrix& Joint::getInverseBindPose() const
 void Joint::setInverseBindPose(const Matrix& m)
 {
     _bindPose = m;
-    _jointMatrixDirty = true;
+    ++_bindPoseVersion;
 }
 
 }
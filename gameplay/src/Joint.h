@@ -32,6 +32,24 @@ public:
      */
     const Matrix& getInverseBindPose() const;
 
+    /**
+     * Sets the importance of this joint for animation level of detail.
+     *
+     * When the skin of a leaf joint (a joint without child joints) is animated at a
+     * reduced rate, the joint is no longer animated if its importance is lower than
+     * the minimum importance of the skin (see MeshSkin::setAnimationLod).
+     *
+     * @param importance The importance of the joint. The default is 1.
+     */
+    void setAnimationImportance(float importance);
+
+    /**
+     * Gets the importance of this joint for animation level of detail.
+     *
+     * @return The importance of the joint.
+     */
+    float getAnimationImportance() const;
+
 protected:
 
     /**
@@ -60,13 +78,13 @@ protected:
      */
     void setInverseBindPose(const Matrix& m);
 
-    void updateJointMatrix(const Matrix& bindShape, Vector4* matrixPalette);
-
     void transformChanged();
 
     Matrix _bindPose;
-    bool _jointMatrixDirty;
+    unsigned int _jointMatrixVersion;
+    unsigned int _bindPoseVersion;
     unsigned int _skinCount;
+    float _animationImportance;
 };
 
 }
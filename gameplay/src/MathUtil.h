@@ -0,0 +1,175 @@
+#ifndef MATHUTIL_H_
+#define MATHUTIL_H_
+
+// Select the vector instruction set used by the math kernels at compile time.
+// Define GAMEPLAY_MATH_NO_SIMD to force the portable scalar implementation.
+#ifndef GAMEPLAY_MATH_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAMEPLAY_MATH_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define GAMEPLAY_MATH_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace gameplay
+{
+
+/**
+ * Defines the low level math kernels shared by the math classes.
+ *
+ * The kernels operate on raw float arrays so that each platform can provide an
+ * implementation using its vector instruction set (SSE2 or NEON), falling back
+ * to a portable scalar implementation everywhere else. Matrices are column-major
+ * arrays of 16 floats and quaternions are arrays of 4 floats stored as x, y, z, w.
+ * Arrays are not required to be 16 byte aligned.
+ */
+class MathUtil
+{
+    friend class Matrix;
+    friend class Quaternion;
+    friend class AnimationPose;
+    friend class MeshSkin;
+    friend class SkinnedMesh;
+    friend class ParticleEmitter;
+    friend class MathUtilTest;
+
+private:
+
+    /**
+     * Multiplies the matrices m1 and m2 and stores the result in dst.
+     *
+     * dst may be the same array as m1 or m2.
+     */
+    inline static void multiplyMatrix(const float* m1, const float* m2, float* dst);
+
+    /**
+     * Multiplies the matrices m1 and m2 and stores the first three rows of the
+     * result in dst (12 floats), which is the layout of a skinning palette matrix.
+     *
+     * dst must not be the same array as m1 or m2.
+     */
+    inline static void multiplyMatrixRows(const float* m1, const float* m2, float* dst);
+
+    /**
+     * Inverts the matrix m and stores the result in dst.
+     *
+     * dst may be the same array as m. dst is not modified when m cannot be inverted.
+     *
+     * @return true if the matrix can be inverted, false otherwise.
+     */
+    inline static bool invertMatrix(const float* m, float* dst);
+
+    /**
+     * Transforms the 4-component vector (x, y, z, w) by the matrix m and stores
+     * the 4-component result in dst.
+     */
+    inline static void transformVector4(const float* m, float x, float y, float z, float w, float* dst);
+
+    /**
+     * Computes alpha * q1 + beta * q2 and corrects the length of the result to one
+     * using a single Newton iteration, which is the blend step of Quaternion::slerp.
+     *
+     * dst may be the same array as q1 or q2.
+     */
+    inline static void blendQuaternion(const float* q1, float alpha, const float* q2, float beta, float* dst);
+
+    /**
+     * Adds weight * v to the 4-component vector sum.
+     */
+    inline static void accumulateVector4(const float* v, float weight, float* sum);
+
+    /**
+     * Adds weight * q to the quaternion sum, negating q first if it lies in the
+     * opposite hemisphere from sum, so that the normalized sum is a weighted nlerp.
+     */
+    inline static void accumulateQuaternion(const float* q, float weight, float* sum);
+
+    /**
+     * Skins a vertex influenced by four joints of a matrix palette.
+     *
+     * The palette matrices are blended by weight, and the blended matrix transforms
+     * the position (x, y, z, 1) and the directions (normal, tangent, binormal) as
+     * (x, y, z, 0), exactly like the MATRIX_PALETTE skinning path of the shaders.
+     *
+     * @param palette The matrix palette, three rows of 4 floats per joint.
+     * @param rows The index of the first palette row of each of the four joints.
+     * @param weights The 4 blend weights.
+     * @param position The 4-component position.
+     * @param directions The 4-component directions, one after the other.
+     * @param directionCount The number of directions (up to 3).
+     * @param dstPosition The 3 floats receiving the skinned position.
+     * @param dstDirections The 3 floats receiving each skinned direction.
+     */
+    inline static void skinVertex(const float* palette, const unsigned int* rows, const float* weights, const float* position,
+                                  const float* directions, unsigned int directionCount, float* dstPosition, float* const* dstDirections);
+
+    /**
+     * Adds scale * src[i] to dst[i] for each element of the arrays.
+     *
+     * count must be a multiple of 4.
+     */
+    inline static void addScaledArray(const float* src, float scale, float* dst, unsigned int count);
+
+    /**
+     * Computes start[i] + delta[i] * t[i] for each element of the arrays and stores it in dst[i].
+     *
+     * count must be a multiple of 4.
+     */
+    inline static void lerpArray(const float* start, const float* delta, const float* t, float* dst, unsigned int count);
+
+    /**
+     * Subtracts elapsed from each remaining energy, and stores the fraction of the initial
+     * energy that was spent, 1 - energy[i] * energyInverse[i], in percent[i].
+     *
+     * count must be a multiple of 4.
+     */
+    inline static void spendEnergyArray(float* energy, const float* energyInverse, float elapsed, float* percent, unsigned int count);
+
+    /**
+     * Advances each frame that is not the last frame by one when the fraction percent[i]
+     * has passed the end of the frame, frames being percentPerFrame long.
+     *
+     * count must be a multiple of 4.
+     */
+    inline static void advanceFrameArray(const float* percent, float percentPerFrame, unsigned int lastFrame,
+                                         unsigned int* frames, unsigned int count);
+
+    /**
+     * Adds elapsed to the time spent on each frame, and advances the frame by one when that
+     * time reaches duration, wrapping to the first frame after frameCount frames.
+     *
+     * count must be a multiple of 4.
+     */
+    inline static void advanceLoopedFrameArray(float* time, float elapsed, float duration, unsigned int frameCount,
+                                               unsigned int* frames, unsigned int count);
+
+    /**
+     * Generates uniformly distributed random floats in [0, 1) with four xorshift generators,
+     * one per vector lane: dst[i] is produced by the generator i % 4, so the sequence is the
+     * same with every implementation.
+     *
+     * @param state The 4 states of the generators, which must not be zero.
+     * @param dst The array receiving the random floats.
+     * @param count The number of floats to generate, a multiple of 4.
+     */
+    inline static void randomArray(unsigned int* state, float* dst, unsigned int count);
+
+    /**
+     * Hidden constructor.
+     */
+    MathUtil();
+};
+
+}
+
+#if defined(GAMEPLAY_MATH_SSE)
+#include "MathUtilSSE.inl"
+#elif defined(GAMEPLAY_MATH_NEON)
+#include "MathUtilNeon.inl"
+#else
+#include "MathUtil.inl"
+#endif
+
+#endif
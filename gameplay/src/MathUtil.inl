@@ -0,0 +1,244 @@
+namespace gameplay
+{
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+    // Support the case where m1 or m2 is the same array as dst.
+    float product[16];
+
+    product[0]  = m1[0] * m2[0]  + m1[4] * m2[1]  + m1[8]  * m2[2]  + m1[12] * m2[3];
+    product[1]  = m1[1] * m2[0]  + m1[5] * m2[1]  + m1[9]  * m2[2]  + m1[13] * m2[3];
+    product[2]  = m1[2] * m2[0]  + m1[6] * m2[1]  + m1[10] * m2[2]  + m1[14] * m2[3];
+    product[3]  = m1[3] * m2[0]  + m1[7] * m2[1]  + m1[11] * m2[2]  + m1[15] * m2[3];
+
+    product[4]  = m1[0] * m2[4]  + m1[4] * m2[5]  + m1[8]  * m2[6]  + m1[12] * m2[7];
+    product[5]  = m1[1] * m2[4]  + m1[5] * m2[5]  + m1[9]  * m2[6]  + m1[13] * m2[7];
+    product[6]  = m1[2] * m2[4]  + m1[6] * m2[5]  + m1[10] * m2[6]  + m1[14] * m2[7];
+    product[7]  = m1[3] * m2[4]  + m1[7] * m2[5]  + m1[11] * m2[6]  + m1[15] * m2[7];
+
+    product[8]  = m1[0] * m2[8]  + m1[4] * m2[9]  + m1[8]  * m2[10] + m1[12] * m2[11];
+    product[9]  = m1[1] * m2[8]  + m1[5] * m2[9]  + m1[9]  * m2[10] + m1[13] * m2[11];
+    product[10] = m1[2] * m2[8]  + m1[6] * m2[9]  + m1[10] * m2[10] + m1[14] * m2[11];
+    product[11] = m1[3] * m2[8]  + m1[7] * m2[9]  + m1[11] * m2[10] + m1[15] * m2[11];
+
+    product[12] = m1[0] * m2[12] + m1[4] * m2[13] + m1[8]  * m2[14] + m1[12] * m2[15];
+    product[13] = m1[1] * m2[12] + m1[5] * m2[13] + m1[9]  * m2[14] + m1[13] * m2[15];
+    product[14] = m1[2] * m2[12] + m1[6] * m2[13] + m1[10] * m2[14] + m1[14] * m2[15];
+    product[15] = m1[3] * m2[12] + m1[7] * m2[13] + m1[11] * m2[14] + m1[15] * m2[15];
+
+    memcpy(dst, product, sizeof(float) * 16);
+}
+
+inline void MathUtil::multiplyMatrixRows(const float* m1, const float* m2, float* dst)
+{
+    for (unsigned int row = 0; row < 3; ++row)
+    {
+        for (unsigned int column = 0; column < 4; ++column)
+        {
+            const float* v = &m2[column * 4];
+            dst[row * 4 + column] = m1[row] * v[0] + m1[row + 4] * v[1] + m1[row + 8] * v[2] + m1[row + 12] * v[3];
+        }
+    }
+}
+
+inline bool MathUtil::invertMatrix(const float* m, float* dst)
+{
+    float a0 = m[0] * m[5] - m[1] * m[4];
+    float a1 = m[0] * m[6] - m[2] * m[4];
+    float a2 = m[0] * m[7] - m[3] * m[4];
+    float a3 = m[1] * m[6] - m[2] * m[5];
+    float a4 = m[1] * m[7] - m[3] * m[5];
+    float a5 = m[2] * m[7] - m[3] * m[6];
+    float b0 = m[8] * m[13] - m[9] * m[12];
+    float b1 = m[8] * m[14] - m[10] * m[12];
+    float b2 = m[8] * m[15] - m[11] * m[12];
+    float b3 = m[9] * m[14] - m[10] * m[13];
+    float b4 = m[9] * m[15] - m[11] * m[13];
+    float b5 = m[10] * m[15] - m[11] * m[14];
+
+    // Calculate the determinant.
+    float det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+
+    // Close to zero, can't invert.
+    if (fabs(det) <= MATH_TOLERANCE)
+        return false;
+
+    // Support the case where m == dst.
+    float inverse[16];
+    inverse[0]  = m[5] * b5 - m[6] * b4 + m[7] * b3;
+    inverse[1]  = -m[1] * b5 + m[2] * b4 - m[3] * b3;
+    inverse[2]  = m[13] * a5 - m[14] * a4 + m[15] * a3;
+    inverse[3]  = -m[9] * a5 + m[10] * a4 - m[11] * a3;
+
+    inverse[4]  = -m[4] * b5 + m[6] * b2 - m[7] * b1;
+    inverse[5]  = m[0] * b5 - m[2] * b2 + m[3] * b1;
+    inverse[6]  = -m[12] * a5 + m[14] * a2 - m[15] * a1;
+    inverse[7]  = m[8] * a5 - m[10] * a2 + m[11] * a1;
+
+    inverse[8]  = m[4] * b4 - m[5] * b2 + m[7] * b0;
+    inverse[9]  = -m[0] * b4 + m[1] * b2 - m[3] * b0;
+    inverse[10] = m[12] * a4 - m[13] * a2 + m[15] * a0;
+    inverse[11] = -m[8] * a4 + m[9] * a2 - m[11] * a0;
+
+    inverse[12] = -m[4] * b3 + m[5] * b1 - m[6] * b0;
+    inverse[13] = m[0] * b3 - m[1] * b1 + m[2] * b0;
+    inverse[14] = -m[12] * a3 + m[13] * a1 - m[14] * a0;
+    inverse[15] = m[8] * a3 - m[9] * a1 + m[10] * a0;
+
+    float invDet = 1.0f / det;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        dst[i] = inverse[i] * invDet;
+    }
+
+    return true;
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    dst[0] = x * m[0] + y * m[4] + z * m[8] + w * m[12];
+    dst[1] = x * m[1] + y * m[5] + z * m[9] + w * m[13];
+    dst[2] = x * m[2] + y * m[6] + z * m[10] + w * m[14];
+    dst[3] = x * m[3] + y * m[7] + z * m[11] + w * m[15];
+}
+
+inline void MathUtil::blendQuaternion(const float* q1, float alpha, const float* q2, float beta, float* dst)
+{
+    float x = alpha * q1[0] + beta * q2[0];
+    float y = alpha * q1[1] + beta * q2[1];
+    float z = alpha * q1[2] + beta * q2[2];
+    float w = alpha * q1[3] + beta * q2[3];
+
+    float f = 1.5f - 0.5f * (w * w + x * x + y * y + z * z);
+    dst[0] = x * f;
+    dst[1] = y * f;
+    dst[2] = z * f;
+    dst[3] = w * f;
+}
+
+inline void MathUtil::accumulateVector4(const float* v, float weight, float* sum)
+{
+    sum[0] += weight * v[0];
+    sum[1] += weight * v[1];
+    sum[2] += weight * v[2];
+    sum[3] += weight * v[3];
+}
+
+inline void MathUtil::accumulateQuaternion(const float* q, float weight, float* sum)
+{
+    if (sum[0] * q[0] + sum[1] * q[1] + sum[2] * q[2] + sum[3] * q[3] < 0.0f)
+        weight = -weight;
+
+    sum[0] += weight * q[0];
+    sum[1] += weight * q[1];
+    sum[2] += weight * q[2];
+    sum[3] += weight * q[3];
+}
+
+inline void MathUtil::skinVertex(const float* palette, const unsigned int* rows, const float* weights, const float* position,
+                                 const float* directions, unsigned int directionCount, float* dstPosition, float* const* dstDirections)
+{
+    float m[12];
+    for (unsigned int i = 0; i < 12; ++i)
+    {
+        m[i] = 0.0f;
+    }
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+        const float* joint = &palette[rows[j] * 4];
+        float w = weights[j];
+        for (unsigned int i = 0; i < 12; ++i)
+        {
+            m[i] += joint[i] * w;
+        }
+    }
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        const float* row = &m[i * 4];
+        dstPosition[i] = row[0] * position[0] + row[1] * position[1] + row[2] * position[2] + row[3] * position[3];
+    }
+
+    for (unsigned int d = 0; d < directionCount; ++d)
+    {
+        const float* direction = &directions[d * 4];
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            const float* row = &m[i * 4];
+            dstDirections[d][i] = row[0] * direction[0] + row[1] * direction[1] + row[2] * direction[2];
+        }
+    }
+}
+
+inline void MathUtil::addScaledArray(const float* src, float scale, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] += src[i] * scale;
+    }
+}
+
+inline void MathUtil::lerpArray(const float* start, const float* delta, const float* t, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i] = start[i] + delta[i] * t[i];
+    }
+}
+
+inline void MathUtil::spendEnergyArray(float* energy, const float* energyInverse, float elapsed, float* percent, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        energy[i] -= elapsed;
+        percent[i] = 1.0f - energy[i] * energyInverse[i];
+    }
+}
+
+inline void MathUtil::advanceFrameArray(const float* percent, float percentPerFrame, unsigned int lastFrame,
+                                        unsigned int* frames, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (frames[i] < lastFrame && percent[i] - (float)frames[i] * percentPerFrame >= percentPerFrame)
+            ++frames[i];
+    }
+}
+
+inline void MathUtil::advanceLoopedFrameArray(float* time, float elapsed, float duration, unsigned int frameCount,
+                                              unsigned int* frames, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        time[i] += elapsed;
+        if (time[i] >= duration)
+        {
+            time[i] -= duration;
+            if (++frames[i] == frameCount)
+                frames[i] = 0;
+        }
+    }
+}
+
+inline void MathUtil::randomArray(unsigned int* state, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int x = state[i & 3];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state[i & 3] = x;
+
+        // Use the high 23 bits as the mantissa of a float in [1, 2).
+        union
+        {
+            unsigned int i;
+            float f;
+        } bits;
+        bits.i = (x >> 9) | 0x3F800000;
+        dst[i] = bits.f - 1.0f;
+    }
+}
+
+}
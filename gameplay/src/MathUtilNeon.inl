@@ -0,0 +1,274 @@
+namespace gameplay
+{
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+    float32x4_t c0 = vld1q_f32(&m1[0]);
+    float32x4_t c1 = vld1q_f32(&m1[4]);
+    float32x4_t c2 = vld1q_f32(&m1[8]);
+    float32x4_t c3 = vld1q_f32(&m1[12]);
+
+    // Load all of m2 before storing to support the case where m1 or m2 is the same array as dst.
+    float32x4_t v[4] = { vld1q_f32(&m2[0]), vld1q_f32(&m2[4]), vld1q_f32(&m2[8]), vld1q_f32(&m2[12]) };
+    float32x4_t product[4];
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        float32x2_t low = vget_low_f32(v[i]);
+        float32x2_t high = vget_high_f32(v[i]);
+        float32x4_t r = vmulq_lane_f32(c0, low, 0);
+        r = vmlaq_lane_f32(r, c1, low, 1);
+        r = vmlaq_lane_f32(r, c2, high, 0);
+        product[i] = vmlaq_lane_f32(r, c3, high, 1);
+    }
+
+    vst1q_f32(&dst[0], product[0]);
+    vst1q_f32(&dst[4], product[1]);
+    vst1q_f32(&dst[8], product[2]);
+    vst1q_f32(&dst[12], product[3]);
+}
+
+inline void MathUtil::multiplyMatrixRows(const float* m1, const float* m2, float* dst)
+{
+    float32x4_t c0 = vld1q_f32(&m1[0]);
+    float32x4_t c1 = vld1q_f32(&m1[4]);
+    float32x4_t c2 = vld1q_f32(&m1[8]);
+    float32x4_t c3 = vld1q_f32(&m1[12]);
+
+    float32x4x4_t product;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        float32x4_t v = vld1q_f32(&m2[i * 4]);
+        float32x2_t low = vget_low_f32(v);
+        float32x2_t high = vget_high_f32(v);
+        float32x4_t r = vmulq_lane_f32(c0, low, 0);
+        r = vmlaq_lane_f32(r, c1, low, 1);
+        r = vmlaq_lane_f32(r, c2, high, 0);
+        product.val[i] = vmlaq_lane_f32(r, c3, high, 1);
+    }
+
+    // Interleaving the columns of the product stores it transposed, as rows.
+    float rows[16];
+    vst4q_f32(rows, product);
+    memcpy(dst, rows, sizeof(float) * 12);
+}
+
+inline bool MathUtil::invertMatrix(const float* m, float* dst)
+{
+    float a0 = m[0] * m[5] - m[1] * m[4];
+    float a1 = m[0] * m[6] - m[2] * m[4];
+    float a2 = m[0] * m[7] - m[3] * m[4];
+    float a3 = m[1] * m[6] - m[2] * m[5];
+    float a4 = m[1] * m[7] - m[3] * m[5];
+    float a5 = m[2] * m[7] - m[3] * m[6];
+    float b0 = m[8] * m[13] - m[9] * m[12];
+    float b1 = m[8] * m[14] - m[10] * m[12];
+    float b2 = m[8] * m[15] - m[11] * m[12];
+    float b3 = m[9] * m[14] - m[10] * m[13];
+    float b4 = m[9] * m[15] - m[11] * m[13];
+    float b5 = m[10] * m[15] - m[11] * m[14];
+
+    // Calculate the determinant.
+    float det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+
+    // Close to zero, can't invert.
+    if (fabs(det) <= MATH_TOLERANCE)
+        return false;
+
+    // Compute the adjugate one column (four cofactors) at a time.
+    float32x4_t ab0 = { b5, -b5, a5, -a5 };
+    float32x4_t ab1 = { b4, -b4, a4, -a4 };
+    float32x4_t ab2 = { b3, -b3, a3, -a3 };
+    float32x4_t ab3 = { b2, -b2, a2, -a2 };
+    float32x4_t ab4 = { b1, -b1, a1, -a1 };
+    float32x4_t ab5 = { b0, -b0, a0, -a0 };
+
+    float32x4_t r0 = { m[5], m[1], m[13], m[9] };
+    float32x4_t r1 = { m[6], m[2], m[14], m[10] };
+    float32x4_t r2 = { m[7], m[3], m[15], m[11] };
+    float32x4_t r3 = { m[4], m[0], m[12], m[8] };
+
+    float32x4_t col0 = vmulq_f32(r0, ab0);
+    col0 = vmlsq_f32(col0, r1, ab1);
+    col0 = vmlaq_f32(col0, r2, ab2);
+
+    float32x4_t col1 = vmulq_f32(r1, ab3);
+    col1 = vmlsq_f32(col1, r2, ab4);
+    col1 = vmlsq_f32(col1, r3, ab0);
+
+    float32x4_t col2 = vmulq_f32(r3, ab1);
+    col2 = vmlsq_f32(col2, r0, ab3);
+    col2 = vmlaq_f32(col2, r2, ab5);
+
+    float32x4_t col3 = vmulq_f32(r0, ab4);
+    col3 = vmlsq_f32(col3, r3, ab2);
+    col3 = vmlsq_f32(col3, r1, ab5);
+
+    float32x4_t invDet = vdupq_n_f32(1.0f / det);
+    vst1q_f32(&dst[0], vmulq_f32(col0, invDet));
+    vst1q_f32(&dst[4], vmulq_f32(col1, invDet));
+    vst1q_f32(&dst[8], vmulq_f32(col2, invDet));
+    vst1q_f32(&dst[12], vmulq_f32(col3, invDet));
+
+    return true;
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    float32x4_t r = vmulq_n_f32(vld1q_f32(&m[0]), x);
+    r = vmlaq_n_f32(r, vld1q_f32(&m[4]), y);
+    r = vmlaq_n_f32(r, vld1q_f32(&m[8]), z);
+    r = vmlaq_n_f32(r, vld1q_f32(&m[12]), w);
+    vst1q_f32(dst, r);
+}
+
+inline void MathUtil::blendQuaternion(const float* q1, float alpha, const float* q2, float beta, float* dst)
+{
+    float32x4_t q = vmulq_n_f32(vld1q_f32(q1), alpha);
+    q = vmlaq_n_f32(q, vld1q_f32(q2), beta);
+
+    float32x4_t lengthSq = vmulq_f32(q, q);
+    float32x2_t sum = vadd_f32(vget_low_f32(lengthSq), vget_high_f32(lengthSq));
+    sum = vpadd_f32(sum, sum);
+
+    float32x4_t f = vmlsq_n_f32(vdupq_n_f32(1.5f), vcombine_f32(sum, sum), 0.5f);
+    vst1q_f32(dst, vmulq_f32(q, f));
+}
+
+inline void MathUtil::accumulateVector4(const float* v, float weight, float* sum)
+{
+    vst1q_f32(sum, vmlaq_n_f32(vld1q_f32(sum), vld1q_f32(v), weight));
+}
+
+inline void MathUtil::accumulateQuaternion(const float* q, float weight, float* sum)
+{
+    float32x4_t a = vld1q_f32(sum);
+    float32x4_t b = vld1q_f32(q);
+
+    float32x4_t product = vmulq_f32(a, b);
+    float32x2_t dot = vadd_f32(vget_low_f32(product), vget_high_f32(product));
+    dot = vpadd_f32(dot, dot);
+
+    if (vget_lane_f32(dot, 0) < 0.0f)
+        weight = -weight;
+
+    vst1q_f32(sum, vmlaq_n_f32(a, b, weight));
+}
+
+inline void MathUtil::skinVertex(const float* palette, const unsigned int* rows, const float* weights, const float* position,
+                                 const float* directions, unsigned int directionCount, float* dstPosition, float* const* dstDirections)
+{
+    float32x4_t r0 = vdupq_n_f32(0.0f);
+    float32x4_t r1 = vdupq_n_f32(0.0f);
+    float32x4_t r2 = vdupq_n_f32(0.0f);
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+        const float* joint = &palette[rows[j] * 4];
+        r0 = vmlaq_n_f32(r0, vld1q_f32(&joint[0]), weights[j]);
+        r1 = vmlaq_n_f32(r1, vld1q_f32(&joint[4]), weights[j]);
+        r2 = vmlaq_n_f32(r2, vld1q_f32(&joint[8]), weights[j]);
+    }
+
+    float32x4_t p = vld1q_f32(position);
+    float32x4_t x = vmulq_f32(r0, p);
+    float32x4_t y = vmulq_f32(r1, p);
+    float32x4_t z = vmulq_f32(r2, p);
+    float32x2_t xy = vpadd_f32(vadd_f32(vget_low_f32(x), vget_high_f32(x)), vadd_f32(vget_low_f32(y), vget_high_f32(y)));
+    float32x2_t zz = vadd_f32(vget_low_f32(z), vget_high_f32(z));
+    vst1_f32(dstPosition, xy);
+    dstPosition[2] = vget_lane_f32(zz, 0) + vget_lane_f32(zz, 1);
+
+    for (unsigned int d = 0; d < directionCount; ++d)
+    {
+        // Clear the w component so that the translation column does not contribute.
+        float32x4_t n = vsetq_lane_f32(0.0f, vld1q_f32(&directions[d * 4]), 3);
+        x = vmulq_f32(r0, n);
+        y = vmulq_f32(r1, n);
+        z = vmulq_f32(r2, n);
+        xy = vpadd_f32(vadd_f32(vget_low_f32(x), vget_high_f32(x)), vadd_f32(vget_low_f32(y), vget_high_f32(y)));
+        zz = vadd_f32(vget_low_f32(z), vget_high_f32(z));
+        float* dstDirection = dstDirections[d];
+        vst1_f32(dstDirection, xy);
+        dstDirection[2] = vget_lane_f32(zz, 0) + vget_lane_f32(zz, 1);
+    }
+}
+
+inline void MathUtil::addScaledArray(const float* src, float scale, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        vst1q_f32(&dst[i], vmlaq_n_f32(vld1q_f32(&dst[i]), vld1q_f32(&src[i]), scale));
+    }
+}
+
+inline void MathUtil::lerpArray(const float* start, const float* delta, const float* t, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        vst1q_f32(&dst[i], vmlaq_f32(vld1q_f32(&start[i]), vld1q_f32(&delta[i]), vld1q_f32(&t[i])));
+    }
+}
+
+inline void MathUtil::spendEnergyArray(float* energy, const float* energyInverse, float elapsed, float* percent, unsigned int count)
+{
+    float32x4_t e = vdupq_n_f32(elapsed);
+    float32x4_t one = vdupq_n_f32(1.0f);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        float32x4_t r = vsubq_f32(vld1q_f32(&energy[i]), e);
+        vst1q_f32(&energy[i], r);
+        vst1q_f32(&percent[i], vmlsq_f32(one, r, vld1q_f32(&energyInverse[i])));
+    }
+}
+
+inline void MathUtil::advanceFrameArray(const float* percent, float percentPerFrame, unsigned int lastFrame,
+                                        unsigned int* frames, unsigned int count)
+{
+    float32x4_t p = vdupq_n_f32(percentPerFrame);
+    uint32x4_t last = vdupq_n_u32(lastFrame);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        uint32x4_t f = vld1q_u32(&frames[i]);
+        float32x4_t spent = vmulq_f32(vcvtq_f32_u32(f), p);
+        uint32x4_t advance = vandq_u32(vcgeq_f32(vsubq_f32(vld1q_f32(&percent[i]), spent), p), vcltq_u32(f, last));
+
+        // The mask of advancing lanes is all ones, so subtracting it increments them.
+        vst1q_u32(&frames[i], vsubq_u32(f, advance));
+    }
+}
+
+inline void MathUtil::advanceLoopedFrameArray(float* time, float elapsed, float duration, unsigned int frameCount,
+                                              unsigned int* frames, unsigned int count)
+{
+    float32x4_t e = vdupq_n_f32(elapsed);
+    float32x4_t d = vdupq_n_f32(duration);
+    uint32x4_t n = vdupq_n_u32(frameCount);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        float32x4_t t = vaddq_f32(vld1q_f32(&time[i]), e);
+        uint32x4_t advance = vcgeq_f32(t, d);
+        vst1q_f32(&time[i], vsubq_f32(t, vreinterpretq_f32_u32(vandq_u32(advance, vreinterpretq_u32_f32(d)))));
+
+        uint32x4_t f = vsubq_u32(vld1q_u32(&frames[i]), advance);
+        vst1q_u32(&frames[i], vbicq_u32(f, vceqq_u32(f, n)));
+    }
+}
+
+inline void MathUtil::randomArray(unsigned int* state, float* dst, unsigned int count)
+{
+    uint32x4_t x = vld1q_u32(state);
+    uint32x4_t exponent = vdupq_n_u32(0x3F800000);
+    float32x4_t one = vdupq_n_f32(1.0f);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        x = veorq_u32(x, vshlq_n_u32(x, 13));
+        x = veorq_u32(x, vshrq_n_u32(x, 17));
+        x = veorq_u32(x, vshlq_n_u32(x, 5));
+
+        // Use the high 23 bits as the mantissa of a float in [1, 2).
+        uint32x4_t bits = vorrq_u32(vshrq_n_u32(x, 9), exponent);
+        vst1q_f32(&dst[i], vsubq_f32(vreinterpretq_f32_u32(bits), one));
+    }
+    vst1q_u32(state, x);
+}
+
+}
@@ -0,0 +1,312 @@
+namespace gameplay
+{
+
+// Shuffles the components (x, y, z, w) of a and b into (a[x], a[y], b[z], b[w]).
+#define MATHUTIL_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE((w), (z), (y), (x)))
+
+// Multiplies the 2x2 matrices a and b stored as (m00, m01, m10, m11).
+inline static __m128 mathUtilMat2Mul(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, MATHUTIL_SHUFFLE(b, b, 0, 3, 0, 3)),
+                      _mm_mul_ps(MATHUTIL_SHUFFLE(a, a, 1, 0, 3, 2), MATHUTIL_SHUFFLE(b, b, 2, 1, 2, 1)));
+}
+
+// Multiplies the adjugate of the 2x2 matrix a with the 2x2 matrix b.
+inline static __m128 mathUtilMat2AdjMul(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(MATHUTIL_SHUFFLE(a, a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(MATHUTIL_SHUFFLE(a, a, 1, 1, 2, 2), MATHUTIL_SHUFFLE(b, b, 2, 3, 0, 1)));
+}
+
+// Multiplies the 2x2 matrix a with the adjugate of the 2x2 matrix b.
+inline static __m128 mathUtilMat2MulAdj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, MATHUTIL_SHUFFLE(b, b, 3, 0, 3, 0)),
+                      _mm_mul_ps(MATHUTIL_SHUFFLE(a, a, 1, 0, 3, 2), MATHUTIL_SHUFFLE(b, b, 2, 1, 2, 1)));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m1[0]);
+    __m128 c1 = _mm_loadu_ps(&m1[4]);
+    __m128 c2 = _mm_loadu_ps(&m1[8]);
+    __m128 c3 = _mm_loadu_ps(&m1[12]);
+
+    // Load all of m2 before storing to support the case where m1 or m2 is the same array as dst.
+    __m128 v[4] = { _mm_loadu_ps(&m2[0]), _mm_loadu_ps(&m2[4]), _mm_loadu_ps(&m2[8]), _mm_loadu_ps(&m2[12]) };
+    __m128 product[4];
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        __m128 r = _mm_mul_ps(c0, MATHUTIL_SHUFFLE(v[i], v[i], 0, 0, 0, 0));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, MATHUTIL_SHUFFLE(v[i], v[i], 1, 1, 1, 1)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, MATHUTIL_SHUFFLE(v[i], v[i], 2, 2, 2, 2)));
+        product[i] = _mm_add_ps(r, _mm_mul_ps(c3, MATHUTIL_SHUFFLE(v[i], v[i], 3, 3, 3, 3)));
+    }
+
+    _mm_storeu_ps(&dst[0], product[0]);
+    _mm_storeu_ps(&dst[4], product[1]);
+    _mm_storeu_ps(&dst[8], product[2]);
+    _mm_storeu_ps(&dst[12], product[3]);
+}
+
+inline void MathUtil::multiplyMatrixRows(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(&m1[0]);
+    __m128 c1 = _mm_loadu_ps(&m1[4]);
+    __m128 c2 = _mm_loadu_ps(&m1[8]);
+    __m128 c3 = _mm_loadu_ps(&m1[12]);
+
+    __m128 product[4];
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        __m128 v = _mm_loadu_ps(&m2[i * 4]);
+        __m128 r = _mm_mul_ps(c0, MATHUTIL_SHUFFLE(v, v, 0, 0, 0, 0));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, MATHUTIL_SHUFFLE(v, v, 1, 1, 1, 1)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, MATHUTIL_SHUFFLE(v, v, 2, 2, 2, 2)));
+        product[i] = _mm_add_ps(r, _mm_mul_ps(c3, MATHUTIL_SHUFFLE(v, v, 3, 3, 3, 3)));
+    }
+
+    // Transpose the columns of the product into rows.
+    _MM_TRANSPOSE4_PS(product[0], product[1], product[2], product[3]);
+
+    _mm_storeu_ps(&dst[0], product[0]);
+    _mm_storeu_ps(&dst[4], product[1]);
+    _mm_storeu_ps(&dst[8], product[2]);
+}
+
+inline bool MathUtil::invertMatrix(const float* m, float* dst)
+{
+    // Block-wise inversion of the matrix partitioned into the 2x2 sub-matrices
+    // A B / C D, using the adjugate of each 2x2 block instead of its inverse.
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+
+    __m128 a = _mm_movelh_ps(c0, c1);
+    __m128 b = _mm_movehl_ps(c1, c0);
+    __m128 c = _mm_movelh_ps(c2, c3);
+    __m128 d = _mm_movehl_ps(c3, c2);
+
+    // Determinants of the four blocks (|A|, |B|, |C|, |D|).
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(MATHUTIL_SHUFFLE(c0, c2, 0, 2, 0, 2), MATHUTIL_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+        _mm_mul_ps(MATHUTIL_SHUFFLE(c0, c2, 1, 3, 1, 3), MATHUTIL_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+    __m128 detA = MATHUTIL_SHUFFLE(detSub, detSub, 0, 0, 0, 0);
+    __m128 detB = MATHUTIL_SHUFFLE(detSub, detSub, 1, 1, 1, 1);
+    __m128 detC = MATHUTIL_SHUFFLE(detSub, detSub, 2, 2, 2, 2);
+    __m128 detD = MATHUTIL_SHUFFLE(detSub, detSub, 3, 3, 3, 3);
+
+    __m128 dc = mathUtilMat2AdjMul(d, c);
+    __m128 ab = mathUtilMat2AdjMul(a, b);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mathUtilMat2Mul(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mathUtilMat2Mul(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mathUtilMat2MulAdj(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mathUtilMat2MulAdj(a, dc));
+
+    // |M| = |A|*|D| + |B|*|C| - tr((A#B)(D#C))
+    __m128 det = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+    __m128 tr = _mm_mul_ps(ab, MATHUTIL_SHUFFLE(dc, dc, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, MATHUTIL_SHUFFLE(tr, tr, 2, 3, 0, 1));
+    tr = _mm_add_ps(tr, MATHUTIL_SHUFFLE(tr, tr, 1, 0, 3, 2));
+    det = _mm_sub_ps(det, tr);
+
+    // Close to zero, can't invert.
+    if (fabs(_mm_cvtss_f32(det)) <= MATH_TOLERANCE)
+        return false;
+
+    __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    x = _mm_mul_ps(x, invDet);
+    y = _mm_mul_ps(y, invDet);
+    z = _mm_mul_ps(z, invDet);
+    w = _mm_mul_ps(w, invDet);
+
+    _mm_storeu_ps(&dst[0], MATHUTIL_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(&dst[4], MATHUTIL_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(&dst[8], MATHUTIL_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(&dst[12], MATHUTIL_SHUFFLE(z, w, 2, 0, 2, 0));
+
+    return true;
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_set1_ps(x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[4]), _mm_set1_ps(y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[8]), _mm_set1_ps(z)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[12]), _mm_set1_ps(w)));
+    _mm_storeu_ps(dst, r);
+}
+
+inline void MathUtil::blendQuaternion(const float* q1, float alpha, const float* q2, float beta, float* dst)
+{
+    __m128 q = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(q1), _mm_set1_ps(alpha)),
+                          _mm_mul_ps(_mm_loadu_ps(q2), _mm_set1_ps(beta)));
+
+    __m128 lengthSq = _mm_mul_ps(q, q);
+    lengthSq = _mm_add_ps(lengthSq, MATHUTIL_SHUFFLE(lengthSq, lengthSq, 2, 3, 0, 1));
+    lengthSq = _mm_add_ps(lengthSq, MATHUTIL_SHUFFLE(lengthSq, lengthSq, 1, 0, 3, 2));
+
+    __m128 f = _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_set1_ps(0.5f), lengthSq));
+    _mm_storeu_ps(dst, _mm_mul_ps(q, f));
+}
+
+inline void MathUtil::accumulateVector4(const float* v, float weight, float* sum)
+{
+    _mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), _mm_mul_ps(_mm_loadu_ps(v), _mm_set1_ps(weight))));
+}
+
+inline void MathUtil::accumulateQuaternion(const float* q, float weight, float* sum)
+{
+    __m128 a = _mm_loadu_ps(sum);
+    __m128 b = _mm_loadu_ps(q);
+
+    __m128 dot = _mm_mul_ps(a, b);
+    dot = _mm_add_ps(dot, MATHUTIL_SHUFFLE(dot, dot, 2, 3, 0, 1));
+    dot = _mm_add_ps(dot, MATHUTIL_SHUFFLE(dot, dot, 1, 0, 3, 2));
+
+    // Negate the weight where the dot product is negative. The sign bit of the dot
+    // product alone would also negate it for -0.
+    __m128 negative = _mm_cmplt_ps(dot, _mm_setzero_ps());
+    __m128 w = _mm_xor_ps(_mm_set1_ps(weight), _mm_and_ps(negative, _mm_set1_ps(-0.0f)));
+    _mm_storeu_ps(sum, _mm_add_ps(a, _mm_mul_ps(b, w)));
+}
+
+inline void MathUtil::skinVertex(const float* palette, const unsigned int* rows, const float* weights, const float* position,
+                                 const float* directions, unsigned int directionCount, float* dstPosition, float* const* dstDirections)
+{
+    __m128 w = _mm_loadu_ps(weights);
+    __m128 r0 = _mm_setzero_ps();
+    __m128 r1 = _mm_setzero_ps();
+    __m128 r2 = _mm_setzero_ps();
+    __m128 r3 = _mm_setzero_ps();
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+        const float* joint = &palette[rows[j] * 4];
+        __m128 wj;
+        switch (j)
+        {
+        case 0: wj = MATHUTIL_SHUFFLE(w, w, 0, 0, 0, 0); break;
+        case 1: wj = MATHUTIL_SHUFFLE(w, w, 1, 1, 1, 1); break;
+        case 2: wj = MATHUTIL_SHUFFLE(w, w, 2, 2, 2, 2); break;
+        default: wj = MATHUTIL_SHUFFLE(w, w, 3, 3, 3, 3); break;
+        }
+        r0 = _mm_add_ps(r0, _mm_mul_ps(_mm_loadu_ps(&joint[0]), wj));
+        r1 = _mm_add_ps(r1, _mm_mul_ps(_mm_loadu_ps(&joint[4]), wj));
+        r2 = _mm_add_ps(r2, _mm_mul_ps(_mm_loadu_ps(&joint[8]), wj));
+    }
+
+    // Transpose the blended rows into columns, so that vectors are transformed with
+    // multiply-adds instead of horizontal dot products.
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    float result[4];
+    __m128 p = _mm_loadu_ps(position);
+    __m128 v = _mm_mul_ps(r0, MATHUTIL_SHUFFLE(p, p, 0, 0, 0, 0));
+    v = _mm_add_ps(v, _mm_mul_ps(r1, MATHUTIL_SHUFFLE(p, p, 1, 1, 1, 1)));
+    v = _mm_add_ps(v, _mm_mul_ps(r2, MATHUTIL_SHUFFLE(p, p, 2, 2, 2, 2)));
+    v = _mm_add_ps(v, _mm_mul_ps(r3, MATHUTIL_SHUFFLE(p, p, 3, 3, 3, 3)));
+    _mm_storeu_ps(result, v);
+    dstPosition[0] = result[0];
+    dstPosition[1] = result[1];
+    dstPosition[2] = result[2];
+
+    for (unsigned int d = 0; d < directionCount; ++d)
+    {
+        __m128 n = _mm_loadu_ps(&directions[d * 4]);
+        v = _mm_mul_ps(r0, MATHUTIL_SHUFFLE(n, n, 0, 0, 0, 0));
+        v = _mm_add_ps(v, _mm_mul_ps(r1, MATHUTIL_SHUFFLE(n, n, 1, 1, 1, 1)));
+        v = _mm_add_ps(v, _mm_mul_ps(r2, MATHUTIL_SHUFFLE(n, n, 2, 2, 2, 2)));
+        _mm_storeu_ps(result, v);
+        float* dstDirection = dstDirections[d];
+        dstDirection[0] = result[0];
+        dstDirection[1] = result[1];
+        dstDirection[2] = result[2];
+    }
+}
+
+inline void MathUtil::addScaledArray(const float* src, float scale, float* dst, unsigned int count)
+{
+    __m128 s = _mm_set1_ps(scale);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        _mm_storeu_ps(&dst[i], _mm_add_ps(_mm_loadu_ps(&dst[i]), _mm_mul_ps(_mm_loadu_ps(&src[i]), s)));
+    }
+}
+
+inline void MathUtil::lerpArray(const float* start, const float* delta, const float* t, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        _mm_storeu_ps(&dst[i], _mm_add_ps(_mm_loadu_ps(&start[i]), _mm_mul_ps(_mm_loadu_ps(&delta[i]), _mm_loadu_ps(&t[i]))));
+    }
+}
+
+inline void MathUtil::spendEnergyArray(float* energy, const float* energyInverse, float elapsed, float* percent, unsigned int count)
+{
+    __m128 e = _mm_set1_ps(elapsed);
+    __m128 one = _mm_set1_ps(1.0f);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        __m128 r = _mm_sub_ps(_mm_loadu_ps(&energy[i]), e);
+        _mm_storeu_ps(&energy[i], r);
+        _mm_storeu_ps(&percent[i], _mm_sub_ps(one, _mm_mul_ps(r, _mm_loadu_ps(&energyInverse[i]))));
+    }
+}
+
+inline void MathUtil::advanceFrameArray(const float* percent, float percentPerFrame, unsigned int lastFrame,
+                                        unsigned int* frames, unsigned int count)
+{
+    // Frame indices are small, so they are compared as signed integers.
+    __m128 p = _mm_set1_ps(percentPerFrame);
+    __m128i last = _mm_set1_epi32((int)lastFrame);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        __m128i f = _mm_loadu_si128((const __m128i*)&frames[i]);
+        __m128 spent = _mm_mul_ps(_mm_cvtepi32_ps(f), p);
+        __m128i advance = _mm_and_si128(_mm_castps_si128(_mm_cmpge_ps(_mm_sub_ps(_mm_loadu_ps(&percent[i]), spent), p)),
+                                        _mm_cmplt_epi32(f, last));
+
+        // The mask of advancing lanes is -1, so subtracting it increments them.
+        _mm_storeu_si128((__m128i*)&frames[i], _mm_sub_epi32(f, advance));
+    }
+}
+
+inline void MathUtil::advanceLoopedFrameArray(float* time, float elapsed, float duration, unsigned int frameCount,
+                                              unsigned int* frames, unsigned int count)
+{
+    __m128 e = _mm_set1_ps(elapsed);
+    __m128 d = _mm_set1_ps(duration);
+    __m128i n = _mm_set1_epi32((int)frameCount);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        __m128 t = _mm_add_ps(_mm_loadu_ps(&time[i]), e);
+        __m128 advance = _mm_cmpge_ps(t, d);
+        _mm_storeu_ps(&time[i], _mm_sub_ps(t, _mm_and_ps(advance, d)));
+
+        __m128i f = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)&frames[i]), _mm_castps_si128(advance));
+        _mm_storeu_si128((__m128i*)&frames[i], _mm_andnot_si128(_mm_cmpeq_epi32(f, n), f));
+    }
+}
+
+inline void MathUtil::randomArray(unsigned int* state, float* dst, unsigned int count)
+{
+    __m128i x = _mm_loadu_si128((const __m128i*)state);
+    __m128i exponent = _mm_set1_epi32(0x3F800000);
+    __m128 one = _mm_set1_ps(1.0f);
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+
+        // Use the high 23 bits as the mantissa of a float in [1, 2).
+        __m128i bits = _mm_or_si128(_mm_srli_epi32(x, 9), exponent);
+        _mm_storeu_ps(&dst[i], _mm_sub_ps(_mm_castsi128_ps(bits), one));
+    }
+    _mm_storeu_si128((__m128i*)state, x);
+}
+
+#undef MATHUTIL_SHUFFLE
+
+}
@@ -1,12 +1,23 @@
 #include "Base.h"
 #include "MeshBatch.h"
+#include "StreamBuffer.h"
+
+// The number of full batches held by the rings of a streaming batch, so that
+// they only wrap around and orphan their buffers once every few batches.
+#define MESH_BATCH_STREAM_RING_SIZE 4
+
+// The maximum number of vertices in the ring of a streaming batch, so that indices
+// offset to the start of the batch in the ring fit in 16 bits.
+#define MESH_BATCH_MAX_STREAM_VERTICES 65536
 
 namespace gameplay
 {
 
-MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize)
+MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize,
+                     bool streaming)
     : _vertexFormat(vertexFormat), _primitiveType(primitiveType), _material(material), _indexed(indexed), _capacity(0), _growSize(growSize),
-      _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL)
+      _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL),
+      _streaming(streaming), _vertexStream(NULL), _indexStream(NULL), _indexBase(0)
 {
     resize(initialCapacity);
 }
@@ -22,26 +33,37 @@ MeshBatch::~MeshBatch()
     SAFE_RELEASE(_material);
     SAFE_DELETE_ARRAY(_vertices);
     SAFE_DELETE_ARRAY(_indices);
+    SAFE_DELETE(_vertexStream);
+    SAFE_DELETE(_indexStream);
 }
 
-MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, const char* materialPath, bool indexed, unsigned int initialCapacity, unsigned int growSize)
+MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, const char* materialPath, bool indexed, unsigned int initialCapacity, unsigned int growSize,
+                             bool streaming)
 {
     Material* material = Material::create(materialPath);
     if (material == NULL)
         return NULL;
-    MeshBatch* batch = create(vertexFormat, primitiveType, material, indexed, initialCapacity, growSize);
+    MeshBatch* batch = create(vertexFormat, primitiveType, material, indexed, initialCapacity, growSize, streaming);
     SAFE_RELEASE(material); // batch now owns the material
     return batch;
 }
 
-MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize)
+MeshBatch* MeshBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize,
+                             bool streaming)
 {
     assert(material);
 
-    MeshBatch* batch = new MeshBatch(vertexFormat, primitiveType, material, indexed, initialCapacity, growSize);
+    MeshBatch* batch = new MeshBatch(vertexFormat, primitiveType, material, indexed, initialCapacity, growSize, streaming);
 
     material->addRef();
 
+    if (streaming && (batch->_vertexStream == NULL || (indexed && batch->_indexStream == NULL)))
+    {
+        LOG_ERROR("Failed to create stream buffers for mesh batch.");
+        SAFE_DELETE(batch);
+        return NULL;
+    }
+
     return batch;
 }
 
@@ -54,7 +76,11 @@ void MeshBatch::updateVertexAttributeBinding()
         for (unsigned int j = 0, passCount = t->getPassCount(); j < passCount; ++j)
         {
             Pass* p = t->getPass(j);
-            VertexAttributeBinding* b = VertexAttributeBinding::create(_vertexFormat, _vertices, p->getEffect());
+            VertexAttributeBinding* b;
+            if (_vertexStream)
+                b = VertexAttributeBinding::create(_vertexStream->getHandle(), _vertexFormat, p->getEffect());
+            else
+                b = VertexAttributeBinding::create(_vertexFormat, _vertices, p->getEffect());
             p->setVertexAttributeBinding(b);
             SAFE_RELEASE(b);
         }
@@ -112,6 +138,39 @@ bool MeshBatch::resize(unsigned int capacity)
     // for now, which is the same number of vertices as indices.
     unsigned int indexCapacity = vertexCapacity;
 
+    if (_streaming)
+    {
+        // Size the rings for several batches, and keep the current batch in them.
+        unsigned int vertexRingCapacity = std::min(vertexCapacity * MESH_BATCH_STREAM_RING_SIZE, (unsigned int)MESH_BATCH_MAX_STREAM_VERTICES);
+        unsigned int indexRingCapacity = indexCapacity * MESH_BATCH_STREAM_RING_SIZE;
+        if (_vertexStream == NULL)
+        {
+            _vertexStream = StreamBuffer::create(GL_ARRAY_BUFFER, _vertexFormat.getVertexSize(), vertexRingCapacity);
+            if (_vertexStream == NULL)
+                return false;
+
+            // The vertex buffer never changes, so the bindings are only created once.
+            updateVertexAttributeBinding();
+        }
+        else if (!_vertexStream->setCapacity(vertexRingCapacity))
+        {
+            return false;
+        }
+        if (_indexed)
+        {
+            if (_indexStream == NULL)
+                _indexStream = StreamBuffer::create(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned short), indexRingCapacity);
+            if (_indexStream == NULL || !_indexStream->setCapacity(indexRingCapacity))
+                return false;
+        }
+
+        _capacity = capacity;
+        _vertexCapacity = vertexCapacity;
+        _indexCapacity = indexCapacity;
+
+        return true;
+    }
+
     assert(indexCapacity <= USHRT_MAX);
     if (indexCapacity > USHRT_MAX)
         return false;
@@ -152,12 +211,111 @@ bool MeshBatch::resize(unsigned int capacity)
     return true;
 }
 
+unsigned char* MeshBatch::append(unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
+{
+    unsigned int newVertexCount = _vertexCount + vertexCount;
+    unsigned int newIndexCount = _indexCount + indexCount;
+    if (_primitiveType == Mesh::TRIANGLE_STRIP && _vertexCount > 0)
+        newIndexCount += 2; // need an extra 2 indices for connecting strips with degenerate triangles
+
+    unsigned char* vertexData;
+    unsigned short* indexData = NULL;
+    if (_vertexStream)
+    {
+        if (newVertexCount > MESH_BATCH_MAX_STREAM_VERTICES)
+            return NULL; // indices would overflow, just clip batch
+
+        // Do we need to grow the rings?
+        while (newVertexCount > _vertexStream->getCapacity() || (_indexed && newIndexCount > _indexStream->getCapacity()))
+        {
+            if (_growSize == 0)
+                return NULL; // growing disabled, just clip batch
+            if (!resize(_capacity + _growSize))
+                return NULL; // failed to grow
+        }
+
+        // Write straight into the rings.
+        vertexData = _vertexStream->append(vertexCount);
+        if (_indexed)
+        {
+            indexData = (unsigned short*)_indexStream->append(newIndexCount - _indexCount);
+
+            // Indices are offset to the start of the batch in the vertex ring, so offset
+            // the indices already added again if the batch moved within the ring.
+            unsigned int indexBase = _vertexStream->getStart();
+            if (indexBase != _indexBase)
+            {
+                unsigned short* batchIndices = (unsigned short*)_indexStream->getData();
+                for (unsigned int i = 0; i < _indexCount; ++i)
+                {
+                    batchIndices[i] = batchIndices[i] - _indexBase + indexBase;
+                }
+                _indexBase = indexBase;
+                _indexStream->invalidate();
+            }
+        }
+    }
+    else
+    {
+        // Do we need to grow the batch?
+        while (newVertexCount > _vertexCapacity || (_indexed && newIndexCount > _indexCapacity))
+        {
+            if (_growSize == 0)
+                return NULL; // growing disabled, just clip batch
+            if (!resize(_capacity + _growSize))
+                return NULL; // failed to grow
+        }
+
+        vertexData = _verticesPtr;
+        _verticesPtr += vertexCount * _vertexFormat.getVertexSize();
+        if (_indexed)
+        {
+            indexData = _indicesPtr;
+            _indicesPtr += newIndexCount - _indexCount;
+        }
+    }
+
+    // Copy index data
+    if (_indexed)
+    {
+        unsigned int base = _indexBase + _vertexCount;
+        if (_primitiveType == Mesh::TRIANGLE_STRIP && _vertexCount > 0)
+        {
+            // Create a degenerate triangle to connect separate triangle strips
+            // by duplicating the previous and next vertices.
+            indexData[0] = *(indexData-1);
+            indexData[1] = base;
+            indexData += 2;
+        }
+
+        // Loop through all indices and insert them, their their value offset by
+        // 'vertexCount' so that they are relative to the first newly insertted vertex
+        for (unsigned int i = 0; i < indexCount; ++i)
+        {
+            indexData[i] = indices[i] + base;
+        }
+        _indexCount = newIndexCount;
+    }
+
+    _vertexCount = newVertexCount;
+
+    return vertexData;
+}
+
 void MeshBatch::begin()
 {
     _vertexCount = 0;
     _indexCount = 0;
     _verticesPtr = _vertices;
     _indicesPtr = _indices;
+
+    if (_vertexStream)
+    {
+        _vertexStream->begin();
+        if (_indexStream)
+            _indexStream->begin();
+        _indexBase = _vertexStream->getStart();
+    }
 }
 
 void MeshBatch::end()
@@ -169,9 +327,19 @@ void MeshBatch::draw()
     if (_vertexCount == 0 || (_indexed && _indexCount == 0))
         return; // nothing to draw
 
-    // Not using VBOs, so unbind the element array buffer.
-    // ARRAY_BUFFER will be unbound automatically during pass->bind().
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0 ) );
+    if (_vertexStream)
+    {
+        // Upload what was added since the last draw.
+        _vertexStream->upload();
+        if (_indexStream)
+            _indexStream->upload();
+    }
+    else
+    {
+        // Not using VBOs, so unbind the element array buffer.
+        // ARRAY_BUFFER will be unbound automatically during pass->bind().
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0 ) );
+    }
 
     // Bind the material
     Technique* technique = _material->getTechnique();
@@ -181,17 +349,29 @@ void MeshBatch::draw()
         Pass* pass = technique->getPass(i);
         pass->bind();
 
-        if (_indexed)
+        if (_indexStream)
+        {
+            // Bound after the pass, since the element array buffer is part of the state of VAOs.
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexStream->getHandle()) );
+            GL_ASSERT( glDrawElements(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)(_indexStream->getStart() * sizeof(unsigned short))) );
+        }
+        else if (_indexed)
         {
             GL_ASSERT( glDrawElements(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)_indices) );
         }
         else
         {
-            GL_ASSERT( glDrawArrays(_primitiveType, 0, _vertexCount) );
+            GL_ASSERT( glDrawArrays(_primitiveType, _vertexStream ? _vertexStream->getStart() : 0, _vertexCount) );
         }
 
         pass->unbind();
     }
+
+    if (_vertexStream)
+    {
+        GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+    }
 }
 
 }
@@ -7,8 +7,21 @@
 namespace gameplay
 {
 
+class StreamBuffer;
+
+/**
+ * Defines a batch of primitives that are added every frame and drawn together.
+ *
+ * By default, a batch keeps its primitives in client memory, and draws them with
+ * client-side vertex arrays. A streaming batch instead writes them straight into rings
+ * of GPU buffers, which are uploaded as the batch is drawn, and orphaned whenever a
+ * ring wraps around. Its storage is allocated once for several batches worth of
+ * primitives, so it only grows if a single batch outgrows it.
+ */
 class MeshBatch
 {
+    friend class SpriteBatch;
+
 public:
 
     /**
@@ -20,10 +33,12 @@ public:
      * @param indexed True if the batched primivites will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
      * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param streaming True to stream the batched primitives through GPU buffers, false to draw them from client memory.
      *
      * @return A new mesh batch.
      */
-    static MeshBatch* create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, const char* materialPath, bool indexed, unsigned int initialCapacity = 1024, unsigned int growSize = 1024);
+    static MeshBatch* create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, const char* materialPath, bool indexed, unsigned int initialCapacity = 1024, unsigned int growSize = 1024,
+                             bool streaming = false);
 
     /**
      * Creates a new mesh batch.
@@ -34,10 +49,12 @@ public:
      * @param indexed True if the batched primivites will contain index data, false otherwise.
      * @param initialCapacity The initial capacity of the batch, in triangles.
      * @param growSize Amount to grow the batch by when it overflows (a value of zero prevents batch growing).
+     * @param streaming True to stream the batched primitives through GPU buffers, false to draw them from client memory.
      *
      * @return A new mesh batch.
      */
-    static MeshBatch* create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity = 1024, unsigned int growSize = 1024);
+    static MeshBatch* create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity = 1024, unsigned int growSize = 1024,
+                             bool streaming = false);
 
     /**
      * Destructor.
@@ -111,7 +128,8 @@ public:
 
 private:
 
-    MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize);
+    MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize,
+              bool streaming);
 
     MeshBatch(const MeshBatch& copy);
 
@@ -119,6 +137,13 @@ private:
 
     bool resize(unsigned int capacity);
 
+    /**
+     * Appends the given indices to the batch, and reserves storage for the given number of vertices.
+     *
+     * @return The storage where the caller must write the vertices, or NULL if the batch is full.
+     */
+    unsigned char* append(unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount);
+
     const VertexFormat _vertexFormat;
     Mesh::PrimitiveType _primitiveType;
     Material* _material;
@@ -133,6 +158,10 @@ private:
     unsigned char* _verticesPtr;
     unsigned short* _indices;
     unsigned short* _indicesPtr;
+    bool _streaming;
+    StreamBuffer* _vertexStream;
+    StreamBuffer* _indexStream;
+    unsigned int _indexBase;
 
 };
 
@@ -1,6 +1,10 @@
 #include "Base.h"
 #include "MeshSkin.h"
 #include "Joint.h"
+#include "Model.h"
+#include "Scene.h"
+#include "Game.h"
+#include "MathUtil.h"
 
 // The number of rows in each palette matrix.
 #define PALETTE_ROWS 3
@@ -9,12 +13,15 @@ namespace gameplay
 {
 
 MeshSkin::MeshSkin()
-    : _rootJoint(NULL), _matrixPalette(NULL), _model(NULL)
+    : _rootJoint(NULL), _matrixPalette(NULL), _model(NULL), _lodDistance(0.0f), _lodMaxInterval(1), _lodMinImportance(0.0f)
 {
+    _animationLod.interval = 1;
+    _animationLod.frame = 0;
 }
 
 MeshSkin::~MeshSkin()
 {
+    setAnimationLod(0.0f);
     clearJoints();
 
     SAFE_DELETE_ARRAY(_matrixPalette);
@@ -28,6 +35,9 @@ const Matrix& MeshSkin::getBindShape() const
 void MeshSkin::setBindShape(const float* matrix)
 {
     _bindShape.set(matrix);
+
+    // Every palette matrix depends on the bind shape.
+    std::fill(_jointBindVersions.begin(), _jointBindVersions.end(), 0);
 }
 
 unsigned int MeshSkin::getJointCount() const
@@ -68,6 +78,9 @@ void MeshSkin::setJointCount(unsigned int jointCount)
     {
         _joints[i] = NULL;
     }
+    _jointBindMatrices.resize(jointCount);
+    _jointBindVersions.assign(jointCount, 0);
+    _jointVersions.assign(jointCount, 0);
 
     // Rebuild the matrix palette. Each matrix is 3 rows of Vector4.
     SAFE_DELETE_ARRAY(_matrixPalette);
@@ -90,25 +103,44 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
 
     if (_joints[index])
     {
+        setJointAnimationLod(_joints[index], false);
         _joints[index]->_skinCount--;
         SAFE_RELEASE(_joints[index]);
     }
 
     _joints[index] = joint;
+    _jointBindVersions[index] = 0;
+    _jointVersions[index] = 0;
 
     if (joint)
     {
         joint->addRef();
         joint->_skinCount++;
+        setJointAnimationLod(joint, _lodDistance > 0.0f);
     }
 }
 
 Vector4* MeshSkin::getMatrixPalette() const
 {
-    unsigned int count = _joints.size();
-    for (unsigned int i = 0; i < count; i++)
+    // The palette matrix of a joint is its world matrix * inverse bind pose * bind shape.
+    // The last two only change when the skin is set up, so their product is kept per joint
+    // and each joint that moved costs a single multiply, written directly as palette rows.
+    for (unsigned int i = 0, count = _joints.size(); i < count; i++)
     {
-        _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+        const Joint* joint = _joints[i];
+
+        if (_jointBindVersions[i] != joint->_bindPoseVersion)
+        {
+            Matrix::multiply(joint->_bindPose, _bindShape, &_jointBindMatrices[i]);
+            _jointBindVersions[i] = joint->_bindPoseVersion;
+            _jointVersions[i] = 0;
+        }
+
+        if (_jointVersions[i] != joint->_jointMatrixVersion)
+        {
+            MathUtil::multiplyMatrixRows(joint->getWorldMatrix().m, _jointBindMatrices[i].m, &_matrixPalette[i * PALETTE_ROWS].x);
+            _jointVersions[i] = joint->_jointMatrixVersion;
+        }
     }
     return _matrixPalette;
 }
@@ -185,9 +217,114 @@ void MeshSkin::clearJoints()
 
     for (unsigned int i = 0, count = _joints.size(); i < count; ++i)
     {
+        if (_joints[i])
+        {
+            setJointAnimationLod(_joints[i], false);
+        }
         SAFE_RELEASE(_joints[i]);
     }
     _joints.clear();
+    _jointBindMatrices.clear();
+    _jointBindVersions.clear();
+    _jointVersions.clear();
+}
+
+void MeshSkin::setAnimationLod(float distance, unsigned int maxInterval, float minImportance)
+{
+    bool wasEnabled = _lodDistance > 0.0f;
+    bool enabled = distance > 0.0f;
+
+    _lodDistance = enabled ? distance : 0.0f;
+    _lodMaxInterval = maxInterval > 0 ? maxInterval : 1;
+    _lodMinImportance = minImportance;
+
+    for (unsigned int i = 0, count = _joints.size(); i < count; ++i)
+    {
+        if (_joints[i])
+        {
+            setJointAnimationLod(_joints[i], enabled);
+        }
+    }
+
+    if (enabled != wasEnabled)
+    {
+        _animationLod.interval = 1;
+        _animationLod.frame = 0;
+
+        Game* game = Game::getInstance();
+        AnimationController* controller = game ? game->getAnimationController() : NULL;
+        if (controller)
+        {
+            if (enabled)
+            {
+                controller->addLodSkin(this);
+            }
+            else
+            {
+                controller->removeLodSkin(this);
+            }
+        }
+    }
+}
+
+unsigned int MeshSkin::getAnimationLodInterval() const
+{
+    return _animationLod.interval;
+}
+
+void MeshSkin::setJointAnimationLod(Joint* joint, bool enabled)
+{
+    if (enabled)
+    {
+        // Only leaf joints may be skipped, since skipping a joint freezes its whole subtree.
+        bool leaf = true;
+        for (Node* child = joint->getFirstChild(); child != NULL; child = child->getNextSibling())
+        {
+            if (child->getType() == Node::JOINT)
+            {
+                leaf = false;
+                break;
+            }
+        }
+        joint->_animationLod = &_animationLod;
+        joint->_animationLodMinor = leaf && joint->_animationImportance < _lodMinImportance;
+    }
+    else if (joint->_animationLod == &_animationLod)
+    {
+        joint->_animationLod = NULL;
+        joint->_animationLodMinor = false;
+    }
+}
+
+void MeshSkin::updateAnimationLod()
+{
+    unsigned int interval = 1;
+
+    Node* node = _model ? _model->getNode() : NULL;
+    Scene* scene = node ? node->getScene() : NULL;
+    Camera* camera = scene ? scene->getActiveCamera() : NULL;
+    if (camera && camera->getNode())
+    {
+        const BoundingSphere& sphere = node->getBoundingSphere();
+        if (!camera->getFrustum().intersects(sphere))
+        {
+            interval = 0;
+        }
+        else
+        {
+            float distance = sphere.center.distance(camera->getNode()->getTranslationWorld()) - sphere.radius;
+            if (distance > 0.0f)
+            {
+                float steps = distance / _lodDistance;
+                interval = steps < (float)(_lodMaxInterval - 1) ? 1 + (unsigned int)steps : _lodMaxInterval;
+            }
+        }
+    }
+
+    // Evaluations happen on frame 0 of each interval. Skins keep advancing their
+    // frame from their own starting point, so that a crowd's updates are spread out.
+    _animationLod.interval = interval;
+    _animationLod.frame = interval > 1 ? (_animationLod.frame + 1) % interval : 0;
 }
 
 }
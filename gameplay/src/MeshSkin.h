@@ -19,6 +19,8 @@ class MeshSkin : public Transform::Listener
     friend class Package;
     friend class Model;
     friend class Joint;
+    friend class AnimationController;
+    friend class SkinnedMeshTest;
 
 public:
 
@@ -84,6 +86,11 @@ public:
 
     /**
      * Returns the pointer to the Vector4 array for the purpose of binding to a shader.
+     *
+     * Only the palette matrices of the joints that moved since the last call are
+     * recomputed. Different skins may be updated concurrently, including skins that
+     * share joints, once the world matrices of the joints are up to date (see
+     * Scene::updateTransforms).
      * 
      * @return The pointer to the matrix palette.
      */
@@ -103,6 +110,39 @@ public:
      */
     Model* getModel() const;
 
+    /**
+     * Enables animation level of detail for the joints of this skin.
+     *
+     * Every frame, the bounding sphere of the skin's model node is tested against
+     * the active camera of its scene. When the sphere is outside the camera's
+     * frustum, the joints of the skin are no longer animated at all. Otherwise,
+     * the joints are animated every frame within the given distance of the camera.
+     * Beyond it, they are animated one frame out of N, where N grows by one every
+     * distance units, up to maxInterval. In between, the joints are interpolated
+     * from one evaluation to the next.
+     *
+     * While the skin is animated at a reduced rate, leaf joints whose importance is
+     * lower than minImportance are not animated (see Joint::setAnimationImportance).
+     *
+     * When a joint is shared by several skins, it follows the level of detail of
+     * the last skin to enable it.
+     *
+     * @param distance The distance from the camera to the skin's bounding sphere
+     *      covered by each update rate, or 0 to disable animation level of detail.
+     * @param maxInterval The maximum number of frames between two evaluations.
+     * @param minImportance The importance under which leaf joints are not animated at reduced rates.
+     */
+    void setAnimationLod(float distance, unsigned int maxInterval = 4, float minImportance = 0.5f);
+
+    /**
+     * Gets the number of frames between two evaluations of the animations of this skin's joints,
+     * as computed for the current frame.
+     *
+     * @return The number of frames between evaluations: 1 when animation level of detail is
+     *      disabled or the skin is close to the camera, and 0 when the skin is outside the camera's frustum.
+     */
+    unsigned int getAnimationLodInterval() const;
+
     /**
      * Handles transform change events for joints.
      */
@@ -141,6 +181,16 @@ private:
      */
     void clearJoints();
 
+    /**
+     * Computes the animation level of detail of the skin for the current frame.
+     */
+    void updateAnimationLod();
+
+    /**
+     * Assigns (or removes, when disabled) the skin's level of detail to the given joint.
+     */
+    void setJointAnimationLod(Joint* joint, bool enabled);
+
     Matrix _bindShape;
     std::vector<Joint*> _joints;
     Joint* _rootJoint;
@@ -151,6 +201,15 @@ private:
     // The number of Vector4's is (_joints.size() * 3).
     Vector4* _matrixPalette;
     Model* _model;
+
+    mutable std::vector<Matrix> _jointBindMatrices;         // The inverse bind pose of each joint multiplied by the bind shape.
+    mutable std::vector<unsigned int> _jointBindVersions;   // The bind pose version of each joint in _jointBindMatrices, or 0.
+    mutable std::vector<unsigned int> _jointVersions;       // The version of each joint in the matrix palette, or 0.
+
+    AnimationTarget::Lod _animationLod;     // The animation level of detail of the joints.
+    float _lodDistance;                     // The distance covered by each update rate, or 0 when disabled.
+    unsigned int _lodMaxInterval;           // The maximum number of frames between evaluations.
+    float _lodMinImportance;                // The importance under which leaf joints are skipped at reduced rates.
 };
 
 }
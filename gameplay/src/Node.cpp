@@ -2,6 +2,7 @@
 #include "Node.h"
 #include "Scene.h"
 #include "Joint.h"
+#include "SpatialIndex.h"
 
 #define NODE_DIRTY_WORLD 1
 #define NODE_DIRTY_BOUNDS 2
@@ -13,7 +14,8 @@ namespace gameplay
 Node::Node(const char* id)
     : _scene(NULL), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(NULL),
     _camera(NULL), _light(NULL), _model(NULL), _audioSource(NULL), _particleEmitter(NULL), _physicsRigidBody(NULL), 
-    _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true)
+    _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _cullingPlane(0),
+    _spatialIndex(NULL), _spatialProxy(-1)
 {
     if (id)
     {
@@ -28,6 +30,11 @@ Node::Node(const Node& node)
 
 Node::~Node()
 {
+    if (_spatialIndex)
+    {
+        _spatialIndex->remove(this);
+    }
+
     removeAllChildren();
 
     SAFE_RELEASE(_camera);
@@ -99,6 +106,17 @@ void Node::addChild(Node* child)
 
     ++_childCount;
 
+    // The child joins our scene, if we have one.
+    Scene* scene = getScene();
+    if (scene)
+    {
+        child->updateSpatialIndex(scene, true);
+    }
+
+    // Our bounds now contain the child's, even when hierarchy changes are not notified.
+    // This also keeps our ancestors dirty when the child's bounds are already dirty.
+    setBoundsDirty();
+
     if (_notifyHierarchyChanged)
     {
         hierarchyChanged();
@@ -160,6 +178,15 @@ void Node::remove()
     _prevSibling = NULL;
     _parent = NULL;
 
+    // A node removed from its parent leaves the scene of its parent.
+    if (parent)
+    {
+        updateSpatialIndex(_scene, true);
+
+        // Our parent's bounds no longer contain ours.
+        parent->setBoundsDirty();
+    }
+
     if (parent && parent->_notifyHierarchyChanged)
     {
         parent->hierarchyChanged();
@@ -282,17 +309,8 @@ const Matrix& Node::getWorldMatrix() const
         // parent calls our getWorldMatrix() method as a result of the following calculations.
         _dirtyBits &= ~NODE_DIRTY_WORLD;
 
-        // If we have a parent, multiply our parent world transform by our local
-        // transform to obtain our final resolved world transform.
         Node* parent = getParent();
-        if (parent && (!_physicsRigidBody || _physicsRigidBody->isKinematic()) )
-        {
-            Matrix::multiply(parent->getWorldMatrix(), getMatrix(), &_world);
-        }
-        else
-        {
-            _world = getMatrix();
-        }
+        computeWorldMatrix(parent ? &parent->getWorldMatrix() : NULL);
 
         // Our world matrix was just updated, so call getWorldMatrix() on all child nodes
         // to force their resolved world matrices to be updated.
@@ -307,6 +325,32 @@ const Matrix& Node::getWorldMatrix() const
     return _world;
 }
 
+void Node::updateWorldMatrix() const
+{
+    if (_dirtyBits & NODE_DIRTY_WORLD)
+    {
+        _dirtyBits &= ~NODE_DIRTY_WORLD;
+
+        Node* parent = getParent();
+        assert(!parent || !(parent->_dirtyBits & NODE_DIRTY_WORLD));
+        computeWorldMatrix(parent ? &parent->_world : NULL);
+    }
+}
+
+void Node::computeWorldMatrix(const Matrix* parentWorld) const
+{
+    // If we have a parent, multiply our parent world transform by our local
+    // transform to obtain our final resolved world transform.
+    if (parentWorld && (!_physicsRigidBody || _physicsRigidBody->isKinematic()) )
+    {
+        Matrix::multiply(*parentWorld, getMatrix(), &_world);
+    }
+    else
+    {
+        _world.set(getMatrix());
+    }
+}
+
 const Matrix& Node::getWorldViewMatrix() const
 {
     static Matrix worldView;
@@ -461,6 +505,13 @@ Vector3 Node::getActiveCameraTranslationWorld() const
 
 void Node::hierarchyChanged()
 {
+    // The flattened transform order of our scene no longer matches the hierarchy.
+    Scene* scene = getScene();
+    if (scene)
+    {
+        scene->_transformOrderDirty = true;
+    }
+
     // When our hierarchy changes our world transform is affected, so we must dirty it.
     transformChanged();
 }
@@ -468,14 +519,20 @@ void Node::hierarchyChanged()
 void Node::transformChanged()
 {
     // Our local transform was changed, so mark our world matrices dirty.
-    _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
+    _dirtyBits |= NODE_DIRTY_WORLD;
+
+    // Our bounds moved, and so did the bounds of our parents which contain them.
+    setBoundsDirty();
 
     // Notify our children that their transform has also changed (since transforms are inherited).
+    // Children with a pending deferred change are notified through their own entry instead
+    // (see Transform::resumeTransformChanged), so that each subtree is traversed only once.
     Joint* rootJoint = NULL;
     Node* n = getFirstChild();
     while (n)
     {
-        n->transformChanged();
+        if (!n->isTransformChangedPending())
+            n->transformChanged();
         n = n->getNextSibling();
     }
 
@@ -484,12 +541,18 @@ void Node::transformChanged()
 
 void Node::setBoundsDirty()
 {
-    // Mark ourself and our parent nodes as dirty
-    _dirtyBits |= NODE_DIRTY_BOUNDS;
+    if (_spatialIndex)
+    {
+        _spatialIndex->setDirty(this);
+    }
 
-    // Mark our parent bounds as dirty as well
-    if (_parent)
-        _parent->setBoundsDirty();
+    // Mark ourself and our parent nodes as dirty. The parents of a node with dirty
+    // bounds are always dirty too (addChild dirties them when a node is attached),
+    // so we can stop at the first one that already is.
+    for (Node* n = this; n != NULL && (n->_dirtyBits & NODE_DIRTY_BOUNDS) == 0; n = n->_parent)
+    {
+        n->_dirtyBits |= NODE_DIRTY_BOUNDS;
+    }
 }
 
 Camera* Node::getCamera() const
@@ -539,6 +602,8 @@ void Node::setLight(Light* light)
             _light->addRef();
             _light->setNode(this);
         }
+
+        updateSpatialIndex(getScene(), false);
     }
 }
 
@@ -559,6 +624,10 @@ void Node::setModel(Model* model)
             _model->addRef();
             _model->setNode(this);
         }
+
+        updateSpatialIndex(getScene(), false);
+
+        setBoundsDirty();
     }
 }
 
@@ -580,7 +649,7 @@ const BoundingSphere& Node::getBoundingSphere() const
         bool empty = true;
         if (_model && _model->getMesh())
         {
-            _bounds.set(_model->getMesh()->getBoundingSphere());
+            getModelBoundingSphere(&_bounds);
             empty = false;
         }
         else
@@ -590,37 +659,6 @@ const BoundingSphere& Node::getBoundingSphere() const
             _bounds.radius = 0;
         }
 
-        // Transform the sphere (if not empty) into world space.
-        if (!empty)
-        {
-            bool applyWorldTransform = true;
-            if (_model && _model->getSkin())
-            {
-                // Special case: If the root joint of our mesh skin is parented by any nodes, 
-                // multiply the world matrix of the root joint's parent by this node's
-                // world matrix. This computes a final world matrix used for transforming this
-                // node's bounding volume. This allows us to store a much smaller bounding
-                // volume approximation than would otherwise be possible for skinned meshes,
-                // since joint parent nodes that are not in the matrix pallette do not need to
-                // be considered as directly transforming vertices on the GPU (they can instead
-                // be applied directly to the bounding volume transformation below).
-                Node* jointParent = _model->getSkin()->getRootJoint()->getParent();
-                if (jointParent)
-                {
-                    // TODO: Should we protect against the case where joints are nested directly
-                    // in the node hierachy of the model (this is normally not the case)?
-                    Matrix boundsMatrix;
-                    Matrix::multiply(getWorldMatrix(), jointParent->getWorldMatrix(), &boundsMatrix);
-                    _bounds.transform(boundsMatrix);
-                    applyWorldTransform = false;
-                }
-            }
-            if (applyWorldTransform)
-            {
-                _bounds.transform(getWorldMatrix());
-            }
-        }
-
         // Merge this world-space bounding sphere with our childrens' bounding volumes.
         for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
         {
@@ -643,6 +681,63 @@ const BoundingSphere& Node::getBoundingSphere() const
     return _bounds;
 }
 
+void Node::getModelBoundingSphere(BoundingSphere* dst) const
+{
+    assert(dst);
+    assert(_model && _model->getMesh());
+
+    dst->set(_model->getMesh()->getBoundingSphere());
+
+    // Transform the sphere into world space.
+    bool applyWorldTransform = true;
+    if (_model->getSkin())
+    {
+        // Special case: If the root joint of our mesh skin is parented by any nodes, 
+        // multiply the world matrix of the root joint's parent by this node's
+        // world matrix. This computes a final world matrix used for transforming this
+        // node's bounding volume. This allows us to store a much smaller bounding
+        // volume approximation than would otherwise be possible for skinned meshes,
+        // since joint parent nodes that are not in the matrix pallette do not need to
+        // be considered as directly transforming vertices on the GPU (they can instead
+        // be applied directly to the bounding volume transformation below).
+        Node* jointParent = _model->getSkin()->getRootJoint()->getParent();
+        if (jointParent)
+        {
+            // TODO: Should we protect against the case where joints are nested directly
+            // in the node hierachy of the model (this is normally not the case)?
+            Matrix boundsMatrix;
+            Matrix::multiply(getWorldMatrix(), jointParent->getWorldMatrix(), &boundsMatrix);
+            dst->transform(boundsMatrix);
+            applyWorldTransform = false;
+        }
+    }
+    if (applyWorldTransform)
+    {
+        dst->transform(getWorldMatrix());
+    }
+}
+
+void Node::updateSpatialIndex(Scene* scene, bool recursive)
+{
+    SpatialIndex* index = scene ? scene->_spatialIndex : NULL;
+    if (index && SpatialIndex::isIndexed(this))
+    {
+        index->insert(this);
+    }
+    else if (_spatialIndex)
+    {
+        _spatialIndex->remove(this);
+    }
+
+    if (recursive)
+    {
+        for (Node* child = _firstChild; child != NULL; child = child->_nextSibling)
+        {
+            child->updateSpatialIndex(scene, true);
+        }
+    }
+}
+
 AudioSource* Node::getAudioSource() const
 {
     return _audioSource;
@@ -665,6 +760,8 @@ void Node::setAudioSource(AudioSource* audio)
             _audioSource->addRef();
             _audioSource->setNode(this);
         }
+
+        updateSpatialIndex(getScene(), false);
     }
 }
 
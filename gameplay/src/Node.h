@@ -15,6 +15,7 @@ namespace gameplay
 
 class Package;
 class Scene;
+class SpatialIndex;
 
 /**
  * Defines a basic hierachial structure of transformation spaces.
@@ -24,6 +25,7 @@ class Node : public Transform, public Ref
     friend class Scene;
     friend class Package;
     friend class MeshSkin;
+    friend class SpatialIndex;
 
 public:
 
@@ -438,6 +440,42 @@ protected:
      */
     void setBoundsDirty();
 
+    /**
+     * Resolves the world matrix of this node if it is dirty, assuming the
+     * world matrix of its parent has already been resolved.
+     *
+     * Unlike getWorldMatrix(), this method does not recurse into the parent
+     * or children, which lets Scene::updateTransforms() resolve nodes in a
+     * single parent-before-child sweep.
+     */
+    void updateWorldMatrix() const;
+
+    /**
+     * Computes the world matrix of this node from the resolved world matrix of its parent.
+     *
+     * Both getWorldMatrix() and updateWorldMatrix() resolve the world matrix through this
+     * method, so nodes that compute their world matrix differently should override it.
+     *
+     * @param parentWorld The world matrix of the parent, or NULL if the node has no parent.
+     */
+    virtual void computeWorldMatrix(const Matrix* parentWorld) const;
+
+    /**
+     * Computes the world-space bounding sphere of this node's model, excluding its children.
+     *
+     * The node must have a model with a mesh.
+     */
+    void getModelBoundingSphere(BoundingSphere* dst) const;
+
+    /**
+     * Adds this node to the spatial index of the given scene if it has anything to
+     * locate, or removes it from the spatial index it belongs to otherwise.
+     *
+     * @param scene The scene the node belongs to, or NULL.
+     * @param recursive Whether to also update the children of this node.
+     */
+    void updateSpatialIndex(Scene* scene, bool recursive);
+
     Scene* _scene;
     std::string _id;
     Node* _firstChild;
@@ -455,6 +493,9 @@ protected:
     mutable int _dirtyBits;
     bool _notifyHierarchyChanged;
     mutable BoundingSphere _bounds;
+    unsigned int _cullingPlane;     // The index of the frustum plane that last culled this node.
+    SpatialIndex* _spatialIndex;    // The spatial index this node is stored in, or NULL.
+    int _spatialProxy;              // The index of this node's leaf in _spatialIndex.
 };
 
 }
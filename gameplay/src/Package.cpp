@@ -6,8 +6,22 @@
 #include "SceneLoader.h"
 #include "Joint.h"
 
+#ifdef WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#endif
+
 #define GPB_PACKAGE_VERSION_MAJOR 1
-#define GPB_PACKAGE_VERSION_MINOR 1
+#define GPB_PACKAGE_VERSION_MINOR 2
+
+// The oldest minor version that can still be read.
+#define GPB_PACKAGE_VERSION_MINOR_MIN 1
+
+// The storage formats of animation key values (version 1.2 and later).
+#define PACKAGE_VALUES_FLOAT 0
+#define PACKAGE_VALUES_QUANTIZED 1
 
 #define PACKAGE_TYPE_SCENE 1
 #define PACKAGE_TYPE_NODE 2
@@ -27,14 +41,54 @@
 // For sanity checking string reads
 #define PACKAGE_MAX_STRING_LENGTH 5000
 
+// The bit of the font style where the encoder stores the spread of distance field fonts
+#define FONT_DISTANCE_FIELD_STYLE_SHIFT 16
+
 namespace gameplay
 {
 
 static std::vector<Package*> __packageCache;
 
+/**
+ * Maps the given file into memory for reading.
+ *
+ * @return The contents of the file, or NULL if the file could not be mapped.
+ */
+static const unsigned char* mapFile(FILE* fp, unsigned int size)
+{
+#ifdef WIN32
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno(fp));
+    HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+        return NULL;
+
+    // The view keeps the file mapping open after its handle is closed.
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    return (const unsigned char*)data;
+#else
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    return data == MAP_FAILED ? NULL : (const unsigned char*)data;
+#endif
+}
+
+/**
+ * Unmaps the contents of a file mapped by mapFile.
+ */
+static void unmapFile(const unsigned char* data, unsigned int size)
+{
+#ifdef WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
 Package::Package(const char* path) :
-    _path(path), _referenceCount(0), _references(NULL), _file(NULL)
+    _path(path), _referenceCount(0), _references(NULL), _data(NULL), _size(0), _position(0), _mapped(false)
 {
+    _version[0] = GPB_PACKAGE_VERSION_MAJOR;
+    _version[1] = GPB_PACKAGE_VERSION_MINOR;
 }
 
 Package::~Package()
@@ -50,10 +104,13 @@ Package::~Package()
 
     SAFE_DELETE_ARRAY(_references);
 
-    if (_file)
+    if (_mapped)
+    {
+        unmapFile(_data, _size);
+    }
+    else
     {
-        fclose(_file);
-        _file = NULL;
+        SAFE_DELETE_ARRAY(_data);
     }
 }
 
@@ -67,7 +124,7 @@ bool Package::readArray(unsigned int* length, T** ptr)
     if (*length > 0)
     {
         *ptr = new T[*length];
-        if (fread(*ptr, sizeof(T), *length, _file) != *length)
+        if (!read(*ptr, sizeof(T), *length))
         {
             SAFE_DELETE_ARRAY(*ptr);
             return false;
@@ -86,7 +143,7 @@ bool Package::readArray(unsigned int* length, std::vector<T>* values)
     if (*length > 0 && values)
     {
         values->resize(*length);
-        if (fread(&(*values)[0], sizeof(T), *length, _file) != *length)
+        if (!read(&(*values)[0], sizeof(T), *length))
         {
             return false;
         }
@@ -106,7 +163,7 @@ bool Package::readArray(unsigned int* length, std::vector<T>* values, unsigned i
     if (*length > 0 && values)
     {
         values->resize(*length);
-        if (fread(&(*values)[0], readSize, *length, _file) != *length)
+        if (!read(&(*values)[0], readSize, *length))
         {
             return false;
         }
@@ -114,10 +171,10 @@ bool Package::readArray(unsigned int* length, std::vector<T>* values, unsigned i
     return true;
 }
 
-std::string readString(FILE* fp)
+std::string Package::readString()
 {
     unsigned int length;
-    if (fread(&length, 4, 1, fp) != 1)
+    if (!read(&length))
     {
         return std::string();
     }
@@ -125,16 +182,12 @@ std::string readString(FILE* fp)
     // Sanity check to detect if string length is far too big
     assert(length < PACKAGE_MAX_STRING_LENGTH);
 
-    std::string str;
-    if (length > 0)
+    const unsigned char* str = readSpan(length);
+    if (str == NULL)
     {
-        str.resize(length);
-        if (fread(&str[0], 1, length, fp) != length)
-        {
-            return std::string();
-        }
+        return std::string();
     }
-    return str;
+    return std::string((const char*)str, length);
 }
 
 Package* Package::create(const char* path)
@@ -159,64 +212,125 @@ Package* Package::create(const char* path)
         return NULL;
     }
 
-    // Read the GPG header info
-    char sig[9];
-    if (fread(sig, 1, 9, fp) != 9 || memcmp(sig, "GPB\r\n\x1A\n", 9) != 0)
+    // Map the whole package into memory, so that objects are read in place instead
+    // of through many small reads. If the file can't be mapped, read it in one go.
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    if (size <= 0)
     {
         LOG_ERROR_VARG("Invalid package header: %s", path);
         fclose(fp);
         return NULL;
     }
+    Package* pkg = new Package(path);
+    pkg->_size = (unsigned int)size;
+    pkg->_data = mapFile(fp, pkg->_size);
+    pkg->_mapped = pkg->_data != NULL;
+    if (!pkg->_mapped)
+    {
+        unsigned char* data = new unsigned char[pkg->_size];
+        fseek(fp, 0, SEEK_SET);
+        if (fread(data, 1, pkg->_size, fp) != pkg->_size)
+        {
+            LOG_ERROR_VARG("Failed to read package: %s", path);
+            SAFE_DELETE_ARRAY(data);
+            fclose(fp);
+            SAFE_RELEASE(pkg);
+            return NULL;
+        }
+        pkg->_data = data;
+    }
+    fclose(fp);
+
+    // Read the GPG header info
+    const unsigned char* sig = pkg->readSpan(9);
+    if (sig == NULL || memcmp(sig, "GPB\r\n\x1A\n", 9) != 0)
+    {
+        LOG_ERROR_VARG("Invalid package header: %s", path);
+        SAFE_RELEASE(pkg);
+        return NULL;
+    }
 
     // Read version
     unsigned char ver[2];
-    if (fread(ver, 1, 2, fp) != 2 || ver[0] != GPB_PACKAGE_VERSION_MAJOR || ver[1] != GPB_PACKAGE_VERSION_MINOR)
+    if (!pkg->read(ver, 1, 2) || ver[0] != GPB_PACKAGE_VERSION_MAJOR || ver[1] < GPB_PACKAGE_VERSION_MINOR_MIN || ver[1] > GPB_PACKAGE_VERSION_MINOR)
     {
         LOG_ERROR_VARG("Unsupported version (%d.%d) for package: %s (expected %d.%d)", (int)ver[0], (int)ver[1], path, GPB_PACKAGE_VERSION_MAJOR, GPB_PACKAGE_VERSION_MINOR);
-        fclose(fp);
+        SAFE_RELEASE(pkg);
         return NULL;
     }
+    memcpy(pkg->_version, ver, sizeof(ver));
 
     // Read ref table
     unsigned int refCount;
-    if (fread(&refCount, 4, 1, fp) != 1)
+    if (!pkg->read(&refCount))
     {
-        fclose(fp);
+        SAFE_RELEASE(pkg);
         return NULL;
     }
 
     // Read all refs
-    Reference* refs = new Reference[refCount];
+    pkg->_references = new Reference[refCount];
+    pkg->_referenceCount = refCount;
     for (unsigned int i = 0; i < refCount; ++i)
     {
-        if ((refs[i].id = readString(fp)).empty() ||
-            fread(&refs[i].type, 4, 1, fp) != 1 ||
-            fread(&refs[i].offset, 4, 1, fp) != 1)
+        Reference& ref = pkg->_references[i];
+        if ((ref.id = pkg->readString()).empty() ||
+            !pkg->read(&ref.type) ||
+            !pkg->read(&ref.offset))
         {
-            fclose(fp);
-            SAFE_DELETE_ARRAY(refs);
+            SAFE_RELEASE(pkg);
             return NULL;
         }
     }
-
-    // Keep file open for faster reading later
-    Package* pkg = new Package(path);
-    pkg->_referenceCount = refCount;
-    pkg->_references = refs;
-    pkg->_file = fp;
+    pkg->indexReferences();
 
     return pkg;
 }
 
-Package::Reference* Package::find(const char* id) const
+/**
+ * Hashes a reference ID (32-bit FNV-1a).
+ */
+static unsigned int hashId(const char* id)
 {
-    // Search the ref table for the given id (case-sensitive)
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*)id; *c; ++c)
+    {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    return hash;
+}
+
+void Package::indexReferences()
+{
+    // Ties are ordered by reference index, so lookups return the first match in the table like a linear search.
+    _referencesById.resize(_referenceCount);
+    _referencesByOffset.resize(_referenceCount);
     for (unsigned int i = 0; i < _referenceCount; ++i)
     {
-        if (_references[i].id == id)
+        _referencesById[i] = std::make_pair(hashId(_references[i].id.c_str()), i);
+        _referencesByOffset[i] = std::make_pair(_references[i].offset, i);
+    }
+    std::sort(_referencesById.begin(), _referencesById.end());
+    std::sort(_referencesByOffset.begin(), _referencesByOffset.end());
+}
+
+Package::Reference* Package::find(const char* id) const
+{
+    if (id == NULL)
+    {
+        return NULL;
+    }
+
+    // Search the ref table for the given id (case-sensitive), among the references with the same hash
+    std::pair<unsigned int, unsigned int> key(hashId(id), 0);
+    std::vector<std::pair<unsigned int, unsigned int> >::const_iterator itr = std::lower_bound(_referencesById.begin(), _referencesById.end(), key);
+    for (; itr != _referencesById.end() && itr->first == key.first; ++itr)
+    {
+        if (_references[itr->second].id == id)
         {
             // Found a match
-            return &_references[i];
+            return &_references[itr->second];
         }
     }
 
@@ -234,7 +348,7 @@ void Package::clearLoadSession()
 
 const char* Package::getIdFromOffset() const
 {
-    return getIdFromOffset((unsigned int) ftell(_file));
+    return getIdFromOffset(_position);
 }
 
 const char* Package::getIdFromOffset(unsigned int offset) const
@@ -242,11 +356,13 @@ const char* Package::getIdFromOffset(unsigned int offset) const
     // Search the ref table for the given offset
     if (offset > 0)
     {
-        for (unsigned int i = 0; i < _referenceCount; ++i)
+        std::pair<unsigned int, unsigned int> key(offset, 0);
+        std::vector<std::pair<unsigned int, unsigned int> >::const_iterator itr = std::lower_bound(_referencesByOffset.begin(), _referencesByOffset.end(), key);
+        for (; itr != _referencesByOffset.end() && itr->first == offset; ++itr)
         {
-            if (_references[i].offset == offset && _references[i].id.length() > 0)
+            if (_references[itr->second].id.length() > 0)
             {
-                return _references[i].id.c_str();
+                return _references[itr->second].id.c_str();
             }
         }
     }
@@ -269,7 +385,7 @@ Package::Reference* Package::seekTo(const char* id, unsigned int type)
     }
 
     // Seek to the offset of this object
-    if (fseek(_file, ref->offset, SEEK_SET) != 0)
+    if (!seek(ref->offset))
     {
         LOG_ERROR_VARG("Failed to seek to object '%s' in package '%s'.", id, _path.c_str());
         return NULL;
@@ -287,7 +403,7 @@ Package::Reference* Package::seekToFirstType(unsigned int type)
         if (ref->type == type)
         {
             // Found a match
-            if (fseek(_file, ref->offset, SEEK_SET) != 0)
+            if (!seek(ref->offset))
             {
                 LOG_ERROR_VARG("Failed to seek to object '%s' in package '%s'.", ref->id.c_str(), _path.c_str());
                 return NULL;
@@ -298,24 +414,119 @@ Package::Reference* Package::seekToFirstType(unsigned int type)
     return NULL;
 }
 
+bool Package::read(void* ptr, unsigned int size, unsigned int count)
+{
+    const unsigned char* data = readSpan(size * count);
+    if (data == NULL)
+    {
+        return false;
+    }
+    memcpy(ptr, data, size * count);
+    return true;
+}
+
+const unsigned char* Package::readSpan(unsigned int byteCount)
+{
+    if (byteCount > _size - _position)
+    {
+        return NULL;
+    }
+    const unsigned char* data = _data + _position;
+    _position += byteCount;
+    return data;
+}
+
+bool Package::seek(unsigned int offset)
+{
+    if (offset > _size)
+    {
+        return false;
+    }
+    _position = offset;
+    return true;
+}
+
+bool Package::skip(unsigned int byteCount)
+{
+    return readSpan(byteCount) != NULL;
+}
+
 bool Package::read(unsigned int* ptr)
 {
-    return fread(ptr, sizeof(unsigned int), 1, _file) == 1;
+    return read(ptr, sizeof(unsigned int), 1);
 }
 
 bool Package::read(unsigned char* ptr)
 {
-    return fread(ptr, sizeof(unsigned char), 1, _file) == 1;
+    return read(ptr, sizeof(unsigned char), 1);
 }
 
 bool Package::read(float* ptr)
 {
-    return fread(ptr, sizeof(float), 1, _file) == 1;
+    return read(ptr, sizeof(float), 1);
+}
+
+bool Package::skipArray(unsigned int elementSize)
+{
+    unsigned int length;
+    if (!read(&length))
+    {
+        return false;
+    }
+    return length == 0 || skip(length * elementSize);
+}
+
+bool Package::readTangents(float* tangents, unsigned int valuesCount)
+{
+    unsigned int length;
+    if (!read(&length))
+    {
+        return false;
+    }
+    if (length == valuesCount)
+    {
+        return read(tangents, sizeof(float), length);
+    }
+    return length == 0 || skip(length * sizeof(float));
+}
+
+bool Package::readQuantizedValues(float* values, unsigned int valuesCount, unsigned int componentCount)
+{
+    // The ranges hold the minimum and the step of each component.
+    unsigned int rangesCount;
+    if (!read(&rangesCount) || rangesCount != componentCount * 2)
+    {
+        return false;
+    }
+    const unsigned char* ranges = readSpan(rangesCount * sizeof(float));
+    unsigned int length;
+    if (ranges == NULL || !read(&length) || length != valuesCount)
+    {
+        return false;
+    }
+    const unsigned char* quantized = readSpan(length * sizeof(unsigned short));
+    if (quantized == NULL)
+    {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < componentCount; ++i)
+    {
+        float range[2];
+        memcpy(range, ranges + i * sizeof(range), sizeof(range));
+        for (unsigned int j = i; j < valuesCount; j += componentCount)
+        {
+            unsigned short value;
+            memcpy(&value, quantized + j * sizeof(unsigned short), sizeof(unsigned short));
+            values[j] = range[0] + range[1] * value;
+        }
+    }
+    return true;
 }
 
 bool Package::readMatrix(float* m)
 {
-    return (fread(m, sizeof(float), 16, _file) == 16);
+    return (read(m, sizeof(float), 16));
 }
 
 Scene* Package::loadScene(const char* id)
@@ -364,7 +575,7 @@ Scene* Package::loadScene(const char* id, const std::vector<std::string>* nodesW
         }
     }
     // Read active camera
-    std::string xref = readString(_file);
+    std::string xref = readString();
     if (xref.length() > 1 && xref[0] == '#') // TODO: Handle full xrefs
     {
         Node* node = scene->findNode(xref.c_str() + 1, true);
@@ -402,7 +613,7 @@ Scene* Package::loadScene(const char* id, const std::vector<std::string>* nodesW
         if (ref->type == PACKAGE_TYPE_ANIMATIONS)
         {
             // Found a match
-            if (fseek(_file, ref->offset, SEEK_SET) != 0)
+            if (!seek(ref->offset))
             {
                 LOG_ERROR_VARG("Failed to seek to object '%s' in package '%s'.", ref->id.c_str(), _path.c_str());
                 return NULL;
@@ -510,7 +721,7 @@ Node* Package::readNode(Scene* sceneContext, Node* nodeContext, const std::vecto
 
     // Read transform
     float transform[16];
-    if (fread(transform, sizeof(float), 16, _file) != 16)
+    if (!read(transform, sizeof(float), 16))
     {
         SAFE_RELEASE(node);
         return NULL;
@@ -705,7 +916,7 @@ Model* Package::readModel(Scene* sceneContext, Node* nodeContext, bool loadWithM
 {
     // Read mesh
     Mesh* mesh = NULL;
-    std::string xref = readString(_file);
+    std::string xref = readString();
     if (xref.length() > 1 && xref[0] == '#') // TODO: Handle full xrefs
     {
         mesh = loadMesh(xref.c_str() + 1, loadWithMeshRBSupport, nodeId);
@@ -784,7 +995,7 @@ MeshSkin* Package::readMeshSkin(Scene* sceneContext, Node* nodeContext)
     // Read joint xref strings for all joints in the list
     for (unsigned int i = 0; i < jointCount; i++)
     {
-        skinData->joints.push_back(readString(_file));
+        skinData->joints.push_back(readString());
     }
 
     // read bindposes
@@ -871,7 +1082,7 @@ void Package::resolveJointReferences(Scene* sceneContext, Node* nodeContext)
 
 void Package::readAnimation(Scene* scene)
 {
-    const std::string animationId = readString(_file);
+    const std::string animationId = readString();
 
     // read the number of animation channels in this animation
     unsigned int animationChannelCount;
@@ -910,7 +1121,7 @@ Animation* Package::readAnimationChannel(Scene* scene, Animation* animation, con
     const char* id = animationId;
 
     // read targetId
-    std::string targetId = readString(_file);
+    std::string targetId = readString();
     if (targetId.empty())
     {
         LOG_ERROR_VARG("Failed to read %s for %s: %s", "targetId", "animation", id);
@@ -925,6 +1136,14 @@ Animation* Package::readAnimationChannel(Scene* scene, Animation* animation, con
         return NULL;
     }
 
+    // read the key values format
+    unsigned char valuesFormat = PACKAGE_VALUES_FLOAT;
+    if (_version[1] >= 2 && (!read(&valuesFormat) || valuesFormat > PACKAGE_VALUES_QUANTIZED))
+    {
+        LOG_ERROR_VARG("Failed to read %s for %s: %s", "valuesFormat", "animation", id);
+        return NULL;
+    }
+
     //long position = ftell(_file);
     //fseek(_file, position, SEEK_SET);
 
@@ -941,70 +1160,109 @@ Animation* Package::readAnimationChannel(Scene* scene, Animation* animation, con
         }
     }
 
-    std::vector<unsigned long> keyTimes;
-    std::vector<float> values;
-    std::vector<float> tangentsIn;
-    std::vector<float> tangentsOut;
-    std::vector<unsigned long> interpolation;
+    // TODO: Handle other target attributes later.
+    unsigned int propertyComponentCount = 0;
+    if (targetAttribute > 0)
+        propertyComponentCount = target->getAnimationPropertyComponentCount(targetAttribute);
 
-    // length of the arrays
+    // read key times count
     unsigned int keyTimesCount;
-    unsigned int valuesCount;
-    unsigned int tangentsInCount;
-    unsigned int tangentsOutCount;
-    unsigned int interpolationCount;
+    if (!read(&keyTimesCount))
+    {
+        LOG_ERROR_VARG("Failed to read %s for %s: %s", "keyTimes", "animation", id);
+        return NULL;
+    }
 
-    // read key times
-    if (!readArray(&keyTimesCount, &keyTimes, sizeof(unsigned int)))
+    if (propertyComponentCount == 0 || keyTimesCount < 2)
+    {
+        // Skip over the key times, values, tangents and interpolations.
+        bool quantized = valuesFormat == PACKAGE_VALUES_QUANTIZED;
+        if (!skip(keyTimesCount * sizeof(unsigned int)) || (quantized && !skipArray(sizeof(float))) ||
+            !skipArray(quantized ? sizeof(unsigned short) : sizeof(float)) ||
+            !skipArray(sizeof(float)) || !skipArray(sizeof(float)) || !skipArray(sizeof(unsigned int)))
+        {
+            LOG_ERROR_VARG("Failed to read %s for %s: %s", "animation channel", "animation", id);
+            return NULL;
+        }
+        return animation;
+    }
+
+    // The key data is read straight into the curve's arrays.
+    Curve* curve = new Curve(keyTimesCount, propertyComponentCount);
+
+    // read key times (stored as unsigned int milliseconds, which are normalized in place)
+    if (!read(curve->_times, sizeof(unsigned int), keyTimesCount))
     {
         LOG_ERROR_VARG("Failed to read %s for %s: %s", "keyTimes", "animation", id);
+        SAFE_DELETE(curve);
         return NULL;
     }
-    
+    unsigned int lowest;
+    unsigned int highest;
+    memcpy(&lowest, curve->_times, sizeof(unsigned int));
+    memcpy(&highest, curve->_times + (keyTimesCount - 1), sizeof(unsigned int));
+    unsigned long duration = highest - lowest;
+    for (unsigned int i = 0; i < keyTimesCount; i++)
+    {
+        unsigned int keyTime;
+        memcpy(&keyTime, curve->_times + i, sizeof(unsigned int));
+        curve->_times[i] = (float) (keyTime - lowest) / (float) duration;
+    }
+    curve->_times[0] = 0.0f;
+    curve->_times[keyTimesCount - 1] = 1.0f;
+
     // read key values
-    if (!readArray(&valuesCount, &values))
+    unsigned int valuesCount = keyTimesCount * propertyComponentCount;
+    bool valuesRead;
+    if (valuesFormat == PACKAGE_VALUES_QUANTIZED)
+    {
+        valuesRead = readQuantizedValues(curve->_values, valuesCount, propertyComponentCount);
+    }
+    else
+    {
+        unsigned int length;
+        valuesRead = read(&length) && length == valuesCount && read(curve->_values, sizeof(float), valuesCount);
+    }
+    if (!valuesRead)
     {
         LOG_ERROR_VARG("Failed to read %s for %s: %s", "values", "animation", id);
+        SAFE_DELETE(curve);
         return NULL;
     }
-    
+
     // read tangentsIn
-    if (!readArray(&tangentsInCount, &tangentsIn))
+    if (!readTangents(curve->_inValues, valuesCount))
     {
         LOG_ERROR_VARG("Failed to read %s for %s: %s", "tangentsIn", "animation", id);
+        SAFE_DELETE(curve);
         return NULL;
     }
-    
-    // read tangent_out
-    if (!readArray(&tangentsOutCount, &tangentsOut))
+
+    // read tangentsOut
+    if (!readTangents(curve->_outValues, valuesCount))
     {
         LOG_ERROR_VARG("Failed to read %s for %s: %s", "tangentsOut", "animation", id);
+        SAFE_DELETE(curve);
         return NULL;
     }
-    
+
     // read interpolations
-    if (!readArray(&interpolationCount, &interpolation, sizeof(unsigned int)))
+    // TODO: This code currently assumes LINEAR only (the curve's default).
+    if (!skipArray(sizeof(unsigned int)))
     {
         LOG_ERROR_VARG("Failed to read %s for %s: %s", "interpolation", "animation", id);
+        SAFE_DELETE(curve);
         return NULL;
     }
 
-    Game* game = Game::getInstance();
-    AnimationController* controller = game->getAnimationController();
-
-    // TODO: Handle other target attributes later.
-    if (targetAttribute > 0)
+    if (animation == NULL)
     {
-        assert(keyTimes.size() > 0 && values.size() > 0);
-        if (animation == NULL)
-        {
-            // TODO: This code currently assumes LINEAR only
-            animation = controller->createAnimation(animationId, target, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
-        }
-        else
-        {
-            animation->createChannel(target, targetAttribute, keyTimesCount, &keyTimes[0], &values[0], Curve::LINEAR);
-        }
+        AnimationController* controller = Game::getInstance()->getAnimationController();
+        animation = controller->createAnimation(animationId, target, targetAttribute, curve, duration);
+    }
+    else
+    {
+        animation->createChannel(target, targetAttribute, curve, duration);
     }
 
     return animation;
@@ -1018,7 +1276,7 @@ Mesh* Package::loadMesh(const char* id)
 Mesh* Package::loadMesh(const char* id, bool loadWithMeshRBSupport, const char* nodeId)
 {
     // save the file position
-    long position = ftell(_file);
+    unsigned int position = _position;
 
     // Seek to the specified Mesh
     Reference* ref = seekTo(id, PACKAGE_TYPE_MESH);
@@ -1029,7 +1287,7 @@ Mesh* Package::loadMesh(const char* id, bool loadWithMeshRBSupport, const char*
 
     // Read vertex format/elements
     unsigned int vertexElementCount;
-    if (fread(&vertexElementCount, 4, 1, _file) != 1 || vertexElementCount < 1)
+    if (!read(&vertexElementCount, 4, 1) || vertexElementCount < 1)
     {
         return NULL;
     }
@@ -1037,7 +1295,7 @@ Mesh* Package::loadMesh(const char* id, bool loadWithMeshRBSupport, const char*
     for (unsigned int i = 0; i < vertexElementCount; ++i)
     {
         unsigned int vUsage, vSize;
-        if (fread(&vUsage, 4, 1, _file) != 1 || fread(&vSize, 4, 1, _file) != 1)
+        if (!read(&vUsage, 4, 1) || !read(&vSize, 4, 1))
         {
             SAFE_DELETE_ARRAY(vertexElements);
             return NULL;
@@ -1053,12 +1311,13 @@ Mesh* Package::loadMesh(const char* id, bool loadWithMeshRBSupport, const char*
 
     // Read vertex data
     unsigned int vertexByteCount;
-    if (fread(&vertexByteCount, 4, 1, _file) != 1 || vertexByteCount == 0)
+    if (!read(&vertexByteCount, 4, 1) || vertexByteCount == 0)
     {
         return NULL;
     }
-    unsigned char* vertexData = new unsigned char[vertexByteCount];
-    if (fread(vertexData, 1, vertexByteCount, _file) != vertexByteCount)
+    // The vertex data is uploaded straight from the package contents.
+    const unsigned char* vertexData = readSpan(vertexByteCount);
+    if (vertexData == NULL)
     {
         LOG_ERROR_VARG("Failed to read %d vertex data bytes for mesh: %s", vertexByteCount, id);
         return NULL;
@@ -1067,12 +1326,12 @@ Mesh* Package::loadMesh(const char* id, bool loadWithMeshRBSupport, const char*
     // Read mesh bounds (bounding box and bounding sphere)
     Vector3 boundsMin, boundsMax, boundsCenter;
     float boundsRadius = 0.0f;
-    if (fread(&boundsMin.x, 4, 3, _file) != 3 || fread(&boundsMax.x, 4, 3, _file) != 3)
+    if (!read(&boundsMin.x, 4, 3) || !read(&boundsMax.x, 4, 3))
     {
         LOG_ERROR_VARG("Failed to read bounding box for mesh: %s", id);
         return NULL;
     }
-    if (fread(&boundsCenter.x, 4, 3, _file) != 3 || fread(&boundsRadius, 4, 1, _file) != 1)
+    if (!read(&boundsCenter.x, 4, 3) || !read(&boundsRadius, 4, 1))
     {
         LOG_ERROR_VARG("Failed to read bounding sphere for mesh: %s", id);
         return NULL;
@@ -1084,13 +1343,11 @@ Mesh* Package::loadMesh(const char* id, bool loadWithMeshRBSupport, const char*
     if (mesh == NULL)
     {
         LOG_ERROR_VARG("Failed to create mesh: %s", id);
-        SAFE_DELETE_ARRAY(vertexData);
         return NULL;
     }
-    mesh->setVertexData(vertexData, 0, vertexCount);
+    mesh->setVertexData((void*)vertexData, 0, vertexCount);
     if (loadWithMeshRBSupport)
-        SceneLoader::addMeshRigidBodyData(nodeId, mesh, vertexData, vertexByteCount);
-    SAFE_DELETE_ARRAY(vertexData);
+        SceneLoader::addMeshRigidBodyData(nodeId, mesh, (unsigned char*)vertexData, vertexByteCount);
 
     // Set mesh bounding volumes
     mesh->_boundingBox.set(boundsMin, boundsMax);
@@ -1098,7 +1355,7 @@ Mesh* Package::loadMesh(const char* id, bool loadWithMeshRBSupport, const char*
 
     // Read mesh parts
     unsigned int meshPartCount;
-    if (fread(&meshPartCount, 4, 1, _file) != 1)
+    if (!read(&meshPartCount, 4, 1))
     {
         SAFE_RELEASE(mesh);
         return NULL;
@@ -1107,20 +1364,19 @@ Mesh* Package::loadMesh(const char* id, bool loadWithMeshRBSupport, const char*
     {
         // Read primitive type, index format and index count
         unsigned int pType, iFormat, iByteCount;
-        if (fread(&pType, 4, 1, _file) != 1 ||
-            fread(&iFormat, 4, 1, _file) != 1 ||
-            fread(&iByteCount, 4, 1, _file) != 1)
+        if (!read(&pType, 4, 1) ||
+            !read(&iFormat, 4, 1) ||
+            !read(&iByteCount, 4, 1))
         {
             LOG_ERROR_VARG("Failed to read mesh part (i=%d): %s", i, id);
             SAFE_RELEASE(mesh);
             return NULL;
         }
 
-        unsigned char* indexData = new unsigned char[iByteCount];
-        if (fread(indexData, 1, iByteCount, _file) != iByteCount)
+        const unsigned char* indexData = readSpan(iByteCount);
+        if (indexData == NULL)
         {
             LOG_ERROR_VARG("Failed to read %d index data bytes for mesh part (i=%d): %s", iByteCount, i, id);
-            SAFE_DELETE_ARRAY(indexData);
             SAFE_RELEASE(mesh);
             return NULL;
         }
@@ -1144,17 +1400,15 @@ Mesh* Package::loadMesh(const char* id, bool loadWithMeshRBSupport, const char*
         if (part == NULL)
         {
             LOG_ERROR_VARG("Failed to create mesh part (i=%d): %s", i, id);
-            SAFE_DELETE_ARRAY(indexData);
             SAFE_RELEASE(mesh);
             return NULL;
         }
-        part->setIndexData(indexData, 0, indexCount);
+        part->setIndexData((void*)indexData, 0, indexCount);
         if (loadWithMeshRBSupport)
-            SceneLoader::addMeshRigidBodyData(nodeId, indexData, iByteCount);
-        SAFE_DELETE_ARRAY(indexData);
+            SceneLoader::addMeshRigidBodyData(nodeId, (unsigned char*)indexData, iByteCount);
     }
 
-    fseek(_file, position, SEEK_SET);
+    _position = position;
     return mesh;
 }
 
@@ -1168,7 +1422,7 @@ Font* Package::loadFont(const char* id)
     }
 
     // Read font family
-    std::string family = readString(_file);
+    std::string family = readString();
     if (family.empty())
     {
         LOG_ERROR_VARG("Failed to read font family for font: %s", id);
@@ -1177,25 +1431,28 @@ Font* Package::loadFont(const char* id)
 
     // Read font style and size
     unsigned int style, size;
-    if (fread(&style, 4, 1, _file) != 1 ||
-        fread(&size, 4, 1, _file) != 1)
+    if (!read(&style, 4, 1) ||
+        !read(&size, 4, 1))
     {
         LOG_ERROR_VARG("Failed to read style and/or size for font: %s", id);
         return NULL;
     }
 
+    // The spread of distance field fonts is stored above the style.
+    unsigned int distanceFieldSpread = style >> FONT_DISTANCE_FIELD_STYLE_SHIFT;
+
     // Read character set
-    std::string charset = readString(_file);
+    std::string charset = readString();
 
     // Read font glyphs
     unsigned int glyphCount;
-    if (fread(&glyphCount, 4, 1, _file) != 1 || glyphCount == 0)
+    if (!read(&glyphCount, 4, 1) || glyphCount == 0)
     {
         LOG_ERROR_VARG("Failed to read glyph count for font: %s", id);
         return NULL;
     }
     Font::Glyph* glyphs = new Font::Glyph[glyphCount];
-    if (fread(glyphs, sizeof(Font::Glyph), glyphCount, _file) != glyphCount)
+    if (!read(glyphs, sizeof(Font::Glyph), glyphCount))
     {
         LOG_ERROR_VARG("Failed to read %d glyphs for font: %s", glyphCount, id);
         SAFE_DELETE_ARRAY(glyphs);
@@ -1204,9 +1461,9 @@ Font* Package::loadFont(const char* id)
 
     // Read texture
     unsigned int width, height, textureByteCount;
-    if (fread(&width, 4, 1, _file) != 1 ||
-        fread(&height, 4, 1, _file) != 1 ||
-        fread(&textureByteCount, 4, 1, _file) != 1)
+    if (!read(&width, 4, 1) ||
+        !read(&height, 4, 1) ||
+        !read(&textureByteCount, 4, 1))
     {
         LOG_ERROR_VARG("Failed to read texture attributes for font: %s", id);
         SAFE_DELETE_ARRAY(glyphs);
@@ -1218,20 +1475,16 @@ Font* Package::loadFont(const char* id)
         SAFE_DELETE_ARRAY(glyphs);
         return NULL;
     }
-    unsigned char* textureData = new unsigned char[textureByteCount];
-    if (fread(textureData, 1, textureByteCount, _file) != textureByteCount)
+    const unsigned char* textureData = readSpan(textureByteCount);
+    if (textureData == NULL)
     {
         LOG_ERROR_VARG("Failed to read %d texture bytes for font: %s", textureByteCount, id);
         SAFE_DELETE_ARRAY(glyphs);
-        SAFE_DELETE_ARRAY(textureData);
         return NULL;
     }
 
-    // Load the texture for the font
-    Texture* texture = Texture::create(Texture::ALPHA, width, height, textureData, true);
-
-    // Free the texture data (no longer needed)
-    SAFE_DELETE_ARRAY(textureData);
+    // Load the texture for the font straight from the package contents
+    Texture* texture = Texture::create(Texture::ALPHA, width, height, (unsigned char*)textureData, true);
 
     if (texture == NULL)
     {
@@ -1241,7 +1494,7 @@ Font* Package::loadFont(const char* id)
     }
 
     // Create the font
-    Font* font = Font::create(family.c_str(), Font::PLAIN, size, glyphs, glyphCount, texture);
+    Font* font = Font::create(family.c_str(), Font::PLAIN, size, glyphs, glyphCount, texture, distanceFieldSpread);
 
     // Free the glyph array
     SAFE_DELETE_ARRAY(glyphs);
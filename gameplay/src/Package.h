@@ -130,6 +130,11 @@ private:
      */
     Reference* find(const char* id) const;
 
+    /**
+     * Builds the lookup tables of the references by ID and by offset.
+     */
+    void indexReferences();
+
     /**
      * Resets any load session specific state for the package.
      */
@@ -214,6 +219,55 @@ private:
      */
     Mesh* loadMesh(const char* id, bool loadWithMeshRBSupport, const char* nodeId);
 
+    /**
+     * Copies count values of the given size from the current file position.
+     *
+     * @param ptr A pointer to the values to copy to.
+     * @param size The size of each value, in bytes.
+     * @param count The number of values to copy.
+     * 
+     * @return True if successful, false if an error occurred.
+     */
+    bool read(void* ptr, unsigned int size, unsigned int count);
+
+    /**
+     * Returns the package contents at the current file position and skips over them,
+     * so that data can be used in place instead of being copied.
+     *
+     * The returned data remains valid for the lifetime of the package, is read-only
+     * and is not necessarily aligned.
+     *
+     * @param byteCount The number of bytes to return.
+     * 
+     * @return The data, or NULL if fewer than byteCount bytes remain in the package.
+     */
+    const unsigned char* readSpan(unsigned int byteCount);
+
+    /**
+     * Sets the current file position.
+     *
+     * @param offset The offset from the beginning of the package.
+     * 
+     * @return True if successful, false if the offset is past the end of the package.
+     */
+    bool seek(unsigned int offset);
+
+    /**
+     * Advances the current file position.
+     *
+     * @param byteCount The number of bytes to skip.
+     * 
+     * @return True if successful, false if fewer than byteCount bytes remain in the package.
+     */
+    bool skip(unsigned int byteCount);
+
+    /**
+     * Reads a length-prefixed string from the current file position.
+     *
+     * @return The string, or an empty string if an error occurred.
+     */
+    std::string readString();
+
     /**
      * Reads an unsigned int from the current file position.
      *
@@ -275,6 +329,38 @@ private:
     template <class T>
     bool readArray(unsigned int* length, std::vector<T>* values, unsigned int readSize);
     
+    /**
+     * Skips over an array of values (and its length) at the current file position.
+     *
+     * @param elementSize The size (in bytes) of each value in the array.
+     * 
+     * @return True if successful, false if an error occurred.
+     */
+    bool skipArray(unsigned int elementSize);
+
+    /**
+     * Reads an array of curve tangents from the current file position straight into the given buffer.
+     * The tangents are skipped if the array length does not match the number of key values.
+     *
+     * @param tangents The buffer to read the tangents into (at least valuesCount floats).
+     * @param valuesCount The number of key values of the curve.
+     * 
+     * @return True if successful, false if an error occurred.
+     */
+    bool readTangents(float* tangents, unsigned int valuesCount);
+
+    /**
+     * Reads an array of 16-bit quantized curve key values, and the range of each of their
+     * components, from the current file position, decoding them into the given buffer.
+     *
+     * @param values The buffer to decode the key values into (at least valuesCount floats).
+     * @param valuesCount The number of key values of the curve.
+     * @param componentCount The number of components of each key value.
+     * 
+     * @return True if successful, false if an error occurred.
+     */
+    bool readQuantizedValues(float* values, unsigned int valuesCount, unsigned int componentCount);
+
     /**
      * Reads 16 floats from the current file position.
      *
@@ -371,7 +457,13 @@ private:
     std::string _path;
     unsigned int _referenceCount;
     Reference* _references;
-    FILE* _file;
+    std::vector<std::pair<unsigned int, unsigned int> > _referencesById;       // (ID hash, reference index) pairs, sorted.
+    std::vector<std::pair<unsigned int, unsigned int> > _referencesByOffset;   // (offset, reference index) pairs, sorted.
+    const unsigned char* _data;     // The contents of the package file.
+    unsigned int _size;             // The size of the package file, in bytes.
+    unsigned int _position;         // The current read position in _data.
+    bool _mapped;                   // Whether _data is mapped from the file rather than read into memory.
+    unsigned char _version[2];      // The version of the package file (major, minor).
 
     std::vector<MeshSkinData*> _meshSkins;
 };
@@ -4,16 +4,22 @@
 #include "Node.h"
 #include "Quaternion.h"
 #include "Properties.h"
+#include "MathUtil.h"
 
 #define PARTICLE_COUNT_MAX                       100
 #define PARTICLE_EMISSION_RATE                   10
 #define PARTICLE_EMISSION_RATE_TIME_INTERVAL     1000.0f / (float)PARTICLE_EMISSION_RATE
+#define PARTICLE_FLOAT_ARRAY_COUNT               34
+#define PARTICLE_RANDOM_COUNT                    28
 
 namespace gameplay
 {
 
+// The number of emitters created, which seeds the random generator of new emitters.
+static unsigned int __emitterCount = 0;
+
 ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountMax) :
-    _particleCountMax(particleCountMax), _particleCount(0), _particles(NULL),
+    _particleCountMax(particleCountMax), _particleCount(0), _particleCapacity(0), _particleData(NULL),
     _emissionRate(PARTICLE_EMISSION_RATE), _started(false), _ellipsoid(false),
     _sizeStartMin(1.0f), _sizeStartMax(1.0f), _sizeEndMin(1.0f), _sizeEndMax(1.0f),
     _energyMin(1000L), _energyMax(1000L),
@@ -23,13 +29,42 @@ ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountM
     _acceleration(Vector3::zero()), _accelerationVar(Vector3::zero()),
     _rotationPerParticleSpeedMin(0.0f), _rotationPerParticleSpeedMax(0.0f),
     _rotationSpeedMin(0.0f), _rotationSpeedMax(0.0f),
-    _rotationAxis(Vector3::zero()), _rotation(Matrix::identity()),
-    _spriteBatch(batch), _spriteTextureBlending(BLEND_TRANSPARENT),  _spriteTextureWidth(0), _spriteTextureHeight(0), _spriteTextureWidthRatio(0), _spriteTextureHeightRatio(0), _spriteTextureCoords(NULL),
+    _rotationAxis(Vector3::zero()),
+    _spriteBatch(batch), _spriteTexture(NULL), _spriteTextureBlending(BLEND_TRANSPARENT),  _spriteTextureWidth(0), _spriteTextureHeight(0), _spriteTextureWidthRatio(0), _spriteTextureHeightRatio(0), _spriteTextureCoords(NULL),
     _spriteAnimated(false),  _spriteLooped(false), _spriteFrameCount(1), _spriteFrameRandomOffset(0),_spriteFrameDuration(0L), _spriteFrameDurationSecs(0.0f), _spritePercentPerFrame(0.0f),
     _node(NULL), _orbitPosition(false), _orbitVelocity(false), _orbitAcceleration(false),
-    _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _timeLast(0L), _timeRunning(0L)
+    _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _timeLast(0L), _timeRunning(0L), _randomSeed(0)
 {
-    _particles = new Particle[particleCountMax];
+    setRandomSeed(__emitterCount++);
+
+    // Round the capacity up to a multiple of four, so that the array kernels can always
+    // process four particles at a time.
+    _particleCapacity = (particleCountMax + 3) & ~3;
+    _particleData = new float[PARTICLE_FLOAT_ARRAY_COUNT * _particleCapacity];
+    memset(_particleData, 0, PARTICLE_FLOAT_ARRAY_COUNT * _particleCapacity * sizeof(float));
+
+    float** arrays[] =
+    {
+        &_particles._positionX, &_particles._positionY, &_particles._positionZ,
+        &_particles._velocityX, &_particles._velocityY, &_particles._velocityZ,
+        &_particles._accelerationX, &_particles._accelerationY, &_particles._accelerationZ,
+        &_particles._rotationAxisX, &_particles._rotationAxisY, &_particles._rotationAxisZ,
+        &_particles._rotationSpeed, &_particles._rotationPerParticleSpeed, &_particles._angle,
+        &_particles._energy, &_particles._energyInverse, &_particles._percent,
+        &_particles._colorStartR, &_particles._colorStartG, &_particles._colorStartB, &_particles._colorStartA,
+        &_particles._colorDeltaR, &_particles._colorDeltaG, &_particles._colorDeltaB, &_particles._colorDeltaA,
+        &_particles._colorR, &_particles._colorG, &_particles._colorB, &_particles._colorA,
+        &_particles._sizeStart, &_particles._sizeDelta, &_particles._size,
+        &_particles._timeOnCurrentFrame
+    };
+    assert(sizeof(arrays) / sizeof(arrays[0]) == PARTICLE_FLOAT_ARRAY_COUNT);
+    for (unsigned int i = 0; i < PARTICLE_FLOAT_ARRAY_COUNT; ++i)
+    {
+        *arrays[i] = _particleData + i * _particleCapacity;
+    }
+
+    _particles._frame = new unsigned int[_particleCapacity];
+    memset(_particles._frame, 0, _particleCapacity * sizeof(unsigned int));
 
     _spriteBatch->getStateBlock()->setDepthWrite(false);
     _spriteBatch->getStateBlock()->setDepthTest(true);
@@ -38,7 +73,8 @@ ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountM
 ParticleEmitter::~ParticleEmitter()
 {
     SAFE_DELETE(_spriteBatch);
-    SAFE_DELETE_ARRAY(_particles);
+    SAFE_DELETE_ARRAY(_particleData);
+    SAFE_DELETE_ARRAY(_particles._frame);
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
 }
 
@@ -66,6 +102,7 @@ ParticleEmitter* ParticleEmitter::create(const char* textureFile, TextureBlendin
 
     // By default assume only one frame which uses the entire texture.
     emitter->setTextureBlending(textureBlending);
+    emitter->_spriteTexture = texture; // owned by the batch
     emitter->_spriteTextureWidth = texture->getWidth();
     emitter->_spriteTextureHeight = texture->getHeight();
     emitter->_spriteTextureWidthRatio = 1.0f / (float)texture->getWidth();
@@ -183,6 +220,8 @@ ParticleEmitter* ParticleEmitter::create(Properties* properties)
     bool orbitPosition = properties->getBool("orbitPosition");
     bool orbitVelocity = properties->getBool("orbitVelocity");
     bool orbitAcceleration = properties->getBool("orbitAcceleration");
+    bool seeded = properties->exists("seed");
+    unsigned int seed = (unsigned int)properties->getLong("seed");
 
     // Apply all properties to a newly created ParticleEmitter.
     ParticleEmitter* emitter = ParticleEmitter::create(texturePath, textureBlending, particleCountMax);
@@ -205,6 +244,11 @@ ParticleEmitter* ParticleEmitter::create(Properties* properties)
 
     emitter->setOrbit(orbitPosition, orbitVelocity, orbitAcceleration);
 
+    if (seeded)
+    {
+        emitter->setRandomSeed(seed);
+    }
+
     return emitter;
 }
 
@@ -255,61 +299,106 @@ void ParticleEmitter::emit(unsigned int particleCount)
     // Emit the new particles.
     for (unsigned int i = 0; i < particleCount; i++)
     {
-        Particle* p = &_particles[_particleCount];
-
-        generateColor(_colorStart, _colorStartVar, &p->_colorStart);
-        generateColor(_colorEnd, _colorEndVar, &p->_colorEnd);
-        p->_color.set(p->_colorStart);
-
-        p->_energy = p->_energyStart = generateScalar(_energyMin, _energyMax);
-        p->_size = p->_sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
-        p->_sizeEnd = generateScalar(_sizeEndMin, _sizeEndMax);
-        p->_rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
-        p->_angle = generateScalar(0.0f, p->_rotationPerParticleSpeed);
-        p->_rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
+        unsigned int p = _particleCount;
+
+        // Draw all the random values of the particle at once.
+        float random[PARTICLE_RANDOM_COUNT];
+        MathUtil::randomArray(_randomState, random, PARTICLE_RANDOM_COUNT);
+
+        Vector4 colorStart;
+        Vector4 colorEnd;
+        generateColor(_colorStart, _colorStartVar, &random[0], &colorStart);
+        generateColor(_colorEnd, _colorEndVar, &random[4], &colorEnd);
+        _particles._colorR[p] = _particles._colorStartR[p] = colorStart.x;
+        _particles._colorG[p] = _particles._colorStartG[p] = colorStart.y;
+        _particles._colorB[p] = _particles._colorStartB[p] = colorStart.z;
+        _particles._colorA[p] = _particles._colorStartA[p] = colorStart.w;
+        _particles._colorDeltaR[p] = colorEnd.x - colorStart.x;
+        _particles._colorDeltaG[p] = colorEnd.y - colorStart.y;
+        _particles._colorDeltaB[p] = colorEnd.z - colorStart.z;
+        _particles._colorDeltaA[p] = colorEnd.w - colorStart.w;
+
+        // Energy is measured in whole milliseconds.
+        float energy = floor(generateScalar(_energyMin, _energyMax, random[8]));
+        _particles._energy[p] = energy;
+        _particles._energyInverse[p] = energy > 0.0f ? 1.0f / energy : 0.0f;
+        _particles._percent[p] = 0.0f;
+
+        float sizeStart = generateScalar(_sizeStartMin, _sizeStartMax, random[9]);
+        _particles._size[p] = _particles._sizeStart[p] = sizeStart;
+        _particles._sizeDelta[p] = generateScalar(_sizeEndMin, _sizeEndMax, random[10]) - sizeStart;
+
+        float rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax, random[11]);
+        _particles._rotationPerParticleSpeed[p] = rotationPerParticleSpeed;
+        _particles._angle[p] = generateScalar(0.0f, rotationPerParticleSpeed, random[12]);
+        float rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax, random[13]);
 
         // Only initial position can be generated within an ellipsoidal domain.
-        generateVector(_position, _positionVar, &p->_position, _ellipsoid);
-        generateVector(_velocity, _velocityVar, &p->_velocity, false);
-        generateVector(_acceleration, _accelerationVar, &p->_acceleration, false);
-        generateVector(_rotationAxis, _rotationAxisVar, &p->_rotationAxis, false);
+        Vector3 position;
+        Vector3 velocity;
+        Vector3 acceleration;
+        Vector3 rotationAxis;
+        generateVector(_position, _positionVar, &random[14], &position, _ellipsoid);
+        generateVector(_velocity, _velocityVar, &random[17], &velocity, false);
+        generateVector(_acceleration, _accelerationVar, &random[20], &acceleration, false);
+        generateVector(_rotationAxis, _rotationAxisVar, &random[23], &rotationAxis, false);
 
         // Initial position, velocity and acceleration can all be relative to the emitter's transform.
         // Rotate specified properties by the node's rotation.
         if (_orbitPosition)
         {
-            world.transformPoint(p->_position, &p->_position);
+            world.transformPoint(position, &position);
         }
 
         if (_orbitVelocity)
         {
-            world.transformPoint(p->_velocity, &p->_velocity);
+            world.transformPoint(velocity, &velocity);
         }
 
         if (_orbitAcceleration)
         {
-            world.transformPoint(p->_acceleration, &p->_acceleration);
+            world.transformPoint(acceleration, &acceleration);
         }
 
-        // The rotation axis always orbits the node.
-        if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
+        // The rotation axis always orbits the node. It is normalized once here rather than
+        // on every update, and particles without a rotation axis do not rotate.
+        if (rotationSpeed != 0.0f && !rotationAxis.isZero())
+        {
+            world.transformPoint(rotationAxis, &rotationAxis);
+            rotationAxis.normalize();
+        }
+        else
         {
-            world.transformPoint(p->_rotationAxis, &p->_rotationAxis);
+            rotationSpeed = 0.0f;
         }
 
         // Translate position relative to the node's world space.
-        p->_position.add(translation);
+        position.add(translation);
+
+        _particles._positionX[p] = position.x;
+        _particles._positionY[p] = position.y;
+        _particles._positionZ[p] = position.z;
+        _particles._velocityX[p] = velocity.x;
+        _particles._velocityY[p] = velocity.y;
+        _particles._velocityZ[p] = velocity.z;
+        _particles._accelerationX[p] = acceleration.x;
+        _particles._accelerationY[p] = acceleration.y;
+        _particles._accelerationZ[p] = acceleration.z;
+        _particles._rotationAxisX[p] = rotationAxis.x;
+        _particles._rotationAxisY[p] = rotationAxis.y;
+        _particles._rotationAxisZ[p] = rotationAxis.z;
+        _particles._rotationSpeed[p] = rotationSpeed;
 
         // Initial sprite frame.
         if (_spriteFrameRandomOffset > 0)
         {
-            p->_frame = rand() % _spriteFrameRandomOffset;
+            _particles._frame[p] = (unsigned int)(random[26] * _spriteFrameRandomOffset);
         }
         else
         {
-            p->_frame = 0;
+            _particles._frame[p] = 0;
         }
-        p->_timeOnCurrentFrame = 0.0f;
+        _particles._timeOnCurrentFrame[p] = 0.0f;
 
         ++_particleCount;
     }
@@ -320,6 +409,29 @@ unsigned int ParticleEmitter::getParticlesCount() const
     return _particleCount;
 }
 
+void ParticleEmitter::setRandomSeed(unsigned int seed)
+{
+    _randomSeed = seed;
+
+    // Spread the seed over the four generators, hashing it so that close seeds give
+    // unrelated sequences. xorshift generators must not have a zero state.
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        unsigned int x = seed + i * 0x9E3779B9;
+        x ^= x >> 16;
+        x *= 0x7FEB352D;
+        x ^= x >> 15;
+        x *= 0x846CA68B;
+        x ^= x >> 16;
+        _randomState[i] = x ? x : 0x9E3779B9;
+    }
+}
+
+unsigned int ParticleEmitter::getRandomSeed() const
+{
+    return _randomSeed;
+}
+
 void ParticleEmitter::setEllipsoid(bool ellipsoid)
 {
     _ellipsoid = ellipsoid;
@@ -645,47 +757,33 @@ void ParticleEmitter::setOrbit(bool orbitPosition, bool orbitVelocity, bool orbi
     _orbitAcceleration = orbitAcceleration;
 }
 
-long ParticleEmitter::generateScalar(long min, long max)
-{
-    // Note: this is not a very good RNG, but it should be suitable for our purposes.
-    long r = 0;
-    for (unsigned int i = 0; i < sizeof(long)/sizeof(int); i++)
-    {
-        r = r << 8; // sizeof(int) * CHAR_BITS
-        r |= rand();
-    }
-
-    // Now we have a random long between 0 and MAX_LONG.  We need to clamp it between min and max.
-    r %= max - min;
-    r += min;
-
-    return r;
-}
-
-float ParticleEmitter::generateScalar(float min, float max)
+float ParticleEmitter::generateScalar(float min, float max, float random)
 {
-    return min + (max - min) * MATH_RANDOM_0_1();
+    return min + (max - min) * random;
 }
 
-void ParticleEmitter::generateVectorInRect(const Vector3& base, const Vector3& variance, Vector3* dst)
+void ParticleEmitter::generateVectorInRect(const Vector3& base, const Vector3& variance, const float* random, Vector3* dst)
 {
     // Scale each component of the variance vector by a random float
     // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
+    dst->x = base.x + variance.x * (2.0f * random[0] - 1.0f);
+    dst->y = base.y + variance.y * (2.0f * random[1] - 1.0f);
+    dst->z = base.z + variance.z * (2.0f * random[2] - 1.0f);
 }
 
-void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vector3& scale, Vector3* dst)
+void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vector3& scale, const float* random, Vector3* dst)
 {
-    // Generate a point within a unit cube, then reject if the point is not in a unit sphere.
-    do
-    {
-        dst->x = MATH_RANDOM_MINUS1_1();
-        dst->y = MATH_RANDOM_MINUS1_1();
-        dst->z = MATH_RANDOM_MINUS1_1();
-    } while (dst->length() > 1.0f);
-    
+    // Generate a point within a unit sphere directly, rather than rejecting points of a unit cube:
+    // pick a direction uniformly on the sphere from its height and longitude, and a distance from
+    // the center whose cube is uniform, since the volume within a radius grows with its cube.
+    float z = 2.0f * random[0] - 1.0f;
+    float longitude = MATH_PIX2 * random[1];
+    float radius = pow(random[2], 1.0f / 3.0f);
+    float r = radius * sqrt(1.0f - z * z);
+    dst->x = r * cos(longitude);
+    dst->y = r * sin(longitude);
+    dst->z = radius * z;
+
     // Scale this point by the scaling vector.
     dst->x *= scale.x;
     dst->y *= scale.y;
@@ -695,26 +793,26 @@ void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vec
     dst->add(center);
 }
 
-void ParticleEmitter::generateVector(const Vector3& base, const Vector3& variance, Vector3* dst, bool ellipsoid)
+void ParticleEmitter::generateVector(const Vector3& base, const Vector3& variance, const float* random, Vector3* dst, bool ellipsoid)
 {
     if (ellipsoid)
     {
-        generateVectorInEllipsoid(base, variance, dst);
+        generateVectorInEllipsoid(base, variance, random, dst);
     }
     else
     {
-        generateVectorInRect(base, variance, dst);
+        generateVectorInRect(base, variance, random, dst);
     }
 }
 
-void ParticleEmitter::generateColor(const Vector4& base, const Vector4& variance, Vector4* dst)
+void ParticleEmitter::generateColor(const Vector4& base, const Vector4& variance, const float* random, Vector4* dst)
 {
     // Scale each component of the variance color by a random float
     // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
-    dst->w = base.w + variance.w * MATH_RANDOM_MINUS1_1();
+    dst->x = base.x + variance.x * (2.0f * random[0] - 1.0f);
+    dst->y = base.y + variance.y * (2.0f * random[1] - 1.0f);
+    dst->z = base.z + variance.z * (2.0f * random[2] - 1.0f);
+    dst->w = base.w + variance.w * (2.0f * random[3] - 1.0f);
 }
 
 ParticleEmitter::TextureBlending ParticleEmitter::getTextureBlendingFromString(const char* str)
@@ -761,89 +859,172 @@ void ParticleEmitter::update(long elapsedTime)
         emit(emitCount);
     }
 
-    // Now update all currently living particles.
-    for (unsigned int particlesIndex = 0; particlesIndex < _particleCount; ++particlesIndex)
-    {
-        Particle* p = &_particles[particlesIndex];
-        p->_energy -= elapsedTime;
+    // Now update all currently living particles, four at a time. The particles past the
+    // last living one, up to the next multiple of four, are dead and only updated to keep
+    // the loops free of a scalar remainder.
+    unsigned int count = (_particleCount + 3) & ~3;
 
-        if (p->_energy > 0L)
-        {
-            if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
-            {
-                Matrix::createRotation(p->_rotationAxis, p->_rotationSpeed * elapsedSecs, &_rotation);
+    MathUtil::spendEnergyArray(_particles._energy, _particles._energyInverse, (float)elapsedTime, _particles._percent, count);
 
-                _rotation.transformPoint(p->_velocity, &p->_velocity);
-                _rotation.transformPoint(p->_acceleration, &p->_acceleration);
-            }
+    rotateParticles(elapsedSecs);
+
+    MathUtil::addScaledArray(_particles._accelerationX, elapsedSecs, _particles._velocityX, count);
+    MathUtil::addScaledArray(_particles._accelerationY, elapsedSecs, _particles._velocityY, count);
+    MathUtil::addScaledArray(_particles._accelerationZ, elapsedSecs, _particles._velocityZ, count);
 
-            // Particle is still alive.
-            p->_velocity.x += p->_acceleration.x * elapsedSecs;
-            p->_velocity.y += p->_acceleration.y * elapsedSecs;
-            p->_velocity.z += p->_acceleration.z * elapsedSecs;
+    MathUtil::addScaledArray(_particles._velocityX, elapsedSecs, _particles._positionX, count);
+    MathUtil::addScaledArray(_particles._velocityY, elapsedSecs, _particles._positionY, count);
+    MathUtil::addScaledArray(_particles._velocityZ, elapsedSecs, _particles._positionZ, count);
 
-            p->_position.x += p->_velocity.x * elapsedSecs;
-            p->_position.y += p->_velocity.y * elapsedSecs;
-            p->_position.z += p->_velocity.z * elapsedSecs;
+    MathUtil::addScaledArray(_particles._rotationPerParticleSpeed, elapsedSecs, _particles._angle, count);
 
-            p->_angle += p->_rotationPerParticleSpeed * elapsedSecs;
+    // Simple linear interpolation of color and size.
+    MathUtil::lerpArray(_particles._colorStartR, _particles._colorDeltaR, _particles._percent, _particles._colorR, count);
+    MathUtil::lerpArray(_particles._colorStartG, _particles._colorDeltaG, _particles._percent, _particles._colorG, count);
+    MathUtil::lerpArray(_particles._colorStartB, _particles._colorDeltaB, _particles._percent, _particles._colorB, count);
+    MathUtil::lerpArray(_particles._colorStartA, _particles._colorDeltaA, _particles._percent, _particles._colorA, count);
+    MathUtil::lerpArray(_particles._sizeStart, _particles._sizeDelta, _particles._percent, _particles._size, count);
 
-            // Simple linear interpolation of color and size.
-            float percent = 1.0f - ((float)p->_energy / (float)p->_energyStart);
+    // Handle sprite animations.
+    if (_spriteAnimated)
+    {
+        if (!_spriteLooped)
+        {
+            // The last frame should finish exactly when the particle dies.
+            MathUtil::advanceFrameArray(_particles._percent, _spritePercentPerFrame, _spriteFrameCount - 1, _particles._frame, count);
+        }
+        else
+        {
+            // _spriteFrameDurationSecs is an absolute time measured in seconds,
+            // and the animation repeats indefinitely.
+            MathUtil::advanceLoopedFrameArray(_particles._timeOnCurrentFrame, elapsedSecs, _spriteFrameDurationSecs, _spriteFrameCount,
+                                              _particles._frame, count);
+        }
+    }
 
-            p->_color.x = p->_colorStart.x + (p->_colorEnd.x - p->_colorStart.x) * percent;
-            p->_color.y = p->_colorStart.y + (p->_colorEnd.y - p->_colorStart.y) * percent;
-            p->_color.z = p->_colorStart.z + (p->_colorEnd.z - p->_colorStart.z) * percent;
-            p->_color.w = p->_colorStart.w + (p->_colorEnd.w - p->_colorStart.w) * percent;
+    removeDeadParticles();
 
-            p->_size = p->_sizeStart + (p->_sizeEnd - p->_sizeStart) * percent;
+    updateBounds();
+}
 
-            // Handle sprite animations.
-            if (_spriteAnimated)
-            {
-                if (!_spriteLooped)
-                {
-                    // The last frame should finish exactly when the particle dies.
-                    float percentSpent = 0.0f;
-                    for (unsigned int i = 0; i < p->_frame; i++)
-                    {
-                        percentSpent += _spritePercentPerFrame;
-                    }
-                    p->_timeOnCurrentFrame = percent - percentSpent;
-                    if (p->_frame < _spriteFrameCount - 1 &&
-                        p->_timeOnCurrentFrame >= _spritePercentPerFrame)
-                    {
-                        ++p->_frame;
-                    }
-                }
-                else
-                {
-                    // _spriteFrameDurationSecs is an absolute time measured in seconds,
-                    // and the animation repeats indefinitely.
-                    p->_timeOnCurrentFrame += elapsedSecs;
-                    if (p->_timeOnCurrentFrame >= _spriteFrameDurationSecs)
-                    {
-                        p->_timeOnCurrentFrame -= _spriteFrameDurationSecs;
-                        ++p->_frame;
-                        if (p->_frame == _spriteFrameCount)
-                        {
-                            p->_frame = 0;
-                        }
-                    }
-                }
-            }
+void ParticleEmitter::rotateParticles(float elapsedSecs)
+{
+    for (unsigned int i = 0; i < _particleCount; ++i)
+    {
+        float speed = _particles._rotationSpeed[i];
+        if (speed == 0.0f)
+        {
+            continue;
         }
-        else
+
+        // Rotate around the unit axis k with Rodrigues' formula,
+        // v' = v cos(a) + (k x v) sin(a) + k (k . v) (1 - cos(a)),
+        // which applies the rotation Matrix::createRotation builds without building it.
+        float angle = speed * elapsedSecs;
+        float c = cos(angle);
+        float s = sin(angle);
+        float t = 1.0f - c;
+        float kx = _particles._rotationAxisX[i];
+        float ky = _particles._rotationAxisY[i];
+        float kz = _particles._rotationAxisZ[i];
+
+        float x = _particles._velocityX[i];
+        float y = _particles._velocityY[i];
+        float z = _particles._velocityZ[i];
+        float d = (kx * x + ky * y + kz * z) * t;
+        _particles._velocityX[i] = x * c + (ky * z - kz * y) * s + kx * d;
+        _particles._velocityY[i] = y * c + (kz * x - kx * z) * s + ky * d;
+        _particles._velocityZ[i] = z * c + (kx * y - ky * x) * s + kz * d;
+
+        x = _particles._accelerationX[i];
+        y = _particles._accelerationY[i];
+        z = _particles._accelerationZ[i];
+        d = (kx * x + ky * y + kz * z) * t;
+        _particles._accelerationX[i] = x * c + (ky * z - kz * y) * s + kx * d;
+        _particles._accelerationY[i] = y * c + (kz * x - kx * z) * s + ky * d;
+        _particles._accelerationZ[i] = z * c + (kx * y - ky * x) * s + kz * d;
+    }
+}
+
+void ParticleEmitter::removeDeadParticles()
+{
+    // Walk the particles from both ends at once: each dead particle found from the start
+    // is replaced by the last living particle found from the end, so every particle is
+    // visited once and only the particles filling holes are copied.
+    unsigned int i = 0;
+    unsigned int count = _particleCount;
+    while (i < count)
+    {
+        if (_particles._energy[i] > 0.0f)
         {
-            // Particle is dead.  Move the particle furthest from the start of the array
-            // down to take its place, and re-use the slot at the end of the list of living particles.
-            if (particlesIndex != _particleCount - 1)
-            {
-                _particles[particlesIndex] = _particles[_particleCount - 1];
-            }
-            --_particleCount;
+            ++i;
+            continue;
+        }
+
+        do
+        {
+            --count;
+        } while (count > i && _particles._energy[count] <= 0.0f);
+
+        if (count > i)
+        {
+            copyParticle(count, i);
+            ++i;
+        }
+    }
+    _particleCount = count;
+}
+
+void ParticleEmitter::copyParticle(unsigned int src, unsigned int dst)
+{
+    for (unsigned int i = 0; i < PARTICLE_FLOAT_ARRAY_COUNT; ++i)
+    {
+        float* array = _particleData + i * _particleCapacity;
+        array[dst] = array[src];
+    }
+    _particles._frame[dst] = _particles._frame[src];
+}
+
+void ParticleEmitter::updateBounds()
+{
+    if (_particleCount == 0)
+    {
+        _bounds.set(Vector3::zero(), Vector3::zero());
+        return;
+    }
+
+    // SpriteBatch draws each particle as a quad in the XY plane spanning [x, x + size]
+    // and [y, y + size], rotated around its center when particles rotate. Bound the
+    // circle around that center with a radius of half the diagonal, which holds the
+    // quad at any angle. The quads are flat, so z is not padded.
+    Vector3 min;
+    Vector3 max;
+    for (unsigned int i = 0; i < _particleCount; ++i)
+    {
+        float size = _particles._size[i];
+        float radius = fabs(size) * 0.70710678f;
+        float x = _particles._positionX[i] + size * 0.5f;
+        float y = _particles._positionY[i] + size * 0.5f;
+        float z = _particles._positionZ[i];
+        if (i == 0)
+        {
+            min.set(x - radius, y - radius, z);
+            max.set(x + radius, y + radius, z);
+            continue;
         }
+        min.x = x - radius < min.x ? x - radius : min.x;
+        min.y = y - radius < min.y ? y - radius : min.y;
+        min.z = z < min.z ? z : min.z;
+        max.x = x + radius > max.x ? x + radius : max.x;
+        max.y = y + radius > max.y ? y + radius : max.y;
+        max.z = z > max.z ? z : max.z;
     }
+    _bounds.set(min, max);
+}
+
+const BoundingBox& ParticleEmitter::getBoundingBox() const
+{
+    return _bounds;
 }
 
 void ParticleEmitter::draw()
@@ -859,32 +1040,42 @@ void ParticleEmitter::draw()
         // Begin sprite batch drawing
         _spriteBatch->begin();
 
-        // Which draw call we use depends on whether particles are rotating.
-        if (_rotationPerParticleSpeedMin == 0.0f && _rotationPerParticleSpeedMax == 0.0f)
+        drawParticles(_spriteBatch);
+
+        // Render.
+        _spriteBatch->end();
+    }
+}
+
+void ParticleEmitter::drawParticles(SpriteBatch* batch)
+{
+    // Which draw call we use depends on whether particles are rotating.
+    if (_rotationPerParticleSpeedMin == 0.0f && _rotationPerParticleSpeedMax == 0.0f)
+    {
+        // No rotation.
+        for (unsigned int i = 0; i < _particleCount; i++)
         {
-            // No rotation.
-            for (unsigned int i = 0; i < _particleCount; i++)
-            {
-                Particle* p = &_particles[i];
-                _spriteBatch->draw(p->_position.x, p->_position.y, p->_position.z, p->_size, p->_size,
-                                   _spriteTextureCoords[p->_frame * 4], _spriteTextureCoords[p->_frame * 4 + 1], _spriteTextureCoords[p->_frame * 4 + 2], _spriteTextureCoords[p->_frame * 4 + 3], p->_color);
-            }
+            const float* texCoords = &_spriteTextureCoords[_particles._frame[i] * 4];
+            float size = _particles._size[i];
+            batch->draw(_particles._positionX[i], _particles._positionY[i], _particles._positionZ[i], size, size,
+                        texCoords[0], texCoords[1], texCoords[2], texCoords[3],
+                        Vector4(_particles._colorR[i], _particles._colorG[i], _particles._colorB[i], _particles._colorA[i]));
         }
-        else
-        {
-            // Rotation.
-            Vector2 pivot(0.5f, 0.5f);
+    }
+    else
+    {
+        // Rotation.
+        Vector2 pivot(0.5f, 0.5f);
 
-            for (unsigned int i = 0; i < _particleCount; i++)
-            {
-                Particle* p = &_particles[i];
-                _spriteBatch->draw(p->_position, p->_size, p->_size,
-                                   _spriteTextureCoords[p->_frame * 4], _spriteTextureCoords[p->_frame * 4 + 1], _spriteTextureCoords[p->_frame * 4 + 2], _spriteTextureCoords[p->_frame * 4 + 3], p->_color, pivot, p->_angle);
-            }
+        for (unsigned int i = 0; i < _particleCount; i++)
+        {
+            const float* texCoords = &_spriteTextureCoords[_particles._frame[i] * 4];
+            float size = _particles._size[i];
+            batch->draw(Vector3(_particles._positionX[i], _particles._positionY[i], _particles._positionZ[i]), size, size,
+                        texCoords[0], texCoords[1], texCoords[2], texCoords[3],
+                        Vector4(_particles._colorR[i], _particles._colorG[i], _particles._colorB[i], _particles._colorA[i]),
+                        pivot, _particles._angle[i]);
         }
-
-        // Render.
-        _spriteBatch->end();
     }
 }
 
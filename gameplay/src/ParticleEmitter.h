@@ -9,6 +9,7 @@
 #include "Rectangle.h"
 #include "SpriteBatch.h"
 #include "Properties.h"
+#include "BoundingBox.h"
 
 namespace gameplay
 {
@@ -139,6 +140,8 @@ class Node;
 class ParticleEmitter : public Ref
 {
     friend class Node;
+    friend class ParticleSystem;
+    friend class ParticleEmitterTest;
 
 public:
 
@@ -232,6 +235,28 @@ public:
      */
     unsigned int getParticlesCount() const;
 
+    /**
+     * Sets the seed of the random generator used to assign the properties of newly emitted particles.
+     *
+     * The generator belongs to the emitter, so an emitter seeded with the same value and driven
+     * by the same sequence of calls to emit() and update() emits the same particles, which allows
+     * particle effects to be replayed. The random sequence itself is identical on every platform,
+     * but the particle properties derived from it go through floating-point math (such as pow,
+     * sin and cos for ellipsoidal positions) whose last bits can differ between platforms and
+     * compilers, so replays are only exact on the same build. By default, emitters are seeded
+     * with the number of emitters created before them.
+     *
+     * @param seed The seed of the random generator.
+     */
+    void setRandomSeed(unsigned int seed);
+
+    /**
+     * Gets the seed of the random generator used to assign the properties of newly emitted particles.
+     *
+     * @return The seed last set on the random generator.
+     */
+    unsigned int getRandomSeed() const;
+
     /**
      * Sets whether the positions of newly emitted particles are generated within an ellipsoidal domain.
      *
@@ -603,6 +628,14 @@ public:
      */
     void draw();
 
+    /**
+     * Gets the world space bounds of the particles currently being emitted, as of the last
+     * call to update(). The bounds include the full extent of each particle's sprite quad.
+     *
+     * @return The bounds of the living particles, or an empty box when there are none.
+     */
+    const BoundingBox& getBoundingBox() const;
+
 private:
 
     /**
@@ -621,28 +654,29 @@ private:
     void setNode(Node* node);
 
     /**
-     * Generates a scalar within the range defined by min and max.
+     * Generates a scalar within the range defined by min and max from a random value in [0, 1).
      */
-    float generateScalar(float min, float max);
-
-    long generateScalar(long min, long max);
+    float generateScalar(float min, float max, float random);
 
     /**
-     * Generates a vector within the domain defined by a base vector and its variance.
+     * Generates a vector within the domain defined by a base vector and its variance
+     * from 3 random values in [0, 1).
      */
-    void generateVectorInRect(const Vector3& base, const Vector3& variance, Vector3* dst);
+    void generateVectorInRect(const Vector3& base, const Vector3& variance, const float* random, Vector3* dst);
 
     /**
-     * Generates a vector within the ellipsoidal domain defined by a center point and scale vector.
+     * Generates a vector within the ellipsoidal domain defined by a center point and scale vector
+     * from 3 random values in [0, 1).
      */
-    void generateVectorInEllipsoid(const Vector3& center, const Vector3& scale, Vector3* dst);
+    void generateVectorInEllipsoid(const Vector3& center, const Vector3& scale, const float* random, Vector3* dst);
 
-    void generateVector(const Vector3& base, const Vector3& variance, Vector3* dst, bool ellipsoid);
+    void generateVector(const Vector3& base, const Vector3& variance, const float* random, Vector3* dst, bool ellipsoid);
 
     /**
-     * Generates a color within the domain defined by a base vector and its variance.
+     * Generates a color within the domain defined by a base vector and its variance
+     * from 4 random values in [0, 1).
      */
-    void generateColor(const Vector4& base, const Vector4& variance, Vector4* dst);
+    void generateColor(const Vector4& base, const Vector4& variance, const float* random, Vector4* dst);
 
     /**
      * Gets a BlendMode enum from a corresponding string.
@@ -652,34 +686,84 @@ private:
     void setTextureBlending(TextureBlending blending);
 
     /**
-     * Defines the data for a single particle in the system.
+     * Rotates the velocity and acceleration of the living particles around their rotation axis.
+     */
+    void rotateParticles(float elapsedSecs);
+
+    /**
+     * Removes the particles that ran out of energy, moving the last living particles into their slots.
+     */
+    void removeDeadParticles();
+
+    /**
+     * Copies the particle at index src over the particle at index dst.
+     */
+    void copyParticle(unsigned int src, unsigned int dst);
+
+    /**
+     * Computes the bounds of the living particles.
+     */
+    void updateBounds();
+
+    /**
+     * Adds the living particles to the given sprite batch, between its begin() and end().
+     */
+    void drawParticles(SpriteBatch* batch);
+
+    /**
+     * Defines the data of the particles in the system as a structure of arrays.
+     *
+     * Each property of the particles is stored in its own array, indexed by particle,
+     * so that update() processes four particles at a time with the array kernels of
+     * MathUtil. The float arrays are allocated one after the other in a single block,
+     * each with the capacity of the emitter rounded up to a multiple of four.
      */
-    class Particle
+    class Particles
     {
 
     public:
-        Vector3 _position;
-        Vector3 _velocity;
-        Vector3 _acceleration;
-        Vector4 _colorStart;
-        Vector4 _colorEnd;
-        Vector4 _color;
-        float _rotationPerParticleSpeed;
-        Vector3 _rotationAxis;
-        float _rotationSpeed;
-        float _angle;
-        long _energyStart;
-        long _energy;
-        float _sizeStart;
-        float _sizeEnd;
-        float _size;
-        unsigned int _frame;
-        float _timeOnCurrentFrame;
+        float* _positionX;
+        float* _positionY;
+        float* _positionZ;
+        float* _velocityX;
+        float* _velocityY;
+        float* _velocityZ;
+        float* _accelerationX;
+        float* _accelerationY;
+        float* _accelerationZ;
+        float* _rotationAxisX;
+        float* _rotationAxisY;
+        float* _rotationAxisZ;
+        float* _rotationSpeed;
+        float* _rotationPerParticleSpeed;
+        float* _angle;
+        float* _energy;
+        float* _energyInverse;
+        float* _percent;
+        float* _colorStartR;
+        float* _colorStartG;
+        float* _colorStartB;
+        float* _colorStartA;
+        float* _colorDeltaR;
+        float* _colorDeltaG;
+        float* _colorDeltaB;
+        float* _colorDeltaA;
+        float* _colorR;
+        float* _colorG;
+        float* _colorB;
+        float* _colorA;
+        float* _sizeStart;
+        float* _sizeDelta;
+        float* _size;
+        float* _timeOnCurrentFrame;
+        unsigned int* _frame;
     };
 
     unsigned int _particleCountMax;
     unsigned int _particleCount;
-    Particle* _particles;
+    unsigned int _particleCapacity;
+    float* _particleData;
+    Particles _particles;
     unsigned int _emissionRate;
     bool _started;
     bool _ellipsoid;
@@ -705,8 +789,8 @@ private:
     float _rotationSpeedMax;
     Vector3 _rotationAxis;
     Vector3 _rotationAxisVar;
-    Matrix _rotation;
     SpriteBatch* _spriteBatch;
+    Texture* _spriteTexture;
     TextureBlending _spriteTextureBlending;
     float _spriteTextureWidth;
     float _spriteTextureHeight;
@@ -727,6 +811,9 @@ private:
     float _timePerEmission;
     long _timeLast;
     long _timeRunning;
+    unsigned int _randomSeed;
+    unsigned int _randomState[4];
+    BoundingBox _bounds;
 };
 
 }
@@ -0,0 +1,176 @@
+#include "Base.h"
+#include "ParticleSystem.h"
+#include "Game.h"
+#include "Node.h"
+
+// The number of particles a sprite batch can hold, since its vertices are indexed with 16 bits.
+#define PARTICLE_SYSTEM_MAX_BATCH_PARTICLES 16384
+
+// The minimum number of emitters worth updating in parallel.
+#define PARTICLE_SYSTEM_PARALLEL_THRESHOLD 2
+
+namespace gameplay
+{
+
+ParticleSystem::ParticleSystem()
+    : _elapsedTime(0L), _drawCallCount(0)
+{
+}
+
+ParticleSystem::ParticleSystem(const ParticleSystem& copy)
+{
+    // hidden
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    for (unsigned int i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_emitters[i]);
+    }
+}
+
+ParticleSystem* ParticleSystem::create()
+{
+    return new ParticleSystem();
+}
+
+void ParticleSystem::addEmitter(ParticleEmitter* emitter)
+{
+    assert(emitter);
+
+    if (std::find(_emitters.begin(), _emitters.end(), emitter) == _emitters.end())
+    {
+        emitter->addRef();
+        _emitters.push_back(emitter);
+    }
+}
+
+void ParticleSystem::removeEmitter(ParticleEmitter* emitter)
+{
+    std::vector<ParticleEmitter*>::iterator itr = std::find(_emitters.begin(), _emitters.end(), emitter);
+    if (itr != _emitters.end())
+    {
+        _emitters.erase(itr);
+        SAFE_RELEASE(emitter);
+    }
+}
+
+unsigned int ParticleSystem::getEmitterCount() const
+{
+    return _emitters.size();
+}
+
+ParticleEmitter* ParticleSystem::getEmitter(unsigned int index) const
+{
+    assert(index < _emitters.size());
+
+    return _emitters[index];
+}
+
+void ParticleSystem::update(long elapsedTime)
+{
+    unsigned int emitterCount = _emitters.size();
+
+    // Emitting particles reads the world matrix of the emitter's node, which is resolved
+    // lazily and may share dirty ancestors with other emitters, so resolve them all here.
+    for (unsigned int i = 0; i < emitterCount; ++i)
+    {
+        Node* node = _emitters[i]->getNode();
+        if (node)
+        {
+            node->getWorldMatrix();
+        }
+    }
+
+    Game* game = Game::getInstance();
+    JobSystem* jobSystem = game ? game->getJobSystem() : NULL;
+    _elapsedTime = elapsedTime;
+    if (!jobSystem || jobSystem->getWorkerCount() == 0 || emitterCount < PARTICLE_SYSTEM_PARALLEL_THRESHOLD)
+    {
+        for (unsigned int i = 0; i < emitterCount; ++i)
+        {
+            _emitters[i]->update(elapsedTime);
+        }
+        return;
+    }
+
+    jobSystem->parallelFor(emitterCount, &ParticleSystem::updateEmitter, this);
+}
+
+void ParticleSystem::updateEmitter(void* data, unsigned int index)
+{
+    ParticleSystem* system = (ParticleSystem*)data;
+    system->_emitters[index]->update(system->_elapsedTime);
+}
+
+bool ParticleSystem::compareEmitters(ParticleEmitter* emitter1, ParticleEmitter* emitter2)
+{
+    if (emitter1->_spriteTexture != emitter2->_spriteTexture)
+    {
+        return emitter1->_spriteTexture < emitter2->_spriteTexture;
+    }
+    return emitter1->_spriteTextureBlending < emitter2->_spriteTextureBlending;
+}
+
+void ParticleSystem::draw(Camera* camera)
+{
+    assert(camera);
+
+    _drawCallCount = 0;
+
+    // Cull the emitters against the view frustum.
+    const Frustum& frustum = camera->getFrustum();
+    _visible.clear();
+    for (unsigned int i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        ParticleEmitter* emitter = _emitters[i];
+        if (emitter->_particleCount > 0 && frustum.intersects(emitter->getBoundingBox()))
+        {
+            _visible.push_back(emitter);
+        }
+    }
+
+    // Group the emitters that share a texture and blend mode, keeping the order they were
+    // added in within each group.
+    std::stable_sort(_visible.begin(), _visible.end(), &ParticleSystem::compareEmitters);
+
+    // Draw each group with the batch of its first emitter, which has the same texture and
+    // render state as the others.
+    const Matrix& viewProjection = camera->getViewProjectionMatrix();
+    for (unsigned int start = 0, count = _visible.size(); start < count; )
+    {
+        SpriteBatch* batch = _visible[start]->_spriteBatch;
+        batch->setProjectionMatrix(viewProjection);
+        batch->begin();
+
+        unsigned int batchParticleCount = 0;
+        unsigned int end = start;
+        do
+        {
+            ParticleEmitter* emitter = _visible[end];
+            if (batchParticleCount > 0 && batchParticleCount + emitter->_particleCount > PARTICLE_SYSTEM_MAX_BATCH_PARTICLES)
+            {
+                // The batch is full, so draw it and start over.
+                batch->end();
+                ++_drawCallCount;
+                batch->begin();
+                batchParticleCount = 0;
+            }
+            emitter->drawParticles(batch);
+            batchParticleCount += emitter->_particleCount;
+            ++end;
+        } while (end < count && !compareEmitters(_visible[start], _visible[end]));
+
+        batch->end();
+        ++_drawCallCount;
+        start = end;
+    }
+}
+
+unsigned int ParticleSystem::getDrawCallCount() const
+{
+    return _drawCallCount;
+}
+
+}
@@ -0,0 +1,120 @@
+#ifndef PARTICLESYSTEM_H_
+#define PARTICLESYSTEM_H_
+
+#include "ParticleEmitter.h"
+#include "Camera.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a set of particle emitters that are updated and drawn together.
+ *
+ * Emitters are independent of each other, so a particle system updates them in
+ * parallel on the worker threads of the game's job system. When drawing, emitters
+ * whose particles are outside the camera's view frustum are skipped, and the
+ * particles of all visible emitters that share a texture and blend mode are
+ * drawn with a single sprite batch, so a scene with many small emitters is drawn
+ * with one draw call per texture and blend mode rather than one per emitter.
+ *
+ * Emitters must be attached to a node to emit particles. The emitters of a
+ * particle system should be updated and drawn through the particle system only.
+ */
+class ParticleSystem : public Ref
+{
+public:
+
+    /**
+     * Creates a new, empty particle system.
+     *
+     * @return The new particle system.
+     */
+    static ParticleSystem* create();
+
+    /**
+     * Adds an emitter to this particle system, which holds a reference to it.
+     *
+     * @param emitter The emitter to add.
+     */
+    void addEmitter(ParticleEmitter* emitter);
+
+    /**
+     * Removes an emitter from this particle system.
+     *
+     * @param emitter The emitter to remove.
+     */
+    void removeEmitter(ParticleEmitter* emitter);
+
+    /**
+     * Gets the number of emitters in this particle system.
+     *
+     * @return The number of emitters.
+     */
+    unsigned int getEmitterCount() const;
+
+    /**
+     * Gets an emitter of this particle system.
+     *
+     * @param index The index of the emitter, in the order emitters were added.
+     *
+     * @return The emitter.
+     */
+    ParticleEmitter* getEmitter(unsigned int index) const;
+
+    /**
+     * Updates the particles of all emitters.
+     *
+     * @param elapsedTime The amount of time that has passed since the last call to update(), in milliseconds.
+     */
+    void update(long elapsedTime);
+
+    /**
+     * Draws the particles of all emitters visible from the given camera.
+     *
+     * @param camera The camera to draw particles with.
+     */
+    void draw(Camera* camera);
+
+    /**
+     * Gets the number of batches drawn by the last call to draw().
+     *
+     * @return The number of draw calls.
+     */
+    unsigned int getDrawCallCount() const;
+
+private:
+
+    /**
+     * Constructor.
+     */
+    ParticleSystem();
+
+    /**
+     * Hidden copy constructor.
+     */
+    ParticleSystem(const ParticleSystem& copy);
+
+    /**
+     * Destructor.
+     */
+    ~ParticleSystem();
+
+    /**
+     * Updates an emitter. Called by the job system.
+     */
+    static void updateEmitter(void* data, unsigned int index);
+
+    /**
+     * Orders emitters by texture and blend mode, so emitters that share a batch are adjacent.
+     */
+    static bool compareEmitters(ParticleEmitter* emitter1, ParticleEmitter* emitter2);
+
+    std::vector<ParticleEmitter*> _emitters;    // The emitters, in the order they were added.
+    std::vector<ParticleEmitter*> _visible;     // The emitters visible in the current draw.
+    long _elapsedTime;                          // The elapsed time of the current update.
+    unsigned int _drawCallCount;                // The number of batches drawn by the last draw.
+};
+
+}
+
+#endif
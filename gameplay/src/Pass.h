@@ -21,6 +21,7 @@ class Pass : public RenderState
     friend class Technique;
     friend class Material;
     friend class RenderState;
+    friend class RenderQueue;
 
 public:
 
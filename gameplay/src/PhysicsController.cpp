@@ -8,6 +8,9 @@
 // The initial capacity of the Bullet debug drawer's vertex batch.
 #define INITIAL_CAPACITY 280
 
+// The initial capacity of the collision status table (must be a power of two).
+#define COLLISION_STATUS_INITIAL_CAPACITY 64
+
 namespace gameplay
 {
 
@@ -15,7 +18,7 @@ PhysicsController::PhysicsController()
   : _collisionConfiguration(NULL), _dispatcher(NULL),
     _overlappingPairCache(NULL), _solver(NULL), _world(NULL), _debugDrawer(NULL), 
     _status(PhysicsController::Listener::DEACTIVATED), _listeners(NULL),
-    _gravity(btScalar(0.0), btScalar(-9.8), btScalar(0.0))
+    _gravity(btScalar(0.0), btScalar(-9.8), btScalar(0.0)), _collisionStatusCount(0), _collisionFrame(0)
 {
     // Default gravity is 9.8 along the negative Y axis.
 }
@@ -212,75 +215,227 @@ void PhysicsController::update(long elapsedTime)
         
     }
 
-    // All statuses are set with the DIRTY bit before collision processing occurs.
-    // During collision processing, if a collision occurs, the status is 
-    // set to COLLISION and the DIRTY bit is cleared. Then, after collision processing 
-    // is finished, if a given status is still dirty, the COLLISION bit is cleared.
+    // Send collision events for the contacts found during the simulation step.
+    updateCollisionListeners();
+}
 
-    // Dirty all the collision listeners' collision status caches.
-    for (unsigned int i = 0; i < _bodies.size(); i++)
+void PhysicsController::updateCollisionListeners()
+{
+    // Every pair of rigid bodies that is in contact is stamped with the current frame.
+    // Pairs that are new to the collision status table started colliding this frame, pairs
+    // that were already in it are still colliding, and pairs that were not stamped this
+    // frame are no longer colliding. Only the dispatcher's persistent manifolds are visited,
+    // so the cost is proportional to the number of contacts.
+    _collisionFrame++;
+    if (_collisionFrame == 0)
+        _collisionFrame = 1;
+
+    int manifoldCount = _dispatcher->getNumManifolds();
+    for (int i = 0; i < manifoldCount; i++)
     {
-        if (_bodies[i]->_listeners)
+        btPersistentManifold* manifold = _dispatcher->getManifoldByIndexInternal(i);
+        int contactCount = manifold->getNumContacts();
+
+        // Manifolds keep points for bodies that have separated but are still within the
+        // contact breaking threshold, so only points that actually touch or penetrate count.
+        // Of those, the deepest point is the one reported to the listeners.
+        int deepest = -1;
+        for (int k = 0; k < contactCount; k++)
         {
-            for (unsigned int k = 0; k < _bodies[i]->_listeners->size(); k++)
-            {
-                std::map<PhysicsRigidBody::CollisionPair, int>::iterator iter = (*_bodies[i]->_listeners)[k]->_collisionStatus.begin();
-                for (; iter != (*_bodies[i]->_listeners)[k]->_collisionStatus.end(); iter++)
-                {
-                    iter->second |= PhysicsRigidBody::Listener::DIRTY;
-                }
-            }
+            btScalar distance = manifold->getContactPoint(k).getDistance();
+            if (distance <= 0.0f && (deepest < 0 || distance < manifold->getContactPoint(deepest).getDistance()))
+                deepest = k;
         }
+        if (deepest < 0)
+            continue;
+
+        PhysicsRigidBody* rbA = getRigidBody(static_cast<const btCollisionObject*>(manifold->getBody0()));
+        PhysicsRigidBody* rbB = getRigidBody(static_cast<const btCollisionObject*>(manifold->getBody1()));
+        if (!rbA || !rbB || (!rbA->_listeners && !rbB->_listeners))
+            continue;
+
+        // Pairs are stored with the lower address first so that the
+        // manifold's body order does not affect the lookup.
+        bool swapped = rbB < rbA;
+        unsigned int index = swapped ? findCollisionStatus(rbB, rbA, true) : findCollisionStatus(rbA, rbB, true);
+        CollisionStatus& status = _collisionStatus[index];
+
+        // A compound pair can have several manifolds; report it once per frame.
+        if (status._frame == _collisionFrame)
+            continue;
+        bool colliding = status._frame != 0;
+        status._frame = _collisionFrame;
+
+        const btManifoldPoint& point = manifold->getContactPoint(deepest);
+
+        CollisionEvent event;
+        event._type = colliding ? PhysicsRigidBody::Listener::STILL_COLLIDING : PhysicsRigidBody::Listener::COLLIDING;
+        event._rbA = rbA;
+        event._rbB = rbB;
+        event._contactPointA.set(point.getPositionWorldOnA().x(), point.getPositionWorldOnA().y(), point.getPositionWorldOnA().z());
+        event._contactPointB.set(point.getPositionWorldOnB().x(), point.getPositionWorldOnB().y(), point.getPositionWorldOnB().z());
+        _collisionEvents.push_back(event);
     }
 
-    // Go through the physics rigid bodies and update the collision listeners.
-    for (unsigned int i = 0; i < _bodies.size(); i++)
+    // Remove the pairs that are no longer colliding.
+    unsigned int capacity = _collisionStatus.size();
+    for (unsigned int i = 0; i < capacity; )
     {
-        if (_bodies[i]->_listeners)
+        CollisionStatus& status = _collisionStatus[i];
+        if (status._rbA && status._frame != _collisionFrame)
         {
-            for (unsigned int k = 0; k < _bodies[i]->_listeners->size(); k++)
-            {
-                std::map<PhysicsRigidBody::CollisionPair, int>::iterator iter = (*_bodies[i]->_listeners)[k]->_collisionStatus.begin();
-                for (; iter != (*_bodies[i]->_listeners)[k]->_collisionStatus.end(); iter++)
-                {
-                    // If this collision pair was one that was registered for listening, then perform the collision test.
-                    // (In the case where we register for all collisions with a rigid body, there will be a lot
-                    // of collision pairs in the status cache that we did not explicitly register for.)
-                    if ((iter->second & PhysicsRigidBody::Listener::REGISTERED) != 0)
-                    {
-                        if (iter->first._rbB)
-                            Game::getInstance()->getPhysicsController()->_world->contactPairTest(iter->first._rbA->_body, iter->first._rbB->_body, *(*_bodies[i]->_listeners)[k]);
-                        else
-                            Game::getInstance()->getPhysicsController()->_world->contactTest(iter->first._rbA->_body, *(*_bodies[i]->_listeners)[k]);
-                    }
-                }   
-            }
+            CollisionEvent event;
+            event._type = PhysicsRigidBody::Listener::NOT_COLLIDING;
+            event._rbA = status._rbA;
+            event._rbB = status._rbB;
+            _collisionEvents.push_back(event);
+
+            // Removal shifts the next entry of the probe sequence into this slot, so check it again.
+            removeCollisionStatus(i);
+        }
+        else
+        {
+            i++;
         }
     }
 
-    // Go through all the collision listeners and update their collision status caches.
-    for (unsigned int i = 0; i < _bodies.size(); i++)
+    // Notify the listeners once the collision status table is up to date.
+    for (unsigned int i = 0; i < _collisionEvents.size(); i++)
+    {
+        const CollisionEvent& event = _collisionEvents[i];
+        notifyCollisionListeners(event._type, event._rbA, event._rbB, event._contactPointA, event._contactPointB);
+        notifyCollisionListeners(event._type, event._rbB, event._rbA, event._contactPointB, event._contactPointA);
+    }
+    _collisionEvents.clear();
+}
+
+void PhysicsController::notifyCollisionListeners(PhysicsRigidBody::Listener::EventType type, PhysicsRigidBody* a, PhysicsRigidBody* b,
+                                                 const Vector3& contactPointA, const Vector3& contactPointB)
+{
+    if (!a->_listeners)
+        return;
+
+    PhysicsRigidBody::CollisionPair pair(a, b);
+    for (unsigned int i = 0; i < a->_listeners->size(); i++)
     {
-        if (_bodies[i]->_listeners)
+        // Copy the entry since a listener may register new listeners while handling the event.
+        PhysicsRigidBody::CollisionListener entry = (*a->_listeners)[i];
+        if (entry.body == NULL || entry.body == b)
+            entry.listener->collisionEvent(type, pair, contactPointA, contactPointB);
+    }
+}
+
+// Hashes a pair of rigid body pointers for the collision status table.
+static unsigned int hashCollisionPair(const PhysicsRigidBody* a, const PhysicsRigidBody* b)
+{
+    unsigned int h = (unsigned int)((size_t)a >> 3) * 2654435761u;
+    h ^= (unsigned int)((size_t)b >> 3) + 0x9e3779b9u + (h << 6) + (h >> 2);
+    return h;
+}
+
+unsigned int PhysicsController::findCollisionStatus(PhysicsRigidBody* a, PhysicsRigidBody* b, bool create)
+{
+    // Grow the table so that it is never more than half full.
+    if (create && (_collisionStatusCount + 1) * 2 > _collisionStatus.size())
+    {
+        std::vector<CollisionStatus> old;
+        old.swap(_collisionStatus);
+
+        CollisionStatus empty;
+        empty._rbA = NULL;
+        empty._rbB = NULL;
+        empty._frame = 0;
+        _collisionStatus.resize(old.empty() ? COLLISION_STATUS_INITIAL_CAPACITY : old.size() * 2, empty);
+
+        unsigned int mask = _collisionStatus.size() - 1;
+        for (unsigned int i = 0; i < old.size(); i++)
         {
-            for (unsigned int k = 0; k < _bodies[i]->_listeners->size(); k++)
+            if (old[i]._rbA)
             {
-                std::map<PhysicsRigidBody::CollisionPair, int>::iterator iter = (*_bodies[i]->_listeners)[k]->_collisionStatus.begin();
-                for (; iter != (*_bodies[i]->_listeners)[k]->_collisionStatus.end(); iter++)
-                {
-                    if ((iter->second & PhysicsRigidBody::Listener::DIRTY) != 0)
-                    {
-                        iter->second &= ~PhysicsRigidBody::Listener::COLLISION;
-                    }
-                }
+                unsigned int index = hashCollisionPair(old[i]._rbA, old[i]._rbB) & mask;
+                while (_collisionStatus[index]._rbA)
+                    index = (index + 1) & mask;
+                _collisionStatus[index] = old[i];
             }
         }
     }
+
+    if (_collisionStatus.empty())
+        return 0;
+
+    // Linear probing until we find the pair or an empty slot.
+    unsigned int mask = _collisionStatus.size() - 1;
+    unsigned int index = hashCollisionPair(a, b) & mask;
+    while (_collisionStatus[index]._rbA)
+    {
+        if (_collisionStatus[index]._rbA == a && _collisionStatus[index]._rbB == b)
+            return index;
+        index = (index + 1) & mask;
+    }
+
+    if (!create)
+        return _collisionStatus.size();
+
+    _collisionStatus[index]._rbA = a;
+    _collisionStatus[index]._rbB = b;
+    _collisionStatus[index]._frame = 0;
+    _collisionStatusCount++;
+    return index;
+}
+
+void PhysicsController::removeCollisionStatus(unsigned int index)
+{
+    // Backward shift deletion: move the following entries of the probe
+    // sequence into the hole so that no tombstones are needed.
+    unsigned int mask = _collisionStatus.size() - 1;
+    unsigned int hole = index;
+    unsigned int i = (index + 1) & mask;
+    while (_collisionStatus[i]._rbA)
+    {
+        unsigned int home = hashCollisionPair(_collisionStatus[i]._rbA, _collisionStatus[i]._rbB) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            _collisionStatus[hole] = _collisionStatus[i];
+            hole = i;
+        }
+        i = (i + 1) & mask;
+    }
+
+    _collisionStatus[hole]._rbA = NULL;
+    _collisionStatus[hole]._rbB = NULL;
+    _collisionStatus[hole]._frame = 0;
+    _collisionStatusCount--;
+}
+
+void PhysicsController::removeCollisionStatus(PhysicsRigidBody* body)
+{
+    std::vector<PhysicsRigidBody*> partners;
+    for (unsigned int i = 0; i < _collisionStatus.size(); )
+    {
+        if (_collisionStatus[i]._rbA == body || _collisionStatus[i]._rbB == body)
+        {
+            partners.push_back(_collisionStatus[i]._rbA == body ? _collisionStatus[i]._rbB : _collisionStatus[i]._rbA);
+            removeCollisionStatus(i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    // The collisions end with the removal of the body, so tell the bodies it was colliding with.
+    // The body itself is being removed, so its own listeners are not notified. The table is
+    // already up to date, so listeners may remove other rigid bodies.
+    for (unsigned int i = 0; i < partners.size(); i++)
+    {
+        notifyCollisionListeners(PhysicsRigidBody::Listener::NOT_COLLIDING, partners[i], body, Vector3::zero(), Vector3::zero());
+    }
 }
-    
 
 void PhysicsController::addRigidBody(PhysicsRigidBody* body)
 {
+    // Store the GamePlay rigid body on the Bullet object for fast lookups from contact manifolds.
+    body->_body->setUserPointer(body);
     _world->addRigidBody(body->_body);
     _bodies.push_back(body);
 }
@@ -298,6 +453,17 @@ void PhysicsController::removeRigidBody(PhysicsRigidBody* rigidBody)
         }
     }
 
+    // Remove the rigid body from the list of bodies and forget about its collisions.
+    for (unsigned int i = 0; i < _bodies.size(); i++)
+    {
+        if (_bodies[i] == rigidBody)
+        {
+            _bodies.erase(_bodies.begin() + i);
+            break;
+        }
+    }
+    removeCollisionStatus(rigidBody);
+
     // Find the rigid body's collision shape and release the rigid body's reference to it.
     for (unsigned int i = 0; i < _shapes.size(); i++)
     {
@@ -318,14 +484,8 @@ void PhysicsController::removeRigidBody(PhysicsRigidBody* rigidBody)
 
 PhysicsRigidBody* PhysicsController::getRigidBody(const btCollisionObject* collisionObject)
 {
-    // Find the rigid body and remove it from the world.
-    for (unsigned int i = 0; i < _bodies.size(); i++)
-    {
-        if (_bodies[i]->_body == collisionObject)
-            return _bodies[i];
-    }
-    
-    return NULL;
+    // The rigid body is stored as the user pointer when it is added to the world.
+    return static_cast<PhysicsRigidBody*>(collisionObject->getUserPointer());
 }
 
 btCollisionShape* PhysicsController::createBox(const Vector3& min, const Vector3& max, const btVector3& scale)
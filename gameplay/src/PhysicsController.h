@@ -263,6 +263,41 @@ private:
     
     // Removes the given constraint from the simulated physics world.
     void removeConstraint(PhysicsConstraint* constraint);
+
+    // Harvests collision events from the dispatcher's contact manifolds and notifies the collision listeners.
+    void updateCollisionListeners();
+
+    // Notifies the collision listeners registered on rigid body 'a' of a collision event with rigid body 'b'.
+    void notifyCollisionListeners(PhysicsRigidBody::Listener::EventType type, PhysicsRigidBody* a, PhysicsRigidBody* b,
+                                  const Vector3& contactPointA, const Vector3& contactPointB);
+
+    // Gets the collision status entry for the given pair of rigid bodies (optionally creating it).
+    unsigned int findCollisionStatus(PhysicsRigidBody* a, PhysicsRigidBody* b, bool create);
+
+    // Removes the collision status entry at the given index of the collision status table.
+    void removeCollisionStatus(unsigned int index);
+
+    // Removes all collision status entries that involve the given rigid body,
+    // notifying the listeners of the other rigid bodies that the collisions ended.
+    void removeCollisionStatus(PhysicsRigidBody* body);
+
+    // Holds the collision status of a pair of rigid bodies that are in contact.
+    struct CollisionStatus
+    {
+        PhysicsRigidBody* _rbA;
+        PhysicsRigidBody* _rbB;
+        unsigned int _frame;
+    };
+
+    // Holds a collision event that is waiting to be sent to the collision listeners.
+    struct CollisionEvent
+    {
+        PhysicsRigidBody::Listener::EventType _type;
+        PhysicsRigidBody* _rbA;
+        PhysicsRigidBody* _rbB;
+        Vector3 _contactPointA;
+        Vector3 _contactPointB;
+    };
     
     // Draws Bullet debug information.
     class DebugDrawer : public btIDebugDraw
@@ -308,6 +343,10 @@ private:
     std::vector<Listener*>* _listeners;
     std::vector<PhysicsRigidBody*> _bodies;
     Vector3 _gravity;
+    std::vector<CollisionStatus> _collisionStatus;  // Open addressing hash table of colliding pairs (size is a power of two).
+    unsigned int _collisionStatusCount;
+    unsigned int _collisionFrame;
+    std::vector<CollisionEvent> _collisionEvents;
 };
 
 }
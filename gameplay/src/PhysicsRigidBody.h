@@ -68,44 +68,52 @@ public:
     /**
      * Collision listener interface.
      */
-    class Listener : public btCollisionWorld::ContactResultCallback
+    class Listener
     {
         friend class PhysicsRigidBody;
         friend class PhysicsController;
 
     public:
+
+        /**
+         * The type of collision event.
+         */
+        enum EventType
+        {
+            /**
+             * Event fired when the two rigid bodies start colliding.
+             */
+            COLLIDING,
+
+            /**
+             * Event fired every frame after the first while the two rigid bodies keep colliding.
+             */
+            STILL_COLLIDING,
+
+            /**
+             * Event fired when the two rigid bodies no longer collide.
+             */
+            NOT_COLLIDING
+        };
+
         /**
          * Destructor.
          */
         virtual ~Listener();
 
         /**
-         * Handles when a collision occurs for the rigid body where this listener is registered.
+         * Handles when a collision starts, continues or stops occurring for the rigid body where this listener is registered.
          * 
-         * @param collisionPair The two rigid bodies involved in the collision.
-         * @param contactPoint The point (in world space) where the collision occurred.
+         * @param type The type of collision event.
+         * @param collisionPair The two rigid bodies involved in the collision (the first
+         *      rigid body is always the one where this listener is registered).
+         * @param contactPointA The contact point (in world space) on the first rigid body
+         *      (only valid for COLLIDING and STILL_COLLIDING events).
+         * @param contactPointB The contact point (in world space) on the second rigid body
+         *      (only valid for COLLIDING and STILL_COLLIDING events).
          */
-        virtual void collisionEvent(const CollisionPair& collisionPair, const Vector3& contactPoint) = 0;
-        
-    protected:
-        
-        /**
-         * Internal function used for Bullet integration (do not use or override).
-         */
-        btScalar addSingleResult(btManifoldPoint& cp, 
-                                 const btCollisionObject* a, int partIdA, int indexA, 
-                                 const btCollisionObject* b, int partIdB, int indexB);
-
-        std::map<CollisionPair, int> _collisionStatus;  // Holds the collision status for each pair of rigid bodies. 
-        
-    private:
-
-        // Internal constant.
-        static const int DIRTY;
-        // Internal constant.
-        static const int COLLISION;
-        // Internal constant.
-        static const int REGISTERED;
+        virtual void collisionEvent(EventType type, const CollisionPair& collisionPair, 
+                                    const Vector3& contactPointA = Vector3(), const Vector3& contactPointB = Vector3()) = 0;
     };
 
     /**
@@ -400,11 +408,19 @@ private:
         bool result;
     };
 
+    // A collision listener registered on this rigid body, along with the (optional)
+    // rigid body that collisions must involve in order to notify the listener.
+    struct CollisionListener
+    {
+        Listener* listener;
+        PhysicsRigidBody* body;
+    };
+
     btCollisionShape* _shape;
     btRigidBody* _body;
     Node* _node;
     std::vector<PhysicsConstraint*> _constraints;
-    std::vector<Listener*>* _listeners;
+    std::vector<CollisionListener>* _listeners;
     mutable Vector3* _angularVelocity;
     mutable Vector3* _anisotropicFriction;
     mutable Vector3* _gravity;
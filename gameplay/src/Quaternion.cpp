@@ -1,5 +1,6 @@
 #include "Base.h"
 #include "Quaternion.h"
+#include "MathUtil.h"
 
 namespace gameplay
 {
@@ -360,22 +361,17 @@ void Quaternion::slerp(float q1x, float q1y, float q1z, float q1w, float q2x, fl
     alpha *= f1 + f2a;
     beta = f1 + f2b;
 
-    // Apply final coefficients to a and b as usual.
-    float w = alpha * q1w + beta * q2w;
-    float x = alpha * q1x + beta * q2x;
-    float y = alpha * q1y + beta * q2y;
-    float z = alpha * q1z + beta * q2z;
-
-    // This final adjustment to the quaternion's length corrects for
-    // any small constraint error in the inputs q1 and q2 But as you
-    // can see, it comes at the cost of 9 additional multiplication
-    // operations. If this error-correcting feature is not required,
-    // the following code may be removed.
-    f1 = 1.5f - 0.5f * (w * w + x * x + y * y + z * z);
-    *dstw = w * f1;
-    *dstx = x * f1;
-    *dsty = y * f1;
-    *dstz = z * f1;
+    // Apply final coefficients to a and b as usual. The blend also
+    // adjusts the quaternion's length, which corrects for any small
+    // constraint error in the inputs q1 and q2.
+    float a[4] = { q1x, q1y, q1z, q1w };
+    float b[4] = { q2x, q2y, q2z, q2w };
+    float q[4];
+    MathUtil::blendQuaternion(a, alpha, b, beta, q);
+    *dstx = q[0];
+    *dsty = q[1];
+    *dstz = q[2];
+    *dstw = q[3];
 }
 
 void Quaternion::slerpForSquad(const Quaternion& q1, const Quaternion& q2, float t, Quaternion* dst)
@@ -0,0 +1,358 @@
+#include "Base.h"
+#include "RenderQueue.h"
+#include "Scene.h"
+#include "Technique.h"
+#include "MeshPart.h"
+
+// Sort key layout (from most to least significant bit):
+// opaque:      layer (4) | 0 | effect (11) | pass (16) | depth (32)
+// transparent: layer (4) | 1 | inverted depth (32) | effect (11) | pass (16)
+#define RENDER_QUEUE_MAX_LAYER          15
+#define RENDER_QUEUE_LAYER_SHIFT        60
+#define RENDER_QUEUE_TRANSPARENT        (1ULL << 59)
+#define RENDER_QUEUE_EFFECT_MASK        0x7FF
+#define RENDER_QUEUE_PASS_MASK          0xFFFF
+
+namespace gameplay
+{
+
+/**
+ * Defines the backend used to issue the commands of a render queue to GL.
+ */
+class RenderQueue::GLBackend : public RenderQueue::Backend
+{
+public:
+
+    void bindEffect(Effect* effect)
+    {
+        effect->bind();
+    }
+
+    void bindRenderState(Pass* pass)
+    {
+        static_cast<RenderState*>(pass)->bind(pass);
+    }
+
+    void bindVertexAttributes(VertexAttributeBinding* binding)
+    {
+        binding->bind();
+    }
+
+    void unbindVertexAttributes(VertexAttributeBinding* binding)
+    {
+        binding->unbind();
+    }
+
+    void bindIndexBuffer(IndexBufferHandle indexBuffer)
+    {
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer) );
+    }
+
+    void drawArrays(Mesh::PrimitiveType primitiveType, unsigned int vertexCount)
+    {
+        GL_ASSERT( glDrawArrays(primitiveType, 0, vertexCount) );
+    }
+
+    void drawElements(Mesh::PrimitiveType primitiveType, unsigned int indexCount, Mesh::IndexFormat indexFormat)
+    {
+        GL_ASSERT( glDrawElements(primitiveType, indexCount, indexFormat, 0) );
+    }
+};
+
+RenderQueue::RenderQueue()
+    : _camera(NULL)
+{
+}
+
+RenderQueue::RenderQueue(const RenderQueue& copy)
+{
+    // hidden
+}
+
+RenderQueue::~RenderQueue()
+{
+    SAFE_RELEASE(_camera);
+}
+
+RenderQueue* RenderQueue::create()
+{
+    return new RenderQueue();
+}
+
+void RenderQueue::setCamera(Camera* camera)
+{
+    if (_camera != camera)
+    {
+        SAFE_RELEASE(_camera);
+
+        _camera = camera;
+
+        if (_camera)
+        {
+            _camera->addRef();
+        }
+    }
+}
+
+Camera* RenderQueue::getCamera() const
+{
+    return _camera;
+}
+
+void RenderQueue::add(Node* node, unsigned int layer)
+{
+    assert(node);
+    assert(layer <= RENDER_QUEUE_MAX_LAYER);
+
+    Model* model = node->getModel();
+    if (!model)
+        return;
+
+    // Use the squared distance to the camera as the depth. The bit pattern of a
+    // positive float increases with its value, so it can be compared as an integer.
+    unsigned int depth = 0;
+    Camera* camera = _camera;
+    if (!camera)
+    {
+        Scene* scene = node->getScene();
+        camera = scene ? scene->getActiveCamera() : NULL;
+    }
+    if (camera && camera->getNode())
+    {
+        float distance = node->getTranslationWorld().distanceSquared(camera->getNode()->getTranslationWorld());
+        memcpy(&depth, &distance, sizeof(depth));
+    }
+
+    unsigned long long layerKey = (unsigned long long)(layer & RENDER_QUEUE_MAX_LAYER) << RENDER_QUEUE_LAYER_SHIFT;
+
+    Mesh* mesh = model->getMesh();
+    unsigned int partCount = mesh->getPartCount();
+    if (partCount == 0)
+    {
+        // No mesh parts (index buffers).
+        Material* material = model->getMaterial();
+        if (material)
+        {
+            addItems(material, mesh, NULL, layerKey, depth);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            Material* material = model->getMaterial(i);
+            if (material)
+            {
+                addItems(material, mesh, mesh->getPart(i), layerKey, depth);
+            }
+        }
+    }
+}
+
+void RenderQueue::addItems(Material* material, Mesh* mesh, MeshPart* part, unsigned long long layerKey, unsigned int depth)
+{
+    Technique* technique = material->getTechnique();
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Item item;
+        item.pass = technique->getPass(i);
+        item.mesh = mesh;
+        item.part = part;
+
+        unsigned long long effectId = getSortId(_effectIds, item.pass->getEffect()) & RENDER_QUEUE_EFFECT_MASK;
+        unsigned long long passId = getSortId(_passIds, item.pass) & RENDER_QUEUE_PASS_MASK;
+        if (item.pass->isBlendEnabled())
+        {
+            // Transparent items are drawn back-to-front, so depth takes precedence over state.
+            item.key = layerKey | RENDER_QUEUE_TRANSPARENT | ((unsigned long long)(0xFFFFFFFF - depth) << 27) | (effectId << 16) | passId;
+        }
+        else
+        {
+            item.key = layerKey | (effectId << 48) | (passId << 32) | depth;
+        }
+
+        _items.push_back(item);
+    }
+}
+
+unsigned int RenderQueue::getSortId(std::map<const void*, unsigned int>& ids, const void* object)
+{
+    std::map<const void*, unsigned int>::iterator itr = ids.find(object);
+    if (itr != ids.end())
+    {
+        return itr->second;
+    }
+
+    unsigned int id = ids.size();
+    ids[object] = id;
+    return id;
+}
+
+unsigned int RenderQueue::getItemCount() const
+{
+    return _items.size();
+}
+
+void RenderQueue::clear()
+{
+    // Sort ids only need to be consistent within the queued items, so they are assigned
+    // again as items are added. This also drops the ids of released effects and passes.
+    _items.clear();
+    _effectIds.clear();
+    _passIds.clear();
+}
+
+bool RenderQueue::compareItems(const Item& a, const Item& b)
+{
+    return a.key < b.key;
+}
+
+void RenderQueue::sort()
+{
+    std::sort(_items.begin(), _items.end(), &RenderQueue::compareItems);
+}
+
+void RenderQueue::draw(Backend* backend)
+{
+    GLBackend glBackend;
+    if (!backend)
+    {
+        backend = &glBackend;
+    }
+
+    Effect* effect = NULL;
+    Pass* pass = NULL;
+    VertexAttributeBinding* vaBinding = NULL;
+    IndexBufferHandle indexBuffer = 0;
+    bool indexBufferBound = false;
+
+    for (unsigned int i = 0, count = _items.size(); i < count; ++i)
+    {
+        const Item& item = _items[i];
+
+        if (item.pass != pass)
+        {
+            pass = item.pass;
+
+            Effect* passEffect = pass->getEffect();
+            if (passEffect != effect)
+            {
+                effect = passEffect;
+                backend->bindEffect(effect);
+            }
+
+            // Parameters are bound to the node of the pass's material, so
+            // they only need to be applied again when the pass changes.
+            backend->bindRenderState(pass);
+
+            if (pass->_vaBinding != vaBinding)
+            {
+                if (vaBinding)
+                {
+                    backend->unbindVertexAttributes(vaBinding);
+                }
+                vaBinding = pass->_vaBinding;
+                if (vaBinding)
+                {
+                    backend->bindVertexAttributes(vaBinding);
+                }
+
+                // The element array buffer is part of the state of a vertex array object,
+                // so the index buffer must be bound again after the binding changes.
+                indexBufferBound = false;
+            }
+        }
+
+        IndexBufferHandle partIndexBuffer = item.part ? item.part->getIndexBuffer() : 0;
+        if (!indexBufferBound || partIndexBuffer != indexBuffer)
+        {
+            indexBuffer = partIndexBuffer;
+            indexBufferBound = true;
+            backend->bindIndexBuffer(indexBuffer);
+        }
+
+        if (item.part)
+        {
+            backend->drawElements(item.part->getPrimitiveType(), item.part->getIndexCount(), item.part->getIndexFormat());
+        }
+        else
+        {
+            backend->drawArrays(item.mesh->getPrimitiveType(), item.mesh->getVertexCount());
+        }
+    }
+
+    if (vaBinding)
+    {
+        backend->unbindVertexAttributes(vaBinding);
+    }
+}
+
+RenderQueue::RecordingBackend::RecordingBackend()
+{
+    clear();
+}
+
+const std::vector<RenderQueue::RecordingBackend::Command>& RenderQueue::RecordingBackend::getCommands() const
+{
+    return _commands;
+}
+
+unsigned int RenderQueue::RecordingBackend::getCommandCount(CommandType type) const
+{
+    assert(type < COMMAND_TYPE_COUNT);
+
+    return _counts[type];
+}
+
+void RenderQueue::RecordingBackend::clear()
+{
+    _commands.clear();
+    memset(_counts, 0, sizeof(_counts));
+}
+
+void RenderQueue::RecordingBackend::record(CommandType type, const void* object, unsigned int value)
+{
+    Command command;
+    command.type = type;
+    command.object = object;
+    command.value = value;
+    _commands.push_back(command);
+    ++_counts[type];
+}
+
+void RenderQueue::RecordingBackend::bindEffect(Effect* effect)
+{
+    record(BIND_EFFECT, effect, 0);
+}
+
+void RenderQueue::RecordingBackend::bindRenderState(Pass* pass)
+{
+    record(BIND_RENDER_STATE, pass, 0);
+}
+
+void RenderQueue::RecordingBackend::bindVertexAttributes(VertexAttributeBinding* binding)
+{
+    record(BIND_VERTEX_ATTRIBUTES, binding, 0);
+}
+
+void RenderQueue::RecordingBackend::unbindVertexAttributes(VertexAttributeBinding* binding)
+{
+    record(UNBIND_VERTEX_ATTRIBUTES, binding, 0);
+}
+
+void RenderQueue::RecordingBackend::bindIndexBuffer(IndexBufferHandle indexBuffer)
+{
+    record(BIND_INDEX_BUFFER, NULL, indexBuffer);
+}
+
+void RenderQueue::RecordingBackend::drawArrays(Mesh::PrimitiveType primitiveType, unsigned int vertexCount)
+{
+    record(DRAW_ARRAYS, NULL, vertexCount);
+}
+
+void RenderQueue::RecordingBackend::drawElements(Mesh::PrimitiveType primitiveType, unsigned int indexCount, Mesh::IndexFormat indexFormat)
+{
+    record(DRAW_ELEMENTS, NULL, indexCount);
+}
+
+}
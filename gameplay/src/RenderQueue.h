@@ -0,0 +1,311 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include "Node.h"
+#include "Pass.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a queue of draw items that are sorted to minimize render state changes.
+ *
+ * Instead of drawing each model as the scene is visited, the mesh parts and
+ * material passes of the visited models are added to a render queue. Once all
+ * items have been added, the queue is sorted by a 64-bit key made of (from most to
+ * least significant) the layer, the transparency, the effect, the material pass
+ * and the depth of each item. Opaque items are sorted front-to-back within their
+ * effect and pass, while transparent items are sorted back-to-front and drawn
+ * after all opaque items of the same layer.
+ *
+ * When the sorted items are drawn, effect, pass, vertex attribute and index
+ * buffer binds that are identical to the previous item are skipped.
+ *
+ * The queue submits its commands to a Backend, which by default issues the
+ * corresponding GL calls. A RecordingBackend can be used instead to capture the
+ * submitted command stream without a GPU.
+ */
+class RenderQueue : public Ref
+{
+public:
+
+    /**
+     * Defines the receiver of the commands submitted by a render queue.
+     */
+    class Backend
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Backend() { }
+
+        /**
+         * Binds the given effect.
+         */
+        virtual void bindEffect(Effect* effect) = 0;
+
+        /**
+         * Binds the material parameters and render state of the given pass
+         * (and of its technique and material).
+         */
+        virtual void bindRenderState(Pass* pass) = 0;
+
+        /**
+         * Binds the given vertex attribute binding.
+         */
+        virtual void bindVertexAttributes(VertexAttributeBinding* binding) = 0;
+
+        /**
+         * Unbinds the given vertex attribute binding.
+         */
+        virtual void unbindVertexAttributes(VertexAttributeBinding* binding) = 0;
+
+        /**
+         * Binds the given index buffer (0 to unbind the current index buffer).
+         */
+        virtual void bindIndexBuffer(IndexBufferHandle indexBuffer) = 0;
+
+        /**
+         * Draws non-indexed primitives from the currently bound vertex attributes.
+         */
+        virtual void drawArrays(Mesh::PrimitiveType primitiveType, unsigned int vertexCount) = 0;
+
+        /**
+         * Draws indexed primitives from the currently bound index buffer.
+         */
+        virtual void drawElements(Mesh::PrimitiveType primitiveType, unsigned int indexCount, Mesh::IndexFormat indexFormat) = 0;
+    };
+
+    /**
+     * Defines a backend that records the submitted commands instead of executing them.
+     *
+     * This is useful for verifying the sort order and counting state changes without a GPU.
+     */
+    class RecordingBackend : public Backend
+    {
+    public:
+
+        /**
+         * The types of commands submitted by a render queue.
+         */
+        enum CommandType
+        {
+            BIND_EFFECT,
+            BIND_RENDER_STATE,
+            BIND_VERTEX_ATTRIBUTES,
+            UNBIND_VERTEX_ATTRIBUTES,
+            BIND_INDEX_BUFFER,
+            DRAW_ARRAYS,
+            DRAW_ELEMENTS,
+            COMMAND_TYPE_COUNT
+        };
+
+        /**
+         * A recorded command.
+         */
+        struct Command
+        {
+            /**
+             * The command type.
+             */
+            CommandType type;
+
+            /**
+             * The effect, pass or vertex attribute binding of bind commands, otherwise NULL.
+             */
+            const void* object;
+
+            /**
+             * The index buffer of BIND_INDEX_BUFFER, or the vertex or index count of draw commands.
+             */
+            unsigned int value;
+        };
+
+        /**
+         * Constructor.
+         */
+        RecordingBackend();
+
+        /**
+         * Gets the commands recorded since the last call to clear().
+         *
+         * @return The recorded commands.
+         */
+        const std::vector<Command>& getCommands() const;
+
+        /**
+         * Gets the number of recorded commands of the given type.
+         *
+         * @param type The command type.
+         *
+         * @return The number of commands of the given type.
+         */
+        unsigned int getCommandCount(CommandType type) const;
+
+        /**
+         * Clears the recorded commands.
+         */
+        void clear();
+
+        /**
+         * @see Backend::bindEffect
+         */
+        void bindEffect(Effect* effect);
+
+        /**
+         * @see Backend::bindRenderState
+         */
+        void bindRenderState(Pass* pass);
+
+        /**
+         * @see Backend::bindVertexAttributes
+         */
+        void bindVertexAttributes(VertexAttributeBinding* binding);
+
+        /**
+         * @see Backend::unbindVertexAttributes
+         */
+        void unbindVertexAttributes(VertexAttributeBinding* binding);
+
+        /**
+         * @see Backend::bindIndexBuffer
+         */
+        void bindIndexBuffer(IndexBufferHandle indexBuffer);
+
+        /**
+         * @see Backend::drawArrays
+         */
+        void drawArrays(Mesh::PrimitiveType primitiveType, unsigned int vertexCount);
+
+        /**
+         * @see Backend::drawElements
+         */
+        void drawElements(Mesh::PrimitiveType primitiveType, unsigned int indexCount, Mesh::IndexFormat indexFormat);
+
+    private:
+
+        /**
+         * Records a command.
+         */
+        void record(CommandType type, const void* object, unsigned int value);
+
+        std::vector<Command> _commands;                 // The recorded commands.
+        unsigned int _counts[COMMAND_TYPE_COUNT];       // The number of recorded commands of each type.
+    };
+
+    /**
+     * Creates a new, empty render queue.
+     *
+     * @return The new render queue.
+     */
+    static RenderQueue* create();
+
+    /**
+     * Sets the camera used to compute the depth of the items added to the queue.
+     *
+     * When no camera is set, the active camera of each node's scene is used.
+     *
+     * @param camera The camera, or NULL.
+     */
+    void setCamera(Camera* camera);
+
+    /**
+     * Gets the camera used to compute the depth of the items added to the queue.
+     *
+     * @return The camera, or NULL.
+     */
+    Camera* getCamera() const;
+
+    /**
+     * Adds a draw item to the queue for each pass of each mesh part of the node's model.
+     *
+     * Nodes without a model are ignored.
+     *
+     * @param node The node to add.
+     * @param layer The layer of the items, from 0 to 15. Lower layers are drawn first.
+     */
+    void add(Node* node, unsigned int layer = 0);
+
+    /**
+     * Gets the number of items in the queue.
+     *
+     * @return The number of items in the queue.
+     */
+    unsigned int getItemCount() const;
+
+    /**
+     * Removes all items from the queue, along with the sort ids of their effects and passes.
+     */
+    void clear();
+
+    /**
+     * Sorts the items in the queue.
+     */
+    void sort();
+
+    /**
+     * Draws the items in the queue in their current order.
+     *
+     * The items remain in the queue, so a queue that does not change can be drawn
+     * repeatedly without being cleared and sorted again.
+     *
+     * @param backend The backend to submit the commands to, or NULL to issue them to GL.
+     */
+    void draw(Backend* backend = NULL);
+
+private:
+
+    class GLBackend;
+
+    /**
+     * A draw item.
+     */
+    struct Item
+    {
+        unsigned long long key;     // The sort key.
+        Pass* pass;                 // The material pass.
+        Mesh* mesh;                 // The mesh.
+        MeshPart* part;             // The mesh part, or NULL to draw the mesh without indices.
+    };
+
+    /**
+     * Compares items by sort key.
+     */
+    static bool compareItems(const Item& a, const Item& b);
+
+    /**
+     * Constructor.
+     */
+    RenderQueue();
+
+    /**
+     * Hidden copy constructor.
+     */
+    RenderQueue(const RenderQueue& copy);
+
+    /**
+     * Destructor.
+     */
+    ~RenderQueue();
+
+    /**
+     * Adds the items for each pass of the given material.
+     */
+    void addItems(Material* material, Mesh* mesh, MeshPart* part, unsigned long long layerKey, unsigned int depth);
+
+    /**
+     * Gets the sort id of the given object, assigning the next id of the given map if it has none.
+     */
+    static unsigned int getSortId(std::map<const void*, unsigned int>& ids, const void* object);
+
+    Camera* _camera;                                // The camera used to compute item depths.
+    std::vector<Item> _items;                       // The draw items.
+    std::map<const void*, unsigned int> _effectIds; // The sort ids assigned to the effects of the queued items.
+    std::map<const void*, unsigned int> _passIds;   // The sort ids assigned to the passes of the queued items.
+};
+
+}
+
+#endif
@@ -295,6 +295,19 @@ RenderState* RenderState::getTopmost(RenderState* below)
     return NULL;
 }
 
+bool RenderState::isBlendEnabled() const
+{
+    for (const RenderState* rs = this; rs != NULL; rs = rs->_parent)
+    {
+        if (rs->_state && (rs->_state->_bits & RS_BLEND))
+        {
+            return rs->_state->_blendEnabled;
+        }
+    }
+
+    return false;
+}
+
 RenderState::StateBlock::StateBlock()
     : _blendEnabled(false), _cullFaceEnabled(false), _depthTestEnabled(false), _depthWriteEnabled(false),
       _srcBlend(RenderState::BLEND_ONE), _dstBlend(RenderState::BLEND_ONE), _bits(0L)
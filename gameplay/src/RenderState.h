@@ -17,6 +17,7 @@ class RenderState : public Ref
     friend class Technique;
     friend class Pass;
     friend class Model;
+    friend class RenderQueue;
 
 public:
 
@@ -326,6 +327,12 @@ protected:
      */
     RenderState* getTopmost(RenderState* below);
 
+    /**
+     * Returns whether blending is enabled by the state of this RenderState,
+     * or by the state of its closest parent that specifies blending.
+     */
+    bool isBlendEnabled() const;
+
     mutable std::vector<MaterialParameter*> _parameters;
     std::map<std::string, AutoBinding> _autoBindings;
     Node* _nodeBinding;
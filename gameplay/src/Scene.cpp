@@ -2,12 +2,21 @@
 #include "AudioListener.h"
 #include "Scene.h"
 #include "SceneLoader.h"
+#include "Game.h"
+
+// Scenes with fewer nodes than this resolve their world matrices on the calling thread only.
+#define SCENE_PARALLEL_TRANSFORM_THRESHOLD 1024
+
+// The number of independent subtrees the transform order is split into per thread.
+#define SCENE_TRANSFORM_SUBTREES_PER_THREAD 4
 
 namespace gameplay
 {
 
-Scene::Scene() : _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), _bindAudioListenerToCamera(true)
+Scene::Scene() : _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), _bindAudioListenerToCamera(true),
+    _transformOrderDirty(true), _spatialIndex(NULL)
 {
+    _spatialIndex = new SpatialIndex();
 }
 
 Scene::Scene(const Scene& copy)
@@ -30,6 +39,8 @@ Scene::~Scene()
 
     // Remove all nodes from the scene
     removeAllNodes();
+
+    SAFE_DELETE(_spatialIndex);
 }
 
 Scene* Scene::createScene()
@@ -163,8 +174,12 @@ void Scene::addNode(Node* node)
 
     node->_scene = this;
 
+    node->updateSpatialIndex(this, true);
+
     ++_nodeCount;
 
+    _transformOrderDirty = true;
+
     // If we don't have an active camera set, then check for one and set it.
     if (_activeCamera == NULL)
     {
@@ -195,9 +210,13 @@ void Scene::removeNode(Node* node)
     node->remove();
     node->_scene = NULL;
 
+    node->updateSpatialIndex(NULL, true);
+
     SAFE_RELEASE(node);
 
     --_nodeCount;
+
+    _transformOrderDirty = true;
 }
 
 void Scene::removeAllNodes()
@@ -223,6 +242,11 @@ Camera* Scene::getActiveCamera() const
     return _activeCamera;
 }
 
+SpatialIndex* Scene::getSpatialIndex() const
+{
+    return _spatialIndex;
+}
+
 void Scene::setActiveCamera(Camera* camera)
 {
     // Make sure we don't release the camera if the same camera is set twice.
@@ -288,4 +312,89 @@ void Scene::setAmbientColor(float red, float green, float blue)
     _ambientColor.set(red, green, blue);
 }
 
+void Scene::updateTransforms()
+{
+    Game* game = Game::getInstance();
+    JobSystem* jobSystem = game ? game->getJobSystem() : NULL;
+    unsigned int workerCount = jobSystem ? jobSystem->getWorkerCount() : 0;
+
+    if (_transformOrderDirty)
+    {
+        buildTransformOrder(workerCount > 0 ? (workerCount + 1) * SCENE_TRANSFORM_SUBTREES_PER_THREAD : 1);
+        _transformOrderDirty = false;
+    }
+
+    unsigned int nodeCount = _transformOrder.size();
+    unsigned int subtreeCount = _transformSegments.size() - 1;
+    if (workerCount == 0 || subtreeCount < 2 || nodeCount < SCENE_PARALLEL_TRANSFORM_THRESHOLD)
+    {
+        for (unsigned int i = 0; i < nodeCount; ++i)
+        {
+            _transformOrder[i]->updateWorldMatrix();
+        }
+        return;
+    }
+
+    // Resolve the nodes above the independent subtrees first, then the subtrees in parallel.
+    for (unsigned int i = 0, count = _transformSegments[0]; i < count; ++i)
+    {
+        _transformOrder[i]->updateWorldMatrix();
+    }
+    jobSystem->parallelFor(subtreeCount, &Scene::updateTransformSegment, this);
+}
+
+void Scene::buildTransformOrder(unsigned int segmentCount)
+{
+    _transformOrder.clear();
+    _transformSegments.clear();
+
+    // Expand the hierarchy one level at a time from the root nodes until there are
+    // enough subtrees to share out. The nodes above those subtrees are placed first,
+    // in level order, so that they are resolved before any of the subtrees.
+    std::vector<Node*> roots;
+    std::vector<Node*> children;
+    for (Node* node = _firstNode; node != NULL; node = node->_nextSibling)
+    {
+        roots.push_back(node);
+    }
+    while (!roots.empty() && roots.size() < segmentCount)
+    {
+        children.clear();
+        for (unsigned int i = 0, count = roots.size(); i < count; ++i)
+        {
+            _transformOrder.push_back(roots[i]);
+            for (Node* child = roots[i]->_firstChild; child != NULL; child = child->_nextSibling)
+            {
+                children.push_back(child);
+            }
+        }
+        roots.swap(children);
+    }
+
+    // Flatten each remaining subtree breadth-first into its own contiguous segment.
+    for (unsigned int i = 0, count = roots.size(); i < count; ++i)
+    {
+        unsigned int start = _transformOrder.size();
+        _transformSegments.push_back(start);
+        _transformOrder.push_back(roots[i]);
+        for (unsigned int j = start; j < _transformOrder.size(); ++j)
+        {
+            for (Node* child = _transformOrder[j]->_firstChild; child != NULL; child = child->_nextSibling)
+            {
+                _transformOrder.push_back(child);
+            }
+        }
+    }
+    _transformSegments.push_back(_transformOrder.size());
+}
+
+void Scene::updateTransformSegment(void* scene, unsigned int index)
+{
+    Scene* s = (Scene*)scene;
+    for (unsigned int i = s->_transformSegments[index], end = s->_transformSegments[index + 1]; i < end; ++i)
+    {
+        s->_transformOrder[i]->updateWorldMatrix();
+    }
+}
+
 }
@@ -2,6 +2,7 @@
 #define SCENE_H_
 
 #include "Node.h"
+#include "SpatialIndex.h"
 
 namespace gameplay
 {
@@ -11,6 +12,8 @@ namespace gameplay
  */
 class Scene : public Ref
 {
+    friend class Node;
+
 public:
 
     /**
@@ -117,6 +120,16 @@ public:
      */
     Camera* getActiveCamera() const;
 
+    /**
+     * Gets the spatial index of the scene.
+     *
+     * The spatial index locates the nodes of the scene that have a model, a point
+     * or spot light, or an audio source, for frustum, proximity and ray queries.
+     *
+     * @return The spatial index of the scene.
+     */
+    SpatialIndex* getSpatialIndex() const;
+
     /**
      * Sets the active camera on the scene.
      * 
@@ -162,6 +175,19 @@ public:
      */
     void setAmbientColor(float red, float green, float blue);
 
+    /**
+     * Resolves the world matrices of all nodes in the scene whose transforms have changed.
+     *
+     * The scene hierarchy is flattened into an array ordered so that parents precede
+     * their children, which is cached until the hierarchy changes. World matrices are
+     * then resolved in a single linear sweep over that array, with independent subtrees
+     * of large scenes split across the worker threads of the game's JobSystem.
+     *
+     * Calling this method once per frame (after animations and physics have updated
+     * and before drawing) avoids resolving world matrices lazily while rendering.
+     */
+    void updateTransforms();
+
     /**
      * Visits each node in the scene and calls the specified method pointer.
      *
@@ -180,6 +206,27 @@ public:
     template <class T>
     void visit(T* instance, bool (T::*visitMethod)(Node*,void*), void* cookie = 0);
 
+    /**
+     * Visits each node in the scene whose bounds intersect the specified frustum.
+     *
+     * This method behaves like visit, except that nodes whose bounding sphere
+     * lies outside the frustum are skipped. Since the bounding sphere of a node
+     * contains the bounding spheres of its children, the children of a culled
+     * node are skipped without being tested, and the children of a node that
+     * lies entirely inside some of the frustum planes are not tested against
+     * those planes again.
+     *
+     * Each node remembers the frustum plane that last culled it and tests that
+     * plane first, which makes rejecting nodes that stay out of view cheap.
+     *
+     * @param frustum The frustum to cull the nodes against (usually the frustum of the active camera).
+     * @param instance The pointer to an instance of the object that contains visitMethod.
+     * @param visitMethod The pointer to the class method to call for each visible node in the scene.
+     * @param cookie An optional user-defined parameter that will be passed to each invocation of visitMethod.
+     */
+    template <class T>
+    void visitVisible(const Frustum& frustum, T* instance, bool (T::*visitMethod)(Node*,void*), void* cookie = 0);
+
 private:
 
     /**
@@ -203,6 +250,22 @@ private:
     template <class T>
     bool visitNode(Node* node, T* instance, bool (T::*visitMethod)(Node*,void*), void* cookie);
 
+    /**
+     * Visits the given node and its children recursively, if they intersect the given frustum planes.
+     */
+    template <class T>
+    bool visitVisibleNode(Node* node, const Frustum& frustum, unsigned int planeMask, T* instance, bool (T::*visitMethod)(Node*,void*), void* cookie);
+
+    /**
+     * Rebuilds the flattened transform order of the scene hierarchy.
+     */
+    void buildTransformOrder(unsigned int segmentCount);
+
+    /**
+     * Resolves the world matrices of one segment of the transform order (job function).
+     */
+    static void updateTransformSegment(void* scene, unsigned int index);
+
     std::string _id;
     Camera* _activeCamera;
     Viewport _viewport;
@@ -211,6 +274,10 @@ private:
     unsigned int _nodeCount;
     Vector3 _ambientColor;
     bool _bindAudioListenerToCamera;
+    std::vector<Node*> _transformOrder;             // The scene nodes, ordered so that parents precede their children.
+    std::vector<unsigned int> _transformSegments;   // Start of each independent subtree in _transformOrder, followed by its size.
+    bool _transformOrderDirty;                      // Whether _transformOrder must be rebuilt.
+    SpatialIndex* _spatialIndex;                    // Locates the nodes of the scene in space.
 };
 
 template <class T>
@@ -240,6 +307,37 @@ bool Scene::visitNode(Node* node, T* instance, bool (T::*visitMethod)(Node*,void
     return true;
 }
 
+template <class T>
+void Scene::visitVisible(const Frustum& frustum, T* instance, bool (T::*visitMethod)(Node*,void*), void* cookie)
+{
+    for (Node* node = getFirstNode(); node != NULL; node = node->getNextSibling())
+    {
+        if (!visitVisibleNode(node, frustum, 0x3F, instance, visitMethod, cookie))
+            return;
+    }
+}
+
+template <class T>
+bool Scene::visitVisibleNode(Node* node, const Frustum& frustum, unsigned int planeMask, T* instance, bool (T::*visitMethod)(Node*,void*), void* cookie)
+{
+    // Once the node is inside all planes, so are its children.
+    if (planeMask != 0 && !frustum.intersects(node->getBoundingSphere(), &planeMask, &node->_cullingPlane))
+        return true;
+
+    // Invoke the visit method for this node.
+    if (!(instance->*visitMethod)(node, cookie))
+        return false;
+
+    // Recurse for all children, testing only the planes they may still be outside of.
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        if (!visitVisibleNode(child, frustum, planeMask, instance, visitMethod, cookie))
+            return false;
+    }
+
+    return true;
+}
+
 }
 
 #endif
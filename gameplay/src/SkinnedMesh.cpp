@@ -0,0 +1,324 @@
+#include "Base.h"
+#include "SkinnedMesh.h"
+#include "Game.h"
+#include "Model.h"
+#include "MathUtil.h"
+
+// The number of vertices skinned by each job of an update.
+#define SKINNED_MESH_RANGE_SIZE                 512
+
+// The number of vertices from which updates are spread across the job system.
+#define SKINNED_MESH_PARALLEL_THRESHOLD         2048
+
+namespace gameplay
+{
+
+SkinnedMesh::SkinnedMesh(MeshSkin* skin, const VertexFormat& vertexFormat, unsigned int vertexCount)
+    : _skin(skin), _model(NULL), _vertexFormat(vertexFormat), _vertexCount(vertexCount), _vertexStride(vertexFormat.getVertexSize() / sizeof(float)),
+      _positionOffset(0), _directionCount(0), _positions(NULL), _directions(NULL), _weights(NULL), _rows(NULL), _vertexData(NULL), _jointCount(0),
+      _palette(NULL), _mesh(NULL)
+{
+    memset(_directionOffsets, 0, sizeof(_directionOffsets));
+}
+
+SkinnedMesh::SkinnedMesh(const SkinnedMesh& copy)
+    : _vertexFormat(copy._vertexFormat)
+{
+    // hidden
+}
+
+SkinnedMesh::~SkinnedMesh()
+{
+    SAFE_RELEASE(_mesh);
+    SAFE_RELEASE(_model);
+    SAFE_DELETE_ARRAY(_positions);
+    SAFE_DELETE_ARRAY(_directions);
+    SAFE_DELETE_ARRAY(_weights);
+    SAFE_DELETE_ARRAY(_rows);
+    SAFE_DELETE_ARRAY(_vertexData);
+}
+
+SkinnedMesh* SkinnedMesh::create(MeshSkin* skin, const VertexFormat& vertexFormat, const void* vertexData, unsigned int vertexCount)
+{
+    assert(skin);
+    assert(vertexData || vertexCount == 0);
+
+    // Locate the skinned elements in the source vertices, and build the format of the
+    // skinned vertices from the other elements.
+    int positionOffset = -1;
+    int weightsOffset = -1;
+    int indicesOffset = -1;
+    unsigned int positionSize = 0;
+    unsigned int directionCount = 0;
+    unsigned int directionOffsets[3];
+    unsigned int directionSizes[3];
+    unsigned int weightsSize = 0;
+    unsigned int indicesSize = 0;
+    std::vector<VertexFormat::Element> elements;
+    std::vector<unsigned int> elementOffsets;
+    unsigned int sourceStride = vertexFormat.getVertexSize() / sizeof(float);
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& element = vertexFormat.getElement(i);
+        switch (element.usage)
+        {
+        case VertexFormat::POSITION:
+            positionOffset = offset;
+            positionSize = std::min(element.size, 4u);
+            elements.push_back(VertexFormat::Element(VertexFormat::POSITION, 3));
+            elementOffsets.push_back(offset);
+            break;
+        case VertexFormat::NORMAL:
+        case VertexFormat::TANGENT:
+        case VertexFormat::BINORMAL:
+            if (directionCount < 3)
+            {
+                directionOffsets[directionCount] = offset;
+                directionSizes[directionCount] = std::min(element.size, 3u);
+                ++directionCount;
+                elements.push_back(VertexFormat::Element(element.usage, 3));
+            }
+            else
+            {
+                elements.push_back(element);
+            }
+            elementOffsets.push_back(offset);
+            break;
+        case VertexFormat::BLENDWEIGHTS:
+            weightsOffset = offset;
+            weightsSize = std::min(element.size, 4u);
+            break;
+        case VertexFormat::BLENDINDICES:
+            indicesOffset = offset;
+            indicesSize = std::min(element.size, 4u);
+            break;
+        default:
+            elements.push_back(element);
+            elementOffsets.push_back(offset);
+            break;
+        }
+        offset += element.size;
+    }
+
+    if (positionOffset < 0 || weightsOffset < 0 || indicesOffset < 0)
+    {
+        WARN("Failed to create skinned mesh: vertex format must have a position, blend weights and blend indices.");
+        return NULL;
+    }
+
+    SkinnedMesh* skinnedMesh = new SkinnedMesh(skin, VertexFormat(&elements[0], elements.size()), vertexCount);
+    skinnedMesh->_model = skin->getModel();
+    if (skinnedMesh->_model)
+    {
+        skinnedMesh->_model->addRef();
+    }
+    skinnedMesh->_jointCount = skin->getJointCount();
+    skinnedMesh->_directionCount = directionCount;
+    skinnedMesh->_positions = new float[vertexCount * 4];
+    skinnedMesh->_directions = directionCount > 0 ? new float[vertexCount * directionCount * 4] : NULL;
+    skinnedMesh->_weights = new float[vertexCount * 4];
+    skinnedMesh->_rows = new unsigned int[vertexCount * 4];
+    skinnedMesh->_vertexData = new float[vertexCount * skinnedMesh->_vertexStride];
+
+    // Split the skinned elements into 4-component streams, padded like the vertex
+    // shaders pad their attributes: missing weights do not contribute, and positions
+    // default to w = 1.
+    const float* source = (const float*)vertexData;
+    bool invalidIndices = false;
+    for (unsigned int v = 0; v < vertexCount; ++v, source += sourceStride)
+    {
+        float* position = &skinnedMesh->_positions[v * 4];
+        position[0] = position[1] = position[2] = 0.0f;
+        position[3] = 1.0f;
+        for (unsigned int i = 0; i < positionSize; ++i)
+        {
+            position[i] = source[positionOffset + i];
+        }
+
+        for (unsigned int d = 0; d < directionCount; ++d)
+        {
+            float* direction = &skinnedMesh->_directions[(v * directionCount + d) * 4];
+            direction[0] = direction[1] = direction[2] = direction[3] = 0.0f;
+            for (unsigned int i = 0; i < directionSizes[d]; ++i)
+            {
+                direction[i] = source[directionOffsets[d] + i];
+            }
+        }
+
+        float* weights = &skinnedMesh->_weights[v * 4];
+        unsigned int* rows = &skinnedMesh->_rows[v * 4];
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            weights[i] = i < weightsSize ? source[weightsOffset + i] : 0.0f;
+            unsigned int joint = i < indicesSize ? (unsigned int)source[indicesOffset + i] : 0;
+            if (joint >= skinnedMesh->_jointCount)
+            {
+                // Keep reads inside the palette; the influence is dropped.
+                invalidIndices = true;
+                joint = 0;
+                weights[i] = 0.0f;
+            }
+            rows[i] = joint * 3;
+        }
+    }
+    if (invalidIndices)
+    {
+        WARN_VARG("Skinned mesh has blend indices beyond the %u joints of its skin.", skinnedMesh->_jointCount);
+    }
+
+    // Copy the elements that are not skinned once, and locate the skinned ones.
+    offset = 0;
+    unsigned int direction = 0;
+    for (unsigned int i = 0, count = elements.size(); i < count; ++i)
+    {
+        const VertexFormat::Element& element = elements[i];
+        if (element.usage == VertexFormat::POSITION)
+        {
+            skinnedMesh->_positionOffset = offset;
+        }
+        else if (direction < directionCount && elementOffsets[i] == directionOffsets[direction])
+        {
+            skinnedMesh->_directionOffsets[direction++] = offset;
+        }
+        else
+        {
+            source = (const float*)vertexData + elementOffsets[i];
+            float* destination = skinnedMesh->_vertexData + offset;
+            for (unsigned int v = 0; v < vertexCount; ++v, source += sourceStride, destination += skinnedMesh->_vertexStride)
+            {
+                memcpy(destination, source, element.size * sizeof(float));
+            }
+        }
+        offset += element.size;
+    }
+
+    unsigned int rangeCount = (vertexCount + SKINNED_MESH_RANGE_SIZE - 1) / SKINNED_MESH_RANGE_SIZE;
+    skinnedMesh->_rangeBounds.resize(rangeCount);
+
+    return skinnedMesh;
+}
+
+MeshSkin* SkinnedMesh::getSkin() const
+{
+    return _skin;
+}
+
+const VertexFormat& SkinnedMesh::getVertexFormat() const
+{
+    return _vertexFormat;
+}
+
+unsigned int SkinnedMesh::getVertexCount() const
+{
+    return _vertexCount;
+}
+
+const float* SkinnedMesh::getVertexData() const
+{
+    return _vertexData;
+}
+
+const BoundingBox& SkinnedMesh::getBoundingBox() const
+{
+    return _boundingBox;
+}
+
+Mesh* SkinnedMesh::getMesh()
+{
+    if (!_mesh && _vertexCount > 0)
+    {
+        _mesh = Mesh::createMesh(_vertexFormat, _vertexCount, true);
+        if (_mesh)
+        {
+            _mesh->setVertexData(_vertexData);
+            _mesh->setBoundingBox(_boundingBox);
+        }
+    }
+
+    return _mesh;
+}
+
+void SkinnedMesh::update()
+{
+    update(_skin->getMatrixPalette(), _skin->getMatrixPaletteSize());
+}
+
+void SkinnedMesh::update(const Vector4* palette, unsigned int paletteSize)
+{
+    assert(palette);
+    assert(paletteSize >= _jointCount * 3);
+
+    _palette = (const float*)palette;
+
+    unsigned int rangeCount = _rangeBounds.size();
+    Game* game = Game::getInstance();
+    JobSystem* jobSystem = game ? game->getJobSystem() : NULL;
+    if (jobSystem && _vertexCount >= SKINNED_MESH_PARALLEL_THRESHOLD)
+    {
+        jobSystem->parallelFor(rangeCount, &SkinnedMesh::skinRange, this);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < rangeCount; ++i)
+        {
+            skinRange(this, i);
+        }
+    }
+
+    _palette = NULL;
+
+    _boundingBox.set(Vector3::zero(), Vector3::zero());
+    for (unsigned int i = 0; i < rangeCount; ++i)
+    {
+        if (i == 0)
+        {
+            _boundingBox.set(_rangeBounds[i]);
+        }
+        else
+        {
+            _boundingBox.merge(_rangeBounds[i]);
+        }
+    }
+
+    if (_mesh)
+    {
+        _mesh->setVertexData(_vertexData);
+        _mesh->setBoundingBox(_boundingBox);
+    }
+}
+
+void SkinnedMesh::skinRange(void* data, unsigned int index)
+{
+    SkinnedMesh* skinnedMesh = (SkinnedMesh*)data;
+    unsigned int start = index * SKINNED_MESH_RANGE_SIZE;
+    unsigned int end = std::min(start + SKINNED_MESH_RANGE_SIZE, skinnedMesh->_vertexCount);
+    unsigned int stride = skinnedMesh->_vertexStride;
+    const float* palette = skinnedMesh->_palette;
+    unsigned int directionCount = skinnedMesh->_directionCount;
+    const float* directions = skinnedMesh->_directions;
+
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    float* dstDirections[3];
+    for (unsigned int v = start; v < end; ++v)
+    {
+        float* vertex = &skinnedMesh->_vertexData[v * stride];
+        float* position = vertex + skinnedMesh->_positionOffset;
+        for (unsigned int d = 0; d < directionCount; ++d)
+        {
+            dstDirections[d] = vertex + skinnedMesh->_directionOffsets[d];
+        }
+        MathUtil::skinVertex(palette, &skinnedMesh->_rows[v * 4], &skinnedMesh->_weights[v * 4], &skinnedMesh->_positions[v * 4],
+                             directions ? &directions[v * directionCount * 4] : NULL, directionCount, position, dstDirections);
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            min[i] = std::min(min[i], position[i]);
+            max[i] = std::max(max[i], position[i]);
+        }
+    }
+
+    skinnedMesh->_rangeBounds[index].set(Vector3(min[0], min[1], min[2]), Vector3(max[0], max[1], max[2]));
+}
+
+}
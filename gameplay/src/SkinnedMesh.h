@@ -0,0 +1,154 @@
+#ifndef SKINNEDMESH_H_
+#define SKINNEDMESH_H_
+
+#include "Ref.h"
+#include "Mesh.h"
+#include "MeshSkin.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a mesh whose vertices are skinned on the CPU instead of in the vertex shader.
+ *
+ * A skinned mesh is created from the vertex data of a skinned mesh (with blend
+ * weights and blend indices) and the skin that deforms it. Each update blends the
+ * matrix palette of the skin into skinned positions, normals, tangents and binormals,
+ * using the same math as the MATRIX_PALETTE path of the shaders, and writes them
+ * into a dynamic vertex buffer. The blend weights and indices are dropped from the
+ * resulting vertex format, so the mesh is drawn with a material that does not skin.
+ *
+ * Skinning is spread across the job system in ranges of vertices for large meshes.
+ * No GL resource is created until getMesh is called, so a skinned mesh can be
+ * updated (and benchmarked) without a graphics context.
+ */
+class SkinnedMesh : public Ref
+{
+public:
+
+    /**
+     * Creates a skinned mesh.
+     *
+     * The vertex data is copied, so it does not need to be kept by the caller. The
+     * position, normal, tangent, binormal, blend weight and blend index elements of
+     * the vertex format are read as floats, like the vertex shaders do.
+     *
+     * A skin is owned by its model, so the skinned mesh keeps a reference to the
+     * model of the skin. A skin that is not attached to a model must outlive the
+     * skinned mesh.
+     *
+     * @param skin The skin deforming the mesh.
+     * @param vertexFormat The format of the vertex data, which must have a position.
+     * @param vertexData The vertex data to skin.
+     * @param vertexCount The number of vertices.
+     *
+     * @return The new skinned mesh, or NULL if the vertex format cannot be skinned.
+     */
+    static SkinnedMesh* create(MeshSkin* skin, const VertexFormat& vertexFormat, const void* vertexData, unsigned int vertexCount);
+
+    /**
+     * Gets the skin deforming the mesh.
+     *
+     * @return The skin.
+     */
+    MeshSkin* getSkin() const;
+
+    /**
+     * Gets the format of the skinned vertices.
+     *
+     * This is the source vertex format without the blend weights and blend indices,
+     * with 3-component positions, normals, tangents and binormals.
+     *
+     * @return The vertex format of the skinned vertices.
+     */
+    const VertexFormat& getVertexFormat() const;
+
+    /**
+     * Gets the number of vertices.
+     *
+     * @return The number of vertices.
+     */
+    unsigned int getVertexCount() const;
+
+    /**
+     * Gets the skinned vertices, as of the last update.
+     *
+     * @return The skinned vertex data, in the format returned by getVertexFormat.
+     */
+    const float* getVertexData() const;
+
+    /**
+     * Gets the bounding box of the skinned positions, as of the last update.
+     *
+     * @return The bounding box of the skinned positions.
+     */
+    const BoundingBox& getBoundingBox() const;
+
+    /**
+     * Gets the dynamic mesh holding the skinned vertices, creating it on first use.
+     *
+     * Mesh parts (index buffers) are not copied from the source mesh; they must be
+     * added to the returned mesh by the caller.
+     *
+     * @return The dynamic mesh, or NULL if it could not be created.
+     */
+    Mesh* getMesh();
+
+    /**
+     * Skins the vertices with the current matrix palette of the skin.
+     */
+    void update();
+
+    /**
+     * Skins the vertices with the given matrix palette.
+     *
+     * @param palette The matrix palette, in the layout of MeshSkin::getMatrixPalette.
+     * @param paletteSize The number of Vector4 rows in the palette.
+     */
+    void update(const Vector4* palette, unsigned int paletteSize);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    SkinnedMesh(MeshSkin* skin, const VertexFormat& vertexFormat, unsigned int vertexCount);
+
+    /**
+     * Hidden copy constructor.
+     */
+    SkinnedMesh(const SkinnedMesh& copy);
+
+    /**
+     * Destructor.
+     */
+    ~SkinnedMesh();
+
+    /**
+     * Skins one range of vertices. Used as a job function.
+     */
+    static void skinRange(void* data, unsigned int index);
+
+    MeshSkin* _skin;                        // The skin deforming the mesh.
+    Model* _model;                          // The model owning the skin, referenced to keep the skin alive.
+    VertexFormat _vertexFormat;             // The format of the skinned vertices.
+    unsigned int _vertexCount;              // The number of vertices.
+    unsigned int _vertexStride;             // The number of floats per skinned vertex.
+    unsigned int _positionOffset;           // The offset of the position in a skinned vertex, in floats.
+    unsigned int _directionCount;           // The number of directions (normal, tangent, binormal) per vertex.
+    unsigned int _directionOffsets[3];      // The offset of each direction in a skinned vertex, in floats.
+    float* _positions;                      // The source positions, 4 floats per vertex.
+    float* _directions;                     // The source directions, 4 floats per direction, or NULL.
+    float* _weights;                        // The blend weights, 4 per vertex.
+    unsigned int* _rows;                    // The first palette row of each of the 4 joints of each vertex.
+    float* _vertexData;                     // The skinned vertices.
+    unsigned int _jointCount;               // The number of joints the blend indices were validated against.
+    const float* _palette;                  // The palette being skinned with during an update.
+    std::vector<BoundingBox> _rangeBounds;  // The bounds of the skinned positions of each range.
+    BoundingBox _boundingBox;               // The bounds of the skinned positions.
+    Mesh* _mesh;                            // The dynamic mesh, created on first use.
+};
+
+}
+
+#endif
@@ -0,0 +1,604 @@
+#include "Base.h"
+#include "SpatialIndex.h"
+#include "Node.h"
+
+// The fraction of their size by which leaf boxes are enlarged on each side, so that
+// nodes moving by small amounts do not need to be reinserted in the hierarchy.
+#define SPATIAL_INDEX_MARGIN 0.1f
+
+namespace gameplay
+{
+
+// Returns half the surface area of the given box, the cost metric of the hierarchy.
+static float getArea(const BoundingBox& box)
+{
+    float x = box.max.x - box.min.x;
+    float y = box.max.y - box.min.y;
+    float z = box.max.z - box.min.z;
+    return x * y + y * z + z * x;
+}
+
+// Returns whether the box a contains the box b.
+static bool contains(const BoundingBox& a, const BoundingBox& b)
+{
+    return a.min.x <= b.min.x && a.min.y <= b.min.y && a.min.z <= b.min.z &&
+           a.max.x >= b.max.x && a.max.y >= b.max.y && a.max.z >= b.max.z;
+}
+
+// Sets dst to the union of the boxes a and b.
+static void combine(const BoundingBox& a, const BoundingBox& b, BoundingBox* dst)
+{
+    dst->set(a);
+    dst->merge(b);
+}
+
+SpatialIndex::SpatialIndex()
+    : _root(-1), _freeList(-1), _nodeCount(0)
+{
+}
+
+SpatialIndex::SpatialIndex(const SpatialIndex& copy)
+{
+    // hidden
+}
+
+SpatialIndex::~SpatialIndex()
+{
+    // Nodes remove themselves when they leave the scene, so the index should be empty by now.
+    for (unsigned int i = 0, count = _entries.size(); i < count; ++i)
+    {
+        if (_entries[i].node)
+        {
+            _entries[i].node->_spatialIndex = NULL;
+            _entries[i].node->_spatialProxy = -1;
+        }
+    }
+}
+
+unsigned int SpatialIndex::getNodeCount() const
+{
+    return _nodeCount;
+}
+
+bool SpatialIndex::isIndexed(const Node* node)
+{
+    if ((node->_model && node->_model->getMesh()) || node->_audioSource)
+        return true;
+
+    return node->_light && node->_light->getLightType() != Light::DIRECTIONAL;
+}
+
+void SpatialIndex::getBounds(const Node* node, BoundingBox* dst)
+{
+    assert(node);
+    assert(dst);
+
+    bool empty = true;
+    if (node->_model && node->_model->getMesh())
+    {
+        BoundingSphere sphere;
+        node->getModelBoundingSphere(&sphere);
+        dst->set(sphere);
+        empty = false;
+    }
+
+    if (node->_light && node->_light->getLightType() != Light::DIRECTIONAL)
+    {
+        BoundingSphere sphere(node->getTranslationWorld(), node->_light->getRange());
+        if (empty)
+        {
+            dst->set(sphere);
+            empty = false;
+        }
+        else
+        {
+            dst->merge(sphere);
+        }
+    }
+
+    if (empty)
+    {
+        // Audio sources (and anything else) are located at the node's position.
+        Vector3 translation = node->getTranslationWorld();
+        dst->set(translation, translation);
+    }
+}
+
+void SpatialIndex::insert(Node* node)
+{
+    assert(node);
+
+    if (node->_spatialIndex == this)
+    {
+        setDirty(node);
+        return;
+    }
+    else if (node->_spatialIndex)
+    {
+        node->_spatialIndex->remove(node);
+    }
+
+    int leaf = allocateEntry();
+    Entry& entry = _entries[leaf];
+    entry.node = node;
+    entry.height = 0;
+    entry.dirty = false;
+    getBounds(node, &entry.bounds);
+    setLeafBox(leaf);
+    insertLeaf(leaf);
+
+    node->_spatialIndex = this;
+    node->_spatialProxy = leaf;
+    ++_nodeCount;
+}
+
+void SpatialIndex::remove(Node* node)
+{
+    assert(node && node->_spatialIndex == this);
+
+    int leaf = node->_spatialProxy;
+    removeLeaf(leaf);
+    freeEntry(leaf);
+
+    node->_spatialIndex = NULL;
+    node->_spatialProxy = -1;
+    --_nodeCount;
+}
+
+void SpatialIndex::setDirty(Node* node)
+{
+    assert(node && node->_spatialIndex == this);
+
+    Entry& entry = _entries[node->_spatialProxy];
+    if (!entry.dirty)
+    {
+        entry.dirty = true;
+        _dirty.push_back(node->_spatialProxy);
+    }
+}
+
+void SpatialIndex::update()
+{
+    for (unsigned int i = 0, count = _dirty.size(); i < count; ++i)
+    {
+        int leaf = _dirty[i];
+
+        // The node may have been removed (and its entry reused) since it was marked dirty.
+        Entry& entry = _entries[leaf];
+        if (entry.height != 0 || !entry.dirty)
+            continue;
+
+        entry.dirty = false;
+        getBounds(entry.node, &entry.bounds);
+        if (!contains(entry.box, entry.bounds))
+        {
+            removeLeaf(leaf);
+            setLeafBox(leaf);
+            insertLeaf(leaf);
+        }
+    }
+    _dirty.clear();
+}
+
+int SpatialIndex::allocateEntry()
+{
+    int index;
+    if (_freeList != -1)
+    {
+        index = _freeList;
+        _freeList = _entries[index].parent;
+    }
+    else
+    {
+        index = _entries.size();
+        _entries.push_back(Entry());
+    }
+
+    Entry& entry = _entries[index];
+    entry.node = NULL;
+    entry.parent = -1;
+    entry.child1 = -1;
+    entry.child2 = -1;
+    entry.height = 0;
+    entry.dirty = false;
+    return index;
+}
+
+void SpatialIndex::freeEntry(int index)
+{
+    Entry& entry = _entries[index];
+    entry.node = NULL;
+    entry.height = -1;
+    entry.dirty = false;
+    entry.parent = _freeList;
+    _freeList = index;
+}
+
+void SpatialIndex::setLeafBox(int leaf)
+{
+    Entry& entry = _entries[leaf];
+    Vector3 margin(entry.bounds.max - entry.bounds.min);
+    margin.scale(SPATIAL_INDEX_MARGIN);
+    entry.box.set(entry.bounds.min - margin, entry.bounds.max + margin);
+}
+
+void SpatialIndex::insertLeaf(int leaf)
+{
+    if (_root == -1)
+    {
+        _root = leaf;
+        _entries[leaf].parent = -1;
+        return;
+    }
+
+    // Descend towards the sibling that minimizes the increase of the surface area of the hierarchy.
+    const BoundingBox leafBox = _entries[leaf].box;
+    int index = _root;
+    BoundingBox combined;
+    while (_entries[index].height > 0)
+    {
+        const Entry& entry = _entries[index];
+
+        combine(entry.box, leafBox, &combined);
+        float area = getArea(entry.box);
+        float combinedArea = getArea(combined);
+
+        // Cost of making the leaf a sibling of this entry.
+        float cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the hierarchy.
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCosts[2];
+        int children[2] = { entry.child1, entry.child2 };
+        for (unsigned int i = 0; i < 2; ++i)
+        {
+            const Entry& child = _entries[children[i]];
+            combine(leafBox, child.box, &combined);
+            childCosts[i] = child.height == 0 ? getArea(combined) : getArea(combined) - getArea(child.box);
+            childCosts[i] += inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+            break;
+
+        index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+
+    // Create a new parent for the sibling and the leaf.
+    int sibling = index;
+    int oldParent = _entries[sibling].parent;
+    int newParent = allocateEntry();
+    Entry& parent = _entries[newParent];
+    parent.parent = oldParent;
+    combine(leafBox, _entries[sibling].box, &parent.box);
+    parent.height = _entries[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+
+    if (oldParent != -1)
+    {
+        if (_entries[oldParent].child1 == sibling)
+            _entries[oldParent].child1 = newParent;
+        else
+            _entries[oldParent].child2 = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+    _entries[sibling].parent = newParent;
+    _entries[leaf].parent = newParent;
+
+    refitAncestors(newParent);
+}
+
+void SpatialIndex::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = -1;
+        return;
+    }
+
+    int parent = _entries[leaf].parent;
+    int grandParent = _entries[parent].parent;
+    int sibling = _entries[parent].child1 == leaf ? _entries[parent].child2 : _entries[parent].child1;
+
+    // Replace the parent by the sibling.
+    if (grandParent != -1)
+    {
+        if (_entries[grandParent].child1 == parent)
+            _entries[grandParent].child1 = sibling;
+        else
+            _entries[grandParent].child2 = sibling;
+        _entries[sibling].parent = grandParent;
+        freeEntry(parent);
+
+        refitAncestors(grandParent);
+    }
+    else
+    {
+        _root = sibling;
+        _entries[sibling].parent = -1;
+        freeEntry(parent);
+    }
+}
+
+void SpatialIndex::refitAncestors(int index)
+{
+    while (index != -1)
+    {
+        index = balance(index);
+
+        Entry& entry = _entries[index];
+        const Entry& child1 = _entries[entry.child1];
+        const Entry& child2 = _entries[entry.child2];
+        entry.height = 1 + std::max(child1.height, child2.height);
+        combine(child1.box, child2.box, &entry.box);
+
+        index = entry.parent;
+    }
+}
+
+int SpatialIndex::balance(int iA)
+{
+    Entry& a = _entries[iA];
+    if (a.height < 2)
+        return iA;
+
+    int iB = a.child1;
+    int iC = a.child2;
+    Entry& b = _entries[iB];
+    Entry& c = _entries[iC];
+
+    int balance = c.height - b.height;
+    if (balance > 1)
+    {
+        // Rotate C up.
+        int iF = c.child1;
+        int iG = c.child2;
+        Entry& f = _entries[iF];
+        Entry& g = _entries[iG];
+
+        c.child1 = iA;
+        c.parent = a.parent;
+        a.parent = iC;
+
+        if (c.parent != -1)
+        {
+            if (_entries[c.parent].child1 == iA)
+                _entries[c.parent].child1 = iC;
+            else
+                _entries[c.parent].child2 = iC;
+        }
+        else
+        {
+            _root = iC;
+        }
+
+        // Keep the higher of C's children under C.
+        if (f.height > g.height)
+        {
+            c.child2 = iF;
+            a.child2 = iG;
+            g.parent = iA;
+            combine(b.box, g.box, &a.box);
+            combine(a.box, f.box, &c.box);
+            a.height = 1 + std::max(b.height, g.height);
+            c.height = 1 + std::max(a.height, f.height);
+        }
+        else
+        {
+            c.child2 = iG;
+            a.child2 = iF;
+            f.parent = iA;
+            combine(b.box, f.box, &a.box);
+            combine(a.box, g.box, &c.box);
+            a.height = 1 + std::max(b.height, f.height);
+            c.height = 1 + std::max(a.height, g.height);
+        }
+
+        return iC;
+    }
+
+    if (balance < -1)
+    {
+        // Rotate B up.
+        int iD = b.child1;
+        int iE = b.child2;
+        Entry& d = _entries[iD];
+        Entry& e = _entries[iE];
+
+        b.child1 = iA;
+        b.parent = a.parent;
+        a.parent = iB;
+
+        if (b.parent != -1)
+        {
+            if (_entries[b.parent].child1 == iA)
+                _entries[b.parent].child1 = iB;
+            else
+                _entries[b.parent].child2 = iB;
+        }
+        else
+        {
+            _root = iB;
+        }
+
+        // Keep the higher of B's children under B.
+        if (d.height > e.height)
+        {
+            b.child2 = iD;
+            a.child1 = iE;
+            e.parent = iA;
+            combine(c.box, e.box, &a.box);
+            combine(a.box, d.box, &b.box);
+            a.height = 1 + std::max(c.height, e.height);
+            b.height = 1 + std::max(a.height, d.height);
+        }
+        else
+        {
+            b.child2 = iE;
+            a.child1 = iD;
+            d.parent = iA;
+            combine(c.box, d.box, &a.box);
+            combine(a.box, e.box, &b.box);
+            a.height = 1 + std::max(c.height, d.height);
+            b.height = 1 + std::max(a.height, e.height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+void SpatialIndex::find(const Frustum& frustum, std::vector<Node*>* dst)
+{
+    assert(dst);
+
+    update();
+    if (_root == -1)
+        return;
+
+    const Plane* planes[6] = { &frustum.getNear(), &frustum.getFar(), &frustum.getLeft(),
+                               &frustum.getRight(), &frustum.getBottom(), &frustum.getTop() };
+
+    // The stack holds pairs of entries and the planes they may still be outside of.
+    _stack.clear();
+    _stack.push_back(_root);
+    _stack.push_back(0x3F);
+    while (!_stack.empty())
+    {
+        unsigned int planeMask = _stack.back();
+        _stack.pop_back();
+        const Entry& entry = _entries[_stack.back()];
+        _stack.pop_back();
+
+        const BoundingBox& box = entry.height == 0 ? entry.bounds : entry.box;
+        bool outside = false;
+        for (unsigned int i = 0; i < 6 && planeMask != 0; ++i)
+        {
+            if ((planeMask & (1 << i)) == 0)
+                continue;
+
+            float result = box.intersects(*planes[i]);
+            if (result == Plane::INTERSECTS_BACK)
+            {
+                outside = true;
+                break;
+            }
+            else if (result == Plane::INTERSECTS_FRONT)
+            {
+                planeMask &= ~(1 << i);
+            }
+        }
+        if (outside)
+            continue;
+
+        if (entry.height == 0)
+        {
+            dst->push_back(entry.node);
+        }
+        else
+        {
+            _stack.push_back(entry.child1);
+            _stack.push_back(planeMask);
+            _stack.push_back(entry.child2);
+            _stack.push_back(planeMask);
+        }
+    }
+}
+
+void SpatialIndex::find(const BoundingSphere& sphere, std::vector<Node*>* dst)
+{
+    assert(dst);
+
+    update();
+    if (_root == -1)
+        return;
+
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const Entry& entry = _entries[_stack.back()];
+        _stack.pop_back();
+
+        if (entry.height == 0)
+        {
+            if (sphere.intersects(entry.bounds))
+            {
+                dst->push_back(entry.node);
+            }
+        }
+        else if (sphere.intersects(entry.box))
+        {
+            _stack.push_back(entry.child1);
+            _stack.push_back(entry.child2);
+        }
+    }
+}
+
+void SpatialIndex::find(const BoundingBox& box, std::vector<Node*>* dst)
+{
+    assert(dst);
+
+    update();
+    if (_root == -1)
+        return;
+
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const Entry& entry = _entries[_stack.back()];
+        _stack.pop_back();
+
+        if (entry.height == 0)
+        {
+            if (box.intersects(entry.bounds))
+            {
+                dst->push_back(entry.node);
+            }
+        }
+        else if (box.intersects(entry.box))
+        {
+            _stack.push_back(entry.child1);
+            _stack.push_back(entry.child2);
+        }
+    }
+}
+
+void SpatialIndex::find(const Ray& ray, std::vector<Node*>* dst)
+{
+    assert(dst);
+
+    update();
+    if (_root == -1)
+        return;
+
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        const Entry& entry = _entries[_stack.back()];
+        _stack.pop_back();
+
+        if (entry.height == 0)
+        {
+            if (ray.intersects(entry.bounds) != Ray::INTERSECTS_NONE)
+            {
+                dst->push_back(entry.node);
+            }
+        }
+        else if (ray.intersects(entry.box) != Ray::INTERSECTS_NONE)
+        {
+            _stack.push_back(entry.child1);
+            _stack.push_back(entry.child2);
+        }
+    }
+}
+
+}
@@ -0,0 +1,191 @@
+#ifndef SPATIALINDEX_H_
+#define SPATIALINDEX_H_
+
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+#include "Frustum.h"
+#include "Ray.h"
+
+namespace gameplay
+{
+
+class Node;
+
+/**
+ * Defines a spatial index over the nodes of a scene.
+ *
+ * The index is a dynamic bounding volume hierarchy of axis-aligned boxes, which
+ * answers frustum, sphere, box and ray queries in logarithmic time on average
+ * instead of visiting every node of the scene. It backs culling, light
+ * assignment and picking on large scenes.
+ *
+ * A node is indexed while it belongs to the scene and has a model, a point or spot
+ * light, or an audio source. Its bounds cover its model's bounding sphere, the range
+ * of its light and the position of its audio source, but not its children (which
+ * are indexed on their own). Directional lights affect the whole scene and are not
+ * indexed.
+ *
+ * Nodes are stored with slightly enlarged bounds. When a node moves, it is only
+ * marked dirty; dirty nodes are refitted before the next query, and are only
+ * reinserted in the hierarchy when they leave their enlarged bounds.
+ *
+ * The scene maintains its index automatically (see Scene::getSpatialIndex).
+ */
+class SpatialIndex
+{
+    friend class Scene;
+    friend class Node;
+
+public:
+
+    /**
+     * Gets the number of nodes in the index.
+     *
+     * @return The number of nodes in the index.
+     */
+    unsigned int getNodeCount() const;
+
+    /**
+     * Finds the nodes whose bounds intersect the specified frustum.
+     *
+     * @param frustum The frustum to test the nodes against.
+     * @param dst The list to append the nodes found to.
+     */
+    void find(const Frustum& frustum, std::vector<Node*>* dst);
+
+    /**
+     * Finds the nodes whose bounds intersect the specified bounding sphere.
+     *
+     * @param sphere The sphere to test the nodes against.
+     * @param dst The list to append the nodes found to.
+     */
+    void find(const BoundingSphere& sphere, std::vector<Node*>* dst);
+
+    /**
+     * Finds the nodes whose bounds intersect the specified bounding box.
+     *
+     * @param box The box to test the nodes against.
+     * @param dst The list to append the nodes found to.
+     */
+    void find(const BoundingBox& box, std::vector<Node*>* dst);
+
+    /**
+     * Finds the nodes whose bounds intersect the specified ray.
+     *
+     * The nodes are not sorted by distance along the ray. Since node bounds are
+     * approximations of their content, picking should test the returned nodes
+     * against their actual geometry.
+     *
+     * @param ray The ray to test the nodes against.
+     * @param dst The list to append the nodes found to.
+     */
+    void find(const Ray& ray, std::vector<Node*>* dst);
+
+private:
+
+    /**
+     * An entry of the hierarchy, either a branch or a leaf storing a node.
+     */
+    struct Entry
+    {
+        BoundingBox box;        // The enlarged bounds of a leaf, or the union of the boxes of a branch.
+        BoundingBox bounds;     // The actual bounds of the node of a leaf.
+        Node* node;             // The node of a leaf, or NULL for a branch.
+        int parent;             // The parent entry, or the next free entry once freed.
+        int child1;             // The first child of a branch.
+        int child2;             // The second child of a branch.
+        int height;             // 0 for leaves, -1 for free entries.
+        bool dirty;             // Whether the bounds of the node of a leaf must be refitted.
+    };
+
+    /**
+     * Constructor.
+     */
+    SpatialIndex();
+
+    /**
+     * Hidden copy constructor.
+     */
+    SpatialIndex(const SpatialIndex& copy);
+
+    /**
+     * Destructor.
+     */
+    ~SpatialIndex();
+
+    /**
+     * Determines whether the given node has anything to be indexed.
+     */
+    static bool isIndexed(const Node* node);
+
+    /**
+     * Computes the world-space bounds of the given node (excluding its children).
+     */
+    static void getBounds(const Node* node, BoundingBox* dst);
+
+    /**
+     * Adds the given node to the index, or marks it dirty if it is already indexed.
+     */
+    void insert(Node* node);
+
+    /**
+     * Removes the given node from the index.
+     */
+    void remove(Node* node);
+
+    /**
+     * Marks the given indexed node as moved.
+     */
+    void setDirty(Node* node);
+
+    /**
+     * Refits the bounds of the nodes that moved since the last query.
+     */
+    void update();
+
+    /**
+     * Allocates an entry.
+     */
+    int allocateEntry();
+
+    /**
+     * Returns an entry to the free list.
+     */
+    void freeEntry(int index);
+
+    /**
+     * Sets the enlarged box of a leaf from its actual bounds.
+     */
+    void setLeafBox(int leaf);
+
+    /**
+     * Inserts a leaf in the hierarchy.
+     */
+    void insertLeaf(int leaf);
+
+    /**
+     * Removes a leaf from the hierarchy.
+     */
+    void removeLeaf(int leaf);
+
+    /**
+     * Recomputes the boxes and heights of the ancestors of a modified entry, rebalancing them.
+     */
+    void refitAncestors(int index);
+
+    /**
+     * Rotates the branch at the given index if it is unbalanced, returning the entry that replaces it.
+     */
+    int balance(int index);
+
+    std::vector<Entry> _entries;    // The entries of the hierarchy, including free ones.
+    int _root;                      // The root entry, or -1 when empty.
+    int _freeList;                  // The first free entry, or -1.
+    unsigned int _nodeCount;        // The number of indexed nodes.
+    std::vector<int> _dirty;        // The leaves whose nodes moved since the last query.
+    std::vector<int> _stack;        // Traversal stack reused by queries.
+};
+
+}
+
+#endif
@@ -8,20 +8,15 @@
 // Factor to grow a sprite batch by when its size is exceeded
 #define SPRITE_BATCH_GROW_FACTOR 2.0f
 
+// Number of sprites to grow a sprite batch by when its size is exceeded
+#define SPRITE_BATCH_GROW_SIZE 1024
+
 // Macro for adding a sprite to the batch
 #define ADD_SPRITE_VERTEX(vtx, vx, vy, vz, vu, vv, vr, vg, vb, va) \
     vtx.x = vx; vtx.y = vy; vtx.z = vz; \
     vtx.u = vu; vtx.v = vv; \
     vtx.r = vr; vtx.g = vg; vtx.b = vb; vtx.a = va
 
-// Sprite vertex structured used for batching
-struct SpriteVertex
-{
-    float x, y, z;
-    float u, v;
-    float r, g, b, a;
-};
-
 // Default sprite vertex shader
 #define SPRITE_VSH \
     "uniform mat4 u_projectionMatrix;\n" \
@@ -144,8 +139,9 @@ SpriteBatch* SpriteBatch::create(Texture* texture, Effect* effect, unsigned int
     };
     VertexFormat vertexFormat(vertexElements, 3);
 
-    // Create the mesh batch
-    MeshBatch* meshBatch = MeshBatch::create(vertexFormat, Mesh::TRIANGLE_STRIP, material, true, initialCapacity > 0 ? initialCapacity : SPRITE_BATCH_DEFAULT_SIZE);
+    // Create the mesh batch, streaming sprites straight into GPU buffers
+    MeshBatch* meshBatch = MeshBatch::create(vertexFormat, Mesh::TRIANGLE_STRIP, material, true, initialCapacity > 0 ? initialCapacity : SPRITE_BATCH_DEFAULT_SIZE,
+                                             SPRITE_BATCH_GROW_SIZE, true);
     material->release(); // don't call SAFE_RELEASE since material is used below
 
     // Create the batch
@@ -222,16 +218,15 @@ void SpriteBatch::draw(const Vector3& dst, float width, float height, float u1,
     downLeft.rotate(pivotPoint, rotationAngle);
     downRight.rotate(pivotPoint, rotationAngle);
     
-    // Write sprite vertex data.
-    static SpriteVertex v[4];
+    // Write sprite vertex data straight into the batch.
+    static unsigned short indices[4] = { 0, 1, 2, 3 };
+    SpriteVertex* v = (SpriteVertex*)_batch->append(4, indices, 4);
+    if (v == NULL)
+        return;
     ADD_SPRITE_VERTEX(v[0], upLeft.x, upLeft.y, dst.z, u1, v1, color.x, color.y, color.z, color.w);
     ADD_SPRITE_VERTEX(v[1], upRight.x, upRight.y, dst.z, u1, v2, color.x, color.y, color.z, color.w);
     ADD_SPRITE_VERTEX(v[2], downLeft.x, downLeft.y, dst.z, u2, v1, color.x, color.y, color.z, color.w);
     ADD_SPRITE_VERTEX(v[3], downRight.x, downRight.y, dst.z, u2, v2, color.x, color.y, color.z, color.w);
-    
-    static unsigned short indices[4] = { 0, 1, 2, 3 };
-
-    _batch->add(v, 4, indices, 4);
 }
 
 void SpriteBatch::draw(float x, float y, float width, float height, float u1, float v1, float u2, float v2, const Vector4& color)
@@ -241,18 +236,22 @@ void SpriteBatch::draw(float x, float y, float width, float height, float u1, fl
 
 void SpriteBatch::draw(float x, float y, float z, float width, float height, float u1, float v1, float u2, float v2, const Vector4& color)
 {
-    // Write sprite vertex data.
+    // Write sprite vertex data straight into the batch.
+    static unsigned short indices[4] = { 0, 1, 2, 3 };
+    SpriteVertex* v = (SpriteVertex*)_batch->append(4, indices, 4);
+    if (v == NULL)
+        return;
     float x2 = x + width;
     float y2 = y + height;
-    static SpriteVertex v[4];
     ADD_SPRITE_VERTEX(v[0], x, y, z, u1, v1, color.x, color.y, color.z, color.w);
     ADD_SPRITE_VERTEX(v[1], x, y2, z, u1, v2, color.x, color.y, color.z, color.w);
     ADD_SPRITE_VERTEX(v[2], x2, y, z, u2, v1, color.x, color.y, color.z, color.w);
     ADD_SPRITE_VERTEX(v[3], x2, y2, z, u2, v2, color.x, color.y, color.z, color.w);
+}
 
-    static unsigned short indices[4] = { 0, 1, 2, 3 };
-
-    _batch->add(v, 4, indices, 4);
+void SpriteBatch::draw(SpriteVertex* vertices, unsigned int vertexCount, unsigned short* indices, unsigned int indexCount)
+{
+    _batch->add(vertices, vertexCount, indices, indexCount);
 }
 
 void SpriteBatch::end()
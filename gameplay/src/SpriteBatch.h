@@ -25,6 +25,7 @@ namespace gameplay
 class SpriteBatch
 {
     friend class Package;
+    friend class TextLayout;
 
 public:
 
@@ -215,6 +216,16 @@ public:
 
 private:
 
+    /**
+     * Sprite vertex structure used for batching.
+     */
+    struct SpriteVertex
+    {
+        float x, y, z;
+        float u, v;
+        float r, g, b, a;
+    };
+
     /**
      * Constructor.
      */
@@ -229,6 +240,17 @@ private:
 
     const Matrix& getOrthoMatrix() const;
 
+    /**
+     * Draws sprites whose vertices were built in advance, as a triangle strip
+     * with degenerate triangles between sprites.
+     *
+     * @param vertices The sprite vertices.
+     * @param vertexCount The number of vertices.
+     * @param indices The triangle strip indices.
+     * @param indexCount The number of indices.
+     */
+    void draw(SpriteVertex* vertices, unsigned int vertexCount, unsigned short* indices, unsigned int indexCount);
+
     MeshBatch* _batch;
     bool _customEffect;
     float _textureWidthRatio;
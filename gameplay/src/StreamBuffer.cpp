@@ -0,0 +1,163 @@
+#include "Base.h"
+#include "StreamBuffer.h"
+
+namespace gameplay
+{
+
+StreamBuffer::StreamBuffer(GLenum target, GLuint handle, unsigned int elementSize, unsigned int capacity)
+    : _target(target), _handle(handle), _elementSize(elementSize), _capacity(capacity), _data(NULL), _start(0), _count(0), _uploaded(0),
+      _orphan(false)
+{
+    _data = new unsigned char[capacity * elementSize];
+}
+
+StreamBuffer::StreamBuffer(const StreamBuffer& copy)
+{
+    // hidden
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    if (_handle)
+    {
+        GL_ASSERT( glDeleteBuffers(1, &_handle) );
+        _handle = 0;
+    }
+    SAFE_DELETE_ARRAY(_data);
+}
+
+StreamBuffer* StreamBuffer::create(GLenum target, unsigned int elementSize, unsigned int capacity)
+{
+    assert(elementSize > 0 && capacity > 0);
+
+    GLuint handle;
+    GL_ASSERT( glGenBuffers(1, &handle) );
+    if (GL_LAST_ERROR())
+    {
+        return NULL;
+    }
+
+    GL_ASSERT( glBindBuffer(target, handle) );
+    if (GL_LAST_ERROR())
+    {
+        glDeleteBuffers(1, &handle);
+        return NULL;
+    }
+
+    GL_CHECK( glBufferData(target, capacity * elementSize, NULL, GL_STREAM_DRAW) );
+    if (GL_LAST_ERROR())
+    {
+        glBindBuffer(target, 0);
+        glDeleteBuffers(1, &handle);
+        return NULL;
+    }
+    GL_ASSERT( glBindBuffer(target, 0) );
+
+    return new StreamBuffer(target, handle, elementSize, capacity);
+}
+
+GLuint StreamBuffer::getHandle() const
+{
+    return _handle;
+}
+
+unsigned int StreamBuffer::getCapacity() const
+{
+    return _capacity;
+}
+
+bool StreamBuffer::setCapacity(unsigned int capacity)
+{
+    assert(capacity > 0);
+    if (capacity < _count)
+    {
+        return false;
+    }
+    if (capacity == _capacity)
+    {
+        return true;
+    }
+
+    unsigned char* data = new unsigned char[capacity * _elementSize];
+    memcpy(data, _data + _start * _elementSize, _count * _elementSize);
+    SAFE_DELETE_ARRAY(_data);
+    _data = data;
+    _capacity = capacity;
+    _start = 0;
+    _uploaded = 0;
+
+    // The GL buffer is reallocated at the new size by the next upload.
+    _orphan = true;
+
+    return true;
+}
+
+void StreamBuffer::begin()
+{
+    _start += _count;
+    _count = 0;
+    _uploaded = 0;
+}
+
+unsigned char* StreamBuffer::append(unsigned int count)
+{
+    if (_count + count > _capacity)
+    {
+        return NULL;
+    }
+
+    if (_start + _count + count > _capacity)
+    {
+        // Wrap around. Earlier regions were already uploaded and drawn, so orphaning the
+        // GL buffer keeps them alive for the GPU while the region is rewritten.
+        memmove(_data, _data + _start * _elementSize, _count * _elementSize);
+        _start = 0;
+        _uploaded = 0;
+        _orphan = true;
+    }
+
+    unsigned char* data = _data + (_start + _count) * _elementSize;
+    _count += count;
+
+    return data;
+}
+
+unsigned char* StreamBuffer::getData() const
+{
+    return _data + _start * _elementSize;
+}
+
+unsigned int StreamBuffer::getStart() const
+{
+    return _start;
+}
+
+unsigned int StreamBuffer::getCount() const
+{
+    return _count;
+}
+
+void StreamBuffer::invalidate()
+{
+    _uploaded = 0;
+}
+
+void StreamBuffer::upload()
+{
+    GL_ASSERT( glBindBuffer(_target, _handle) );
+
+    if (_orphan)
+    {
+        GL_ASSERT( glBufferData(_target, _capacity * _elementSize, NULL, GL_STREAM_DRAW) );
+        _orphan = false;
+    }
+
+    if (_uploaded < _count)
+    {
+        unsigned int offset = (_start + _uploaded) * _elementSize;
+        GL_ASSERT( glBufferSubData(_target, offset, (_count - _uploaded) * _elementSize, _data + offset) );
+        _uploaded = _count;
+    }
+}
+
+}
@@ -0,0 +1,144 @@
+#ifndef STREAMBUFFER_H_
+#define STREAMBUFFER_H_
+
+namespace gameplay
+{
+
+/**
+ * Defines a GPU buffer that streams data written by the CPU, as a ring.
+ *
+ * Data is written in regions: begin() starts a new region after the previous one,
+ * and append() extends it. Regions are written to a CPU copy of the buffer, and each
+ * one is uploaded to the same range of the GPU buffer by upload() before it is drawn.
+ * When a region does not fit before the end of the ring, it is moved to the start of
+ * the ring and the GPU buffer is orphaned before the next upload. The driver then gives
+ * the buffer new storage, so draws still reading the previous contents neither stall
+ * nor see them overwritten.
+ *
+ * Since the storage of a stream buffer is allocated once, data streamed every frame
+ * never reallocates memory, unless a single region outgrows the whole ring.
+ *
+ * All OpenGL calls are made by create(), upload() and the destructor, so the
+ * allocation of regions can run without a GL context.
+ */
+class StreamBuffer
+{
+public:
+
+    /**
+     * Creates a new stream buffer.
+     *
+     * @param target The GL buffer target, such as GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+     * @param elementSize The size of the elements of the buffer, in bytes.
+     * @param capacity The number of elements of the ring.
+     *
+     * @return The new stream buffer, or NULL if the GL buffer could not be created.
+     */
+    static StreamBuffer* create(GLenum target, unsigned int elementSize, unsigned int capacity);
+
+    /**
+     * Destructor.
+     */
+    ~StreamBuffer();
+
+    /**
+     * Gets the handle of the GL buffer.
+     *
+     * @return The GL buffer.
+     */
+    GLuint getHandle() const;
+
+    /**
+     * Gets the number of elements of the ring.
+     *
+     * @return The capacity of the ring.
+     */
+    unsigned int getCapacity() const;
+
+    /**
+     * Sets the number of elements of the ring, keeping the current region, which is
+     * moved to the start of the ring.
+     *
+     * @param capacity The new capacity of the ring.
+     *
+     * @return True if the capacity was set, false if the current region does not fit in it.
+     */
+    bool setCapacity(unsigned int capacity);
+
+    /**
+     * Starts a new, empty region after the current one.
+     */
+    void begin();
+
+    /**
+     * Appends elements to the current region, moving the region to the start of the
+     * ring if they do not fit before its end.
+     *
+     * The returned pointer is only valid until the next call to append, since the
+     * region may move.
+     *
+     * @param count The number of elements to append.
+     *
+     * @return The storage of the appended elements, or NULL if the region would not fit in the ring.
+     */
+    unsigned char* append(unsigned int count);
+
+    /**
+     * Gets the storage of the current region.
+     *
+     * @return The first element of the current region.
+     */
+    unsigned char* getData() const;
+
+    /**
+     * Gets the position of the current region in the ring.
+     *
+     * @return The index of the first element of the current region.
+     */
+    unsigned int getStart() const;
+
+    /**
+     * Gets the number of elements in the current region.
+     *
+     * @return The size of the current region.
+     */
+    unsigned int getCount() const;
+
+    /**
+     * Marks the whole current region to be uploaded again, after elements that were
+     * already uploaded were modified.
+     */
+    void invalidate();
+
+    /**
+     * Binds the GL buffer, and uploads the elements of the current region that were
+     * appended since the last upload.
+     */
+    void upload();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    StreamBuffer(GLenum target, GLuint handle, unsigned int elementSize, unsigned int capacity);
+
+    /**
+     * Hidden copy constructor.
+     */
+    StreamBuffer(const StreamBuffer& copy);
+
+    GLenum _target;             // The GL buffer target.
+    GLuint _handle;             // The GL buffer.
+    unsigned int _elementSize;  // The size of elements, in bytes.
+    unsigned int _capacity;     // The number of elements of the ring.
+    unsigned char* _data;       // The CPU copy of the ring.
+    unsigned int _start;        // The first element of the current region.
+    unsigned int _count;        // The number of elements of the current region.
+    unsigned int _uploaded;     // The number of elements of the current region uploaded to the GL buffer.
+    bool _orphan;               // Whether the GL buffer must be orphaned before the next upload.
+};
+
+}
+
+#endif
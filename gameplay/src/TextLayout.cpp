@@ -0,0 +1,200 @@
+#include "Base.h"
+#include "TextLayout.h"
+
+// The maximum number of glyphs added to the font's batch at once, so that the
+// strip indices of a batch of glyphs fit in 16 bits.
+#define TEXT_LAYOUT_MAX_BATCH_GLYPHS 8192
+
+namespace gameplay
+{
+
+// Triangle strip indices of consecutive glyph quads, joined by degenerate triangles.
+// They are the same for every layout, so they are shared.
+static std::vector<unsigned short> __glyphIndices;
+
+TextLayout::TextLayout(Font* font)
+    : _font(font), _clip(false), _color(Vector4::one()), _size(0), _justify(Font::ALIGN_TOP_LEFT), _wrap(true), _rightToLeft(false),
+      _glyphVersion(0)
+{
+}
+
+TextLayout::TextLayout(const TextLayout& copy)
+{
+    // hidden
+}
+
+TextLayout::~TextLayout()
+{
+    SAFE_RELEASE(_font);
+}
+
+TextLayout* TextLayout::create(Font* font)
+{
+    assert(font);
+
+    font->addRef();
+
+    return new TextLayout(font);
+}
+
+Font* TextLayout::getFont() const
+{
+    return _font;
+}
+
+void TextLayout::setText(const char* text, int x, int y, const Vector4& color, unsigned int size, bool rightToLeft)
+{
+    assert(text);
+
+    Rectangle area(x, y, 0, 0);
+    if (!_clip && _area == area && _size == size && _rightToLeft == rightToLeft && _text == text)
+    {
+        setColor(color);
+        return;
+    }
+
+    _text = text;
+    _area = area;
+    _clip = false;
+    _color.set(color);
+    _size = size;
+    _rightToLeft = rightToLeft;
+
+    layout();
+}
+
+void TextLayout::setText(const char* text, const Rectangle& clip, const Vector4& color, unsigned int size, Font::Justify justify, bool wrap, bool rightToLeft)
+{
+    assert(text);
+
+    if (_clip && _area == clip && _size == size && _justify == justify && _wrap == wrap && _rightToLeft == rightToLeft && _text == text)
+    {
+        setColor(color);
+        return;
+    }
+
+    _text = text;
+    _area = clip;
+    _clip = true;
+    _color.set(color);
+    _size = size;
+    _justify = justify;
+    _wrap = wrap;
+    _rightToLeft = rightToLeft;
+
+    layout();
+}
+
+const char* TextLayout::getText() const
+{
+    return _text.c_str();
+}
+
+void TextLayout::setColor(const Vector4& color)
+{
+    if (_color == color)
+    {
+        return;
+    }
+
+    _color.set(color);
+    for (unsigned int i = 0, count = _vertices.size(); i < count; ++i)
+    {
+        SpriteBatch::SpriteVertex& vertex = _vertices[i];
+        vertex.r = color.x;
+        vertex.g = color.y;
+        vertex.b = color.z;
+        vertex.a = color.w;
+    }
+}
+
+const Vector4& TextLayout::getColor() const
+{
+    return _color;
+}
+
+unsigned int TextLayout::getGlyphCount() const
+{
+    return _vertices.size() / 4;
+}
+
+void TextLayout::draw()
+{
+    if (_glyphVersion != _font->getGlyphVersion())
+    {
+        // Glyphs were evicted from the font's atlas, so the cached quads may be stale.
+        layout();
+    }
+
+    unsigned int glyphCount = _vertices.size() / 4;
+    if (glyphCount == 0)
+    {
+        return;
+    }
+
+    // Extend the shared strip indices to cover a full batch of glyphs on first use.
+    if (__glyphIndices.empty())
+    {
+        __glyphIndices.reserve(TEXT_LAYOUT_MAX_BATCH_GLYPHS * 6 - 2);
+        for (unsigned int i = 0; i < TEXT_LAYOUT_MAX_BATCH_GLYPHS; ++i)
+        {
+            unsigned short first = i * 4;
+            if (i > 0)
+            {
+                __glyphIndices.push_back(first - 1);
+                __glyphIndices.push_back(first);
+            }
+            __glyphIndices.push_back(first);
+            __glyphIndices.push_back(first + 1);
+            __glyphIndices.push_back(first + 2);
+            __glyphIndices.push_back(first + 3);
+        }
+    }
+
+    // Add each run of glyphs from the same font page at once. The indices are relative to
+    // the first vertex added, so every run uses the same ones.
+    for (unsigned int start = 0; start < glyphCount; )
+    {
+        unsigned int page = _pages[start];
+        unsigned int count = 1;
+        while (start + count < glyphCount && count < TEXT_LAYOUT_MAX_BATCH_GLYPHS && _pages[start + count] == page)
+        {
+            ++count;
+        }
+        _font->getBatch(page)->draw(&_vertices[start * 4], count * 4, &__glyphIndices[0], count * 6 - 2);
+        start += count;
+    }
+}
+
+void TextLayout::layout()
+{
+    _vertices.clear();
+    _pages.clear();
+    if (_clip)
+    {
+        _font->layoutText(_text.c_str(), _area, _color, _size, _justify, _wrap, _rightToLeft, this);
+    }
+    else
+    {
+        _font->layoutText(_text.c_str(), _area.x, _area.y, _color, _size, _rightToLeft, this);
+    }
+    _glyphVersion = _font->getGlyphVersion();
+}
+
+void TextLayout::addGlyph(float x, float y, float width, float height, const float* uvs, unsigned int page, const Vector4& color)
+{
+    // Same vertex order as SpriteBatch::draw.
+    float x2 = x + width;
+    float y2 = y + height;
+    SpriteBatch::SpriteVertex v[4] =
+    {
+        { x, y, 0, uvs[0], uvs[1], color.x, color.y, color.z, color.w },
+        { x, y2, 0, uvs[0], uvs[3], color.x, color.y, color.z, color.w },
+        { x2, y, 0, uvs[2], uvs[1], color.x, color.y, color.z, color.w },
+        { x2, y2, 0, uvs[2], uvs[3], color.x, color.y, color.z, color.w }
+    };
+    _vertices.insert(_vertices.end(), v, v + 4);
+    _pages.push_back(page);
+}
+
+}
@@ -0,0 +1,160 @@
+#ifndef TEXTLAYOUT_H_
+#define TEXTLAYOUT_H_
+
+#include "Font.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a cached layout of text drawn with a font.
+ *
+ * Drawing text with Font::drawText measures, wraps, justifies and clips the text
+ * again on every call, and adds each glyph to the font's batch separately. A text
+ * layout instead keeps the glyph quads produced by laying out its text, and adds
+ * all of them to the font's batch at once when drawn. The text is only laid out
+ * again when its text, position, area, size or options change; a change of color
+ * only updates the colors of the cached quads. With fonts that rasterize their glyphs
+ * at runtime, the text is also laid out again when glyphs it uses were evicted from
+ * the font's atlas.
+ *
+ * This makes layouts well suited to labels that are drawn every frame but rarely
+ * change. A layout is drawn between calls to Font::begin and Font::end of its font,
+ * like Font::drawText.
+ */
+class TextLayout : public Ref
+{
+    friend class Font;
+
+public:
+
+    /**
+     * Creates a new, empty text layout for the given font.
+     *
+     * @param font The font to lay out text with.
+     *
+     * @return The new text layout.
+     */
+    static TextLayout* create(Font* font);
+
+    /**
+     * Gets the font of this layout.
+     *
+     * @return The font.
+     */
+    Font* getFont() const;
+
+    /**
+     * Sets the text of this layout, drawn at a position.
+     *
+     * The parameters are those of the corresponding Font::drawText method. The text is
+     * only laid out again if it differs from the current layout.
+     *
+     * @param text The text to lay out.
+     * @param x The viewport x position to draw text at.
+     * @param y The viewport y position to draw text at.
+     * @param color The color of text.
+     * @param size The size to draw text.
+     * @param rightToLeft Whether the text is written right-to-left.
+     */
+    void setText(const char* text, int x, int y, const Vector4& color, unsigned int size, bool rightToLeft = false);
+
+    /**
+     * Sets the text of this layout, drawn within a rectangular area.
+     *
+     * The parameters are those of the corresponding Font::drawText method. The text is
+     * only laid out again if it differs from the current layout.
+     *
+     * @param text The text to lay out.
+     * @param clip The viewport area to draw within. Text will be clipped outside this rectangle.
+     * @param color The color of text.
+     * @param size The size to draw text.
+     * @param justify Justification of text within the viewport.
+     * @param wrap Wraps text to fit within the width of the viewport if true.
+     * @param rightToLeft Whether the text is written right-to-left.
+     */
+    void setText(const char* text, const Rectangle& clip, const Vector4& color, unsigned int size,
+                 Font::Justify justify = Font::ALIGN_TOP_LEFT, bool wrap = true, bool rightToLeft = false);
+
+    /**
+     * Gets the text of this layout.
+     *
+     * @return The text.
+     */
+    const char* getText() const;
+
+    /**
+     * Sets the color of the text, without laying it out again.
+     *
+     * @param color The color of text.
+     */
+    void setColor(const Vector4& color);
+
+    /**
+     * Gets the color of the text.
+     *
+     * @return The color of text.
+     */
+    const Vector4& getColor() const;
+
+    /**
+     * Gets the number of glyphs drawn by this layout, after clipping.
+     *
+     * @return The number of glyphs.
+     */
+    unsigned int getGlyphCount() const;
+
+    /**
+     * Draws the laid out text with the font's batch.
+     */
+    void draw();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    TextLayout(Font* font);
+
+    /**
+     * Hidden copy constructor.
+     */
+    TextLayout(const TextLayout& copy);
+
+    /**
+     * Hidden copy assignment operator (not implemented).
+     */
+    TextLayout& operator=(const TextLayout& copy);
+
+    /**
+     * Destructor.
+     */
+    ~TextLayout();
+
+    /**
+     * Lays out the text with the current parameters.
+     */
+    void layout();
+
+    /**
+     * Adds the quad of a glyph to the layout. Called by the font while laying out text.
+     */
+    void addGlyph(float x, float y, float width, float height, const float* uvs, unsigned int page, const Vector4& color);
+
+    Font* _font;                                        // The font to lay out text with.
+    std::string _text;                                  // The text.
+    Rectangle _area;                                    // The area the text is drawn within, or its position.
+    bool _clip;                                         // Whether the text is drawn within an area.
+    Vector4 _color;                                     // The color of text.
+    unsigned int _size;                                 // The size to draw text.
+    Font::Justify _justify;                             // The justification of text within its area.
+    bool _wrap;                                         // Whether text wraps within its area.
+    bool _rightToLeft;                                  // Whether the text is written right-to-left.
+    std::vector<SpriteBatch::SpriteVertex> _vertices;   // The 4 vertices of each laid out glyph.
+    std::vector<unsigned int> _pages;                   // The font page of each laid out glyph.
+    unsigned int _glyphVersion;                         // The glyph version of the font the text was laid out with.
+};
+
+}
+
+#endif
@@ -7,7 +7,7 @@ namespace gameplay
 
 static std::vector<Texture*> __textureCache;
 
-Texture::Texture() : _handle(0), _mipmapped(false), _cached(false)
+Texture::Texture() : _handle(0), _format(RGBA), _mipmapped(false), _cached(false)
 {
 }
 
@@ -125,6 +125,7 @@ Texture* Texture::create(Format format, unsigned int width, unsigned int height,
 
     Texture* texture = new Texture();
     texture->_handle = textureId;
+    texture->_format = format;
     texture->_width = width;
     texture->_height = height;
 
@@ -136,6 +137,19 @@ Texture* Texture::create(Format format, unsigned int width, unsigned int height,
     return texture;
 }
 
+void Texture::setData(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const unsigned char* data)
+{
+    assert(x + width <= _width && y + height <= _height);
+
+    GLint currentTextureId;
+    GL_ASSERT( glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTextureId) );
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _handle) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, (GLenum)_format, _format == DEPTH ? GL_UNSIGNED_INT : GL_UNSIGNED_BYTE, data) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 4) );
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, (GLuint)currentTextureId) );
+}
+
 unsigned int Texture::getWidth() const
 {
     return _width;
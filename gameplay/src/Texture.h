@@ -141,6 +141,21 @@ public:
      */
     static Texture* create(Format format, unsigned int width, unsigned int height, unsigned char* data, bool generateMipmaps = false);
 
+    /**
+     * Replaces a region of the texture's data.
+     *
+     * The data must be in the format the texture was created with, with tightly
+     * packed rows. Only the base level is updated; the mipmap chain is not
+     * regenerated.
+     *
+     * @param x The x coordinate of the region, in pixels.
+     * @param y The y coordinate of the region, in pixels.
+     * @param width The width of the region, in pixels.
+     * @param height The height of the region, in pixels.
+     * @param data The new data of the region.
+     */
+    void setData(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const unsigned char* data);
+
     /**
      * Returns the texture width.
      */
@@ -205,6 +220,7 @@ private:
 
     std::string _path;
     TextureHandle _handle;
+    Format _format;
     unsigned int _width;
     unsigned int _height;
     bool _mipmapped;
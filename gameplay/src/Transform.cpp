@@ -5,29 +5,32 @@
 namespace gameplay
 {
 
+int Transform::_suspendTransformChanged = 0;
+std::vector<Transform*> Transform::_transformsChanged;
+
 Transform::Transform()
-    : _matrixDirty(false), _listeners(NULL)
+    : _matrixDirty(false), _listeners(NULL), _transformChangedPending(false)
 {
     _targetType = AnimationTarget::TRANSFORM;
     _scale.set(Vector3::one());
 }
 
 Transform::Transform(const Vector3& scale, const Quaternion& rotation, const Vector3& translation)
-    : _matrixDirty(false), _listeners(NULL)
+    : _matrixDirty(false), _listeners(NULL), _transformChangedPending(false)
 {
     _targetType = AnimationTarget::TRANSFORM;
     set(scale, rotation, translation);
 }
 
 Transform::Transform(const Vector3& scale, const Matrix& rotation, const Vector3& translation)
-    : _matrixDirty(false), _listeners(NULL)
+    : _matrixDirty(false), _listeners(NULL), _transformChangedPending(false)
 {
     _targetType = AnimationTarget::TRANSFORM;
     set(scale, rotation, translation);
 }
 
 Transform::Transform(const Transform& copy)
-    : _matrixDirty(false), _listeners(NULL)
+    : _matrixDirty(false), _listeners(NULL), _transformChangedPending(false)
 {
     _targetType = AnimationTarget::TRANSFORM;
     set(copy);
@@ -35,9 +38,59 @@ Transform::Transform(const Transform& copy)
 
 Transform::~Transform()
 {
+    if (_transformChangedPending)
+    {
+        // Clear the entries rather than erasing them, since resumeTransformChanged may be
+        // walking the list by index while a listener deletes this transform. A transform
+        // changed again during the resume is in the list twice, so clear every entry.
+        std::replace(_transformsChanged.begin(), _transformsChanged.end(), this, (Transform*)NULL);
+    }
+
     SAFE_DELETE(_listeners);
 }
 
+void Transform::suspendTransformChanged()
+{
+    ++_suspendTransformChanged;
+}
+
+void Transform::resumeTransformChanged()
+{
+    assert(_suspendTransformChanged > 0);
+    if (_suspendTransformChanged == 0)
+        return;
+
+    if (_suspendTransformChanged == 1)
+    {
+        // Nodes skip their children that are still pending, which are notified through their
+        // own entry. Each entry stops being pending just before it is notified, so that
+        // transforms changed again by listeners (including the one being notified) are
+        // appended and notified again. Entries of transforms deleted while pending are NULL.
+        for (unsigned int i = 0; i < _transformsChanged.size(); ++i)
+        {
+            Transform* transform = _transformsChanged[i];
+            if (transform)
+            {
+                transform->_transformChangedPending = false;
+                transform->transformChanged();
+            }
+        }
+        _transformsChanged.clear();
+    }
+
+    --_suspendTransformChanged;
+}
+
+bool Transform::isTransformChangedSuspended()
+{
+    return _suspendTransformChanged > 0;
+}
+
+bool Transform::isTransformChangedPending() const
+{
+    return _transformChangedPending;
+}
+
 const Matrix& Transform::getMatrix() const
 {
     if (_matrixDirty)
@@ -843,7 +896,19 @@ void Transform::setAnimationPropertyValue(int propertyId, AnimationValue* value,
 void Transform::dirty()
 {
     _matrixDirty = true;
-    transformChanged();
+
+    if (_suspendTransformChanged > 0)
+    {
+        if (!_transformChangedPending)
+        {
+            _transformChangedPending = true;
+            _transformsChanged.push_back(this);
+        }
+    }
+    else
+    {
+        transformChanged();
+    }
 }
 
 void Transform::addListener(Transform::Listener* listener, long cookie)
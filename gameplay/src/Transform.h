@@ -28,6 +28,8 @@ class BoundingSphere;
  */
 class Transform : public AnimationTarget
 {
+    friend class AnimationPose;
+
 public:
 
     /**
@@ -711,6 +713,41 @@ public:
      * Removes a transform listener.
      */
     void removeListener(Transform::Listener* listener);
+
+    /**
+     * Suspends the propagation of transform changes.
+     *
+     * While suspended, changing a transform only updates its own values: the
+     * transform is recorded as changed, and its transformChanged notification
+     * (which marks the world transforms of its node's subtree dirty and notifies
+     * its listeners) is deferred until resumeTransformChanged is called.
+     *
+     * This is used to apply many changes to a hierarchy in a single pass, such
+     * as when animations write their values back to their target transforms.
+     * Calls can be nested; changes are propagated when the outermost call is resumed.
+     *
+     * The changed transforms are recorded in a single list shared by all transforms,
+     * so transform changes must only be suspended and resumed on the main thread.
+     */
+    static void suspendTransformChanged();
+
+    /**
+     * Resumes the propagation of transform changes suspended by suspendTransformChanged.
+     *
+     * When the outermost suspension is resumed, each transform changed while
+     * suspended is notified. A changed node does not traverse the children whose
+     * own changes have not been notified yet, so a subtree in which several nodes
+     * were changed is usually traversed only once. Transforms changed by listeners
+     * during the resume are notified too, even when they were already notified.
+     */
+    static void resumeTransformChanged();
+
+    /**
+     * Determines whether the propagation of transform changes is currently suspended.
+     *
+     * @return true if transform changes are suspended, false otherwise.
+     */
+    static bool isTransformChangedSuspended();
     
     /**
      * @see AnimationTarget#getAnimationPropertyComponentCount
@@ -737,6 +774,7 @@ protected:
 
     void dirty();
     virtual void transformChanged();
+    bool isTransformChangedPending() const;
 
     Vector3 _scale;
     Quaternion _rotation;
@@ -746,6 +784,10 @@ protected:
     std::list<TransformListener>* _listeners;
 
 private:
+
+    static int _suspendTransformChanged;                // The nesting depth of suspendTransformChanged calls.
+    static std::vector<Transform*> _transformsChanged;  // The transforms changed while suspended (main thread only).
+
     static const char ANIMATION_SCALE_X_BIT = 0x01; 
     static const char ANIMATION_SCALE_Y_BIT = 0x02; 
     static const char ANIMATION_SCALE_Z_BIT = 0x04; 
@@ -761,6 +803,8 @@ private:
     void applyAnimationValueTranslationX(float tx);
     void applyAnimationValueTranslationY(float ty);
     void applyAnimationValueTranslationZ(float tz);
+
+    bool _transformChangedPending;  // Whether this transform is in _transformsChanged.
 };
 
 }
@@ -10,7 +10,7 @@ static GLuint __maxVertexAttribs = 0;
 static std::vector<VertexAttributeBinding*> __vertexAttributeBindingCache;
 
 VertexAttributeBinding::VertexAttributeBinding() :
-    _handle(0), _attributes(NULL), _mesh(NULL), _effect(NULL)
+    _handle(0), _attributes(NULL), _mesh(NULL), _vertexBuffer(0), _effect(NULL)
 {
 }
 
@@ -51,7 +51,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effec
         }
     }
 
-    b = create(mesh, mesh->getVertexFormat(), 0, effect);
+    b = create(mesh, mesh->getVertexBuffer(), mesh->getVertexFormat(), 0, effect);
 
     // Add the new vertex attribute binding to the cache.
     if (b)
@@ -64,10 +64,15 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, Effect* effec
 
 VertexAttributeBinding* VertexAttributeBinding::create(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
 {
-    return create(NULL, vertexFormat, vertexPointer, effect);
+    return create(NULL, 0, vertexFormat, vertexPointer, effect);
 }
 
-VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
+VertexAttributeBinding* VertexAttributeBinding::create(VertexBufferHandle vertexBuffer, const VertexFormat& vertexFormat, Effect* effect)
+{
+    return create(NULL, vertexBuffer, vertexFormat, 0, effect);
+}
+
+VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, VertexBufferHandle vertexBuffer, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect)
 {
     // One-time initialization.
     if (__maxVertexAttribs == 0)
@@ -87,7 +92,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
     VertexAttributeBinding* b = new VertexAttributeBinding();
 
 #ifdef USE_GL_VAOS
-    if (mesh && glGenVertexArrays)
+    if (vertexBuffer && glGenVertexArrays)
     {
         GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
         GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,0) );
@@ -104,8 +109,8 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         // Bind the new VAO.
         GL_ASSERT( glBindVertexArray(b->_handle) );
 
-        // Bind the Mesh VBO so our glVertexAttribPointer calls use it.
-        GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, mesh->getVertexBuffer()) );
+        // Bind the VBO so our glVertexAttribPointer calls use it.
+        GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer) );
     }
     else
 #endif
@@ -130,6 +135,7 @@ VertexAttributeBinding* VertexAttributeBinding::create(Mesh* mesh, const VertexF
         b->_mesh = mesh;
         mesh->addRef();
     }
+    b->_vertexBuffer = vertexBuffer;
     
     b->_effect = effect;
     effect->addRef();
@@ -246,9 +252,9 @@ void VertexAttributeBinding::bind()
     else
     {
         // Software mode
-        if (_mesh)
+        if (_vertexBuffer)
         {
-            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _mesh->getVertexBuffer()) );
+            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer) );
         }
         else
         {
@@ -277,7 +283,7 @@ void VertexAttributeBinding::unbind()
     else
     {
         // Software mode
-        if (_mesh)
+        if (_vertexBuffer)
         {
             GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
         }
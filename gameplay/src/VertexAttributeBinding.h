@@ -66,6 +66,22 @@ public:
      */
     static VertexAttributeBinding* create(const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
 
+    /**
+     * Creates a vertex attribute binding for the vertices of the given vertex buffer.
+     *
+     * The vertices start at the beginning of the buffer, formatted as indicated in the
+     * specified vertexFormat parameter. Unlike bindings of meshes, the returned binding
+     * is not shared. If OpenGL VAOs are enabled, a new VAO will be created and stored in
+     * the returned VertexAttributeBinding.
+     *
+     * @param vertexBuffer The vertex buffer.
+     * @param vertexFormat The vertex format.
+     * @param effect The effect.
+     *
+     * @return A VertexAttributeBinding for the requested parameters.
+     */
+    static VertexAttributeBinding* create(VertexBufferHandle vertexBuffer, const VertexFormat& vertexFormat, Effect* effect);
+
     /**
      * Binds this vertex array object.
      */
@@ -99,13 +115,14 @@ private:
      */
     ~VertexAttributeBinding();
 
-    static VertexAttributeBinding* create(Mesh* mesh, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
+    static VertexAttributeBinding* create(Mesh* mesh, VertexBufferHandle vertexBuffer, const VertexFormat& vertexFormat, void* vertexPointer, Effect* effect);
 
     void setVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalize, GLsizei stride, void* pointer);
 
     GLuint _handle;
     VertexAttribute* _attributes;
     Mesh* _mesh;
+    VertexBufferHandle _vertexBuffer;
     Effect* _effect;
 };
 
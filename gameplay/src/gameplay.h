@@ -33,14 +33,19 @@
 #include "VertexFormat.h"
 #include "VertexAttributeBinding.h"
 #include "Model.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "Light.h"
 #include "Scene.h"
+#include "SpatialIndex.h"
 #include "Node.h"
 #include "Joint.h"
+#include "SkinnedMesh.h"
 #include "Font.h"
+#include "TextLayout.h"
 #include "SpriteBatch.h"
 #include "ParticleEmitter.h"
+#include "ParticleSystem.h"
 #include "FrameBuffer.h"
 #include "RenderTarget.h"
 #include "DepthStencilTarget.h"